@@ -0,0 +1,167 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+// Python bindings for the geort._C extension module.
+// Everything here only converts tensors and checks shapes, the work itself is done in the
+// plain C++ sources next to this file.
+
+#include <torch/extension.h>
+
+#include "CompiledHand.hpp"
+#include "PinchLoss.hpp"
+#include "PointCloudResample.hpp"
+
+/// @brief Voxel downsample each finger of a [Num_Fingers, N, 3] cloud and resample it to K points.
+/// @return a float32 tensor of shape [Num_Fingers, K, 3].
+static torch::Tensor VoxelResample(
+	const torch::Tensor& p_Points,
+	const double p_VoxelSize,
+	const int64_t p_NumSamples,
+	const int64_t p_Seed)
+{
+	TORCH_CHECK(p_Points.dim() == 3 && p_Points.size(2) == 3, "voxel_resample expects points of shape [Num_Fingers, N, 3].");
+	TORCH_CHECK(p_NumSamples > 0, "voxel_resample needs a positive number of samples.");
+
+	const torch::Tensor t_Points = p_Points.to(torch::kCPU, torch::kFloat32).contiguous();
+	torch::Tensor t_Out = torch::empty({ t_Points.size(0), p_NumSamples, 3 }, torch::kFloat32);
+
+	bool t_Success = false;
+	{
+		pybind11::gil_scoped_release t_NoGil;
+		t_Success = VoxelResampleFingers(
+			t_Points.data_ptr<float>(),
+			static_cast<size_t>(t_Points.size(0)),
+			static_cast<size_t>(t_Points.size(1)),
+			static_cast<float>(p_VoxelSize),
+			static_cast<size_t>(p_NumSamples),
+			static_cast<uint64_t>(p_Seed),
+			t_Out.data_ptr<float>());
+	}
+	TORCH_CHECK(t_Success, "voxel_resample failed: a finger has no finite points or the voxel size is invalid.");
+
+	return t_Out;
+}
+
+/// @brief Autograd wrapper around the fused CPU pinch loss kernel.
+class PinchLossFunction : public torch::autograd::Function<PinchLossFunction>
+{
+public:
+	static torch::Tensor forward(
+		torch::autograd::AutogradContext* p_Context,
+		const torch::Tensor& p_Points,
+		const torch::Tensor& p_Embedded,
+		const double p_Threshold)
+	{
+		const torch::Tensor t_Points = p_Points.detach().contiguous();
+		const torch::Tensor t_Embedded = p_Embedded.detach().contiguous();
+		const int64_t t_NumFingers = t_Points.size(1);
+		torch::Tensor t_PairWeights = torch::zeros({ t_NumFingers, t_NumFingers }, torch::kFloat64);
+
+		const double t_Loss = PinchLossForward(
+			t_Points.data_ptr<float>(),
+			t_Embedded.data_ptr<float>(),
+			static_cast<size_t>(t_Points.size(0)),
+			static_cast<size_t>(t_NumFingers),
+			static_cast<float>(p_Threshold),
+			t_PairWeights.data_ptr<double>());
+
+		p_Context->save_for_backward({ t_Points, t_Embedded, t_PairWeights });
+		p_Context->saved_data["threshold"] = p_Threshold;
+		return torch::full({}, t_Loss, p_Embedded.options());
+	}
+
+	static torch::autograd::tensor_list backward(
+		torch::autograd::AutogradContext* p_Context,
+		torch::autograd::tensor_list p_GradOutputs)
+	{
+		const torch::autograd::variable_list t_Saved = p_Context->get_saved_variables();
+		const torch::Tensor& t_Points = t_Saved[0];
+		const torch::Tensor& t_Embedded = t_Saved[1];
+		const torch::Tensor& t_PairWeights = t_Saved[2];
+		torch::Tensor t_GradEmbedded = torch::empty_like(t_Embedded);
+
+		PinchLossBackward(
+			t_Points.data_ptr<float>(),
+			t_Embedded.data_ptr<float>(),
+			static_cast<size_t>(t_Points.size(0)),
+			static_cast<size_t>(t_Points.size(1)),
+			static_cast<float>(p_Context->saved_data["threshold"].toDouble()),
+			t_PairWeights.data_ptr<double>(),
+			p_GradOutputs[0].item<float>(),
+			t_GradEmbedded.data_ptr<float>());
+
+		return { torch::Tensor(), t_GradEmbedded, torch::Tensor() };
+	}
+};
+
+/// @brief Pinch loss over all finger pairs i < j of a [B, N, 3] keypoint batch.
+/// CPU float32 batches go through the fused kernel. Other devices use the same math
+/// as one batched ATen expression over all pairs, so there is no per-pair dispatch either way.
+static torch::Tensor PinchLoss(
+	const torch::Tensor& p_Points,
+	const torch::Tensor& p_Embedded,
+	const double p_Threshold)
+{
+	TORCH_CHECK(p_Points.dim() == 3 && p_Points.size(2) == 3, "pinch_loss expects points of shape [B, N, 3].");
+	TORCH_CHECK(p_Points.sizes() == p_Embedded.sizes(), "pinch_loss expects points and embedded points of the same shape.");
+
+	if (p_Points.is_cpu() && p_Embedded.is_cpu()
+		&& p_Points.scalar_type() == torch::kFloat32 && p_Embedded.scalar_type() == torch::kFloat32)
+	{
+		return PinchLossFunction::apply(p_Points, p_Embedded, p_Threshold);
+	}
+
+	const int64_t t_NumFingers = p_Points.size(1);
+	const torch::Tensor t_Upper = torch::ones({ t_NumFingers, t_NumFingers }, p_Points.options().dtype(torch::kBool)).triu(1);
+	const torch::Tensor t_Distance = (p_Points.unsqueeze(2) - p_Points.unsqueeze(1)).norm(2, -1); // [B, N, N]
+	const torch::Tensor t_Mask = ((t_Distance < p_Threshold) & t_Upper).to(p_Embedded.scalar_type()).detach();
+	const torch::Tensor t_EmbeddedDistance = (p_Embedded.unsqueeze(2) - p_Embedded.unsqueeze(1)).pow(2).sum(-1); // [B, N, N]
+	return ((t_Mask * t_EmbeddedDistance).sum(0) / (t_Mask.sum(0) + s_PinchLossEpsilon)).sum();
+}
+
+/// @brief Batched forward kinematics of a compiled hand.
+/// @param p_Qpos float64 joint positions, [B, DOF] in joint_order order.
+/// @return float64 keypoints in the base link frame, [B, Num_Keypoints, 3].
+static torch::Tensor CompiledHandForwardKinematics(const CompiledHand& p_Hand, const torch::Tensor& p_Qpos)
+{
+	TORCH_CHECK(p_Hand.IsLoaded(), "The compiled hand is not loaded.");
+	TORCH_CHECK(p_Qpos.dim() == 2 && p_Qpos.size(1) == p_Hand.GetNumDof(), "forward_kinematics expects qpos of shape [B, DOF].");
+
+	const torch::Tensor t_Qpos = p_Qpos.to(torch::kCPU, torch::kFloat64).contiguous();
+	const int64_t t_Batch = t_Qpos.size(0);
+	torch::Tensor t_Out = torch::empty({ t_Batch, static_cast<int64_t>(p_Hand.GetNumKeypoints()), 3 }, torch::kFloat64);
+	const double* const t_In = t_Qpos.data_ptr<double>();
+	double* const t_Keypoints = t_Out.data_ptr<double>();
+
+	pybind11::gil_scoped_release t_NoGil;
+	at::parallel_for(0, t_Batch, 256, [&](const int64_t p_Begin, const int64_t p_End)
+	{
+		std::vector<double> t_Scratch;
+		for (int64_t b = p_Begin; b < p_End; b++)
+		{
+			p_Hand.ForwardKinematics(t_In + b * p_Hand.GetNumDof(), t_Keypoints + b * p_Hand.GetNumKeypoints() * 3, t_Scratch);
+		}
+	});
+	return t_Out;
+}
+
+PYBIND11_MODULE(TORCH_EXTENSION_NAME, m)
+{
+	pybind11::class_<CompiledHand>(m, "CompiledHand")
+		.def(pybind11::init<>())
+		.def("load", &CompiledHand::Load, pybind11::arg("path"))
+		.def_property_readonly("num_dof", &CompiledHand::GetNumDof)
+		.def_property_readonly("num_keypoints", &CompiledHand::GetNumKeypoints)
+		.def_property_readonly("input_hash", &CompiledHand::GetInputHash)
+		.def("forward_kinematics", &CompiledHandForwardKinematics, pybind11::arg("qpos"));
+
+	m.def("voxel_resample", &VoxelResample,
+		"Per-finger hashed voxel downsample followed by uniform resampling to [Num_Fingers, K, 3].",
+		pybind11::arg("points"), pybind11::arg("voxel_size"), pybind11::arg("num_samples"), pybind11::arg("seed"));
+	m.def("pinch_loss", &PinchLoss,
+		"Fused pinch loss over all finger pairs of a [B, N, 3] keypoint batch.",
+		pybind11::arg("points"), pybind11::arg("embedded_points"), pybind11::arg("threshold") = 0.015);
+}
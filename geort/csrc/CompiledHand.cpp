@@ -0,0 +1,203 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "CompiledHand.hpp"
+
+// std::cos, std::sin
+#include <cmath>
+// std::memcmp, std::memcpy
+#include <cstring>
+// std::ifstream
+#include <fstream>
+#include <iostream>
+// std::istreambuf_iterator
+#include <iterator>
+
+// geort/env/compiled_hand.py writes these structs with fixed struct formats.
+static_assert(sizeof(CompiledHandHeader) == 64, "CompiledHandHeader layout changed, update compiled_hand.py.");
+static_assert(sizeof(CompiledHandLink) == 144, "CompiledHandLink layout changed, update compiled_hand.py.");
+static_assert(sizeof(CompiledHandKeypoint) == 32, "CompiledHandKeypoint layout changed, update compiled_hand.py.");
+
+/// @brief p_Out = p_A * p_B for row major 3x4 rigid transforms.
+static inline void ComposeTransforms(const double* const p_A, const double* const p_B, double* const p_Out)
+{
+	for (int r = 0; r < 3; r++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			p_Out[r * 4 + c] = p_A[r * 4 + 0] * p_B[0 * 4 + c]
+				+ p_A[r * 4 + 1] * p_B[1 * 4 + c]
+				+ p_A[r * 4 + 2] * p_B[2 * 4 + c];
+		}
+		p_Out[r * 4 + 3] += p_A[r * 4 + 3];
+	}
+}
+
+/// @brief The 3x4 transform of a joint's motion for position p_Q.
+static inline void JointMotion(const CompiledHandLink& p_Link, const double p_Q, double* const p_Out)
+{
+	const double* const t_Axis = p_Link.axis;
+	if (p_Link.jointType == CompiledHandJointType_Revolute)
+	{
+		// Rodrigues' rotation formula.
+		const double t_C = std::cos(p_Q);
+		const double t_S = std::sin(p_Q);
+		const double t_T = 1.0 - t_C;
+		const double t_X = t_Axis[0], t_Y = t_Axis[1], t_Z = t_Axis[2];
+		const double t_Motion[12] = {
+			t_C + t_X * t_X * t_T,       t_X * t_Y * t_T - t_Z * t_S, t_X * t_Z * t_T + t_Y * t_S, 0.0,
+			t_Y * t_X * t_T + t_Z * t_S, t_C + t_Y * t_Y * t_T,       t_Y * t_Z * t_T - t_X * t_S, 0.0,
+			t_Z * t_X * t_T - t_Y * t_S, t_Z * t_Y * t_T + t_X * t_S, t_C + t_Z * t_Z * t_T,       0.0 };
+		std::memcpy(p_Out, t_Motion, sizeof(t_Motion));
+	}
+	else
+	{
+		const double t_Motion[12] = {
+			1.0, 0.0, 0.0, t_Axis[0] * p_Q,
+			0.0, 1.0, 0.0, t_Axis[1] * p_Q,
+			0.0, 0.0, 1.0, t_Axis[2] * p_Q };
+		std::memcpy(p_Out, t_Motion, sizeof(t_Motion));
+	}
+}
+
+bool CompiledHand::Load(const std::string& p_Path)
+{
+	m_Links.clear();
+
+	std::ifstream t_File(p_Path, std::ifstream::binary);
+	if (!t_File)
+	{
+		std::cerr << "Could not open compiled hand " << p_Path << "." << std::endl;
+		return false;
+	}
+	const std::vector<char> t_Data((std::istreambuf_iterator<char>(t_File)), std::istreambuf_iterator<char>());
+
+	CompiledHandHeader t_Header;
+	if (t_Data.size() < sizeof(t_Header))
+	{
+		std::cerr << "Compiled hand " << p_Path << " is truncated." << std::endl;
+		return false;
+	}
+	std::memcpy(&t_Header, t_Data.data(), sizeof(t_Header));
+	if (std::memcmp(t_Header.magic, COMPILED_HAND_MAGIC, sizeof(t_Header.magic)) != 0 || t_Header.version != COMPILED_HAND_VERSION)
+	{
+		std::cerr << "Compiled hand " << p_Path << " has an unknown format or version." << std::endl;
+		return false;
+	}
+
+	const size_t t_LimitBytes = sizeof(double) * t_Header.numDof;
+	const size_t t_LinkBytes = sizeof(CompiledHandLink) * t_Header.numLinks;
+	const size_t t_KeypointBytes = sizeof(CompiledHandKeypoint) * t_Header.numKeypoints;
+	if (t_Data.size() != sizeof(t_Header) + 2 * t_LimitBytes + t_LinkBytes + t_KeypointBytes
+		|| t_Header.numLinks == 0 || t_Header.baseLink >= t_Header.numLinks)
+	{
+		std::cerr << "Compiled hand " << p_Path << " does not match its header." << std::endl;
+		return false;
+	}
+
+	const char* t_Cursor = t_Data.data() + sizeof(t_Header);
+	std::vector<double> t_Lower(t_Header.numDof);
+	std::vector<double> t_Upper(t_Header.numDof);
+	std::vector<CompiledHandLink> t_Links(t_Header.numLinks);
+	std::vector<CompiledHandKeypoint> t_Keypoints(t_Header.numKeypoints);
+	std::memcpy(t_Lower.data(), t_Cursor, t_LimitBytes);
+	t_Cursor += t_LimitBytes;
+	std::memcpy(t_Upper.data(), t_Cursor, t_LimitBytes);
+	t_Cursor += t_LimitBytes;
+	std::memcpy(t_Links.data(), t_Cursor, t_LinkBytes);
+	t_Cursor += t_LinkBytes;
+	std::memcpy(t_Keypoints.data(), t_Cursor, t_KeypointBytes);
+
+	// forward kinematics walks the links once, so every parent has to come first.
+	for (uint32_t i = 0; i < t_Header.numLinks; i++)
+	{
+		const CompiledHandLink& t_Link = t_Links[i];
+		if (t_Link.parent >= static_cast<int32_t>(i) || t_Link.dofIndex >= static_cast<int32_t>(t_Header.numDof)
+			|| (t_Link.parent < 0 && i != 0))
+		{
+			std::cerr << "Compiled hand " << p_Path << " has an invalid link " << i << "." << std::endl;
+			return false;
+		}
+	}
+	for (const CompiledHandKeypoint& t_Keypoint : t_Keypoints)
+	{
+		if (t_Keypoint.link < 0 || t_Keypoint.link >= static_cast<int32_t>(t_Header.numLinks))
+		{
+			std::cerr << "Compiled hand " << p_Path << " has a keypoint on an unknown link." << std::endl;
+			return false;
+		}
+	}
+
+	std::memcpy(m_InputHash, t_Header.inputHash, sizeof(m_InputHash));
+	m_BaseLink = t_Header.baseLink;
+	m_Lower.swap(t_Lower);
+	m_Upper.swap(t_Upper);
+	m_Links.swap(t_Links);
+	m_Keypoints.swap(t_Keypoints);
+	return true;
+}
+
+std::string CompiledHand::GetInputHash() const
+{
+	static const char s_Hex[] = "0123456789abcdef";
+	std::string t_Hash;
+	for (unsigned char t_Byte : m_InputHash)
+	{
+		t_Hash += s_Hex[t_Byte >> 4];
+		t_Hash += s_Hex[t_Byte & 0xf];
+	}
+	return t_Hash;
+}
+
+void CompiledHand::ForwardKinematics(const double* const p_Qpos, double* const p_Keypoints, std::vector<double>& p_Scratch) const
+{
+	p_Scratch.resize(m_Links.size() * 12);
+	double t_Local[12];
+	double t_Motion[12];
+
+	for (size_t i = 0; i < m_Links.size(); i++)
+	{
+		const CompiledHandLink& t_Link = m_Links[i];
+		double* const t_World = p_Scratch.data() + i * 12;
+
+		if (t_Link.dofIndex >= 0 && t_Link.jointType != CompiledHandJointType_Fixed)
+		{
+			JointMotion(t_Link, p_Qpos[t_Link.dofIndex], t_Motion);
+			ComposeTransforms(t_Link.origin, t_Motion, t_Local);
+		}
+		else
+		{
+			std::memcpy(t_Local, t_Link.origin, sizeof(t_Local));
+		}
+
+		if (t_Link.parent < 0)
+		{
+			std::memcpy(t_World, t_Local, sizeof(t_Local));
+		}
+		else
+		{
+			ComposeTransforms(p_Scratch.data() + t_Link.parent * 12, t_Local, t_World);
+		}
+	}
+
+	// keypoint = base^-1 * (link * offset), the inverse of a rigid transform is [R^T | -R^T t].
+	const double* const t_Base = p_Scratch.data() + m_BaseLink * 12;
+	for (size_t k = 0; k < m_Keypoints.size(); k++)
+	{
+		const double* const t_Pose = p_Scratch.data() + m_Keypoints[k].link * 12;
+		const double* const t_Offset = m_Keypoints[k].offset;
+		double t_World[3];
+		for (int r = 0; r < 3; r++)
+		{
+			t_World[r] = t_Pose[r * 4 + 0] * t_Offset[0] + t_Pose[r * 4 + 1] * t_Offset[1] + t_Pose[r * 4 + 2] * t_Offset[2]
+				+ t_Pose[r * 4 + 3] - t_Base[r * 4 + 3];
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			p_Keypoints[k * 3 + c] = t_Base[0 * 4 + c] * t_World[0] + t_Base[1 * 4 + c] * t_World[1] + t_Base[2 * 4 + c] * t_World[2];
+		}
+	}
+}
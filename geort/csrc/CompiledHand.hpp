@@ -0,0 +1,113 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _COMPILED_HAND_HPP_
+#define _COMPILED_HAND_HPP_
+
+// size_t
+#include <cstddef>
+// int32_t, uint32_t
+#include <cstdint>
+// std::string
+#include <string>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTCore
+ *  @{
+ */
+
+/// @brief A "compiled hand" is the kinematic subset of a hand config + URDF that GeoRT needs:
+/// the joint limits after joint_range_clip_ratio, the chains from the root to the base link and
+/// to every fingertip link, and the fingertip offsets.
+///
+/// It is written once by geort/env/compiled_hand.py and cached next to the kinematics dataset.
+/// The header carries a SHA-256 of the URDF bytes and the config fields it was built from, so a
+/// stale file is detected and rebuilt by the Python side.
+///
+/// File layout, little endian, every struct is 8 byte aligned:
+///   CompiledHandHeader
+///   double jointLower[numDof], double jointUpper[numDof]   (joint_order order)
+///   CompiledHandLink[numLinks]                             (parents before children)
+///   CompiledHandKeypoint[numKeypoints]                     (fingertip_link order)
+
+#define COMPILED_HAND_MAGIC "GEORTHND"
+#define COMPILED_HAND_VERSION 1
+
+typedef enum CompiledHandJointType
+{
+	CompiledHandJointType_Fixed = 0,
+	CompiledHandJointType_Revolute = 1,
+	CompiledHandJointType_Prismatic = 2,
+} CompiledHandJointType;
+
+typedef struct CompiledHandHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t numDof;
+	uint32_t numLinks;
+	uint32_t numKeypoints;
+	uint32_t baseLink;
+	uint32_t reserved;
+	unsigned char inputHash[32];
+} CompiledHandHeader;
+
+/// @brief One link of the kinematic tree, placed relative to its parent by a URDF joint.
+/// The link pose is parent * origin * motion(q), where motion is a rotation about axis
+/// (revolute) or a translation along axis (prismatic) by q = qpos[dofIndex].
+typedef struct CompiledHandLink
+{
+	int32_t parent; // -1 for the root.
+	int32_t jointType; // CompiledHandJointType.
+	int32_t dofIndex; // index in joint_order, -1 if the joint does not move.
+	int32_t reserved;
+	double origin[12]; // row major 3x4 [R | t] of the joint origin.
+	double axis[4]; // unit axis, the last element is padding.
+} CompiledHandLink;
+
+typedef struct CompiledHandKeypoint
+{
+	int32_t link;
+	int32_t reserved;
+	double offset[3]; // center_offset in the link frame.
+} CompiledHandKeypoint;
+
+class CompiledHand
+{
+public:
+	/// @brief Read and validate a compiled hand file.
+	bool Load(const std::string& p_Path);
+
+	bool IsLoaded() const { return !m_Links.empty(); }
+	uint32_t GetNumDof() const { return static_cast<uint32_t>(m_Lower.size()); }
+	uint32_t GetNumKeypoints() const { return static_cast<uint32_t>(m_Keypoints.size()); }
+	const std::vector<double>& GetJointLower() const { return m_Lower; }
+	const std::vector<double>& GetJointUpper() const { return m_Upper; }
+
+	/// @brief The SHA-256 of the inputs the file was compiled from, as lowercase hex.
+	std::string GetInputHash() const;
+
+	/// @brief Keypoint positions in the base link frame for one joint configuration.
+	/// @param p_Qpos GetNumDof() joint positions in joint_order order.
+	/// @param p_Keypoints receives GetNumKeypoints() xyz triplets.
+	/// @param p_Scratch work buffer reused between calls, resized as needed.
+	void ForwardKinematics(const double* const p_Qpos, double* const p_Keypoints, std::vector<double>& p_Scratch) const;
+
+protected:
+	unsigned char m_InputHash[32] = { 0 };
+	uint32_t m_BaseLink = 0;
+	std::vector<double> m_Lower;
+	std::vector<double> m_Upper;
+	std::vector<CompiledHandLink> m_Links;
+	std::vector<CompiledHandKeypoint> m_Keypoints;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,100 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "PinchLoss.hpp"
+
+// std::fill
+#include <algorithm>
+// std::vector
+#include <vector>
+
+/// @brief Squared distance between two xyz triplets.
+static inline float SquaredDistance(const float* const p_A, const float* const p_B)
+{
+	const float t_X = p_A[0] - p_B[0];
+	const float t_Y = p_A[1] - p_B[1];
+	const float t_Z = p_A[2] - p_B[2];
+	return t_X * t_X + t_Y * t_Y + t_Z * t_Z;
+}
+
+double PinchLossForward(
+	const float* const p_Points,
+	const float* const p_Embedded,
+	const size_t p_Batch,
+	const size_t p_NumFingers,
+	const float p_Threshold,
+	double* const p_PairWeights)
+{
+	const size_t t_NumPairs = p_NumFingers * p_NumFingers;
+	std::vector<double> t_Count(t_NumPairs, 0.0);
+	std::vector<double> t_Sum(t_NumPairs, 0.0);
+	// compare squared distances, this is the same as torch.norm(distance) < threshold.
+	const float t_ThresholdSq = p_Threshold * p_Threshold;
+
+	// one pass over the batch, all pairs of a sample are in the same cache line or two.
+	for (size_t b = 0; b < p_Batch; b++)
+	{
+		const float* const t_Points = p_Points + b * p_NumFingers * 3;
+		const float* const t_Embedded = p_Embedded + b * p_NumFingers * 3;
+		for (size_t i = 0; i < p_NumFingers; i++)
+		{
+			for (size_t j = i + 1; j < p_NumFingers; j++)
+			{
+				if (SquaredDistance(t_Points + i * 3, t_Points + j * 3) >= t_ThresholdSq) continue;
+				t_Count[i * p_NumFingers + j] += 1.0;
+				t_Sum[i * p_NumFingers + j] += SquaredDistance(t_Embedded + i * 3, t_Embedded + j * 3);
+			}
+		}
+	}
+
+	double t_Loss = 0.0;
+	for (size_t i = 0; i < p_NumFingers; i++)
+	{
+		for (size_t j = i + 1; j < p_NumFingers; j++)
+		{
+			const double t_Weight = 1.0 / (t_Count[i * p_NumFingers + j] + s_PinchLossEpsilon);
+			p_PairWeights[i * p_NumFingers + j] = t_Weight;
+			t_Loss += t_Sum[i * p_NumFingers + j] * t_Weight;
+		}
+	}
+	return t_Loss;
+}
+
+void PinchLossBackward(
+	const float* const p_Points,
+	const float* const p_Embedded,
+	const size_t p_Batch,
+	const size_t p_NumFingers,
+	const float p_Threshold,
+	const double* const p_PairWeights,
+	const float p_GradOutput,
+	float* const p_GradEmbedded)
+{
+	std::fill(p_GradEmbedded, p_GradEmbedded + p_Batch * p_NumFingers * 3, 0.0f);
+	const float t_ThresholdSq = p_Threshold * p_Threshold;
+
+	for (size_t b = 0; b < p_Batch; b++)
+	{
+		const float* const t_Points = p_Points + b * p_NumFingers * 3;
+		const float* const t_Embedded = p_Embedded + b * p_NumFingers * 3;
+		float* const t_Grad = p_GradEmbedded + b * p_NumFingers * 3;
+		for (size_t i = 0; i < p_NumFingers; i++)
+		{
+			for (size_t j = i + 1; j < p_NumFingers; j++)
+			{
+				if (SquaredDistance(t_Points + i * 3, t_Points + j * 3) >= t_ThresholdSq) continue;
+				// d|e_i - e_j|^2 / de_i = 2 (e_i - e_j), and the opposite for e_j.
+				const float t_Scale = static_cast<float>(2.0 * p_PairWeights[i * p_NumFingers + j]) * p_GradOutput;
+				for (int a = 0; a < 3; a++)
+				{
+					const float t_Delta = (t_Embedded[i * 3 + a] - t_Embedded[j * 3 + a]) * t_Scale;
+					t_Grad[i * 3 + a] += t_Delta;
+					t_Grad[j * 3 + a] -= t_Delta;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,58 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _PINCH_LOSS_HPP_
+#define _PINCH_LOSS_HPP_
+
+// size_t
+#include <cstddef>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTCore
+ *  @{
+ */
+
+/// @brief Added to the per-pair mask count, same value the trainer used in Python.
+static const double s_PinchLossEpsilon = 1e-7;
+
+/// @brief Fused pinch loss over all finger pairs i < j.
+/// A sample takes part in pair (i, j) when its human fingertips are closer than p_Threshold.
+/// The loss is sum over pairs of sum_b(mask * |e_i - e_j|^2) / (sum_b(mask) + eps),
+/// where e are the embedded (robot) keypoints.
+/// @param p_Points human keypoints, [p_Batch, p_NumFingers, 3].
+/// @param p_Embedded embedded keypoints, [p_Batch, p_NumFingers, 3].
+/// @param p_Batch the batch size B.
+/// @param p_NumFingers the number of fingers N.
+/// @param p_Threshold the pinch distance.
+/// @param p_PairWeights receives 1 / (sum_b(mask) + eps) per pair, [N, N]. Only i < j is written.
+/// @return the loss value.
+double PinchLossForward(
+	const float* const p_Points,
+	const float* const p_Embedded,
+	const size_t p_Batch,
+	const size_t p_NumFingers,
+	const float p_Threshold,
+	double* const p_PairWeights);
+
+/// @brief Gradient of PinchLossForward with respect to the embedded keypoints.
+/// The mask is recomputed from p_Points, it does not carry a gradient.
+/// @param p_PairWeights the weights written by PinchLossForward.
+/// @param p_GradOutput the incoming gradient of the scalar loss.
+/// @param p_GradEmbedded receives the gradient, [p_Batch, p_NumFingers, 3]. It is overwritten.
+void PinchLossBackward(
+	const float* const p_Points,
+	const float* const p_Embedded,
+	const size_t p_Batch,
+	const size_t p_NumFingers,
+	const float p_Threshold,
+	const double* const p_PairWeights,
+	const float p_GradOutput,
+	float* const p_GradEmbedded);
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,195 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "PointCloudResample.hpp"
+
+// std::min
+#include <algorithm>
+// std::atomic
+#include <atomic>
+// std::floor, std::isfinite
+#include <cmath>
+// std::numeric_limits
+#include <limits>
+// std::mt19937_64
+#include <random>
+// std::thread
+#include <thread>
+
+/// @brief Number of bits used per axis when packing a voxel coordinate into a hash key.
+static const uint32_t s_VoxelKeyBitsPerAxis = 21;
+static const uint64_t s_VoxelKeyAxisMask = (1ull << s_VoxelKeyBitsPerAxis) - 1;
+static const uint64_t s_EmptySlot = std::numeric_limits<uint64_t>::max();
+
+/// @brief Spread the bits of a packed voxel key so that neighbouring voxels land in different slots.
+static inline uint64_t MixVoxelKey(uint64_t p_Key)
+{
+	p_Key ^= p_Key >> 33;
+	p_Key *= 0xff51afd7ed558ccdull;
+	p_Key ^= p_Key >> 33;
+	p_Key *= 0xc4ceb9fe1a85ec53ull;
+	p_Key ^= p_Key >> 33;
+	return p_Key;
+}
+
+/// @brief Accumulated sum of the points inside one voxel.
+struct VoxelAccumulator
+{
+	double x = 0.0;
+	double y = 0.0;
+	double z = 0.0;
+	uint32_t count = 0;
+};
+
+bool VoxelDownsample(
+	const float* const p_Points,
+	const size_t p_NumPoints,
+	const float p_VoxelSize,
+	std::vector<float>& p_Out)
+{
+	p_Out.clear();
+	if (!(p_VoxelSize > 0.0f))
+	{
+		return false;
+	}
+
+	// Bounding box over the finite points only.
+	float t_Min[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+	float t_Max[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+	size_t t_NumFinite = 0;
+	for (size_t i = 0; i < p_NumPoints; i++)
+	{
+		const float* const t_Point = p_Points + i * 3;
+		if (!std::isfinite(t_Point[0]) || !std::isfinite(t_Point[1]) || !std::isfinite(t_Point[2])) continue;
+		for (int a = 0; a < 3; a++)
+		{
+			t_Min[a] = std::min(t_Min[a], t_Point[a]);
+			t_Max[a] = std::max(t_Max[a], t_Point[a]);
+		}
+		t_NumFinite++;
+	}
+	if (t_NumFinite == 0)
+	{
+		return true;
+	}
+
+	const double t_InvVoxelSize = 1.0 / static_cast<double>(p_VoxelSize);
+	double t_Origin[3];
+	for (int a = 0; a < 3; a++)
+	{
+		t_Origin[a] = static_cast<double>(t_Min[a]) - 0.5 * static_cast<double>(p_VoxelSize);
+		const double t_Extent = (static_cast<double>(t_Max[a]) - t_Origin[a]) * t_InvVoxelSize;
+		if (t_Extent >= static_cast<double>(s_VoxelKeyAxisMask))
+		{
+			// the grid does not fit in the packed key. with millimeter voxels this is a 2km wide cloud.
+			return false;
+		}
+	}
+
+	// Open addressing table, at most half full.
+	size_t t_Capacity = 16;
+	while (t_Capacity < t_NumFinite * 2) t_Capacity <<= 1;
+	std::vector<uint64_t> t_Keys(t_Capacity, s_EmptySlot);
+	std::vector<uint32_t> t_Slots(t_Capacity, 0);
+	std::vector<VoxelAccumulator> t_Voxels;
+	t_Voxels.reserve(std::min<size_t>(t_NumFinite, 1 << 20));
+
+	for (size_t i = 0; i < p_NumPoints; i++)
+	{
+		const float* const t_Point = p_Points + i * 3;
+		if (!std::isfinite(t_Point[0]) || !std::isfinite(t_Point[1]) || !std::isfinite(t_Point[2])) continue;
+
+		uint64_t t_Key = 0;
+		for (int a = 0; a < 3; a++)
+		{
+			const uint64_t t_Index = static_cast<uint64_t>(std::floor((static_cast<double>(t_Point[a]) - t_Origin[a]) * t_InvVoxelSize));
+			t_Key |= (t_Index & s_VoxelKeyAxisMask) << (a * s_VoxelKeyBitsPerAxis);
+		}
+
+		size_t t_Slot = MixVoxelKey(t_Key) & (t_Capacity - 1);
+		while (t_Keys[t_Slot] != s_EmptySlot && t_Keys[t_Slot] != t_Key)
+		{
+			t_Slot = (t_Slot + 1) & (t_Capacity - 1);
+		}
+		if (t_Keys[t_Slot] == s_EmptySlot)
+		{
+			t_Keys[t_Slot] = t_Key;
+			t_Slots[t_Slot] = static_cast<uint32_t>(t_Voxels.size());
+			t_Voxels.emplace_back();
+		}
+
+		VoxelAccumulator& t_Voxel = t_Voxels[t_Slots[t_Slot]];
+		t_Voxel.x += t_Point[0];
+		t_Voxel.y += t_Point[1];
+		t_Voxel.z += t_Point[2];
+		t_Voxel.count++;
+	}
+
+	p_Out.resize(t_Voxels.size() * 3);
+	for (size_t i = 0; i < t_Voxels.size(); i++)
+	{
+		const double t_Inv = 1.0 / static_cast<double>(t_Voxels[i].count);
+		p_Out[i * 3 + 0] = static_cast<float>(t_Voxels[i].x * t_Inv);
+		p_Out[i * 3 + 1] = static_cast<float>(t_Voxels[i].y * t_Inv);
+		p_Out[i * 3 + 2] = static_cast<float>(t_Voxels[i].z * t_Inv);
+	}
+	return true;
+}
+
+bool VoxelResampleFingers(
+	const float* const p_Points,
+	const size_t p_NumFingers,
+	const size_t p_NumPoints,
+	const float p_VoxelSize,
+	const size_t p_NumSamples,
+	const uint64_t p_Seed,
+	float* const p_Out)
+{
+	std::atomic<bool> t_Success(true);
+	std::atomic<size_t> t_NextFinger(0);
+
+	// each worker pulls whole fingers, so the downsampling of one finger is never split.
+	auto t_Worker = [&]()
+	{
+		std::vector<float> t_Downsampled;
+		for (size_t t_Finger = t_NextFinger++; t_Finger < p_NumFingers; t_Finger = t_NextFinger++)
+		{
+			const float* const t_Source = p_Points + t_Finger * p_NumPoints * 3;
+			float* const t_Target = p_Out + t_Finger * p_NumSamples * 3;
+
+			if (!VoxelDownsample(t_Source, p_NumPoints, p_VoxelSize, t_Downsampled) || t_Downsampled.empty())
+			{
+				t_Success = false;
+				continue;
+			}
+
+			const size_t t_NumVoxels = t_Downsampled.size() / 3;
+			std::mt19937_64 t_Generator(p_Seed + t_Finger);
+			std::uniform_int_distribution<size_t> t_Pick(0, t_NumVoxels - 1);
+			for (size_t i = 0; i < p_NumSamples; i++)
+			{
+				const float* const t_Point = t_Downsampled.data() + t_Pick(t_Generator) * 3;
+				t_Target[i * 3 + 0] = t_Point[0];
+				t_Target[i * 3 + 1] = t_Point[1];
+				t_Target[i * 3 + 2] = t_Point[2];
+			}
+		}
+	};
+
+	const size_t t_NumThreads = std::min<size_t>(p_NumFingers, std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::thread> t_Threads;
+	for (size_t i = 1; i < t_NumThreads; i++)
+	{
+		t_Threads.emplace_back(t_Worker);
+	}
+	t_Worker();
+	for (std::thread& t_Thread : t_Threads)
+	{
+		t_Thread.join();
+	}
+
+	return t_Success;
+}
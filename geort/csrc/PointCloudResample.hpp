@@ -0,0 +1,60 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _POINT_CLOUD_RESAMPLE_HPP_
+#define _POINT_CLOUD_RESAMPLE_HPP_
+
+// size_t
+#include <cstddef>
+// uint64_t
+#include <cstdint>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTCore
+ *  @{
+ */
+
+/// @brief Replace all points that fall into the same cubic voxel by their centroid.
+/// This matches open3d's PointCloud::VoxelDownSample: the grid is anchored half a voxel
+/// below the minimum bound and the output order is unspecified.
+/// Points with a non-finite coordinate are skipped.
+/// @param p_Points xyz triplets, p_NumPoints * 3 floats.
+/// @param p_NumPoints the number of points.
+/// @param p_VoxelSize the edge length of a voxel, must be positive.
+/// @param p_Out receives the centroids as xyz triplets. It is cleared first.
+/// @return false if the voxel size is invalid or the cloud is too large to be indexed.
+bool VoxelDownsample(
+	const float* const p_Points,
+	const size_t p_NumPoints,
+	const float p_VoxelSize,
+	std::vector<float>& p_Out);
+
+/// @brief Voxel downsample every finger and draw p_NumSamples points from the result.
+/// Fingers are processed in parallel. The output has the [Num_Fingers, K, 3] float32 layout
+/// MultiPointDataset stores, so it can be handed over without copying.
+/// @param p_Points input cloud with the layout [p_NumFingers, p_NumPoints, 3].
+/// @param p_NumFingers the number of fingers.
+/// @param p_NumPoints the number of points per finger.
+/// @param p_VoxelSize the edge length of a voxel.
+/// @param p_NumSamples the number of points drawn per finger (K).
+/// @param p_Seed the seed for the per-finger random generators.
+/// @param p_Out output buffer with room for p_NumFingers * p_NumSamples * 3 floats.
+/// @return false if any finger could not be downsampled or ended up empty.
+bool VoxelResampleFingers(
+	const float* const p_Points,
+	const size_t p_NumFingers,
+	const size_t p_NumPoints,
+	const float p_VoxelSize,
+	const size_t p_NumSamples,
+	const uint64_t p_Seed,
+	float* const p_Out);
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -5,7 +5,12 @@
 # LICENSE file in the root directory of this source tree.
 import random
 import numpy as np
-import open3d as o3d
+import torch
+
+try:
+    from geort import _C
+except ImportError:
+    _C = None
 
 def upsample_array(x, K=50000):
     n = x.shape[0]
@@ -22,6 +27,13 @@ class MultiPointDataset:
         '''
             This is the actual initialization function. 
         '''
+        if _C is not None:
+            # Hashed voxel downsample + resample in C++, all fingers in parallel.
+            points = torch.from_numpy(np.ascontiguousarray(points, dtype=np.float32))
+            seed = np.random.randint(0, 2 ** 31 - 1)
+            return MultiPointDataset(_C.voxel_resample(points, resample_resolution, resample_to, seed).numpy())
+
+        import open3d as o3d
         num_fingers = points.shape[0]
         all_points = []
 
@@ -0,0 +1,342 @@
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+# All rights reserved.
+
+# This source code is licensed under the license found in the
+# LICENSE file in the root directory of this source tree.
+
+'''
+    Compiled hand: a small binary cache of the kinematics GeoRT needs from a hand config + URDF.
+
+    HandKinematicModel parses the URDF through SAPIEN and builds a Pinocchio model, which takes
+    seconds. Code that only needs joint limits and fingertip forward kinematics (e.g. the trainer)
+    can use CompiledHandModel instead. The cache is built once from urdf_path, base_link,
+    joint_order, fingertip_link and joint_range_clip_ratio, and is rebuilt automatically when the
+    SHA-256 of those inputs changes. The layout is documented in geort/csrc/CompiledHand.hpp.
+'''
+
+import hashlib
+import json
+import os
+import struct
+import xml.etree.ElementTree as ET
+import numpy as np
+import torch
+
+try:
+    from geort import _C
+except ImportError:
+    _C = None
+
+COMPILED_HAND_MAGIC = b"GEORTHND"
+COMPILED_HAND_VERSION = 1
+
+# Must match CompiledHandHeader / CompiledHandLink / CompiledHandKeypoint in CompiledHand.hpp.
+_HEADER = struct.Struct("<8sIIIIII32s")
+_LINK = struct.Struct("<iiii12d4d")
+_KEYPOINT = struct.Struct("<ii3d")
+
+JOINT_FIXED = 0
+JOINT_REVOLUTE = 1
+JOINT_PRISMATIC = 2
+
+
+def get_compiled_hand_path(config):
+    return f"data/{config['name']}.ghand"
+
+
+def compute_compiled_hand_hash(config):
+    '''
+        SHA-256 over the URDF bytes and every config field the compiled hand depends on.
+    '''
+    digest = hashlib.sha256()
+    with open(config["urdf_path"], "rb") as f:
+        digest.update(f.read())
+
+    inputs = {
+        "base_link": config["base_link"],
+        "joint_order": config["joint_order"],
+        "fingertip_link": [[info["link"], info["center_offset"]] for info in config["fingertip_link"]],
+        "joint_range_clip_ratio": config.get("joint_range_clip_ratio", {}),
+    }
+    digest.update(json.dumps(inputs, sort_keys=True).encode("utf-8"))
+    return digest.digest()
+
+
+def _parse_vector(element, attribute, default):
+    if element is None or element.get(attribute) is None:
+        return np.array(default, dtype=np.float64)
+    return np.array([float(x) for x in element.get(attribute).split()], dtype=np.float64)
+
+
+def _origin_matrix(xyz, rpy):
+    # URDF fixed-axis roll, pitch, yaw: R = Rz(yaw) @ Ry(pitch) @ Rx(roll).
+    cr, sr = np.cos(rpy[0]), np.sin(rpy[0])
+    cp, sp = np.cos(rpy[1]), np.sin(rpy[1])
+    cy, sy = np.cos(rpy[2]), np.sin(rpy[2])
+    rotation = np.array([
+        [cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr],
+        [sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr],
+        [-sp, cp * sr, cp * cr],
+    ])
+    return np.concatenate([rotation, xyz.reshape(3, 1)], axis=1)
+
+
+def compile_hand(config, output_path):
+    '''
+        Parse the URDF once and write the compiled hand to output_path.
+    '''
+    urdf = ET.parse(config["urdf_path"]).getroot()
+    link_names = {link.get("name") for link in urdf.findall("link")}
+    joints = {}
+    joint_by_child = {}
+    for joint in urdf.findall("joint"):
+        info = {
+            "name": joint.get("name"),
+            "type": joint.get("type"),
+            "parent": joint.find("parent").get("link"),
+            "child": joint.find("child").get("link"),
+            "origin": _origin_matrix(
+                _parse_vector(joint.find("origin"), "xyz", [0.0, 0.0, 0.0]),
+                _parse_vector(joint.find("origin"), "rpy", [0.0, 0.0, 0.0]),
+            ),
+            "axis": _parse_vector(joint.find("axis"), "xyz", [1.0, 0.0, 0.0]),
+            "limit": joint.find("limit"),
+        }
+        joints[info["name"]] = info
+        joint_by_child[info["child"]] = info
+
+    joint_order = config["joint_order"]
+    keypoint_links = [info["link"] for info in config["fingertip_link"]]
+    keypoint_offsets = [info["center_offset"] for info in config["fingertip_link"]]
+
+    for name in [config["base_link"]] + keypoint_links:
+        assert name in link_names, f"Link {name} is not in {config['urdf_path']}"
+    for name in joint_order:
+        assert name in joints, f"Joint {name} is not in {config['urdf_path']}"
+
+    # Keep only the links on the paths from the root to the base link and to every fingertip.
+    def chain_to_root(link):
+        chain = [link]
+        while chain[-1] in joint_by_child:
+            chain.append(joint_by_child[chain[-1]]["parent"])
+        return chain
+
+    depth = {}
+    for name in [config["base_link"]] + keypoint_links:
+        chain = chain_to_root(name)
+        for i, link in enumerate(chain):
+            depth[link] = len(chain) - 1 - i
+    roots = [link for link, d in depth.items() if d == 0]
+    assert len(roots) == 1, f"Base link and fingertip links do not share one root: {roots}"
+
+    ordered_links = sorted(depth.keys(), key=lambda link: (depth[link], link))
+    link_index = {link: i for i, link in enumerate(ordered_links)}
+
+    link_records = []
+    for link in ordered_links:
+        joint = joint_by_child.get(link)
+        if joint is None:
+            link_records.append(_LINK.pack(-1, JOINT_FIXED, -1, 0, *np.eye(3, 4).reshape(-1), 0.0, 0.0, 0.0, 0.0))
+            continue
+
+        if joint["type"] in ("revolute", "continuous"):
+            joint_type = JOINT_REVOLUTE
+        elif joint["type"] == "prismatic":
+            joint_type = JOINT_PRISMATIC
+        else:
+            joint_type = JOINT_FIXED
+
+        dof_index = joint_order.index(joint["name"]) if joint["name"] in joint_order else -1
+        if joint_type != JOINT_FIXED and dof_index < 0:
+            print(f"[CompiledHand] Joint {joint['name']} moves but is not in joint_order, it is held at 0.")
+
+        axis = joint["axis"] / np.linalg.norm(joint["axis"])
+        link_records.append(_LINK.pack(
+            link_index[joint["parent"]], joint_type, dof_index, 0,
+            *joint["origin"].reshape(-1), *axis, 0.0,
+        ))
+
+    # Same clipping as HandKinematicModel.
+    clip_ratio_dict = config.get("joint_range_clip_ratio", {})
+    joint_lower_limit = np.zeros(len(joint_order))
+    joint_upper_limit = np.zeros(len(joint_order))
+    for i, name in enumerate(joint_order):
+        limit = joints[name]["limit"]
+        if joints[name]["type"] == "continuous" or limit is None:
+            urdf_lower, urdf_upper = -np.inf, np.inf
+        else:
+            urdf_lower, urdf_upper = float(limit.get("lower", 0.0)), float(limit.get("upper", 0.0))
+
+        if name in clip_ratio_dict:
+            ratio_low, ratio_high = clip_ratio_dict[name]
+            assert 0.0 <= ratio_low < ratio_high <= 1.0, f"Invalid clip ratio for joint {name}"
+            joint_lower_limit[i] = urdf_lower + ratio_low * (urdf_upper - urdf_lower)
+            joint_upper_limit[i] = urdf_lower + ratio_high * (urdf_upper - urdf_lower)
+        else:
+            joint_lower_limit[i] = urdf_lower
+            joint_upper_limit[i] = urdf_upper
+
+    keypoint_records = [
+        _KEYPOINT.pack(link_index[link], 0, *[float(x) for x in offset])
+        for link, offset in zip(keypoint_links, keypoint_offsets)
+    ]
+
+    header = _HEADER.pack(
+        COMPILED_HAND_MAGIC, COMPILED_HAND_VERSION,
+        len(joint_order), len(ordered_links), len(keypoint_links),
+        link_index[config["base_link"]], 0,
+        compute_compiled_hand_hash(config),
+    )
+
+    os.makedirs(os.path.dirname(output_path) or ".", exist_ok=True)
+    tmp_path = output_path + ".tmp"
+    with open(tmp_path, "wb") as f:
+        f.write(header)
+        f.write(joint_lower_limit.astype("<f8").tobytes())
+        f.write(joint_upper_limit.astype("<f8").tobytes())
+        f.write(b"".join(link_records))
+        f.write(b"".join(keypoint_records))
+    os.replace(tmp_path, output_path)
+    return output_path
+
+
+def _compose(a, b):
+    # [..., 3, 4] rigid transforms.
+    out = np.empty(np.broadcast_shapes(a.shape, b.shape))
+    out[..., :3] = a[..., :3] @ b[..., :3]
+    out[..., 3] = (a[..., :3] @ b[..., 3:4])[..., 0] + a[..., 3]
+    return out
+
+
+def _joint_motion(joint_type, axis, q):
+    motion = np.zeros((len(q), 3, 4))
+    if joint_type == JOINT_PRISMATIC:
+        motion[:, :, :3] = np.eye(3)
+        motion[:, :, 3] = q[:, None] * axis[None, :3]
+        return motion
+
+    x, y, z = axis[:3]
+    c, s = np.cos(q), np.sin(q)
+    t = 1.0 - c
+    motion[:, 0, 0], motion[:, 0, 1], motion[:, 0, 2] = c + x * x * t, x * y * t - z * s, x * z * t + y * s
+    motion[:, 1, 0], motion[:, 1, 1], motion[:, 1, 2] = y * x * t + z * s, c + y * y * t, y * z * t - x * s
+    motion[:, 2, 0], motion[:, 2, 1], motion[:, 2, 2] = z * x * t - y * s, z * y * t + x * s, c + z * z * t
+    return motion
+
+
+class CompiledHandModel:
+    '''
+        Kinematics-only stand-in for HandKinematicModel (joint limits and fingertip FK),
+        loaded from a compiled hand file instead of the URDF.
+    '''
+    def __init__(self, compiled_path, keypoint_link_names):
+        with open(compiled_path, "rb") as f:
+            data = f.read()
+
+        magic, version, n_dof, n_links, n_keypoints, base_link, _, input_hash = _HEADER.unpack_from(data, 0)
+        assert magic == COMPILED_HAND_MAGIC and version == COMPILED_HAND_VERSION, f"{compiled_path} is not a compiled hand"
+        assert len(keypoint_link_names) == n_keypoints, "Keypoint count does not match the compiled hand"
+
+        offset = _HEADER.size
+        self.joint_lower_limit = np.frombuffer(data, dtype="<f8", count=n_dof, offset=offset).copy()
+        offset += 8 * n_dof
+        self.joint_upper_limit = np.frombuffer(data, dtype="<f8", count=n_dof, offset=offset).copy()
+        offset += 8 * n_dof
+
+        self.links = []
+        for _ in range(n_links):
+            record = _LINK.unpack_from(data, offset)
+            offset += _LINK.size
+            self.links.append({
+                "parent": record[0],
+                "type": record[1],
+                "dof": record[2],
+                "origin": np.array(record[4:16]).reshape(3, 4),
+                "axis": np.array(record[16:19]),
+            })
+
+        self.keypoints = []
+        for _ in range(n_keypoints):
+            record = _KEYPOINT.unpack_from(data, offset)
+            offset += _KEYPOINT.size
+            self.keypoints.append((record[0], np.array(record[2:5])))
+
+        self.base_link = base_link
+        self.input_hash = input_hash
+        self.joint_names = None
+        self.keypoint_link_names = list(keypoint_link_names)
+
+        self.native = None
+        if _C is not None:
+            self.native = _C.CompiledHand()
+            if not self.native.load(compiled_path):
+                self.native = None
+
+    @staticmethod
+    def build_from_config(config, **kwargs):
+        '''
+            Load the compiled hand for this config, compiling it first if it is missing or stale.
+        '''
+        compiled_path = kwargs.get("compiled_path", get_compiled_hand_path(config))
+        keypoint_link_names = [info["link"] for info in config["fingertip_link"]]
+
+        expected_hash = compute_compiled_hand_hash(config)
+        stale = True
+        if os.path.exists(compiled_path):
+            with open(compiled_path, "rb") as f:
+                header = f.read(_HEADER.size)
+            if len(header) == _HEADER.size:
+                magic, version, *_, input_hash = _HEADER.unpack(header)
+                stale = magic != COMPILED_HAND_MAGIC or version != COMPILED_HAND_VERSION or input_hash != expected_hash
+
+        if stale:
+            print(f"[CompiledHand] Compiling {config['urdf_path']} -> {compiled_path}")
+            compile_hand(config, compiled_path)
+
+        model = CompiledHandModel(compiled_path, keypoint_link_names)
+        model.joint_names = config["joint_order"]
+        return model
+
+    def get_n_dof(self):
+        return len(self.joint_lower_limit)
+
+    def get_joint_limit(self):
+        return self.joint_lower_limit, self.joint_upper_limit
+
+    def initialize_keypoint(self, keypoint_link_names, keypoint_offsets):
+        # The keypoints are baked in at compile time, just make sure the caller agrees.
+        assert list(keypoint_link_names) == self.keypoint_link_names, "Keypoint links differ from the compiled hand"
+        for (_, compiled_offset), offset in zip(self.keypoints, keypoint_offsets):
+            assert np.allclose(compiled_offset, offset), "Keypoint offsets differ from the compiled hand"
+
+    def keypoints_from_qpos_batch(self, qpos):
+        '''
+            qpos: [B, DOF] in joint_order order. Returns [B, N_keypoint, 3] in the base link frame.
+        '''
+        qpos = np.asarray(qpos, dtype=np.float64).reshape(-1, self.get_n_dof())
+        if self.native is not None:
+            return self.native.forward_kinematics(torch.from_numpy(qpos)).numpy()
+
+        poses = []
+        for link in self.links:
+            local = np.broadcast_to(link["origin"], (len(qpos), 3, 4))
+            if link["dof"] >= 0 and link["type"] != JOINT_FIXED:
+                local = _compose(local, _joint_motion(link["type"], link["axis"], qpos[:, link["dof"]]))
+            poses.append(local if link["parent"] < 0 else _compose(poses[link["parent"]], local))
+
+        base = poses[self.base_link]
+        result = []
+        for link, offset in self.keypoints:
+            world = poses[link][..., :3] @ offset + poses[link][..., 3]
+            result.append(np.einsum("bji,bj->bi", base[..., :3], world - base[..., 3]))
+        return np.stack(result, axis=1)
+
+    def keypoint_from_qpos(self, qpos, ret_vec=False):
+        keypoints = self.keypoints_from_qpos_batch(np.asarray(qpos)[None])[0]
+        if ret_vec:
+            return keypoints
+        return {name: keypoints[i] for i, name in enumerate(self.keypoint_link_names)}
+
+    def precise_fk_tensor(self, qpos_tensor: torch.Tensor) -> torch.Tensor:
+        keypoints = self.keypoints_from_qpos_batch(qpos_tensor.detach().cpu().numpy())
+        return torch.from_numpy(keypoints).to(qpos_tensor.device).float()
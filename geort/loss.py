@@ -6,6 +6,11 @@
 
 import torch 
 
+try:
+    from geort import _C
+except ImportError:
+    _C = None
+
 def chamfer_distance(input_points, target_points):
     """
     Args:
@@ -38,3 +43,27 @@ def chamfer_distance(input_points, target_points):
     chamfer_dist = torch.mean(min_dist_a, dim=1) + torch.mean(min_dist_b, dim=1)
     
     return chamfer_dist.mean()
+
+
+def pinch_loss(points, embedded_points, threshold=0.015):
+    """
+    Pull embedded fingertips together wherever the human fingertips pinch.
+
+    Args:
+    - points (torch.Tensor): Human keypoints of shape [B, N, 3]. Only used to build the pinch mask.
+    - embedded_points (torch.Tensor): Embedded robot keypoints of shape [B, N, 3].
+    - threshold (float): Human fingertips closer than this count as a pinch.
+
+    Returns:
+    - loss (torch.Tensor): Sum over finger pairs i < j of the masked mean squared embedded distance.
+    """
+    if _C is not None:
+        return _C.pinch_loss(points, embedded_points, threshold)
+
+    # All pairs at once, same math as the C++ kernel.
+    n_finger = points.size(1)
+    upper = torch.ones(n_finger, n_finger, dtype=torch.bool, device=points.device).triu(1)
+    distance = torch.norm(points.unsqueeze(2) - points.unsqueeze(1), dim=-1)                  # [B, N, N]
+    mask = ((distance < threshold) & upper).float().detach()
+    e_distance = ((embedded_points.unsqueeze(2) - embedded_points.unsqueeze(1)) ** 2).sum(dim=-1)  # [B, N, N]
+    return ((mask * e_distance).sum(dim=0) / (mask.sum(dim=0) + 1e-7)).sum()
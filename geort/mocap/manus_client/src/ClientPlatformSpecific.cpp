@@ -137,9 +137,29 @@ bool SDKClientPlatformSpecific::PlatformSpecificInitialization(void)
 {
 	const bool t_SignalResult = SetUpSignalHandlers();
 
+	// the real-time settings are best effort, what does not take effect is reported but does not stop the client.
+	if (m_RealtimeSettings.IsEnabled())
+	{
+		ApplyRealtimeProcessSettings(m_RealtimeSettings);
+	}
+
 	return t_SignalResult;
 }
 
+bool SDKClientPlatformSpecific::PlatformSpecificPublishThreadInitialization(void)
+{
+	if (!m_RealtimeSettings.IsEnabled()) return true;
+
+	return ApplyRealtimeThreadSettings(m_RealtimeSettings, m_RealtimeSettings.publishPriority, "publish");
+}
+
+bool SDKClientPlatformSpecific::PlatformSpecificCallbackThreadInitialization(void)
+{
+	if (!m_RealtimeSettings.IsEnabled()) return true;
+
+	return ApplyRealtimeThreadSettings(m_RealtimeSettings, m_RealtimeSettings.callbackPriority, "callback");
+}
+
 bool SDKClientPlatformSpecific::PlatformSpecificShutdown(void)
 {
 	return true;
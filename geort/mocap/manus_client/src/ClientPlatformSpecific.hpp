@@ -8,6 +8,7 @@
 #define _CLIENT_PLATFORM_SPECIFIC_HPP_
 
 #include "ClientPlatformSpecificTypes.hpp"
+#include "RealtimeSettings.hpp"
 
 #include "ManusSDKTypes.h"
 
@@ -23,10 +24,25 @@
 
 class SDKClientPlatformSpecific
 {
+public:
+	/// @brief Real-time options for PlatformSpecificInitialization, set them before it runs.
+	void SetRealtimeSettings(const RealtimeSettings& p_Settings) { m_RealtimeSettings = p_Settings; }
+
 protected:
 	/// @brief Initialise things only needed for this platform.
+	/// This also applies the real-time settings of the process, like locking its memory. The thread
+	/// settings are left to PlatformSpecificPublishThreadInitialization, so the threads the SDK and
+	/// ROS start in the meantime do not inherit the priority and CPUs of the publish loop.
 	bool PlatformSpecificInitialization(void);
 
+	/// @brief Apply the real-time settings to the calling thread, which goes on to run the publish loop.
+	/// Call it once the SDK is connected and the node exists, threads started after it inherit them.
+	bool PlatformSpecificPublishThreadInitialization(void);
+
+	/// @brief Apply the real-time settings to an SDK callback thread.
+	/// The SDK creates those threads itself, so call this from the first callback on each of them.
+	bool PlatformSpecificCallbackThreadInitialization(void);
+
 	/// @brief Shut down things only needed for this platform.
 	bool PlatformSpecificShutdown(void);
 
@@ -59,6 +75,8 @@ protected:
 
 	/// @brief The slash character that is used in the filesystem.
 	static const std::string s_SlashForFilesystemPath;
+
+	RealtimeSettings m_RealtimeSettings;
 };
 
 // Close the Doxygen group.
@@ -0,0 +1,157 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ClockMapping.hpp"
+
+// std::max, std::min, std::nth_element
+#include <algorithm>
+// std::fabs
+#include <cmath>
+#include <iostream>
+
+/// @brief The drift is clamped to this, quartz clocks stay well within it.
+static const double s_MaxDrift = 1e-3;
+
+/// @brief The median of p_Values, which are reordered.
+static double Median(std::vector<double>& p_Values)
+{
+	const size_t t_Middle = p_Values.size() / 2;
+	std::nth_element(p_Values.begin(), p_Values.begin() + t_Middle, p_Values.end());
+	return p_Values[t_Middle];
+}
+
+void ClockMapping::Configure(const double p_BinMs, const size_t p_BinCount, const double p_MinDriftSpanMs, const double p_ResetMs, const double p_LatencyMs)
+{
+	m_BinMs = (std::max)(p_BinMs, 1.0);
+	m_BinCount = (std::max)(p_BinCount, static_cast<size_t>(2));
+	m_MinDriftSpanMs = p_MinDriftSpanMs;
+	m_ResetMs = p_ResetMs;
+	m_LatencyMs = p_LatencyMs;
+	m_Bins.assign(m_BinCount, Bin());
+	m_Slopes.reserve(m_BinCount);
+	m_Residuals.reserve(m_BinCount);
+	Reset();
+}
+
+void ClockMapping::Reset()
+{
+	if (m_Bins.size() != m_BinCount) m_Bins.assign(m_BinCount, Bin());
+	m_BinStart = 0;
+	m_BinsUsed = 0;
+	m_HasCurrent = false;
+	m_Valid = false;
+	m_Slope = 1.0;
+	m_SpreadMs = 0.0;
+}
+
+void ClockMapping::AddSample(const double p_DeviceMs, const double p_HostMs)
+{
+	m_SampleCount++;
+	if (m_Valid && m_ResetMs > 0.0 && std::fabs(p_HostMs - ToHost(p_DeviceMs) - m_LatencyMs) > m_ResetMs)
+	{
+		m_ResetCount++;
+		Reset();
+	}
+	if (m_HasCurrent && (p_DeviceMs - m_CurrentStartMs >= m_BinMs || p_DeviceMs < m_CurrentStartMs))
+	{
+		CommitBin();
+	}
+	if (!m_HasCurrent)
+	{
+		m_HasCurrent = true;
+		m_CurrentStartMs = p_DeviceMs;
+		m_Current.deviceMs = p_DeviceMs;
+		m_Current.hostMs = p_HostMs;
+		return;
+	}
+	// the pair with the smallest delay is the one closest to the true mapping.
+	if (p_HostMs - p_DeviceMs < m_Current.hostMs - m_Current.deviceMs)
+	{
+		m_Current.deviceMs = p_DeviceMs;
+		m_Current.hostMs = p_HostMs;
+	}
+}
+
+void ClockMapping::CommitBin()
+{
+	m_Bins[(m_BinStart + m_BinsUsed) % m_BinCount] = m_Current;
+	if (m_BinsUsed < m_BinCount) m_BinsUsed++;
+	else m_BinStart = (m_BinStart + 1) % m_BinCount;
+	m_HasCurrent = false;
+	Fit();
+}
+
+void ClockMapping::Fit()
+{
+	const Bin& t_First = m_Bins[m_BinStart];
+	const Bin& t_Last = m_Bins[(m_BinStart + m_BinsUsed - 1) % m_BinCount];
+
+	// Theil-Sen on pairs half the window apart, every bin is in exactly one pair.
+	m_Slope = 1.0;
+	if (m_BinsUsed >= 4 && t_Last.deviceMs - t_First.deviceMs >= m_MinDriftSpanMs)
+	{
+		const size_t t_Half = m_BinsUsed / 2;
+		m_Slopes.clear();
+		for (size_t i = 0; i + t_Half < m_BinsUsed; i++)
+		{
+			const Bin& t_From = m_Bins[(m_BinStart + i) % m_BinCount];
+			const Bin& t_To = m_Bins[(m_BinStart + i + t_Half) % m_BinCount];
+			const double t_DeviceSpan = t_To.deviceMs - t_From.deviceMs;
+			if (t_DeviceSpan > 0.0) m_Slopes.push_back((t_To.hostMs - t_From.hostMs) / t_DeviceSpan);
+		}
+		if (!m_Slopes.empty()) m_Slope = (std::min)((std::max)(Median(m_Slopes), 1.0 - s_MaxDrift), 1.0 + s_MaxDrift);
+	}
+
+	// the offset at the newest bin, so the mapping is most accurate where it is used.
+	m_DeviceReference = t_Last.deviceMs;
+	m_Residuals.clear();
+	for (size_t i = 0; i < m_BinsUsed; i++)
+	{
+		const Bin& t_Bin = m_Bins[(m_BinStart + i) % m_BinCount];
+		m_Residuals.push_back(t_Bin.hostMs - m_Slope * (t_Bin.deviceMs - m_DeviceReference));
+	}
+	m_HostReference = Median(m_Residuals);
+	for (double& t_Residual : m_Residuals) t_Residual = std::fabs(t_Residual - m_HostReference);
+	m_SpreadMs = Median(m_Residuals);
+	m_Valid = true;
+}
+
+double ClockMapping::ToHost(const double p_DeviceMs) const
+{
+	return m_HostReference - m_LatencyMs + m_Slope * (p_DeviceMs - m_DeviceReference);
+}
+
+double ClockMapping::ToDevice(const double p_HostMs) const
+{
+	return m_DeviceReference + (p_HostMs + m_LatencyMs - m_HostReference) / m_Slope;
+}
+
+void ClockMapping::Print() const
+{
+	if (!m_Valid)
+	{
+		std::cout << "Clock mapping: not enough frames with a publishTime (" << m_SampleCount << ").\n";
+		return;
+	}
+	std::cout << "Clock mapping: " << m_SampleCount << " frames, drift " << GetDriftPpm() << " ppm, spread " << m_SpreadMs
+		<< " ms over the last " << m_BinsUsed << " bins, restarted " << m_ResetCount << " times.\n";
+}
+
+double ClockMapping::ToMilliseconds(const std::chrono::steady_clock::time_point p_Time)
+{
+	return std::chrono::duration<double, std::milli>(p_Time.time_since_epoch()).count();
+}
+
+builtin_interfaces::msg::Time HostToRosTime(const double p_HostMs, rclcpp::Clock& p_Clock)
+{
+	const int64_t t_RosNs = p_Clock.now().nanoseconds();
+	const double t_AgeMs = ClockMapping::ToMilliseconds(std::chrono::steady_clock::now()) - p_HostMs;
+	const int64_t t_Ns = t_RosNs - static_cast<int64_t>(t_AgeMs * 1e6);
+	builtin_interfaces::msg::Time t_Time;
+	t_Time.sec = static_cast<int32_t>(t_Ns / 1000000000);
+	t_Time.nanosec = static_cast<uint32_t>(t_Ns % 1000000000);
+	return t_Time;
+}
@@ -0,0 +1,115 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _CLOCK_MAPPING_HPP_
+#define _CLOCK_MAPPING_HPP_
+
+#include "builtin_interfaces/msg/time.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include <chrono>
+// size_t
+#include <cstddef>
+// uint64_t
+#include <cstdint>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTracking
+ *  @{
+ */
+
+/// @brief Maps the Manus Core clock (the publishTime of the frames, in unix milliseconds on the
+/// machine running Core) onto the steady_clock of this host, so a frame can be stamped with the
+/// host time it was captured rather than the time it was picked up.
+///
+/// The two clocks differ by an offset and drift apart by some ppm. Every frame gives a pair of its
+/// publishTime and the host time it arrived, which is the mapped time plus a transport delay that
+/// is never negative and often much larger than usual (scheduling, network). So the pairs are
+/// reduced to the one with the smallest delay per bin of p_BinMs, the lower envelope, and the line
+/// through the recent bins is fitted by Theil-Sen regression: the drift is the median of the slopes
+/// between bins half the window apart, the offset the median of what remains, neither is moved by
+/// a few outliers. The drift is only fitted once the bins span p_MinDriftSpanMs, before that it is
+/// taken as 0. A sample that is more than p_ResetMs off the fit restarts the mapping, that is what
+/// a step of the Core clock looks like.
+///
+/// The mapped time is when the frame would have arrived with the smallest delay seen, the fixed
+/// part of the delay cannot be told apart from the offset without a round trip. p_LatencyMs can be
+/// given to move the mapping back by that much.
+class ClockMapping
+{
+public:
+	void Configure(const double p_BinMs, const size_t p_BinCount, const double p_MinDriftSpanMs, const double p_ResetMs, const double p_LatencyMs);
+
+	/// @brief Add a frame that was published at p_DeviceMs and arrived at p_HostMs (steady_clock).
+	void AddSample(const double p_DeviceMs, const double p_HostMs);
+
+	/// @brief True once a bin is complete, until then nothing should be mapped.
+	bool IsValid() const { return m_Valid; }
+	/// @brief The host time (steady_clock milliseconds) of a device time.
+	double ToHost(const double p_DeviceMs) const;
+	/// @brief The device time of a host time (steady_clock milliseconds).
+	double ToDevice(const double p_HostMs) const;
+
+	double GetDriftPpm() const { return (m_Slope - 1.0) * 1e6; }
+	/// @brief Median distance of the bins from the fit, the jitter left in the lower envelope.
+	double GetSpreadMs() const { return m_SpreadMs; }
+
+	/// @brief Offset, drift, spread and how often the mapping restarted.
+	void Print() const;
+
+	/// @brief Milliseconds of p_Time on steady_clock.
+	static double ToMilliseconds(const std::chrono::steady_clock::time_point p_Time);
+
+protected:
+	class Bin
+	{
+	public:
+		double deviceMs = 0.0;
+		double hostMs = 0.0;
+	};
+
+	void Reset();
+	void CommitBin();
+	void Fit();
+
+	double m_BinMs = 100.0;
+	size_t m_BinCount = 300;
+	double m_MinDriftSpanMs = 10000.0;
+	double m_ResetMs = 1000.0;
+	double m_LatencyMs = 0.0;
+
+	// the bins in a ring, the oldest is overwritten.
+	std::vector<Bin> m_Bins;
+	size_t m_BinStart = 0;
+	size_t m_BinsUsed = 0;
+	Bin m_Current; // the smallest delay of the bin being filled.
+	bool m_HasCurrent = false;
+	double m_CurrentStartMs = 0.0;
+
+	// host = m_HostReference + m_Slope * (device - m_DeviceReference).
+	bool m_Valid = false;
+	double m_DeviceReference = 0.0;
+	double m_HostReference = 0.0;
+	double m_Slope = 1.0;
+	double m_SpreadMs = 0.0;
+	uint64_t m_SampleCount = 0;
+	uint64_t m_ResetCount = 0;
+
+	// scratch space of Fit, kept so fitting does not allocate.
+	std::vector<double> m_Slopes;
+	std::vector<double> m_Residuals;
+};
+
+/// @brief The ROS time of p_HostMs (steady_clock milliseconds) on p_Clock, through the current
+/// difference between the two clocks.
+builtin_interfaces::msg::Time HostToRosTime(const double p_HostMs, rclcpp::Clock& p_Clock);
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,53 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _COMMAND_LINE_HPP_
+#define _COMMAND_LINE_HPP_
+
+// errno, ERANGE
+#include <cerrno>
+// uint64_t
+#include <cstdint>
+// std::strtod, std::strtoull
+#include <cstdlib>
+// std::string
+#include <string>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTools
+ *  @{
+ */
+
+/// @brief Parse all of p_Text as a number. False, leaving p_Value alone, if it is empty, out of
+/// range or has anything after the number, so "--rate x" is a usage error rather than an exception.
+inline bool ParseDoubleArgument(const std::string& p_Text, double& p_Value)
+{
+	char* t_End = nullptr;
+	errno = 0;
+	const double t_Value = std::strtod(p_Text.c_str(), &t_End);
+	if (p_Text.empty() || *t_End != '\0' || errno == ERANGE) return false;
+	p_Value = t_Value;
+	return true;
+}
+
+/// @brief Parse all of p_Text as a whole number of at most p_Max, see ParseDoubleArgument.
+template <class Unsigned>
+inline bool ParseUnsignedArgument(const std::string& p_Text, Unsigned& p_Value, const uint64_t p_Max = static_cast<Unsigned>(-1))
+{
+	// strtoull takes "-1" as the largest value, only digits are a count.
+	if (p_Text.empty() || p_Text[0] < '0' || p_Text[0] > '9') return false;
+	char* t_End = nullptr;
+	errno = 0;
+	const unsigned long long t_Value = std::strtoull(p_Text.c_str(), &t_End, 10);
+	if (*t_End != '\0' || errno == ERANGE || t_Value > p_Max) return false;
+	p_Value = static_cast<Unsigned>(t_Value);
+	return true;
+}
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
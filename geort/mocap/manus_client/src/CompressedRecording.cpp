@@ -0,0 +1,795 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "CompressedRecording.hpp"
+
+// std::upper_bound, std::max, std::min
+#include <algorithm>
+// std::sqrt, std::lround, std::fabs
+#include <cmath>
+// std::memcpy, std::memcmp, std::memset
+#include <cstring>
+#include <iostream>
+
+// mmap
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef GEORT_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static_assert(sizeof(CompressedRecordingHeader) == 64, "CompressedRecordingHeader layout changed.");
+static_assert(sizeof(CompressedRecordingBlock) == 64, "CompressedRecordingBlock layout changed.");
+static_assert(sizeof(CompressedRecordingIndexEntry) == 40, "CompressedRecordingIndexEntry layout changed.");
+static_assert(sizeof(CompressedRecordingFooter) == 32, "CompressedRecordingFooter layout changed.");
+
+/// @brief zstd level for new blocks, the decode speed hardly depends on it.
+static const int s_ZstdLevel = 3;
+
+bool IsZstdAvailable()
+{
+#ifdef GEORT_HAVE_ZSTD
+	return true;
+#else
+	return false;
+#endif
+}
+
+static inline void WriteVarint(std::vector<uint8_t>& p_Out, uint64_t p_Value)
+{
+	while (p_Value >= 0x80)
+	{
+		p_Out.push_back(static_cast<uint8_t>(p_Value | 0x80));
+		p_Value >>= 7;
+	}
+	p_Out.push_back(static_cast<uint8_t>(p_Value));
+}
+
+static inline void WriteZigzag(std::vector<uint8_t>& p_Out, const int64_t p_Value)
+{
+	WriteVarint(p_Out, (static_cast<uint64_t>(p_Value) << 1) ^ static_cast<uint64_t>(p_Value >> 63));
+}
+
+static inline bool ReadVarint(const uint8_t*& p_Cursor, const uint8_t* const p_End, uint64_t& p_Value)
+{
+	p_Value = 0;
+	for (int t_Shift = 0; t_Shift < 64 && p_Cursor < p_End; t_Shift += 7)
+	{
+		const uint8_t t_Byte = *p_Cursor++;
+		p_Value |= static_cast<uint64_t>(t_Byte & 0x7f) << t_Shift;
+		if ((t_Byte & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+static inline bool ReadZigzag(const uint8_t*& p_Cursor, const uint8_t* const p_End, int64_t& p_Value)
+{
+	uint64_t t_Raw = 0;
+	if (!ReadVarint(p_Cursor, p_End, t_Raw)) return false;
+	p_Value = static_cast<int64_t>(t_Raw >> 1) ^ -static_cast<int64_t>(t_Raw & 1);
+	return true;
+}
+
+/// @brief Largest integer a quaternion component is quantized to.
+static inline int32_t RotationLimit(const uint32_t p_RotationBits)
+{
+	return (1 << (p_RotationBits - 1)) - 1;
+}
+
+/// @brief Smallest-three quantization: the index of the largest component and the other three
+/// scaled from [-1/sqrt(2), 1/sqrt(2)] to [-limit, limit].
+static void QuantizeRotation(const ManusQuaternion& p_Rotation, const uint32_t p_RotationBits, int32_t* const p_Out)
+{
+	float t_Q[4] = { p_Rotation.w, p_Rotation.x, p_Rotation.y, p_Rotation.z };
+	const float t_Norm = std::sqrt(t_Q[0] * t_Q[0] + t_Q[1] * t_Q[1] + t_Q[2] * t_Q[2] + t_Q[3] * t_Q[3]);
+	if (!(t_Norm > 1e-12f))
+	{
+		t_Q[0] = 1.0f; t_Q[1] = 0.0f; t_Q[2] = 0.0f; t_Q[3] = 0.0f;
+	}
+	else
+	{
+		for (float& t_Value : t_Q) t_Value /= t_Norm;
+	}
+
+	int t_Largest = 0;
+	for (int i = 1; i < 4; i++)
+	{
+		if (std::fabs(t_Q[i]) > std::fabs(t_Q[t_Largest])) t_Largest = i;
+	}
+	const float t_Sign = t_Q[t_Largest] < 0.0f ? -1.0f : 1.0f;
+
+	const int32_t t_Limit = RotationLimit(p_RotationBits);
+	const float t_Scale = static_cast<float>(t_Limit) * 1.41421356f;
+	p_Out[0] = t_Largest;
+	for (int i = 0, j = 1; i < 4; i++)
+	{
+		if (i == t_Largest) continue;
+		const long t_Value = std::lround(t_Sign * t_Q[i] * t_Scale);
+		p_Out[j++] = static_cast<int32_t>((std::max)(static_cast<long>(-t_Limit), (std::min)(static_cast<long>(t_Limit), t_Value)));
+	}
+}
+
+static void DequantizeRotation(const int32_t* const p_In, const uint32_t p_RotationBits, ManusQuaternion& p_Rotation)
+{
+	const float t_InverseScale = 1.0f / (static_cast<float>(RotationLimit(p_RotationBits)) * 1.41421356f);
+	float t_Q[4];
+	float t_SumSquares = 0.0f;
+	for (int i = 0, j = 1; i < 4; i++)
+	{
+		if (i == p_In[0]) continue;
+		t_Q[i] = static_cast<float>(p_In[j++]) * t_InverseScale;
+		t_SumSquares += t_Q[i] * t_Q[i];
+	}
+	t_Q[p_In[0]] = std::sqrt((std::max)(0.0f, 1.0f - t_SumSquares));
+	p_Rotation.w = t_Q[0];
+	p_Rotation.x = t_Q[1];
+	p_Rotation.y = t_Q[2];
+	p_Rotation.z = t_Q[3];
+}
+
+static inline int32_t QuantizePosition(const float p_Value, const float p_Quantum)
+{
+	const double t_Steps = static_cast<double>(p_Value) / static_cast<double>(p_Quantum);
+	return static_cast<int32_t>(std::lround((std::max)(-2147483647.0, (std::min)(2147483647.0, t_Steps))));
+}
+
+void DecodedRecordingBlock::GetSkeletons(const size_t p_Frame, std::vector<RecordedSkeleton>& p_Skeletons) const
+{
+	const uint32_t t_Begin = skeletonBegin[p_Frame];
+	const uint32_t t_End = skeletonBegin[p_Frame + 1];
+	p_Skeletons.resize(t_End - t_Begin);
+	for (uint32_t s = t_Begin; s < t_End; s++)
+	{
+		p_Skeletons[s - t_Begin].info = infos[s];
+		p_Skeletons[s - t_Begin].nodes = nodes.data() + nodeBegin[s];
+	}
+}
+
+CompressedRecordingWriter::CompressedRecordingWriter()
+{
+}
+
+CompressedRecordingWriter::~CompressedRecordingWriter()
+{
+	Close();
+}
+
+bool CompressedRecordingWriter::Open(
+	const std::string& p_Path,
+	const SkeletonRecordingHeader& p_Source,
+	const CompressedRecordingCodec p_Codec,
+	const float p_PositionQuantum,
+	const uint32_t p_RotationBits,
+	const uint32_t p_FramesPerBlock)
+{
+	Close();
+
+	if (!(p_PositionQuantum > 0.0f) || p_RotationBits < 8 || p_RotationBits > 24 || p_FramesPerBlock == 0)
+	{
+		std::cerr << "Invalid compressed recording settings." << std::endl;
+		return false;
+	}
+
+	m_Codec = p_Codec;
+	if (m_Codec == CompressedRecordingCodec_Zstd && !IsZstdAvailable())
+	{
+		std::cerr << "Built without zstd, blocks are stored without byte level compression." << std::endl;
+		m_Codec = CompressedRecordingCodec_None;
+	}
+
+	m_File = std::fopen(p_Path.c_str(), "wb");
+	if (m_File == nullptr)
+	{
+		std::cerr << "Could not create compressed recording " << p_Path << "." << std::endl;
+		return false;
+	}
+
+	std::memset(&m_Header, 0, sizeof(m_Header));
+	std::memcpy(m_Header.magic, COMPRESSED_RECORDING_MAGIC, sizeof(m_Header.magic));
+	m_Header.version = COMPRESSED_RECORDING_VERSION;
+	m_Header.headerBytes = sizeof(CompressedRecordingHeader);
+	m_Header.positionQuantum = p_PositionQuantum;
+	m_Header.rotationBits = p_RotationBits;
+	m_Header.framesPerBlock = p_FramesPerBlock;
+	m_Header.steadyStartNs = p_Source.steadyStartNs;
+	m_Header.systemStartNs = p_Source.systemStartNs;
+
+	m_Failed = std::fwrite(&m_Header, sizeof(m_Header), 1, m_File) != 1;
+	m_BytesWritten = sizeof(m_Header);
+	std::memset(&m_Block, 0, sizeof(m_Block));
+	m_Raw.clear();
+	m_Slots.clear();
+	m_Index.clear();
+	m_FrameCount = 0;
+	return !m_Failed;
+}
+
+bool CompressedRecordingWriter::Close()
+{
+	if (m_File == nullptr) return true;
+
+	FlushBlock();
+
+	CompressedRecordingFooter t_Footer;
+	std::memset(&t_Footer, 0, sizeof(t_Footer));
+	t_Footer.indexOffset = m_BytesWritten;
+	t_Footer.blockCount = m_Index.size();
+	t_Footer.frameCount = m_FrameCount;
+	std::memcpy(t_Footer.magic, COMPRESSED_RECORDING_FOOTER_MAGIC, sizeof(t_Footer.magic));
+	m_Failed |= !m_Index.empty() && std::fwrite(m_Index.data(), sizeof(CompressedRecordingIndexEntry), m_Index.size(), m_File) != m_Index.size();
+	m_Failed |= std::fwrite(&t_Footer, sizeof(t_Footer), 1, m_File) != 1;
+	m_BytesWritten += sizeof(CompressedRecordingIndexEntry) * m_Index.size() + sizeof(t_Footer);
+
+	m_Failed |= std::fclose(m_File) != 0;
+	m_File = nullptr;
+	if (m_Failed)
+	{
+		std::cerr << "Writing the compressed recording failed." << std::endl;
+	}
+	return !m_Failed;
+}
+
+bool CompressedRecordingWriter::WriteFrame(const SkeletonRecordingFrame& p_Frame, const RecordedSkeleton* const p_Skeletons, const size_t p_SkeletonCount)
+{
+	if (m_File == nullptr || m_Failed) return false;
+
+	const uint64_t t_PublishTime = p_SkeletonCount > 0 ? p_Skeletons[0].info.publishTime.time : 0;
+	if (m_Block.frameCount == 0)
+	{
+		// every block starts from scratch so it can be decoded on its own.
+		m_Block.firstFrameIndex = p_Frame.frameIndex;
+		m_Block.firstHostTimeNs = p_Frame.hostTimeNs;
+		m_Block.firstPublishTime = t_PublishTime;
+		m_PreviousFrameIndex = p_Frame.frameIndex;
+		m_PreviousHostTime = p_Frame.hostTimeNs;
+		for (RecordingSlotState& t_Slot : m_Slots) t_Slot.valid = false;
+	}
+	m_Block.lastHostTimeNs = p_Frame.hostTimeNs;
+	m_Block.lastPublishTime = t_PublishTime;
+
+	WriteVarint(m_Raw, p_Frame.frameIndex - m_PreviousFrameIndex);
+	WriteZigzag(m_Raw, static_cast<int64_t>(p_Frame.hostTimeNs - m_PreviousHostTime));
+	WriteVarint(m_Raw, p_SkeletonCount);
+	m_PreviousFrameIndex = p_Frame.frameIndex;
+	m_PreviousHostTime = p_Frame.hostTimeNs;
+
+	if (m_Slots.size() < p_SkeletonCount) m_Slots.resize(p_SkeletonCount);
+	for (size_t s = 0; s < p_SkeletonCount; s++)
+	{
+		const RecordedSkeleton& t_Skeleton = p_Skeletons[s];
+		const uint32_t t_NodesCount = t_Skeleton.info.nodesCount;
+		RecordingSlotState& t_Slot = m_Slots[s];
+
+		bool t_SameLayout = t_Slot.valid && t_Slot.id == t_Skeleton.info.id && t_Slot.nodeIds.size() == t_NodesCount;
+		bool t_UnitScale = true;
+		for (uint32_t n = 0; n < t_NodesCount; n++)
+		{
+			const SkeletonNode& t_Node = t_Skeleton.nodes[n];
+			t_SameLayout = t_SameLayout && t_Slot.nodeIds[n] == t_Node.id;
+			t_UnitScale = t_UnitScale && t_Node.transform.scale.x == 1.0f && t_Node.transform.scale.y == 1.0f && t_Node.transform.scale.z == 1.0f;
+		}
+
+		m_Raw.push_back(static_cast<uint8_t>((t_SameLayout ? CompressedRecordingFlag_SameLayout : 0) | (t_UnitScale ? CompressedRecordingFlag_UnitScale : 0)));
+		if (!t_SameLayout)
+		{
+			WriteVarint(m_Raw, t_Skeleton.info.id);
+			WriteVarint(m_Raw, t_NodesCount);
+			t_Slot.nodeIds.resize(t_NodesCount);
+			for (uint32_t n = 0; n < t_NodesCount; n++)
+			{
+				WriteVarint(m_Raw, t_Skeleton.nodes[n].id);
+				t_Slot.nodeIds[n] = t_Skeleton.nodes[n].id;
+			}
+			// delta against zero.
+			t_Slot.positions.assign(static_cast<size_t>(t_NodesCount) * 3, 0);
+			t_Slot.rotations.assign(static_cast<size_t>(t_NodesCount) * 4, -1);
+			t_Slot.publishTime = 0;
+			t_Slot.id = t_Skeleton.info.id;
+			t_Slot.valid = true;
+		}
+		WriteZigzag(m_Raw, static_cast<int64_t>(t_Skeleton.info.publishTime.time - t_Slot.publishTime));
+		t_Slot.publishTime = t_Skeleton.info.publishTime.time;
+
+		for (uint32_t n = 0; n < t_NodesCount; n++)
+		{
+			const ManusTransform& t_Transform = t_Skeleton.nodes[n].transform;
+
+			int32_t* const t_Position = t_Slot.positions.data() + n * 3;
+			const int32_t t_NewPosition[3] = {
+				QuantizePosition(t_Transform.position.x, m_Header.positionQuantum),
+				QuantizePosition(t_Transform.position.y, m_Header.positionQuantum),
+				QuantizePosition(t_Transform.position.z, m_Header.positionQuantum) };
+			for (int a = 0; a < 3; a++)
+			{
+				WriteZigzag(m_Raw, static_cast<int64_t>(t_NewPosition[a]) - t_Position[a]);
+				t_Position[a] = t_NewPosition[a];
+			}
+
+			int32_t* const t_Rotation = t_Slot.rotations.data() + n * 4;
+			int32_t t_NewRotation[4];
+			QuantizeRotation(t_Transform.rotation, m_Header.rotationBits, t_NewRotation);
+			const bool t_DeltaRotation = t_Rotation[0] == t_NewRotation[0];
+			for (int a = 1; a < 4; a++)
+			{
+				const int64_t t_Value = t_DeltaRotation ? static_cast<int64_t>(t_NewRotation[a]) - t_Rotation[a] : t_NewRotation[a];
+				const uint64_t t_Zigzag = (static_cast<uint64_t>(t_Value) << 1) ^ static_cast<uint64_t>(t_Value >> 63);
+				WriteVarint(m_Raw, a == 1 ? (t_Zigzag << 2) | static_cast<uint64_t>(t_NewRotation[0]) : t_Zigzag);
+			}
+			std::memcpy(t_Rotation, t_NewRotation, sizeof(t_NewRotation));
+
+			if (!t_UnitScale)
+			{
+				const size_t t_Size = m_Raw.size();
+				m_Raw.resize(t_Size + sizeof(ManusVec3));
+				std::memcpy(m_Raw.data() + t_Size, &t_Transform.scale, sizeof(ManusVec3));
+			}
+		}
+	}
+
+	m_Block.frameCount++;
+	if (m_Block.frameCount >= m_Header.framesPerBlock)
+	{
+		return FlushBlock();
+	}
+	return true;
+}
+
+bool CompressedRecordingWriter::FlushBlock()
+{
+	if (m_Block.frameCount == 0) return !m_Failed;
+
+	m_Block.magic = COMPRESSED_RECORDING_BLOCK_MAGIC;
+	m_Block.codec = m_Codec;
+	m_Block.rawBytes = static_cast<uint32_t>(m_Raw.size());
+
+	const uint8_t* t_Payload = m_Raw.data();
+	size_t t_PayloadBytes = m_Raw.size();
+#ifdef GEORT_HAVE_ZSTD
+	if (m_Codec == CompressedRecordingCodec_Zstd)
+	{
+		m_Stored.resize(ZSTD_compressBound(m_Raw.size()));
+		const size_t t_Result = ZSTD_compress(m_Stored.data(), m_Stored.size(), m_Raw.data(), m_Raw.size(), s_ZstdLevel);
+		if (ZSTD_isError(t_Result))
+		{
+			std::cerr << "zstd failed: " << ZSTD_getErrorName(t_Result) << std::endl;
+			m_Failed = true;
+			return false;
+		}
+		t_Payload = m_Stored.data();
+		t_PayloadBytes = t_Result;
+	}
+#endif
+	m_Block.storedBytes = static_cast<uint32_t>(t_PayloadBytes);
+
+	CompressedRecordingIndexEntry t_Entry;
+	t_Entry.offset = m_BytesWritten;
+	t_Entry.firstFrame = m_FrameCount;
+	t_Entry.firstFrameIndex = m_Block.firstFrameIndex;
+	t_Entry.firstHostTimeNs = m_Block.firstHostTimeNs;
+	t_Entry.firstPublishTime = m_Block.firstPublishTime;
+	m_Index.push_back(t_Entry);
+	m_FrameCount += m_Block.frameCount;
+
+	m_Failed |= std::fwrite(&m_Block, sizeof(m_Block), 1, m_File) != 1;
+	m_Failed |= t_PayloadBytes > 0 && std::fwrite(t_Payload, t_PayloadBytes, 1, m_File) != 1;
+	m_BytesWritten += sizeof(m_Block) + t_PayloadBytes;
+
+	std::memset(&m_Block, 0, sizeof(m_Block));
+	m_Raw.clear();
+	return !m_Failed;
+}
+
+CompressedRecordingReader::CompressedRecordingReader()
+{
+}
+
+CompressedRecordingReader::~CompressedRecordingReader()
+{
+	Close();
+}
+
+bool CompressedRecordingReader::Open(const std::string& p_Path)
+{
+	Close();
+
+	const int t_Descriptor = open(p_Path.c_str(), O_RDONLY);
+	if (t_Descriptor < 0)
+	{
+		std::cerr << "Could not open compressed recording " << p_Path << "." << std::endl;
+		return false;
+	}
+
+	struct stat t_Stat;
+	if (fstat(t_Descriptor, &t_Stat) != 0 || static_cast<size_t>(t_Stat.st_size) < sizeof(CompressedRecordingHeader))
+	{
+		std::cerr << "Compressed recording " << p_Path << " is too small." << std::endl;
+		close(t_Descriptor);
+		return false;
+	}
+
+	void* const t_Mapping = mmap(nullptr, static_cast<size_t>(t_Stat.st_size), PROT_READ, MAP_SHARED, t_Descriptor, 0);
+	// the mapping keeps the file alive, the descriptor is no longer needed.
+	close(t_Descriptor);
+	if (t_Mapping == MAP_FAILED)
+	{
+		std::cerr << "Could not mmap compressed recording " << p_Path << "." << std::endl;
+		return false;
+	}
+
+	m_Data = static_cast<const unsigned char*>(t_Mapping);
+	m_Size = static_cast<size_t>(t_Stat.st_size);
+
+	const CompressedRecordingHeader* const t_Header = GetHeader();
+	if (std::memcmp(t_Header->magic, COMPRESSED_RECORDING_MAGIC, sizeof(t_Header->magic)) != 0
+		|| t_Header->version < 1 || t_Header->version > COMPRESSED_RECORDING_VERSION
+		|| t_Header->headerBytes != sizeof(CompressedRecordingHeader)
+		|| !(t_Header->positionQuantum > 0.0f) || t_Header->rotationBits < 8 || t_Header->rotationBits > 24)
+	{
+		std::cerr << "Compressed recording " << p_Path << " has an unknown format or version." << std::endl;
+		Close();
+		return false;
+	}
+
+	if (t_Header->version >= 2 && LoadIndex())
+	{
+		m_HasIndex = true;
+		return true;
+	}
+
+	m_BlockFirstFrame.push_back(0);
+	uint64_t t_Offset = t_Header->headerBytes;
+	while (t_Offset + sizeof(CompressedRecordingBlock) <= m_Size)
+	{
+		CompressedRecordingBlock t_Block;
+		std::memcpy(&t_Block, m_Data + t_Offset, sizeof(t_Block));
+		if (t_Block.magic != COMPRESSED_RECORDING_BLOCK_MAGIC || t_Block.frameCount == 0
+			|| t_Offset + sizeof(t_Block) + t_Block.storedBytes > m_Size)
+		{
+			break;
+		}
+		CompressedRecordingIndexEntry t_Entry;
+		t_Entry.offset = t_Offset;
+		t_Entry.firstFrame = m_BlockFirstFrame.back();
+		t_Entry.firstFrameIndex = t_Block.firstFrameIndex;
+		t_Entry.firstHostTimeNs = t_Block.firstHostTimeNs;
+		t_Entry.firstPublishTime = t_Block.firstPublishTime;
+		m_Index.push_back(t_Entry);
+		m_BlockFirstFrame.push_back(m_BlockFirstFrame.back() + t_Block.frameCount);
+		t_Offset += sizeof(t_Block) + t_Block.storedBytes;
+	}
+
+	if (t_Offset != m_Size)
+	{
+		std::cerr << "Compressed recording " << p_Path << " has " << (m_Size - t_Offset)
+			<< " trailing bytes that are not a complete block, they are ignored." << std::endl;
+	}
+	return true;
+}
+
+void CompressedRecordingReader::Close()
+{
+	if (m_Data != nullptr)
+	{
+		munmap(const_cast<unsigned char*>(m_Data), m_Size);
+	}
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Index.clear();
+	m_BlockFirstFrame.clear();
+	m_HasIndex = false;
+	m_CachedBlock = static_cast<size_t>(-1);
+}
+
+bool CompressedRecordingReader::LoadIndex()
+{
+	if (m_Size < GetHeader()->headerBytes + sizeof(CompressedRecordingFooter)) return false;
+
+	CompressedRecordingFooter t_Footer;
+	std::memcpy(&t_Footer, m_Data + m_Size - sizeof(t_Footer), sizeof(t_Footer));
+	if (std::memcmp(t_Footer.magic, COMPRESSED_RECORDING_FOOTER_MAGIC, sizeof(t_Footer.magic)) != 0
+		|| t_Footer.indexOffset < GetHeader()->headerBytes
+		|| t_Footer.blockCount > m_Size / sizeof(CompressedRecordingIndexEntry)
+		|| t_Footer.indexOffset + t_Footer.blockCount * sizeof(CompressedRecordingIndexEntry) + sizeof(t_Footer) != m_Size)
+	{
+		return false;
+	}
+
+	m_Index.resize(static_cast<size_t>(t_Footer.blockCount));
+	if (!m_Index.empty())
+	{
+		std::memcpy(m_Index.data(), m_Data + t_Footer.indexOffset, m_Index.size() * sizeof(CompressedRecordingIndexEntry));
+	}
+
+	// the blocks must follow each other between the header and the index, or the index is not ours.
+	m_BlockFirstFrame.clear();
+	uint64_t t_End = GetHeader()->headerBytes;
+	for (size_t b = 0; b < m_Index.size(); b++)
+	{
+		const CompressedRecordingIndexEntry& t_Entry = m_Index[b];
+		const bool t_Valid = t_Entry.offset >= t_End && t_Entry.offset + sizeof(CompressedRecordingBlock) <= t_Footer.indexOffset
+			&& (b == 0 ? t_Entry.firstFrame == 0 : t_Entry.firstFrame > m_BlockFirstFrame.back());
+		if (!t_Valid)
+		{
+			m_Index.clear();
+			m_BlockFirstFrame.clear();
+			return false;
+		}
+		m_BlockFirstFrame.push_back(static_cast<size_t>(t_Entry.firstFrame));
+		t_End = t_Entry.offset + sizeof(CompressedRecordingBlock);
+	}
+	if (m_BlockFirstFrame.empty() ? t_Footer.frameCount != 0 : t_Footer.frameCount <= m_BlockFirstFrame.back())
+	{
+		m_Index.clear();
+		m_BlockFirstFrame.clear();
+		return false;
+	}
+	m_BlockFirstFrame.push_back(static_cast<size_t>(t_Footer.frameCount));
+	return true;
+}
+
+CompressedRecordingBlock CompressedRecordingReader::GetBlock(const size_t p_Block) const
+{
+	CompressedRecordingBlock t_Block;
+	std::memcpy(&t_Block, m_Data + m_Index[p_Block].offset, sizeof(t_Block));
+	return t_Block;
+}
+
+size_t CompressedRecordingReader::FindBlockOfFrame(const size_t p_Frame) const
+{
+	return static_cast<size_t>(std::upper_bound(m_BlockFirstFrame.begin(), m_BlockFirstFrame.end(), p_Frame) - m_BlockFirstFrame.begin()) - 1;
+}
+
+bool CompressedRecordingReader::DecodeBlock(const size_t p_Block, DecodedRecordingBlock& p_Decoded) const
+{
+	// with an index the block header has not been looked at yet.
+	const CompressedRecordingBlock t_Block = GetBlock(p_Block);
+	const uint64_t t_Offset = m_Index[p_Block].offset;
+	if (t_Block.magic != COMPRESSED_RECORDING_BLOCK_MAGIC
+		|| t_Block.frameCount != m_BlockFirstFrame[p_Block + 1] - m_BlockFirstFrame[p_Block]
+		|| t_Offset + sizeof(CompressedRecordingBlock) + t_Block.storedBytes > m_Size)
+	{
+		std::cerr << "Block " << p_Block << " of the compressed recording is corrupt." << std::endl;
+		return false;
+	}
+	const uint8_t* const t_Stored = m_Data + t_Offset + sizeof(CompressedRecordingBlock);
+	const uint32_t t_RotationBits = GetHeader()->rotationBits;
+	const float t_Quantum = GetHeader()->positionQuantum;
+
+	const uint8_t* t_Cursor = t_Stored;
+	const uint8_t* t_End = t_Stored + t_Block.storedBytes;
+	if (t_Block.codec == CompressedRecordingCodec_Zstd)
+	{
+#ifdef GEORT_HAVE_ZSTD
+		p_Decoded.raw.resize(t_Block.rawBytes);
+		const size_t t_Result = ZSTD_decompress(p_Decoded.raw.data(), p_Decoded.raw.size(), t_Stored, t_Block.storedBytes);
+		if (ZSTD_isError(t_Result) || t_Result != t_Block.rawBytes)
+		{
+			std::cerr << "Block " << p_Block << " of the compressed recording is corrupt." << std::endl;
+			return false;
+		}
+		t_Cursor = p_Decoded.raw.data();
+		t_End = t_Cursor + t_Result;
+#else
+		std::cerr << "The compressed recording uses zstd, rebuild manus_client with zstd to read it." << std::endl;
+		return false;
+#endif
+	}
+	else if (t_Block.codec != CompressedRecordingCodec_None || t_Block.storedBytes != t_Block.rawBytes)
+	{
+		std::cerr << "Block " << p_Block << " of the compressed recording has an unknown codec." << std::endl;
+		return false;
+	}
+
+	p_Decoded.frames.resize(t_Block.frameCount);
+	p_Decoded.skeletonBegin.assign(1, 0);
+	p_Decoded.infos.clear();
+	p_Decoded.nodeBegin.clear();
+	p_Decoded.nodes.clear();
+	for (RecordingSlotState& t_Slot : p_Decoded.slots) t_Slot.valid = false;
+
+	uint64_t t_FrameIndex = t_Block.firstFrameIndex;
+	uint64_t t_HostTime = t_Block.firstHostTimeNs;
+	bool t_Valid = true;
+	for (uint32_t f = 0; t_Valid && f < t_Block.frameCount; f++)
+	{
+		uint64_t t_FrameDelta = 0;
+		int64_t t_HostDelta = 0;
+		uint64_t t_SkeletonCount = 0;
+		t_Valid = ReadVarint(t_Cursor, t_End, t_FrameDelta) && ReadZigzag(t_Cursor, t_End, t_HostDelta)
+			&& ReadVarint(t_Cursor, t_End, t_SkeletonCount) && t_SkeletonCount <= t_Block.rawBytes;
+		if (!t_Valid) break;
+
+		t_FrameIndex += t_FrameDelta;
+		t_HostTime += static_cast<uint64_t>(t_HostDelta);
+		SkeletonRecordingFrame& t_Frame = p_Decoded.frames[f];
+		t_Frame.magic = SKELETON_RECORDING_FRAME_MAGIC;
+		t_Frame.frameBytes = 0;
+		t_Frame.frameIndex = t_FrameIndex;
+		t_Frame.hostTimeNs = t_HostTime;
+		t_Frame.skeletonCount = static_cast<uint32_t>(t_SkeletonCount);
+		t_Frame.reserved = 0;
+
+		if (p_Decoded.slots.size() < t_SkeletonCount) p_Decoded.slots.resize(t_SkeletonCount);
+		for (uint64_t s = 0; t_Valid && s < t_SkeletonCount; s++)
+		{
+			RecordingSlotState& t_Slot = p_Decoded.slots[s];
+			t_Valid = t_Cursor < t_End;
+			if (!t_Valid) break;
+			const uint8_t t_Flags = *t_Cursor++;
+
+			if ((t_Flags & CompressedRecordingFlag_SameLayout) == 0)
+			{
+				uint64_t t_Id = 0;
+				uint64_t t_NodesCount = 0;
+				t_Valid = ReadVarint(t_Cursor, t_End, t_Id) && ReadVarint(t_Cursor, t_End, t_NodesCount)
+					&& t_NodesCount <= static_cast<uint64_t>(t_End - t_Cursor);
+				if (!t_Valid) break;
+				t_Slot.nodeIds.resize(t_NodesCount);
+				for (uint64_t n = 0; t_Valid && n < t_NodesCount; n++)
+				{
+					uint64_t t_NodeId = 0;
+					t_Valid = ReadVarint(t_Cursor, t_End, t_NodeId);
+					t_Slot.nodeIds[n] = static_cast<uint32_t>(t_NodeId);
+				}
+				t_Slot.positions.assign(t_NodesCount * 3, 0);
+				t_Slot.rotations.assign(t_NodesCount * 4, -1);
+				t_Slot.publishTime = 0;
+				t_Slot.id = static_cast<uint32_t>(t_Id);
+				t_Slot.valid = true;
+			}
+			else
+			{
+				t_Valid = t_Slot.valid;
+			}
+
+			int64_t t_PublishDelta = 0;
+			t_Valid = t_Valid && ReadZigzag(t_Cursor, t_End, t_PublishDelta);
+			if (!t_Valid) break;
+			t_Slot.publishTime += static_cast<uint64_t>(t_PublishDelta);
+
+			const uint32_t t_NodesCount = static_cast<uint32_t>(t_Slot.nodeIds.size());
+			SkeletonInfo t_Info;
+			t_Info.id = t_Slot.id;
+			t_Info.nodesCount = t_NodesCount;
+			t_Info.publishTime.time = t_Slot.publishTime;
+			p_Decoded.infos.push_back(t_Info);
+			p_Decoded.nodeBegin.push_back(static_cast<uint32_t>(p_Decoded.nodes.size()));
+
+			for (uint32_t n = 0; t_Valid && n < t_NodesCount; n++)
+			{
+				SkeletonNode t_Node;
+				t_Node.id = t_Slot.nodeIds[n];
+
+				int32_t* const t_Position = t_Slot.positions.data() + n * 3;
+				int64_t t_Delta[3];
+				t_Valid = ReadZigzag(t_Cursor, t_End, t_Delta[0]) && ReadZigzag(t_Cursor, t_End, t_Delta[1]) && ReadZigzag(t_Cursor, t_End, t_Delta[2]);
+				if (!t_Valid) break;
+				for (int a = 0; a < 3; a++) t_Position[a] += static_cast<int32_t>(t_Delta[a]);
+				t_Node.transform.position.x = static_cast<float>(t_Position[0] * static_cast<double>(t_Quantum));
+				t_Node.transform.position.y = static_cast<float>(t_Position[1] * static_cast<double>(t_Quantum));
+				t_Node.transform.position.z = static_cast<float>(t_Position[2] * static_cast<double>(t_Quantum));
+
+				int32_t* const t_Rotation = t_Slot.rotations.data() + n * 4;
+				uint64_t t_First = 0;
+				int64_t t_Second = 0;
+				int64_t t_Third = 0;
+				t_Valid = ReadVarint(t_Cursor, t_End, t_First) && ReadZigzag(t_Cursor, t_End, t_Second) && ReadZigzag(t_Cursor, t_End, t_Third);
+				if (!t_Valid) break;
+				const int32_t t_Largest = static_cast<int32_t>(t_First & 3);
+				const uint64_t t_FirstZigzag = t_First >> 2;
+				const int64_t t_FirstValue = static_cast<int64_t>(t_FirstZigzag >> 1) ^ -static_cast<int64_t>(t_FirstZigzag & 1);
+				if (t_Rotation[0] == t_Largest)
+				{
+					t_Rotation[1] += static_cast<int32_t>(t_FirstValue);
+					t_Rotation[2] += static_cast<int32_t>(t_Second);
+					t_Rotation[3] += static_cast<int32_t>(t_Third);
+				}
+				else
+				{
+					t_Rotation[0] = t_Largest;
+					t_Rotation[1] = static_cast<int32_t>(t_FirstValue);
+					t_Rotation[2] = static_cast<int32_t>(t_Second);
+					t_Rotation[3] = static_cast<int32_t>(t_Third);
+				}
+				DequantizeRotation(t_Rotation, t_RotationBits, t_Node.transform.rotation);
+
+				if (t_Flags & CompressedRecordingFlag_UnitScale)
+				{
+					t_Node.transform.scale.x = 1.0f;
+					t_Node.transform.scale.y = 1.0f;
+					t_Node.transform.scale.z = 1.0f;
+				}
+				else
+				{
+					t_Valid = static_cast<size_t>(t_End - t_Cursor) >= sizeof(ManusVec3);
+					if (!t_Valid) break;
+					std::memcpy(&t_Node.transform.scale, t_Cursor, sizeof(ManusVec3));
+					t_Cursor += sizeof(ManusVec3);
+				}
+				p_Decoded.nodes.push_back(t_Node);
+			}
+		}
+		p_Decoded.skeletonBegin.push_back(static_cast<uint32_t>(p_Decoded.infos.size()));
+	}
+
+	if (!t_Valid || t_Cursor != t_End)
+	{
+		std::cerr << "Block " << p_Block << " of the compressed recording is corrupt." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool CompressedRecordingReader::ReadFrame(const size_t p_Frame, SkeletonRecordingFrame& p_Header, std::vector<RecordedSkeleton>& p_Skeletons)
+{
+	if (p_Frame >= GetFrameCount()) return false;
+
+	const size_t t_Block = FindBlockOfFrame(p_Frame);
+	if (!CacheBlock(t_Block)) return false;
+
+	const size_t t_Local = p_Frame - m_BlockFirstFrame[t_Block];
+	p_Header = m_Cache.frames[t_Local];
+	m_Cache.GetSkeletons(t_Local, p_Skeletons);
+	return true;
+}
+
+bool CompressedRecordingReader::FindFirstFrame(const RecordingFrameKey& p_Key, const int64_t p_Target, size_t& p_Frame)
+{
+	// the first block whose first frame reaches the target, only from the index.
+	SkeletonRecordingFrame t_Frame;
+	std::memset(&t_Frame, 0, sizeof(t_Frame));
+	size_t t_Low = 0;
+	size_t t_High = m_Index.size();
+	while (t_Low < t_High)
+	{
+		const size_t t_Middle = t_Low + (t_High - t_Low) / 2;
+		const CompressedRecordingIndexEntry& t_Entry = m_Index[t_Middle];
+		t_Frame.frameIndex = t_Entry.firstFrameIndex;
+		t_Frame.hostTimeNs = t_Entry.firstHostTimeNs;
+
+		int64_t t_Key = 0;
+		if (!p_Key(t_Frame, t_Entry.firstPublishTime, t_Key)) return false;
+		if (t_Key < p_Target) t_Low = t_Middle + 1;
+		else t_High = t_Middle;
+	}
+	if (t_Low == 0)
+	{
+		p_Frame = 0;
+		return true;
+	}
+
+	// the frame is in the block before it, or it is that block's first frame.
+	const size_t t_Block = t_Low - 1;
+	if (!CacheBlock(t_Block)) return false;
+	t_Low = 1;
+	t_High = m_Cache.frames.size();
+	while (t_Low < t_High)
+	{
+		const size_t t_Middle = t_Low + (t_High - t_Low) / 2;
+		const uint32_t t_FirstSkeleton = m_Cache.skeletonBegin[t_Middle];
+		const uint64_t t_PublishTime = t_FirstSkeleton < m_Cache.skeletonBegin[t_Middle + 1] ? m_Cache.infos[t_FirstSkeleton].publishTime.time : 0;
+
+		int64_t t_Key = 0;
+		if (!p_Key(m_Cache.frames[t_Middle], t_PublishTime, t_Key)) return false;
+		if (t_Key < p_Target) t_Low = t_Middle + 1;
+		else t_High = t_Middle;
+	}
+	p_Frame = m_BlockFirstFrame[t_Block] + t_Low;
+	return true;
+}
+
+bool CompressedRecordingReader::CacheBlock(const size_t p_Block)
+{
+	if (p_Block == m_CachedBlock) return true;
+
+	m_CachedBlock = static_cast<size_t>(-1);
+	if (!DecodeBlock(p_Block, m_Cache)) return false;
+	m_CachedBlock = p_Block;
+	return true;
+}
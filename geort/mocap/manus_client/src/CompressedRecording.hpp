@@ -0,0 +1,261 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _COMPRESSED_RECORDING_HPP_
+#define _COMPRESSED_RECORDING_HPP_
+
+#include "SkeletonRecording.hpp"
+
+// size_t
+#include <cstddef>
+// uint32_t, uint64_t
+#include <cstdint>
+// std::FILE
+#include <cstdio>
+// std::string
+#include <string>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTRecording
+ *  @{
+ */
+
+/// @brief A compressed skeleton recording holds the same frames as a SkeletonRecording in a
+/// fraction of the space, for long term storage and for feeding replay and dataset export.
+///
+/// File layout, little endian:
+///   CompressedRecordingHeader (64 bytes)
+///   blocks, back to back, each one:
+///     CompressedRecordingBlock (64 bytes)
+///     storedBytes of payload, compressed with the block's codec into rawBytes of frame data.
+///   CompressedRecordingIndexEntry per block (40 bytes each)
+///   CompressedRecordingFooter (32 bytes), ends with COMPRESSED_RECORDING_FOOTER_MAGIC.
+///
+/// The index and footer are written by Close. With them a reader finds any frame number,
+/// host time or publishTime with a binary search over the index and decodes only the block that
+/// holds it, without touching the rest of the file. A file without a valid footer (version 1, or
+/// a writer that did not close) is still readable, the reader then walks the block headers.
+///
+/// Every block is self contained, so blocks can be decoded in any order and in parallel. Inside a
+/// block each frame is coded against the previous one:
+///   varint   frameIndex delta (the first frame against the block's firstFrameIndex)
+///   zvarint  hostTimeNs delta (the first frame against the block's firstHostTimeNs)
+///   varint   skeletonCount
+///   per skeleton, against the skeleton at the same position in the previous frame:
+///     byte     flags, CompressedRecordingFlag_*
+///     varint   id, nodesCount, nodesCount x node id       (unless SameLayout)
+///     zvarint  publishTime delta, as a raw 64 bit integer
+///     per node:
+///       3 x zvarint   position / positionQuantum, delta coded (against 0 unless SameLayout)
+///       zvarint << 2 | largest, 2 x zvarint   smallest-three quaternion, delta coded while the
+///                     largest component stays the same, the sign is chosen so it is positive
+///       3 x float     scale                             (unless UnitScale)
+/// varint is unsigned LEB128, zvarint is a zigzag coded signed LEB128.
+///
+/// Ids, timestamps and scales are lossless. Positions are rounded to positionQuantum meters and
+/// quaternion components to rotationBits, decoded quaternions may have the opposite sign.
+
+/// @brief Magic bytes at the start of a compressed skeleton recording.
+#define COMPRESSED_RECORDING_MAGIC "GEORTRCZ"
+/// @brief Bumped whenever the layout above changes.
+#define COMPRESSED_RECORDING_VERSION 2
+/// @brief "BLCK", at the start of every block.
+#define COMPRESSED_RECORDING_BLOCK_MAGIC 0x4B434C42u
+/// @brief Last bytes of a compressed recording that has a block index.
+#define COMPRESSED_RECORDING_FOOTER_MAGIC "GRZINDEX"
+
+typedef enum CompressedRecordingCodec
+{
+	CompressedRecordingCodec_None = 0,
+	CompressedRecordingCodec_Zstd = 1,
+} CompressedRecordingCodec;
+
+typedef enum CompressedRecordingFlag
+{
+	CompressedRecordingFlag_SameLayout = 1 << 0, // id, nodesCount and node ids equal the previous frame.
+	CompressedRecordingFlag_UnitScale = 1 << 1, // every node scale is exactly (1, 1, 1).
+} CompressedRecordingFlag;
+
+typedef struct CompressedRecordingHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t headerBytes;
+	float positionQuantum; // meters per position step.
+	uint32_t rotationBits; // bits per quaternion component, sign included.
+	uint32_t framesPerBlock;
+	uint32_t reserved0;
+	uint64_t steadyStartNs; // copied from the SkeletonRecordingHeader.
+	uint64_t systemStartNs;
+	uint8_t reserved[16];
+} CompressedRecordingHeader;
+
+typedef struct CompressedRecordingBlock
+{
+	uint32_t magic;
+	uint32_t codec; // CompressedRecordingCodec.
+	uint32_t storedBytes;
+	uint32_t rawBytes;
+	uint32_t frameCount;
+	uint32_t reserved;
+	uint64_t firstFrameIndex;
+	uint64_t firstHostTimeNs;
+	uint64_t lastHostTimeNs;
+	uint64_t firstPublishTime; // publishTime of the first skeleton of the first frame, 0 if it has none.
+	uint64_t lastPublishTime; // publishTime of the first skeleton of the last frame, 0 if it has none.
+} CompressedRecordingBlock;
+
+typedef struct CompressedRecordingIndexEntry
+{
+	uint64_t offset; // of the CompressedRecordingBlock from the start of the file.
+	uint64_t firstFrame; // number of frames in the blocks before this one.
+	uint64_t firstFrameIndex; // copied from the block, so seeking does not touch the block itself.
+	uint64_t firstHostTimeNs;
+	uint64_t firstPublishTime;
+} CompressedRecordingIndexEntry;
+
+typedef struct CompressedRecordingFooter
+{
+	uint64_t indexOffset; // of the first CompressedRecordingIndexEntry.
+	uint64_t blockCount;
+	uint64_t frameCount;
+	char magic[8];
+} CompressedRecordingFooter;
+
+/// @brief Whether this build can write and read zstd blocks.
+bool IsZstdAvailable();
+
+/// @brief What the codec remembers about the skeleton at one position of the previous frame.
+class RecordingSlotState
+{
+public:
+	bool valid = false;
+	uint32_t id = 0;
+	uint64_t publishTime = 0;
+	std::vector<uint32_t> nodeIds;
+	std::vector<int32_t> positions; // 3 per node, in position quanta.
+	std::vector<int32_t> rotations; // 4 per node, the largest component index then the other three.
+};
+
+/// @brief The frames of one decoded block. The skeletons of frame f are infos[skeletonBegin[f]]
+/// up to infos[skeletonBegin[f + 1]], the nodes of skeleton s start at nodes[nodeBegin[s]].
+class DecodedRecordingBlock
+{
+public:
+	std::vector<SkeletonRecordingFrame> frames;
+	std::vector<uint32_t> skeletonBegin;
+	std::vector<SkeletonInfo> infos;
+	std::vector<uint32_t> nodeBegin;
+	std::vector<SkeletonNode> nodes;
+	std::vector<uint8_t> raw; // decompressed payload, kept to reuse its memory.
+	std::vector<RecordingSlotState> slots;
+
+	/// @brief Point p_Skeletons at the skeletons of frame p_Frame of this block.
+	void GetSkeletons(const size_t p_Frame, std::vector<RecordedSkeleton>& p_Skeletons) const;
+};
+
+/// @brief Writes a compressed recording frame by frame.
+class CompressedRecordingWriter
+{
+public:
+	CompressedRecordingWriter();
+	~CompressedRecordingWriter();
+
+	/// @param p_Source the header of the raw recording the frames come from, for its clocks.
+	/// @param p_Codec falls back to CompressedRecordingCodec_None if zstd is not available.
+	bool Open(
+		const std::string& p_Path,
+		const SkeletonRecordingHeader& p_Source,
+		const CompressedRecordingCodec p_Codec,
+		const float p_PositionQuantum = 1e-5f,
+		const uint32_t p_RotationBits = 16,
+		const uint32_t p_FramesPerBlock = 256);
+
+	/// @brief Write the last block, the block index and the footer and close the file.
+	bool Close();
+
+	bool WriteFrame(const SkeletonRecordingFrame& p_Frame, const RecordedSkeleton* const p_Skeletons, const size_t p_SkeletonCount);
+
+	uint64_t GetBytesWritten() const { return m_BytesWritten; }
+
+protected:
+	bool FlushBlock();
+
+	std::FILE* m_File = nullptr;
+	CompressedRecordingHeader m_Header;
+	CompressedRecordingCodec m_Codec = CompressedRecordingCodec_None;
+	CompressedRecordingBlock m_Block;
+	std::vector<uint8_t> m_Raw;
+	std::vector<uint8_t> m_Stored;
+	std::vector<RecordingSlotState> m_Slots;
+	std::vector<CompressedRecordingIndexEntry> m_Index;
+	uint64_t m_FrameCount = 0;
+	uint64_t m_PreviousFrameIndex = 0;
+	uint64_t m_PreviousHostTime = 0;
+	uint64_t m_BytesWritten = 0;
+	bool m_Failed = false;
+};
+
+/// @brief Maps a compressed recording and decodes its blocks on demand.
+class CompressedRecordingReader
+{
+public:
+	CompressedRecordingReader();
+	~CompressedRecordingReader();
+
+	/// @brief Map p_Path and load its block index. Without a valid footer the block headers are
+	/// walked instead, a torn last block is then ignored with a warning.
+	bool Open(const std::string& p_Path);
+	void Close();
+
+	const CompressedRecordingHeader* GetHeader() const { return reinterpret_cast<const CompressedRecordingHeader*>(m_Data); }
+	size_t GetFrameCount() const { return m_BlockFirstFrame.empty() ? 0 : m_BlockFirstFrame.back(); }
+	size_t GetBlockCount() const { return m_Index.size(); }
+	size_t GetBlockFirstFrame(const size_t p_Block) const { return m_BlockFirstFrame[p_Block]; }
+	const CompressedRecordingIndexEntry& GetIndexEntry(const size_t p_Block) const { return m_Index[p_Block]; }
+	CompressedRecordingBlock GetBlock(const size_t p_Block) const;
+
+	/// @brief Whether Open found the block index, false if it had to walk the blocks.
+	bool HasIndex() const { return m_HasIndex; }
+
+	/// @brief The block that holds frame p_Frame.
+	size_t FindBlockOfFrame(const size_t p_Frame) const;
+
+	/// @brief Binary search for the first frame whose p_Key is at least p_Target, the frame count if
+	/// there is none. Searches the index first and decodes at most one block.
+	/// @return false if p_Key failed on a frame it had to look at or the block is corrupt.
+	bool FindFirstFrame(const RecordingFrameKey& p_Key, const int64_t p_Target, size_t& p_Frame);
+
+	/// @brief Decode block p_Block into p_Decoded. Does not touch the reader, so it is safe to call
+	/// from several threads with a DecodedRecordingBlock each.
+	bool DecodeBlock(const size_t p_Block, DecodedRecordingBlock& p_Decoded) const;
+
+	/// @brief Read frame p_Frame, decoding its block unless it is the one decoded last.
+	/// The nodes in p_Skeletons stay valid until the next call.
+	bool ReadFrame(const size_t p_Frame, SkeletonRecordingFrame& p_Header, std::vector<RecordedSkeleton>& p_Skeletons);
+
+protected:
+	/// @brief Load the block index from the footer, false if there is no valid one.
+	bool LoadIndex();
+	/// @brief Decode p_Block into m_Cache unless it is already there.
+	bool CacheBlock(const size_t p_Block);
+
+	const unsigned char* m_Data = nullptr;
+	size_t m_Size = 0;
+	std::vector<CompressedRecordingIndexEntry> m_Index;
+	std::vector<size_t> m_BlockFirstFrame; // one more entry than blocks, the last is the frame count.
+	bool m_HasIndex = false;
+
+	DecodedRecordingBlock m_Cache;
+	size_t m_CachedBlock = static_cast<size_t>(-1);
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,169 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _FRAME_HANDOFF_HPP_
+#define _FRAME_HANDOFF_HPP_
+
+// std::max
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+// size_t
+#include <cstddef>
+// uint64_t
+#include <cstdint>
+// std::deque
+#include <deque>
+#include <mutex>
+// std::string
+#include <string>
+
+// Set up a Doxygen group.
+/** @addtogroup SDKMinimalClient
+ *  @{
+ */
+
+/// @brief What a FrameHandoff does when its consumer falls behind.
+enum class FrameHandoffPolicy
+{
+	FrameHandoffPolicy_Latest, // keep only the newest frame, older ones are overwritten.
+	FrameHandoffPolicy_Fifo, // keep up to slots frames in order, the oldest is overwritten when full.
+	FrameHandoffPolicy_Block, // keep up to slots frames in order, the producer waits when full.
+};
+
+/// @brief "latest", "fifo" or "block". false, leaving p_Policy unchanged, for anything else.
+inline bool ParseFrameHandoffPolicy(const std::string& p_Text, FrameHandoffPolicy& p_Policy)
+{
+	if (p_Text == "latest") p_Policy = FrameHandoffPolicy::FrameHandoffPolicy_Latest;
+	else if (p_Text == "fifo") p_Policy = FrameHandoffPolicy::FrameHandoffPolicy_Fifo;
+	else if (p_Text == "block") p_Policy = FrameHandoffPolicy::FrameHandoffPolicy_Block;
+	else return false;
+	return true;
+}
+
+inline const char* GetFrameHandoffPolicyName(const FrameHandoffPolicy p_Policy)
+{
+	switch (p_Policy)
+	{
+	case FrameHandoffPolicy::FrameHandoffPolicy_Fifo: return "fifo";
+	case FrameHandoffPolicy::FrameHandoffPolicy_Block: return "block";
+	default: return "latest";
+	}
+}
+
+/// @brief A snapshot of what went through a FrameHandoff.
+class FrameHandoffCounters
+{
+public:
+	FrameHandoffPolicy policy = FrameHandoffPolicy::FrameHandoffPolicy_Latest;
+	size_t slots = 1;
+	uint64_t produced = 0; // frames pushed by the SDK callback.
+	uint64_t consumed = 0; // frames popped by the loop.
+	uint64_t overwritten = 0; // frames dropped before the loop got to them, including at Close.
+	uint64_t republished = 0; // loop iterations that published the previous frame again.
+	uint64_t queued = 0; // frames waiting right now.
+	uint64_t skipped = 0; // frames dropped after the loop took them, e.g. by a busy skeleton worker. Set by the loop.
+	double producerWaitMs = 0.0; // time the producer spent blocked, block policy only.
+};
+
+/// @brief Hands frames from an SDK callback to the publish loop with an explicit policy for when
+/// the two run at different rates, and counts what happened to every frame.
+///
+/// The frames are heap allocated by the producer, Push takes ownership, Pop gives it to the consumer
+/// and frames that are overwritten are deleted here.
+template <class Frame>
+class FrameHandoff
+{
+public:
+	~FrameHandoff()
+	{
+		for (Frame* t_Frame : m_Frames) delete t_Frame;
+	}
+
+	/// @brief Set the policy, before the producer starts. p_Slots is ignored by the latest policy.
+	void Configure(const FrameHandoffPolicy p_Policy, const size_t p_Slots)
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+		m_Counters.policy = p_Policy;
+		m_Counters.slots = p_Policy == FrameHandoffPolicy::FrameHandoffPolicy_Latest ? 1 : (std::max)(p_Slots, static_cast<size_t>(1));
+	}
+
+	/// @brief Take over p_Frame. With the block policy this waits for a free slot, unless the handoff is closed.
+	void Push(Frame* const p_Frame)
+	{
+		std::unique_lock<std::mutex> t_Lock(m_Mutex);
+		m_Counters.produced++;
+		if (m_Counters.policy == FrameHandoffPolicy::FrameHandoffPolicy_Block && !m_Closed && m_Frames.size() >= m_Counters.slots)
+		{
+			const std::chrono::steady_clock::time_point t_Start = std::chrono::steady_clock::now();
+			m_SlotFreed.wait(t_Lock, [this]() { return m_Closed || m_Frames.size() < m_Counters.slots; });
+			m_Counters.producerWaitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_Start).count();
+		}
+		if (m_Closed)
+		{
+			delete p_Frame;
+			m_Counters.overwritten++;
+			return;
+		}
+		while (m_Frames.size() >= m_Counters.slots)
+		{
+			delete m_Frames.front();
+			m_Frames.pop_front();
+			m_Counters.overwritten++;
+		}
+		m_Frames.push_back(p_Frame);
+	}
+
+	/// @return the oldest frame, which the caller now owns, or nullptr if there is none.
+	Frame* Pop()
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+		if (m_Frames.empty()) return nullptr;
+		Frame* const t_Frame = m_Frames.front();
+		m_Frames.pop_front();
+		m_Counters.consumed++;
+		m_SlotFreed.notify_one();
+		return t_Frame;
+	}
+
+	/// @brief Count a loop iteration that had no new frame and published the previous one again.
+	void CountRepublished()
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+		m_Counters.republished++;
+	}
+
+	/// @brief Stop accepting frames and release a blocked producer, the queued frames are dropped.
+	void Close()
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+		m_Closed = true;
+		m_Counters.overwritten += m_Frames.size();
+		for (Frame* t_Frame : m_Frames) delete t_Frame;
+		m_Frames.clear();
+		m_SlotFreed.notify_all();
+	}
+
+	FrameHandoffCounters GetCounters() const
+	{
+		std::lock_guard<std::mutex> t_Lock(m_Mutex);
+		FrameHandoffCounters t_Counters = m_Counters;
+		t_Counters.queued = m_Frames.size();
+		return t_Counters;
+	}
+
+protected:
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_SlotFreed;
+	std::deque<Frame*> m_Frames;
+	FrameHandoffCounters m_Counters;
+	bool m_Closed = false;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
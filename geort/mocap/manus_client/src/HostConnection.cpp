@@ -0,0 +1,136 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "HostConnection.hpp"
+
+// std::min
+#include <algorithm>
+#include <chrono>
+// std::strncmp, std::memcpy
+#include <cstring>
+// std::filesystem::create_directories
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+// std::unique_ptr
+#include <memory>
+
+static double GetMillisecondsSince(const std::chrono::steady_clock::time_point p_Start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - p_Start).count();
+}
+
+/// @brief Copy p_Text into a fixed size field of ManusHost, cut off if it does not fit.
+template <size_t Size>
+static void CopyHostField(char (&p_Target)[Size], const std::string& p_Text)
+{
+	const size_t t_Length = (std::min)(p_Text.size(), Size - 1);
+	std::memcpy(p_Target, p_Text.data(), t_Length);
+	p_Target[t_Length] = '\0';
+}
+
+const char* GetHostConnectStepName(const HostConnectStep p_Step)
+{
+	switch (p_Step)
+	{
+	case HostConnectStep::HostConnectStep_LastHost: return "last host";
+	case HostConnectStep::HostConnectStep_Loopback: return "loopback discovery";
+	case HostConnectStep::HostConnectStep_Network: return "network discovery";
+	default: return "none";
+	}
+}
+
+void HostConnector::Configure(const std::string& p_CachePath, const uint32_t p_NetworkWaitSeconds)
+{
+	m_CachePath = p_CachePath;
+	m_NetworkWaitSeconds = (std::max)(p_NetworkWaitSeconds, 1u);
+	m_HasLastHost = LoadLastHost();
+	if (m_HasLastHost)
+	{
+		std::cout << "Will try the last Manus Core host " << m_LastHost.hostName << " (" << m_LastHost.ipAddress << ") first.\n";
+	}
+}
+
+bool HostConnector::Connect()
+{
+	m_LastStep = HostConnectStep::HostConnectStep_None;
+	if (m_HasLastHost && ConnectToHost(m_LastHost, HostConnectStep::HostConnectStep_LastHost)) return true;
+	if (ConnectToFirstFound(true, 1)) return true;
+	return ConnectToFirstFound(false, m_NetworkWaitSeconds);
+}
+
+bool HostConnector::ConnectToHost(const ManusHost& p_Host, const HostConnectStep p_Step)
+{
+	const std::chrono::steady_clock::time_point t_Start = std::chrono::steady_clock::now();
+	const SDKReturnCode t_Result = CoreSdk_ConnectToHost(p_Host);
+	m_ConnectMs += GetMillisecondsSince(t_Start);
+	if (t_Result != SDKReturnCode::SDKReturnCode_Success) return false;
+
+	m_LastStep = p_Step;
+	const bool t_Changed = !m_HasLastHost || std::strncmp(m_LastHost.hostName, p_Host.hostName, sizeof(m_LastHost.hostName)) != 0
+		|| std::strncmp(m_LastHost.ipAddress, p_Host.ipAddress, sizeof(m_LastHost.ipAddress)) != 0;
+	m_LastHost = p_Host;
+	m_HasLastHost = true;
+	if (t_Changed) SaveLastHost();
+	return true;
+}
+
+bool HostConnector::ConnectToFirstFound(const bool p_LoopbackOnly, const uint32_t p_WaitSeconds)
+{
+	const std::chrono::steady_clock::time_point t_Start = std::chrono::steady_clock::now();
+	if (CoreSdk_LookForHosts(p_WaitSeconds, p_LoopbackOnly) != SDKReturnCode::SDKReturnCode_Success)
+	{
+		m_DiscoveryMs += GetMillisecondsSince(t_Start);
+		return false;
+	}
+
+	uint32_t t_NumberOfHostsFound = 0;
+	if (CoreSdk_GetNumberOfAvailableHostsFound(&t_NumberOfHostsFound) != SDKReturnCode::SDKReturnCode_Success || t_NumberOfHostsFound == 0)
+	{
+		m_DiscoveryMs += GetMillisecondsSince(t_Start);
+		return false;
+	}
+
+	std::unique_ptr<ManusHost[]> t_AvailableHosts(new ManusHost[t_NumberOfHostsFound]);
+	const SDKReturnCode t_HostsResult = CoreSdk_GetAvailableHostsFound(t_AvailableHosts.get(), t_NumberOfHostsFound);
+	m_DiscoveryMs += GetMillisecondsSince(t_Start);
+	if (t_HostsResult != SDKReturnCode::SDKReturnCode_Success)
+	{
+		return false;
+	}
+	return ConnectToHost(t_AvailableHosts[0], p_LoopbackOnly ? HostConnectStep::HostConnectStep_Loopback : HostConnectStep::HostConnectStep_Network);
+}
+
+bool HostConnector::LoadLastHost()
+{
+	if (m_CachePath.empty()) return false;
+	std::ifstream t_File(m_CachePath);
+	std::string t_HostName;
+	std::string t_IpAddress;
+	if (!std::getline(t_File, t_HostName) || !std::getline(t_File, t_IpAddress)) return false;
+	if (t_HostName.empty() && t_IpAddress.empty()) return false;
+
+	m_LastHost = ManusHost{};
+	CopyHostField(m_LastHost.hostName, t_HostName);
+	CopyHostField(m_LastHost.ipAddress, t_IpAddress);
+	return true;
+}
+
+void HostConnector::SaveLastHost() const
+{
+	if (m_CachePath.empty()) return;
+	std::error_code t_Error;
+	const std::filesystem::path t_Folder = std::filesystem::path(m_CachePath).parent_path();
+	if (!t_Folder.empty()) std::filesystem::create_directories(t_Folder, t_Error);
+
+	// a host name and an address cannot contain a line break, one per line is enough.
+	std::ofstream t_File(m_CachePath, std::ofstream::trunc);
+	t_File << m_LastHost.hostName << "\n" << m_LastHost.ipAddress << "\n";
+	if (!t_File)
+	{
+		std::cerr << "Could not save the Manus Core host to " << m_CachePath << ", the next start will look for it again." << std::endl;
+	}
+}
@@ -0,0 +1,76 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _HOST_CONNECTION_HPP_
+#define _HOST_CONNECTION_HPP_
+
+#include "ManusSDK.h"
+
+// uint32_t
+#include <cstdint>
+// std::string
+#include <string>
+
+// Set up a Doxygen group.
+/** @addtogroup SDKMinimalClient
+ *  @{
+ */
+
+/// @brief How HostConnector::Connect found Core.
+enum class HostConnectStep
+{
+	HostConnectStep_None, // not connected.
+	HostConnectStep_LastHost, // the host of the last good connection, without discovery.
+	HostConnectStep_Loopback, // discovery on this machine only.
+	HostConnectStep_Network, // discovery on the whole network.
+};
+
+const char* GetHostConnectStepName(const HostConnectStep p_Step);
+
+/// @brief Connects to Manus Core, trying the cheap ways first.
+///
+/// Discovery blocks for its whole wait time (at least a second) even when Core answers at once,
+/// so every attempt first connects straight to the host of the last good connection, which is
+/// kept in a small text file so it survives restarts. Only if that fails it looks for Core on
+/// this machine, and only if there is none there on the network.
+///
+/// Not thread safe, use it from the thread that drives the SDK.
+class HostConnector
+{
+public:
+	/// @param p_CachePath file the last good host is kept in, empty to keep it in memory only.
+	/// @param p_NetworkWaitSeconds how long network discovery waits for hosts to reply.
+	void Configure(const std::string& p_CachePath, const uint32_t p_NetworkWaitSeconds);
+
+	/// @brief One connection attempt, see the class description. Remembers the host on success.
+	bool Connect();
+
+	HostConnectStep GetLastStep() const { return m_LastStep; }
+	bool HasLastHost() const { return m_HasLastHost; }
+	const ManusHost& GetLastHost() const { return m_LastHost; }
+	/// @brief Time spent in discovery and in connecting, over all attempts so far.
+	double GetDiscoveryMs() const { return m_DiscoveryMs; }
+	double GetConnectMs() const { return m_ConnectMs; }
+
+protected:
+	bool ConnectToHost(const ManusHost& p_Host, const HostConnectStep p_Step);
+	bool ConnectToFirstFound(const bool p_LoopbackOnly, const uint32_t p_WaitSeconds);
+	bool LoadLastHost();
+	void SaveLastHost() const;
+
+	std::string m_CachePath;
+	uint32_t m_NetworkWaitSeconds = 1;
+	ManusHost m_LastHost = {};
+	bool m_HasLastHost = false;
+	HostConnectStep m_LastStep = HostConnectStep::HostConnectStep_None;
+	double m_DiscoveryMs = 0.0;
+	double m_ConnectMs = 0.0;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
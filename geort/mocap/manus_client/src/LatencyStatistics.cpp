@@ -0,0 +1,50 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "LatencyStatistics.hpp"
+
+// std::max, std::min
+#include <algorithm>
+
+/// @brief Width of a bucket in milliseconds.
+static const double s_BucketMs = 0.1;
+
+LatencyStatistics::LatencyStatistics(const double p_RangeMs)
+	: m_Buckets(static_cast<size_t>((std::max)(p_RangeMs, s_BucketMs) / s_BucketMs) + 1, 0)
+{
+}
+
+void LatencyStatistics::Add(const double p_Milliseconds)
+{
+	const double t_Milliseconds = (std::max)(p_Milliseconds, 0.0);
+	const size_t t_Bucket = (std::min)(static_cast<size_t>(t_Milliseconds / s_BucketMs), m_Buckets.size() - 1);
+	m_Buckets[t_Bucket]++;
+	m_Count++;
+	m_Sum += t_Milliseconds;
+	m_Max = (std::max)(m_Max, t_Milliseconds);
+}
+
+void LatencyStatistics::Add(const LatencyStatistics& p_Other)
+{
+	const size_t t_Count = (std::min)(m_Buckets.size(), p_Other.m_Buckets.size());
+	for (size_t i = 0; i < t_Count; i++) m_Buckets[i] += p_Other.m_Buckets[i];
+	m_Count += p_Other.m_Count;
+	m_Sum += p_Other.m_Sum;
+	m_Max = (std::max)(m_Max, p_Other.m_Max);
+}
+
+double LatencyStatistics::GetPercentile(const double p_Fraction) const
+{
+	if (m_Count == 0) return 0.0;
+	const uint64_t t_Rank = static_cast<uint64_t>(p_Fraction * (m_Count - 1));
+	uint64_t t_Seen = 0;
+	for (size_t i = 0; i < m_Buckets.size(); i++)
+	{
+		t_Seen += m_Buckets[i];
+		if (t_Seen > t_Rank) return (std::min)((i + 1) * s_BucketMs, m_Max);
+	}
+	return m_Max;
+}
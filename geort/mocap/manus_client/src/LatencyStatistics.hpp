@@ -0,0 +1,50 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _LATENCY_STATISTICS_HPP_
+#define _LATENCY_STATISTICS_HPP_
+
+// size_t
+#include <cstddef>
+// uint64_t
+#include <cstdint>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTools
+ *  @{
+ */
+
+/// @brief Latencies in milliseconds in a fixed histogram of 0.1 ms buckets up to p_RangeMs, so
+/// adding one never allocates and percentiles are exact to the bucket width. Anything above the
+/// range lands in the last bucket and only shows in the maximum.
+class LatencyStatistics
+{
+public:
+	explicit LatencyStatistics(const double p_RangeMs = 200.0);
+
+	void Add(const double p_Milliseconds);
+	/// @brief Merge the samples of p_Other, which must have the same range.
+	void Add(const LatencyStatistics& p_Other);
+
+	uint64_t GetCount() const { return m_Count; }
+	double GetMean() const { return m_Count == 0 ? 0.0 : m_Sum / m_Count; }
+	double GetMax() const { return m_Max; }
+	/// @brief The upper edge of the bucket holding the p_Fraction quantile, e.g. 0.99.
+	double GetPercentile(const double p_Fraction) const;
+
+protected:
+	std::vector<uint64_t> m_Buckets;
+	uint64_t m_Count = 0;
+	double m_Sum = 0.0;
+	double m_Max = 0.0;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
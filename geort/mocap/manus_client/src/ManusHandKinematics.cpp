@@ -0,0 +1,171 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ManusHandKinematics.hpp"
+
+// std::isfinite, std::sqrt
+#include <cmath>
+
+/// @brief The manually measured human finger link vectors of manus_mocap_core.py, in meters.
+static const double s_LinkVectors[MANUS_HAND_KEYPOINTS][3] = {
+	{ 0.0, 0.0, 0.0 },
+	{ 0.0250, 0.0000, 0.0050 },
+	{ 0.0000, 0.0000, 0.0390 },
+	{ 0.0000, 0.0000, 0.0330 },
+	{ 0.0000, 0.0000, 0.0210 },
+	{ 0.0170, 0.0000, 0.0870 },
+	{ 0.0000, 0.0000, 0.0260 },
+	{ 0.0000, 0.0000, 0.0220 },
+	{ 0.0000, 0.0000, 0.0200 },
+	{ 0.0000, 0.0000, 0.0920 },
+	{ 0.0000, 0.0000, 0.0260 },
+	{ 0.0000, 0.0000, 0.0260 },
+	{ 0.0000, 0.0000, 0.0220 },
+	{ -0.0170, 0.0000, 0.0840 },
+	{ 0.0000, 0.0000, 0.0210 },
+	{ 0.0000, 0.0000, 0.0210 },
+	{ 0.0000, 0.0000, 0.0200 },
+	{ -0.0340, 0.0000, 0.0720 },
+	{ 0.0000, 0.0000, 0.0210 },
+	{ 0.0000, 0.0000, 0.0210 },
+	{ 0.0000, 0.0000, 0.0200 },
+};
+
+/// @brief The finger chains after the wrist, thumb to pinky.
+static const uint32_t s_Chains[5][4] = {
+	{ 1, 2, 3, 4 },
+	{ 5, 6, 7, 8 },
+	{ 9, 10, 11, 12 },
+	{ 13, 14, 15, 16 },
+	{ 17, 18, 19, 20 },
+};
+
+/// @brief Row major rotation matrix of p_Rotation after normalizing it.
+static bool RotationMatrix(const ManusQuaternion& p_Rotation, double p_Matrix[3][3])
+{
+	double t_W = p_Rotation.w;
+	double t_X = p_Rotation.x;
+	double t_Y = p_Rotation.y;
+	double t_Z = p_Rotation.z;
+	const double t_Norm = std::sqrt(t_W * t_W + t_X * t_X + t_Y * t_Y + t_Z * t_Z);
+	if (!std::isfinite(t_Norm) || t_Norm < 1e-12) return false;
+	t_W /= t_Norm;
+	t_X /= t_Norm;
+	t_Y /= t_Norm;
+	t_Z /= t_Norm;
+
+	p_Matrix[0][0] = 1.0 - 2.0 * (t_Y * t_Y + t_Z * t_Z);
+	p_Matrix[0][1] = 2.0 * (t_X * t_Y - t_Z * t_W);
+	p_Matrix[0][2] = 2.0 * (t_X * t_Z + t_Y * t_W);
+	p_Matrix[1][0] = 2.0 * (t_X * t_Y + t_Z * t_W);
+	p_Matrix[1][1] = 1.0 - 2.0 * (t_X * t_X + t_Z * t_Z);
+	p_Matrix[1][2] = 2.0 * (t_Y * t_Z - t_X * t_W);
+	p_Matrix[2][0] = 2.0 * (t_X * t_Z - t_Y * t_W);
+	p_Matrix[2][1] = 2.0 * (t_Y * t_Z + t_X * t_W);
+	p_Matrix[2][2] = 1.0 - 2.0 * (t_X * t_X + t_Y * t_Y);
+	return true;
+}
+
+bool SolveManusKeypoints(const SkeletonNode* const p_Nodes, const uint32_t p_NodeCount, double p_Keypoints[MANUS_HAND_KEYPOINTS][3])
+{
+	if (p_NodeCount < MANUS_HAND_KEYPOINTS) return false;
+
+	double t_Rotations[MANUS_HAND_KEYPOINTS][3][3];
+	for (uint32_t i = 0; i < MANUS_HAND_KEYPOINTS; i++)
+	{
+		if (!RotationMatrix(p_Nodes[i].transform.rotation, t_Rotations[i])) return false;
+	}
+
+	// the wrist link vector is zero, so the wrist stays at the origin with its own rotation.
+	p_Keypoints[0][0] = 0.0;
+	p_Keypoints[0][1] = 0.0;
+	p_Keypoints[0][2] = 0.0;
+	for (const uint32_t* const t_Chain : s_Chains)
+	{
+		double t_Rotation[3][3];
+		for (int r = 0; r < 3; r++)
+		{
+			for (int c = 0; c < 3; c++) t_Rotation[r][c] = t_Rotations[0][r][c];
+		}
+		double t_Position[3] = { 0.0, 0.0, 0.0 };
+
+		for (int j = 0; j < 4; j++)
+		{
+			const uint32_t t_Node = t_Chain[j];
+			const double* const t_Link = s_LinkVectors[t_Node];
+			for (int r = 0; r < 3; r++)
+			{
+				t_Position[r] += t_Rotation[r][0] * t_Link[0] + t_Rotation[r][1] * t_Link[1] + t_Rotation[r][2] * t_Link[2];
+			}
+
+			double t_Next[3][3];
+			for (int r = 0; r < 3; r++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					t_Next[r][c] = t_Rotation[r][0] * t_Rotations[t_Node][0][c] + t_Rotation[r][1] * t_Rotations[t_Node][1][c] + t_Rotation[r][2] * t_Rotations[t_Node][2][c];
+				}
+			}
+			for (int r = 0; r < 3; r++)
+			{
+				for (int c = 0; c < 3; c++) t_Rotation[r][c] = t_Next[r][c];
+			}
+
+			p_Keypoints[t_Node][0] = t_Position[0];
+			p_Keypoints[t_Node][1] = t_Position[1];
+			p_Keypoints[t_Node][2] = t_Position[2];
+		}
+	}
+	return true;
+}
+
+/// @brief Normalize p_Vector in place, false if it is too short to have a direction.
+static bool Normalize(double p_Vector[3])
+{
+	const double t_Norm = std::sqrt(p_Vector[0] * p_Vector[0] + p_Vector[1] * p_Vector[1] + p_Vector[2] * p_Vector[2]);
+	if (!std::isfinite(t_Norm) || t_Norm < 1e-9) return false;
+	p_Vector[0] /= t_Norm;
+	p_Vector[1] /= t_Norm;
+	p_Vector[2] /= t_Norm;
+	return true;
+}
+
+static void Cross(const double p_A[3], const double p_B[3], double p_Result[3])
+{
+	p_Result[0] = p_A[1] * p_B[2] - p_A[2] * p_B[1];
+	p_Result[1] = p_A[2] * p_B[0] - p_A[0] * p_B[2];
+	p_Result[2] = p_A[0] * p_B[1] - p_A[1] * p_B[0];
+}
+
+bool HandToCanonical(double p_Keypoints[MANUS_HAND_KEYPOINTS][3])
+{
+	double t_Z[3];
+	double t_YAux[3];
+	for (int a = 0; a < 3; a++)
+	{
+		t_Z[a] = p_Keypoints[9][a] - p_Keypoints[0][a];
+		t_YAux[a] = p_Keypoints[5][a] - p_Keypoints[13][a];
+	}
+	if (!Normalize(t_Z) || !Normalize(t_YAux)) return false;
+
+	double t_X[3];
+	Cross(t_YAux, t_Z, t_X);
+	if (!Normalize(t_X)) return false;
+	double t_Y[3];
+	Cross(t_Z, t_X, t_Y);
+	if (!Normalize(t_Y)) return false;
+
+	// the frame is orthonormal, so its inverse is the transpose around the wrist.
+	const double t_Origin[3] = { p_Keypoints[0][0], p_Keypoints[0][1], p_Keypoints[0][2] };
+	for (uint32_t i = 0; i < MANUS_HAND_KEYPOINTS; i++)
+	{
+		const double t_Point[3] = { p_Keypoints[i][0] - t_Origin[0], p_Keypoints[i][1] - t_Origin[1], p_Keypoints[i][2] - t_Origin[2] };
+		p_Keypoints[i][0] = t_X[0] * t_Point[0] + t_X[1] * t_Point[1] + t_X[2] * t_Point[2];
+		p_Keypoints[i][1] = t_Y[0] * t_Point[0] + t_Y[1] * t_Point[1] + t_Y[2] * t_Point[2];
+		p_Keypoints[i][2] = t_Z[0] * t_Point[0] + t_Z[1] * t_Point[1] + t_Z[2] * t_Point[2];
+	}
+	return true;
+}
@@ -0,0 +1,38 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _MANUS_HAND_KINEMATICS_HPP_
+#define _MANUS_HAND_KINEMATICS_HPP_
+
+#include "ManusSDKTypes.h"
+
+// uint32_t
+#include <cstdint>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTools
+ *  @{
+ */
+
+/// @brief Number of keypoints of a Manus hand, the layout GeoRT trains on (wrist, then four joints per finger).
+#define MANUS_HAND_KEYPOINTS 21
+
+/// @brief The C++ version of ManusForwardKinematicsSolver.solve_keypoints in manus_mocap_core.py.
+/// Every finger chain starts at the wrist, each node turns by its recorded rotation and moves by
+/// the measured link vector of that node, the keypoint is the position after the node.
+/// Rotations are normalized like scipy does. Works in double precision like numpy.
+/// @return false if there are fewer than MANUS_HAND_KEYPOINTS nodes or a rotation is not usable (zero or not finite).
+bool SolveManusKeypoints(const SkeletonNode* const p_Nodes, const uint32_t p_NodeCount, double p_Keypoints[MANUS_HAND_KEYPOINTS][3]);
+
+/// @brief The C++ version of hand_to_canonical in manus_mocap_core.py: move the keypoints into
+/// the wrist frame, z towards the middle finger base and y from the ring towards the index finger base.
+/// @return false if that frame is degenerate, the keypoints are left untouched then.
+bool HandToCanonical(double p_Keypoints[MANUS_HAND_KEYPOINTS][3]);
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,42 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "ManusTimestamp.hpp"
+#include "ManusSDK.h"
+
+/// @brief Days between 1970-01-01 and the given civil date (proleptic Gregorian calendar).
+static int64_t DaysFromCivil(int64_t p_Year, const int64_t p_Month, const int64_t p_Day)
+{
+	p_Year -= p_Month <= 2 ? 1 : 0;
+	const int64_t t_Era = (p_Year >= 0 ? p_Year : p_Year - 399) / 400;
+	const int64_t t_YearOfEra = p_Year - t_Era * 400;
+	const int64_t t_DayOfYear = (153 * (p_Month + (p_Month > 2 ? -3 : 9)) + 2) / 5 + p_Day - 1;
+	const int64_t t_DayOfEra = t_YearOfEra * 365 + t_YearOfEra / 4 - t_YearOfEra / 100 + t_DayOfYear;
+	return t_Era * 146097 + t_DayOfEra - 719468;
+}
+
+bool ManusTimestampInfoToUnixMilliseconds(const ManusTimestampInfo& p_Info, int64_t& p_Milliseconds)
+{
+	if (p_Info.timecode || p_Info.month < 1 || p_Info.month > 12 || p_Info.day < 1 || p_Info.day > 31)
+	{
+		return false;
+	}
+
+	const int64_t t_Days = DaysFromCivil(p_Info.year, p_Info.month, p_Info.day);
+	const int64_t t_Seconds = ((t_Days * 24 + p_Info.hour) * 60 + p_Info.minute) * 60 + p_Info.second;
+	p_Milliseconds = t_Seconds * 1000 + p_Info.fraction;
+	return true;
+}
+
+bool ManusTimestampToUnixMilliseconds(const ManusTimestamp p_Timestamp, int64_t& p_Milliseconds)
+{
+	ManusTimestampInfo t_Info;
+	if (CoreSdk_GetTimestampInfo(p_Timestamp, &t_Info) != SDKReturnCode::SDKReturnCode_Success)
+	{
+		return false;
+	}
+	return ManusTimestampInfoToUnixMilliseconds(t_Info, p_Milliseconds);
+}
@@ -0,0 +1,32 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _MANUS_TIMESTAMP_HPP_
+#define _MANUS_TIMESTAMP_HPP_
+
+#include "ManusSDKTypes.h"
+
+// int64_t
+#include <cstdint>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTRecording
+ *  @{
+ */
+
+/// @brief Turn a decoded Manus timestamp into milliseconds since the unix epoch (UTC).
+/// Timecode timestamps count frames instead of milliseconds and carry no date, they are rejected.
+bool ManusTimestampInfoToUnixMilliseconds(const ManusTimestampInfo& p_Info, int64_t& p_Milliseconds);
+
+/// @brief Decode a compressed ManusTimestamp (e.g. SkeletonInfo::publishTime) through the SDK
+/// and turn it into milliseconds since the unix epoch.
+/// @return false if the SDK could not decode it or it is a timecode timestamp.
+bool ManusTimestampToUnixMilliseconds(const ManusTimestamp p_Timestamp, int64_t& p_Milliseconds);
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
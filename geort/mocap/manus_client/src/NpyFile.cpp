@@ -0,0 +1,156 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "NpyFile.hpp"
+
+// uint32_t
+#include <cstdint>
+// std::memcmp
+#include <cstring>
+// std::ifstream
+#include <fstream>
+#include <iostream>
+
+/// @brief The magic string at the start of every .npy file.
+static const char s_NpyMagic[6] = { '\x93', 'N', 'U', 'M', 'P', 'Y' };
+
+/// @brief Return the value text following p_Key in a .npy header dict, e.g. "'<f4'" for 'descr'.
+static std::string FindNpyHeaderValue(const std::string& p_Header, const std::string& p_Key)
+{
+	const size_t t_KeyPos = p_Header.find("'" + p_Key + "'");
+	if (t_KeyPos == std::string::npos) return std::string();
+
+	size_t t_Begin = p_Header.find(':', t_KeyPos);
+	if (t_Begin == std::string::npos) return std::string();
+	t_Begin++;
+	while (t_Begin < p_Header.size() && p_Header[t_Begin] == ' ') t_Begin++;
+
+	// tuples contain commas, so match the closing parenthesis for those.
+	const size_t t_End = (t_Begin < p_Header.size() && p_Header[t_Begin] == '(')
+		? p_Header.find(')', t_Begin) + 1
+		: p_Header.find_first_of(",}", t_Begin);
+	if (t_End == std::string::npos || t_End <= t_Begin) return std::string();
+
+	return p_Header.substr(t_Begin, t_End - t_Begin);
+}
+
+bool LoadNpyAsFloat32(const std::string& p_Path, NpyArray& p_Array)
+{
+	std::ifstream t_File(p_Path, std::ifstream::binary);
+	if (!t_File)
+	{
+		std::cerr << "Could not open " << p_Path << "." << std::endl;
+		return false;
+	}
+
+	char t_Preamble[8];
+	if (!t_File.read(t_Preamble, sizeof(t_Preamble)) || std::memcmp(t_Preamble, s_NpyMagic, sizeof(s_NpyMagic)) != 0)
+	{
+		std::cerr << p_Path << " is not a .npy file." << std::endl;
+		return false;
+	}
+
+	// version 1.x uses a 2 byte header length, 2.x and 3.x use 4 bytes.
+	const unsigned char t_MajorVersion = static_cast<unsigned char>(t_Preamble[6]);
+	uint32_t t_HeaderLength = 0;
+	unsigned char t_LengthBytes[4] = { 0, 0, 0, 0 };
+	const std::streamsize t_LengthSize = (t_MajorVersion == 1) ? 2 : 4;
+	if (!t_File.read(reinterpret_cast<char*>(t_LengthBytes), t_LengthSize))
+	{
+		std::cerr << p_Path << " has a truncated header." << std::endl;
+		return false;
+	}
+	for (int i = static_cast<int>(t_LengthSize) - 1; i >= 0; i--)
+	{
+		t_HeaderLength = (t_HeaderLength << 8) | t_LengthBytes[i];
+	}
+
+	std::string t_Header(t_HeaderLength, '\0');
+	if (!t_File.read(&t_Header[0], t_HeaderLength))
+	{
+		std::cerr << p_Path << " has a truncated header." << std::endl;
+		return false;
+	}
+
+	const std::string t_Descr = FindNpyHeaderValue(t_Header, "descr");
+	const bool t_IsFloat32 = (t_Descr == "'<f4'");
+	const bool t_IsFloat64 = (t_Descr == "'<f8'");
+	if (!t_IsFloat32 && !t_IsFloat64)
+	{
+		std::cerr << p_Path << " has dtype " << t_Descr << ", only little endian float32 and float64 are supported." << std::endl;
+		return false;
+	}
+	if (FindNpyHeaderValue(t_Header, "fortran_order") != "False")
+	{
+		std::cerr << p_Path << " is Fortran ordered, save it with np.ascontiguousarray first." << std::endl;
+		return false;
+	}
+
+	// shape looks like "(5, 100000, 3)" or "(7,)".
+	const std::string t_ShapeText = FindNpyHeaderValue(t_Header, "shape");
+	p_Array.shape.clear();
+	size_t t_NumElements = 1;
+	for (size_t i = 0; i < t_ShapeText.size(); i++)
+	{
+		if (t_ShapeText[i] < '0' || t_ShapeText[i] > '9') continue;
+		size_t t_Dim = 0;
+		while (i < t_ShapeText.size() && t_ShapeText[i] >= '0' && t_ShapeText[i] <= '9')
+		{
+			t_Dim = t_Dim * 10 + static_cast<size_t>(t_ShapeText[i] - '0');
+			i++;
+		}
+		p_Array.shape.push_back(t_Dim);
+		t_NumElements *= t_Dim;
+	}
+
+	p_Array.data.resize(t_NumElements);
+	if (t_IsFloat32)
+	{
+		t_File.read(reinterpret_cast<char*>(p_Array.data.data()), static_cast<std::streamsize>(t_NumElements * sizeof(float)));
+	}
+	else
+	{
+		std::vector<double> t_Doubles(t_NumElements);
+		t_File.read(reinterpret_cast<char*>(t_Doubles.data()), static_cast<std::streamsize>(t_NumElements * sizeof(double)));
+		for (size_t i = 0; i < t_NumElements; i++)
+		{
+			p_Array.data[i] = static_cast<float>(t_Doubles[i]);
+		}
+	}
+	if (!t_File)
+	{
+		std::cerr << p_Path << " is shorter than its shape says." << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+std::string MakeNpyFloat32Header(const std::vector<size_t>& p_Shape)
+{
+	std::string t_Dict = "{'descr': '<f4', 'fortran_order': False, 'shape': (";
+	for (size_t i = 0; i < p_Shape.size(); i++)
+	{
+		t_Dict += std::to_string(p_Shape[i]);
+		if (p_Shape.size() == 1 || i + 1 < p_Shape.size()) t_Dict += ",";
+		if (i + 1 < p_Shape.size()) t_Dict += " ";
+	}
+	t_Dict += "), }";
+
+	// magic (6) + version (2) + length (2) + dict + padding + newline must be a multiple of 64.
+	const size_t t_Unpadded = 10 + t_Dict.size() + 1;
+	const size_t t_Padding = (64 - (t_Unpadded % 64)) % 64;
+	t_Dict.append(t_Padding, ' ');
+	t_Dict += '\n';
+
+	std::string t_Header(s_NpyMagic, sizeof(s_NpyMagic));
+	t_Header += '\x01';
+	t_Header += '\x00';
+	t_Header += static_cast<char>(t_Dict.size() & 0xff);
+	t_Header += static_cast<char>((t_Dict.size() >> 8) & 0xff);
+	t_Header += t_Dict;
+	return t_Header;
+}
@@ -0,0 +1,42 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _NPY_FILE_HPP_
+#define _NPY_FILE_HPP_
+
+// size_t
+#include <cstddef>
+// std::string
+#include <string>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTools
+ *  @{
+ */
+
+/// @brief A C-ordered float32 array read from a .npy file.
+class NpyArray
+{
+public:
+	std::vector<size_t> shape;
+	std::vector<float> data;
+};
+
+/// @brief Load a little endian float32 or float64 .npy file as float32.
+/// This is the format np.save writes for the GeoRT point clouds and keypoint recordings.
+/// Fortran ordered arrays and other dtypes are rejected.
+bool LoadNpyAsFloat32(const std::string& p_Path, NpyArray& p_Array);
+
+/// @brief Build a complete .npy (version 1.0) header for a C-ordered float32 array.
+/// The header is padded so that the data starts at a 64 byte boundary.
+std::string MakeNpyFloat32Header(const std::vector<size_t>& p_Shape);
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
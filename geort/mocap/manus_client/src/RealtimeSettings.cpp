@@ -0,0 +1,212 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "RealtimeSettings.hpp"
+
+// mallopt, M_TRIM_THRESHOLD, M_MMAP_MAX
+#include <malloc.h>
+// pthread_setschedparam, pthread_setaffinity_np
+#include <pthread.h>
+// SCHED_FIFO, sched_get_priority_max, CPU_SET
+#include <sched.h>
+// mlockall
+#include <sys/mman.h>
+// sysconf
+#include <unistd.h>
+
+// errno
+#include <cerrno>
+// std::malloc, std::free, std::strtol
+#include <cstdlib>
+// std::strerror
+#include <cstring>
+#include <iostream>
+// std::ostringstream
+#include <sstream>
+
+/// @brief Stack touched per thread, so the first deep call in the loop does not page fault.
+static const size_t s_PrefaultStackBytes = 128u << 10;
+
+static bool ParseInteger(const std::string& p_Text, const long p_Min, const long p_Max, int& p_Value)
+{
+	char* t_End = nullptr;
+	const long t_Value = std::strtol(p_Text.c_str(), &t_End, 10);
+	if (p_Text.empty() || *t_End != '\0' || t_Value < p_Min || t_Value > p_Max) return false;
+	p_Value = static_cast<int>(t_Value);
+	return true;
+}
+
+bool ParseCpuList(const std::string& p_Text, std::vector<int>& p_Cpus)
+{
+	std::vector<int> t_Cpus;
+	std::istringstream t_Stream(p_Text);
+	std::string t_Item;
+	while (std::getline(t_Stream, t_Item, ','))
+	{
+		const size_t t_Dash = t_Item.find('-');
+		int t_First = 0;
+		int t_Last = 0;
+		if (!ParseInteger(t_Item.substr(0, t_Dash), 0, CPU_SETSIZE - 1, t_First)) return false;
+		t_Last = t_First;
+		if (t_Dash != std::string::npos && (!ParseInteger(t_Item.substr(t_Dash + 1), t_First, CPU_SETSIZE - 1, t_Last))) return false;
+		for (int t_Cpu = t_First; t_Cpu <= t_Last; t_Cpu++) t_Cpus.push_back(t_Cpu);
+	}
+	if (t_Cpus.empty()) return false;
+	p_Cpus.swap(t_Cpus);
+	return true;
+}
+
+bool RealtimeSettings::Parse(std::vector<std::string>& p_Arguments)
+{
+	std::vector<std::string> t_Rest;
+	bool t_HasCallbackPriority = false;
+	bool t_Valid = true;
+	const int t_MaxPriority = sched_get_priority_max(SCHED_FIFO);
+	for (size_t i = 0; i < p_Arguments.size(); i++)
+	{
+		const std::string& t_Argument = p_Arguments[i];
+		const bool t_HasValue = i + 1 < p_Arguments.size();
+		if (t_Argument.compare(0, 5, "--rt-") != 0)
+		{
+			t_Rest.push_back(t_Argument);
+		}
+		else if (t_Argument == "--rt-mlock")
+		{
+			lockMemory = true;
+		}
+		else if (!t_HasValue)
+		{
+			t_Valid = false;
+		}
+		else if (t_Argument == "--rt-priority")
+		{
+			t_Valid &= ParseInteger(p_Arguments[++i], 1, t_MaxPriority, publishPriority);
+		}
+		else if (t_Argument == "--rt-callback-priority")
+		{
+			t_Valid &= ParseInteger(p_Arguments[++i], 0, t_MaxPriority, callbackPriority);
+			t_HasCallbackPriority = true;
+		}
+		else if (t_Argument == "--rt-cpus")
+		{
+			t_Valid &= ParseCpuList(p_Arguments[++i], cpus);
+		}
+		else if (t_Argument == "--rt-prefault-mb")
+		{
+			int t_Megabytes = 0;
+			t_Valid &= ParseInteger(p_Arguments[++i], 0, 1 << 16, t_Megabytes);
+			prefaultHeapBytes = static_cast<size_t>(t_Megabytes) << 20;
+		}
+		else
+		{
+			t_Valid = false;
+		}
+	}
+	if (!t_HasCallbackPriority) callbackPriority = publishPriority;
+	p_Arguments.swap(t_Rest);
+	return t_Valid;
+}
+
+const char* RealtimeSettings::GetUsage()
+{
+	return "[--rt-priority N] [--rt-callback-priority N] [--rt-cpus LIST] [--rt-mlock] [--rt-prefault-mb N]";
+}
+
+bool ApplyRealtimeProcessSettings(const RealtimeSettings& p_Settings)
+{
+	if (!p_Settings.lockMemory) return true;
+
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+	{
+		std::cerr << "Real-time: could not lock the memory (" << std::strerror(errno) << "), see ulimit -l." << std::endl;
+		return false;
+	}
+
+	// keep freed memory in the heap instead of returning it, so the frame buffers reuse the locked, faulted in pages.
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+	if (p_Settings.prefaultHeapBytes > 0)
+	{
+		volatile char* const t_Heap = static_cast<volatile char*>(std::malloc(p_Settings.prefaultHeapBytes));
+		if (t_Heap != nullptr)
+		{
+			const size_t t_PageBytes = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+			for (size_t i = 0; i < p_Settings.prefaultHeapBytes; i += t_PageBytes) t_Heap[i] = 0;
+			std::free(const_cast<char*>(t_Heap));
+		}
+	}
+	std::cout << "Real-time: memory locked, " << (p_Settings.prefaultHeapBytes >> 20) << " MB of heap pre-faulted.\n";
+	return true;
+}
+
+/// @brief Not inlined, so the array really is on the stack of the calling thread.
+__attribute__((noinline)) static void PrefaultStack()
+{
+	volatile char t_Stack[s_PrefaultStackBytes];
+	for (size_t i = 0; i < s_PrefaultStackBytes; i += 1024) t_Stack[i] = 0;
+	(void)t_Stack;
+}
+
+bool ApplyRealtimeThreadSettings(const RealtimeSettings& p_Settings, const int p_Priority, const char* const p_Name)
+{
+	bool t_Result = true;
+	std::ostringstream t_Report;
+	t_Report << "Real-time " << p_Name << " thread:";
+
+	if (!p_Settings.cpus.empty())
+	{
+		cpu_set_t t_Set;
+		CPU_ZERO(&t_Set);
+		for (const int t_Cpu : p_Settings.cpus) CPU_SET(t_Cpu, &t_Set);
+		const int t_Error = pthread_setaffinity_np(pthread_self(), sizeof(t_Set), &t_Set);
+		if (t_Error != 0)
+		{
+			std::cerr << "Real-time: could not pin the " << p_Name << " thread (" << std::strerror(t_Error) << ")." << std::endl;
+			t_Result = false;
+		}
+		// report the mask the thread ended up with, CPUs that are offline or outside the cpuset are dropped.
+		CPU_ZERO(&t_Set);
+		pthread_getaffinity_np(pthread_self(), sizeof(t_Set), &t_Set);
+		t_Report << " CPUs";
+		const char* t_Separator = " ";
+		for (int t_Cpu = 0; t_Cpu < CPU_SETSIZE; t_Cpu++)
+		{
+			if (!CPU_ISSET(t_Cpu, &t_Set)) continue;
+			t_Report << t_Separator << t_Cpu;
+			t_Separator = ",";
+		}
+		t_Report << ",";
+	}
+
+	if (p_Priority > 0)
+	{
+		sched_param t_Parameter = {};
+		t_Parameter.sched_priority = p_Priority;
+		const int t_Error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &t_Parameter);
+		if (t_Error != 0)
+		{
+			std::cerr << "Real-time: could not move the " << p_Name << " thread to SCHED_FIFO " << p_Priority << " (" << std::strerror(t_Error)
+				<< "), see ulimit -r." << std::endl;
+			t_Result = false;
+		}
+	}
+	int t_Policy = 0;
+	sched_param t_Parameter = {};
+	pthread_getschedparam(pthread_self(), &t_Policy, &t_Parameter);
+	if (t_Policy == SCHED_FIFO) t_Report << " SCHED_FIFO " << t_Parameter.sched_priority << ",";
+	else t_Report << " normal scheduling,";
+
+	if (p_Settings.lockMemory)
+	{
+		PrefaultStack();
+		t_Report << " " << (s_PrefaultStackBytes >> 10) << " KB of stack pre-faulted,";
+	}
+
+	std::string t_Line = t_Report.str();
+	t_Line.back() = '.';
+	std::cout << t_Line << "\n";
+	return t_Result;
+}
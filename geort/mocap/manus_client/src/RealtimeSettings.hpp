@@ -0,0 +1,64 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _REALTIME_SETTINGS_HPP_
+#define _REALTIME_SETTINGS_HPP_
+
+// size_t
+#include <cstddef>
+// std::string
+#include <string>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTools
+ *  @{
+ */
+
+/// @brief Scheduling and memory options that keep the glove pipeline from being delayed by other
+/// work on the machine. Everything is off by default, and every option that fails (usually for
+/// lack of CAP_SYS_NICE / CAP_IPC_LOCK or an rtprio / memlock limit) is reported and skipped
+/// rather than stopping the client.
+class RealtimeSettings
+{
+public:
+	int publishPriority = 0; // SCHED_FIFO priority of the publish thread, 0 keeps the normal scheduler.
+	int callbackPriority = 0; // of the SDK callback thread that copies the frames in.
+	std::vector<int> cpus; // affinity of both threads, empty keeps the inherited mask.
+	bool lockMemory = false; // mlockall of the current and future pages.
+	size_t prefaultHeapBytes = 64u << 20; // heap faulted in (and kept by malloc) when locking memory, for the frame buffers.
+
+	bool IsEnabled() const { return publishPriority > 0 || callbackPriority > 0 || !cpus.empty() || lockMemory; }
+
+	/// @brief Take the --rt-* options out of p_Arguments, the rest is left for the caller:
+	///   --rt-priority N           SCHED_FIFO priority of the publish thread (and the callback thread)
+	///   --rt-callback-priority N  a different priority for the callback thread
+	///   --rt-cpus LIST            e.g. 2,3 or 2-3
+	///   --rt-mlock                lock all memory and pre-fault the stacks and the heap
+	///   --rt-prefault-mb N        heap to pre-fault with --rt-mlock (64 by default)
+	/// @return false if one of them has a missing or bad value.
+	bool Parse(std::vector<std::string>& p_Arguments);
+
+	static const char* GetUsage();
+};
+
+/// @brief Parse a CPU list like "2,3", "2-5" or a mix of both.
+bool ParseCpuList(const std::string& p_Text, std::vector<int>& p_Cpus);
+
+/// @brief Lock the memory and pre-fault the heap, once per process. Prints what took effect.
+/// @return false if anything that was asked for did not take effect.
+bool ApplyRealtimeProcessSettings(const RealtimeSettings& p_Settings);
+
+/// @brief Move the calling thread to SCHED_FIFO p_Priority (if above 0) and onto the CPUs of
+/// p_Settings, and pre-fault its stack if memory is locked. Prints what took effect for p_Name.
+/// @return false if anything that was asked for did not take effect.
+bool ApplyRealtimeThreadSettings(const RealtimeSettings& p_Settings, const int p_Priority, const char* const p_Name);
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,440 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "RecordingBlockWriter.hpp"
+
+// std::max, std::min, std::sort
+#include <algorithm>
+// std::chrono::steady_clock
+#include <chrono>
+// errno
+#include <cerrno>
+// std::snprintf
+#include <cstdio>
+// std::memcpy
+#include <cstring>
+#include <iostream>
+
+// O_DIRECT, readdir
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t s_BlockAlignment = 4096;
+
+static uint64_t NanosecondsSinceEpoch(const std::chrono::steady_clock::time_point p_Time)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(p_Time.time_since_epoch()).count());
+}
+
+RecordingBlockWriter::RecordingBlockWriter()
+{
+}
+
+RecordingBlockWriter::~RecordingBlockWriter()
+{
+	// subclasses close in their own destructor, their hooks are gone by the time this runs.
+}
+
+bool RecordingBlockWriter::Open(const std::string& p_Path, const RecordingWriterSettings& p_Settings)
+{
+	Close();
+
+	m_Settings = p_Settings;
+	m_Path = p_Path;
+	if (m_Settings.diskBudgetBytes > 0 && m_Settings.chunkBytes == 0 && !(m_Settings.chunkSeconds > 0.0))
+	{
+		// a budget can only be kept by deleting whole chunks.
+		m_Settings.chunkBytes = (std::max)(m_Settings.diskBudgetBytes / 8, static_cast<uint64_t>(s_BlockAlignment));
+		std::cerr << "A disk budget needs chunks, rotating every " << m_Settings.chunkBytes << " bytes." << std::endl;
+	}
+	m_Rotating = m_Settings.chunkBytes > 0 || m_Settings.chunkSeconds > 0.0;
+
+	m_Chunks.clear();
+	m_ChunkTotalBytes = 0;
+	m_NextChunk = 0;
+	if (m_Rotating) FindExistingChunks();
+
+	m_FilePath = m_Rotating ? GetChunkPath(m_NextChunk++) : m_Path;
+	if (!OpenFile(m_FilePath)) return false;
+
+	m_BlockBytes = ((std::max)(m_Settings.blockBytes, s_BlockAlignment) + s_BlockAlignment - 1) / s_BlockAlignment * s_BlockAlignment;
+	m_Blocks.clear();
+	m_Blocks.resize((std::max)(m_Settings.blockCount, static_cast<size_t>(2)));
+	m_FreeBlocks.clear();
+	m_FullBlocks.clear();
+	for (size_t i = 0; i < m_Blocks.size(); i++)
+	{
+		Block& t_Block = m_Blocks[i];
+		t_Block.storage.reset(new char[m_BlockBytes + s_BlockAlignment]);
+		const uintptr_t t_Address = reinterpret_cast<uintptr_t>(t_Block.storage.get());
+		t_Block.data = t_Block.storage.get() + (s_BlockAlignment - t_Address % s_BlockAlignment) % s_BlockAlignment;
+		t_Block.used = 0;
+		t_Block.endsChunk = false;
+		if (i != 0) m_FreeBlocks.push_back(i);
+	}
+	m_CurrentBlock = 0;
+	m_Stopping = false;
+	m_WriteFailed = false;
+	m_RecordsRecorded = 0;
+	m_RecordsDropped = 0;
+	m_BytesWritten = 0;
+	m_ChunksDeleted = 0;
+	m_WriteCount = 0;
+	m_TotalWriteNs = 0;
+	m_MaxWriteNs = 0;
+
+	m_ChunkBytes = 0;
+	m_ChunkStartNs = NanosecondsSinceEpoch(std::chrono::steady_clock::now());
+	AppendFileHeader(m_ChunkStartNs);
+	m_FileHeaderBytes = m_ChunkBytes;
+	EnforceDiskBudget();
+
+	m_Writer = std::thread(&RecordingBlockWriter::WriterThread, this);
+	m_Open.store(true, std::memory_order_release);
+	std::cout << "Recording " << m_RecordName << " to " << m_FilePath << ".\n";
+	return true;
+}
+
+void RecordingBlockWriter::Close()
+{
+	if (!m_Open.exchange(false)) return;
+
+	m_Mutex.lock();
+	m_Stopping = true;
+	m_Mutex.unlock();
+	m_WriterWake.notify_one();
+	m_Writer.join();
+	m_Blocks.clear();
+
+	std::cout << m_Description << " " << m_Path << " closed: " << GetRecordsRecorded() << " " << m_RecordName << ", "
+		<< GetRecordsDropped() << " dropped, " << GetBytesWritten() << " bytes";
+	if (m_Rotating)
+	{
+		std::cout << " in chunks up to " << m_FilePath << ", " << GetChunksDeleted() << " old chunks deleted";
+	}
+	std::cout << ", block writes took " << GetMeanWriteLatencyUs() << " us on average and " << GetMaxWriteLatencyUs() << " us at most.\n";
+}
+
+double RecordingBlockWriter::GetMeanWriteLatencyUs() const
+{
+	const uint64_t t_Count = m_WriteCount.load(std::memory_order_relaxed);
+	if (t_Count == 0) return 0.0;
+	return static_cast<double>(m_TotalWriteNs.load(std::memory_order_relaxed)) * 1e-3 / static_cast<double>(t_Count);
+}
+
+bool RecordingBlockWriter::BeginRecord(const size_t p_Bytes, uint64_t& p_HostTime)
+{
+	if (!IsOpen()) return false;
+
+	m_Mutex.lock();
+	if (m_Stopping)
+	{
+		m_Mutex.unlock();
+		return false;
+	}
+	p_HostTime = NanosecondsSinceEpoch(std::chrono::steady_clock::now());
+
+	// a chunk holds at least one record, so a record larger than chunkBytes still gets written.
+	const bool t_Rotate = m_Rotating && m_ChunkBytes > m_FileHeaderBytes
+		&& ((m_Settings.chunkBytes > 0 && m_ChunkBytes + p_Bytes > m_Settings.chunkBytes)
+			|| (m_Settings.chunkSeconds > 0.0 && static_cast<double>(p_HostTime - m_ChunkStartNs) * 1e-9 >= m_Settings.chunkSeconds));
+
+	// strictly less, so a block that fills up can always be swapped for a free one right away.
+	// a new chunk starts in a fresh block.
+	const size_t t_Capacity = t_Rotate
+		? m_FreeBlocks.size() * m_BlockBytes
+		: (m_BlockBytes - m_Blocks[m_CurrentBlock].used) + m_FreeBlocks.size() * m_BlockBytes;
+	const size_t t_Needed = p_Bytes + (t_Rotate ? m_FileHeaderBytes : 0);
+	if (t_Needed >= t_Capacity)
+	{
+		m_Mutex.unlock();
+		m_RecordsDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	m_FullBefore = m_FullBlocks.size();
+	if (t_Rotate) StartChunk(p_HostTime);
+	return true;
+}
+
+/// @brief Copy into the current block, handing it to the writer as soon as it is full.
+/// Must be called with m_Mutex held and enough capacity checked by BeginRecord.
+void RecordingBlockWriter::Append(const void* const p_Data, const size_t p_Bytes)
+{
+	const char* t_Source = static_cast<const char*>(p_Data);
+	size_t t_Remaining = p_Bytes;
+	m_ChunkBytes += p_Bytes;
+	while (t_Remaining > 0)
+	{
+		Block& t_Block = m_Blocks[m_CurrentBlock];
+		const size_t t_Count = (std::min)(t_Remaining, m_BlockBytes - t_Block.used);
+		std::memcpy(t_Block.data + t_Block.used, t_Source, t_Count);
+		t_Block.used += t_Count;
+		t_Source += t_Count;
+		t_Remaining -= t_Count;
+
+		if (t_Block.used == m_BlockBytes && !m_FreeBlocks.empty())
+		{
+			m_FullBlocks.push_back(m_CurrentBlock);
+			m_CurrentBlock = m_FreeBlocks.back();
+			m_FreeBlocks.pop_back();
+			m_Blocks[m_CurrentBlock].used = 0;
+			m_Blocks[m_CurrentBlock].endsChunk = false;
+		}
+	}
+}
+
+void RecordingBlockWriter::EndRecord()
+{
+	const bool t_WakeWriter = m_FullBlocks.size() != m_FullBefore;
+	m_Mutex.unlock();
+	m_RecordsRecorded.fetch_add(1, std::memory_order_relaxed);
+
+	if (t_WakeWriter) m_WriterWake.notify_one();
+}
+
+/// @brief Must be called with m_Mutex held and a free block available.
+void RecordingBlockWriter::StartChunk(const uint64_t p_HostTime)
+{
+	m_Blocks[m_CurrentBlock].endsChunk = true;
+	m_FullBlocks.push_back(m_CurrentBlock);
+	m_CurrentBlock = m_FreeBlocks.back();
+	m_FreeBlocks.pop_back();
+	m_Blocks[m_CurrentBlock].used = 0;
+	m_Blocks[m_CurrentBlock].endsChunk = false;
+
+	m_ChunkBytes = 0;
+	m_ChunkStartNs = p_HostTime;
+	AppendFileHeader(p_HostTime);
+}
+
+std::string RecordingBlockWriter::GetChunkPath(const uint64_t p_Chunk) const
+{
+	const size_t t_Slash = m_Path.find_last_of('/');
+	const size_t t_Dot = m_Path.find_last_of('.');
+	const bool t_HasExtension = t_Dot != std::string::npos && (t_Slash == std::string::npos || t_Dot > t_Slash + 1);
+	const std::string t_Stem = t_HasExtension ? m_Path.substr(0, t_Dot) : m_Path;
+	const std::string t_Extension = t_HasExtension ? m_Path.substr(t_Dot) : std::string();
+
+	char t_Number[32];
+	std::snprintf(t_Number, sizeof(t_Number), ".%06llu", static_cast<unsigned long long>(p_Chunk));
+	return t_Stem + t_Number + t_Extension;
+}
+
+void RecordingBlockWriter::FindExistingChunks()
+{
+	// chunk names are the stem, a dot, digits and the extension, in the directory of m_Path.
+	const std::string t_Probe = GetChunkPath(0);
+	const size_t t_Slash = t_Probe.find_last_of('/');
+	const std::string t_Directory = t_Slash == std::string::npos ? std::string(".") : t_Probe.substr(0, t_Slash + 1);
+	const std::string t_Name = t_Slash == std::string::npos ? t_Probe : t_Probe.substr(t_Slash + 1);
+	const size_t t_DigitsStart = t_Name.rfind(".000000") + 1;
+	const std::string t_Prefix = t_Name.substr(0, t_DigitsStart);
+	const std::string t_Suffix = t_Name.substr(t_DigitsStart + 6);
+
+	DIR* const t_Dir = opendir(t_Directory.c_str());
+	if (t_Dir == nullptr) return;
+
+	std::vector<std::pair<uint64_t, Chunk>> t_Found;
+	while (const dirent* const t_Entry = readdir(t_Dir))
+	{
+		const std::string t_Candidate = t_Entry->d_name;
+		if (t_Candidate.size() <= t_Prefix.size() + t_Suffix.size()
+			|| t_Candidate.compare(0, t_Prefix.size(), t_Prefix) != 0
+			|| t_Candidate.compare(t_Candidate.size() - t_Suffix.size(), t_Suffix.size(), t_Suffix) != 0)
+		{
+			continue;
+		}
+		const std::string t_Digits = t_Candidate.substr(t_Prefix.size(), t_Candidate.size() - t_Prefix.size() - t_Suffix.size());
+		if (t_Digits.find_first_not_of("0123456789") != std::string::npos || t_Digits.size() > 18) continue;
+
+		Chunk t_Chunk;
+		t_Chunk.path = (t_Slash == std::string::npos ? std::string() : t_Directory) + t_Candidate;
+		struct stat t_Stat;
+		if (stat(t_Chunk.path.c_str(), &t_Stat) != 0 || !S_ISREG(t_Stat.st_mode)) continue;
+		t_Chunk.bytes = static_cast<uint64_t>(t_Stat.st_size);
+		t_Found.emplace_back(std::stoull(t_Digits), t_Chunk);
+	}
+	closedir(t_Dir);
+
+	std::sort(t_Found.begin(), t_Found.end(), [](const std::pair<uint64_t, Chunk>& p_A, const std::pair<uint64_t, Chunk>& p_B) { return p_A.first < p_B.first; });
+	for (const std::pair<uint64_t, Chunk>& t_Chunk : t_Found)
+	{
+		m_Chunks.push_back(t_Chunk.second);
+		m_ChunkTotalBytes += t_Chunk.second.bytes;
+		m_NextChunk = t_Chunk.first + 1;
+	}
+	if (!t_Found.empty())
+	{
+		std::cout << "Found " << t_Found.size() << " earlier chunks of " << m_Path << ", continuing at chunk " << m_NextChunk << ".\n";
+	}
+}
+
+bool RecordingBlockWriter::OpenFile(const std::string& p_Path)
+{
+	m_Descriptor = -1;
+#ifdef O_DIRECT
+	if (m_Settings.directIo)
+	{
+		m_Descriptor = open(p_Path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+	}
+#endif
+	// tmpfs and some network file systems refuse O_DIRECT, use the page cache there.
+	if (m_Descriptor < 0)
+	{
+		m_Descriptor = open(p_Path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	}
+	if (m_Descriptor < 0)
+	{
+		std::cerr << "Could not create recording " << p_Path << "." << std::endl;
+		return false;
+	}
+	m_FileBytes = 0;
+	BeginChunkData();
+	return true;
+}
+
+bool RecordingBlockWriter::WriteBlock(const char* const p_Data, const size_t p_Bytes)
+{
+	// O_DIRECT writes whole aligned blocks, the block memory behind p_Bytes is ours to write out.
+	const size_t t_Aligned = (p_Bytes + s_BlockAlignment - 1) / s_BlockAlignment * s_BlockAlignment;
+
+	const auto t_Start = std::chrono::steady_clock::now();
+	size_t t_Done = 0;
+	while (t_Done < t_Aligned)
+	{
+		const ssize_t t_Result = write(m_Descriptor, p_Data + t_Done, t_Aligned - t_Done);
+		if (t_Result < 0 && errno == EINTR) continue;
+#ifdef O_DIRECT
+		if (t_Result < 0 && errno == EINVAL && (fcntl(m_Descriptor, F_GETFL) & O_DIRECT) != 0)
+		{
+			// the file system took the flag at open but not the write, fall back for the rest of the file.
+			fcntl(m_Descriptor, F_SETFL, fcntl(m_Descriptor, F_GETFL) & ~O_DIRECT);
+			continue;
+		}
+#endif
+		if (t_Result <= 0) return false;
+		t_Done += static_cast<size_t>(t_Result);
+	}
+	const uint64_t t_Nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t_Start).count());
+
+	m_WriteCount.fetch_add(1, std::memory_order_relaxed);
+	m_TotalWriteNs.fetch_add(t_Nanoseconds, std::memory_order_relaxed);
+	if (t_Nanoseconds > m_MaxWriteNs.load(std::memory_order_relaxed)) m_MaxWriteNs.store(t_Nanoseconds, std::memory_order_relaxed);
+	m_FileBytes += p_Bytes;
+	m_BytesWritten.fetch_add(p_Bytes, std::memory_order_relaxed);
+	return true;
+}
+
+void RecordingBlockWriter::FinishFile()
+{
+	if (m_Descriptor < 0) return;
+
+	// the last write was padded up to the alignment.
+	if (ftruncate(m_Descriptor, static_cast<off_t>(m_FileBytes)) != 0)
+	{
+		std::cerr << "Could not trim recording " << m_FilePath << "." << std::endl;
+	}
+
+	if (!m_WriteFailed)
+	{
+		GetChunkTrailer(m_Trailer);
+	}
+	if (!m_WriteFailed && !m_Trailer.empty())
+	{
+		// the trailer is small and unaligned, it goes through the page cache.
+#ifdef O_DIRECT
+		fcntl(m_Descriptor, F_SETFL, fcntl(m_Descriptor, F_GETFL) & ~O_DIRECT);
+#endif
+		size_t t_Done = 0;
+		while (t_Done < m_Trailer.size())
+		{
+			const ssize_t t_Result = pwrite(m_Descriptor, m_Trailer.data() + t_Done, m_Trailer.size() - t_Done, static_cast<off_t>(m_FileBytes + t_Done));
+			if (t_Result < 0 && errno == EINTR) continue;
+			if (t_Result <= 0)
+			{
+				std::cerr << "Could not write the trailer of recording " << m_FilePath << ", readers fall back to scanning it." << std::endl;
+				break;
+			}
+			t_Done += static_cast<size_t>(t_Result);
+		}
+		m_FileBytes += t_Done;
+		m_BytesWritten.fetch_add(t_Done, std::memory_order_relaxed);
+	}
+	close(m_Descriptor);
+	m_Descriptor = -1;
+}
+
+void RecordingBlockWriter::EnforceDiskBudget()
+{
+	if (m_Settings.diskBudgetBytes == 0) return;
+
+	while (!m_Chunks.empty() && m_ChunkTotalBytes + m_FileBytes > m_Settings.diskBudgetBytes)
+	{
+		const Chunk& t_Oldest = m_Chunks.front();
+		if (unlink(t_Oldest.path.c_str()) != 0)
+		{
+			std::cerr << "Could not delete old recording chunk " << t_Oldest.path << "." << std::endl;
+		}
+		m_ChunkTotalBytes -= t_Oldest.bytes;
+		m_Chunks.pop_front();
+		m_ChunksDeleted.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void RecordingBlockWriter::WriterThread()
+{
+	std::unique_lock<std::mutex> t_Lock(m_Mutex);
+	while (true)
+	{
+		m_WriterWake.wait(t_Lock, [this] { return !m_FullBlocks.empty() || m_Stopping; });
+		if (m_FullBlocks.empty()) break;
+
+		const size_t t_Index = m_FullBlocks.front();
+		m_FullBlocks.pop_front();
+		const Block& t_Block = m_Blocks[t_Index];
+		t_Lock.unlock();
+
+		if (!m_WriteFailed) ObserveChunkData(t_Block.data, t_Block.used);
+		if (!m_WriteFailed && !WriteBlock(t_Block.data, t_Block.used))
+		{
+			// keep draining so the callback does not back up, the records are counted as recorded but lost.
+			std::cerr << "Writing recording " << m_FilePath << " failed, the rest of the session is not saved." << std::endl;
+			m_WriteFailed = true;
+		}
+		if (!m_WriteFailed && t_Block.endsChunk)
+		{
+			FinishFile();
+			Chunk t_Chunk;
+			t_Chunk.path = m_FilePath;
+			t_Chunk.bytes = m_FileBytes;
+			m_Chunks.push_back(t_Chunk);
+			m_ChunkTotalBytes += t_Chunk.bytes;
+
+			m_FilePath = GetChunkPath(m_NextChunk++);
+			m_WriteFailed = !OpenFile(m_FilePath);
+		}
+		if (!m_WriteFailed) EnforceDiskBudget();
+
+		t_Lock.lock();
+		m_FreeBlocks.push_back(t_Index);
+	}
+
+	// stopping, nobody appends anymore. flush the partially filled block.
+	const Block& t_Last = m_Blocks[m_CurrentBlock];
+	if (!m_WriteFailed && t_Last.used > 0)
+	{
+		ObserveChunkData(t_Last.data, t_Last.used);
+		if (!WriteBlock(t_Last.data, t_Last.used))
+		{
+			std::cerr << "Writing recording " << m_FilePath << " failed." << std::endl;
+			m_WriteFailed = true;
+		}
+	}
+	FinishFile();
+}
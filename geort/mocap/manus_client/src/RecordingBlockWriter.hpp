@@ -0,0 +1,178 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _RECORDING_BLOCK_WRITER_HPP_
+#define _RECORDING_BLOCK_WRITER_HPP_
+
+// std::atomic
+#include <atomic>
+#include <condition_variable>
+// size_t
+#include <cstddef>
+// uint64_t
+#include <cstdint>
+// std::deque
+#include <deque>
+#include <memory>
+#include <mutex>
+// std::string
+#include <string>
+#include <thread>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTRecording
+ *  @{
+ */
+
+/// @brief How a recorder buffers, splits and bounds what it writes.
+class RecordingWriterSettings
+{
+public:
+	size_t blockBytes = 1 << 20; // size of every write, rounded up to a multiple of 4096.
+	size_t blockCount = 16; // bounds the memory use and how far the disk may fall behind, at least 2.
+	uint64_t chunkBytes = 0; // start a new chunk before a file grows past this, 0 to not rotate on size.
+	double chunkSeconds = 0.0; // start a new chunk after this much time, 0 to not rotate on time.
+	uint64_t diskBudgetBytes = 0; // delete the oldest chunks to stay under this, 0 for no limit.
+	bool directIo = true; // bypass the page cache (O_DIRECT) where the file system allows it.
+};
+
+/// @brief The I/O half of the recorders: appends records to a file without ever blocking the SDK
+/// callback on I/O. Subclasses define the file header and the records.
+///
+/// A record is copied into one of a fixed set of large blocks. Full blocks are handed to a
+/// background thread that writes each one with a single call at a block aligned file offset,
+/// with O_DIRECT when possible so an always-on recorder does not push everything else out of the
+/// page cache. When every block is waiting for the disk the record is dropped and counted instead
+/// of waiting.
+///
+/// With rotation on, a recording is a series of chunks next to p_Path: session.rec becomes
+/// session.000000.rec, session.000001.rec and so on. Every chunk is a complete file that starts
+/// with its own header on a record boundary. Numbering continues after the chunks already on disk,
+/// and those count against the disk budget too. The oldest chunks are deleted first, the one being
+/// written never.
+class RecordingBlockWriter
+{
+public:
+	RecordingBlockWriter();
+	virtual ~RecordingBlockWriter();
+
+	/// @brief Create p_Path (or its first chunk) and start the writer thread.
+	bool Open(const std::string& p_Path, const RecordingWriterSettings& p_Settings);
+
+	/// @brief Write out what is buffered, stop the writer thread and close the file.
+	void Close();
+
+	bool IsOpen() const { return m_Open.load(std::memory_order_acquire); }
+
+	uint64_t GetRecordsRecorded() const { return m_RecordsRecorded.load(std::memory_order_relaxed); }
+	uint64_t GetRecordsDropped() const { return m_RecordsDropped.load(std::memory_order_relaxed); }
+	uint64_t GetBytesWritten() const { return m_BytesWritten.load(std::memory_order_relaxed); }
+	uint64_t GetChunksDeleted() const { return m_ChunksDeleted.load(std::memory_order_relaxed); }
+
+	/// @brief Time the writer thread spent in single block writes, in microseconds.
+	uint64_t GetWriteCount() const { return m_WriteCount.load(std::memory_order_relaxed); }
+	double GetMeanWriteLatencyUs() const;
+	double GetMaxWriteLatencyUs() const { return static_cast<double>(m_MaxWriteNs.load(std::memory_order_relaxed)) * 1e-3; }
+
+protected:
+	/// @brief Lock the writer for a record of p_Bytes and start a new chunk first if it is time.
+	/// p_HostTime is steady_clock in nanoseconds, read under the lock so records are in time order.
+	/// @return false, unlocked, if the recorder is closed or the record has to be dropped.
+	bool BeginRecord(const size_t p_Bytes, uint64_t& p_HostTime);
+	/// @brief Copy part of the record, between BeginRecord and EndRecord only.
+	void Append(const void* const p_Data, const size_t p_Bytes);
+	/// @brief Unlock and wake the writer thread if a block filled up.
+	void EndRecord();
+
+	/// @brief Append the header every file (chunk) starts with, called with the writer locked.
+	virtual void AppendFileHeader(const uint64_t p_HostTime) = 0;
+	/// @brief Writer thread: a new file starts, ObserveChunkData follows with all of its bytes in order.
+	virtual void BeginChunkData() {}
+	virtual void ObserveChunkData(const char* const, const size_t) {}
+	/// @brief Writer thread: bytes to put after the data when a file is finished, e.g. an index.
+	virtual void GetChunkTrailer(std::vector<char>& p_Trailer) { p_Trailer.clear(); }
+
+	/// @brief Used in the message Close prints, e.g. "Skeleton recording" and "frames".
+	std::string m_Description = "Recording";
+	std::string m_RecordName = "records";
+
+private:
+	class Block
+	{
+	public:
+		std::unique_ptr<char[]> storage;
+		char* data = nullptr; // storage aligned to 4096.
+		size_t used = 0;
+		bool endsChunk = false; // the last block of its chunk, only partly used.
+	};
+
+	/// @brief A finished chunk on disk, oldest first.
+	class Chunk
+	{
+	public:
+		std::string path;
+		uint64_t bytes = 0;
+	};
+
+	void WriterThread();
+	/// @brief Hand the current block to the writer as the end of its chunk and begin the next chunk.
+	void StartChunk(const uint64_t p_HostTime);
+
+	std::string GetChunkPath(const uint64_t p_Chunk) const;
+	/// @brief Collect the chunks of an earlier session at m_Path, sets m_NextChunk after them.
+	void FindExistingChunks();
+	bool OpenFile(const std::string& p_Path);
+	/// @brief Write p_Bytes of an aligned block, p_Bytes is rounded up to the alignment for O_DIRECT.
+	bool WriteBlock(const char* const p_Data, const size_t p_Bytes);
+	/// @brief Append the subclass trailer, cut the padding of the last write and close the file.
+	void FinishFile();
+	void EnforceDiskBudget();
+
+	RecordingWriterSettings m_Settings;
+	std::string m_Path;
+	bool m_Rotating = false;
+	size_t m_BlockBytes = 0;
+	std::vector<Block> m_Blocks;
+	std::atomic<bool> m_Open{ false };
+
+	// guards everything below, never held during I/O.
+	std::mutex m_Mutex;
+	std::condition_variable m_WriterWake;
+	std::vector<size_t> m_FreeBlocks;
+	std::deque<size_t> m_FullBlocks; // in file order.
+	size_t m_CurrentBlock = 0;
+	size_t m_FullBefore = 0; // m_FullBlocks.size() at BeginRecord.
+	bool m_Stopping = false;
+	uint64_t m_ChunkStartNs = 0;
+	uint64_t m_ChunkBytes = 0; // appended to the current chunk so far, header included.
+	uint64_t m_FileHeaderBytes = 0;
+
+	// writer thread only, after Open.
+	std::thread m_Writer;
+	int m_Descriptor = -1;
+	std::string m_FilePath;
+	uint64_t m_FileBytes = 0; // data in the open file, without padding.
+	uint64_t m_NextChunk = 0;
+	std::deque<Chunk> m_Chunks;
+	uint64_t m_ChunkTotalBytes = 0; // of m_Chunks.
+	std::vector<char> m_Trailer;
+	bool m_WriteFailed = false;
+
+	std::atomic<uint64_t> m_RecordsRecorded{ 0 };
+	std::atomic<uint64_t> m_RecordsDropped{ 0 };
+	std::atomic<uint64_t> m_BytesWritten{ 0 };
+	std::atomic<uint64_t> m_ChunksDeleted{ 0 };
+	std::atomic<uint64_t> m_WriteCount{ 0 };
+	std::atomic<uint64_t> m_TotalWriteNs{ 0 };
+	std::atomic<uint64_t> m_MaxWriteNs{ 0 };
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -130,27 +130,69 @@ ClientReturnCode SDKMinimalClient::RegisterAllCallbacks()
 		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
 	}
 
+	// Register the callbacks for when the connection to manus core is made or lost, so Run can reconnect
+	// and reload the skeleton as soon as Core goes away, e.g. when it is restarted.
+	if (CoreSdk_RegisterCallbackForOnConnect(*OnConnectedCallback) != SDKReturnCode::SDKReturnCode_Success
+		|| CoreSdk_RegisterCallbackForOnDisconnect(*OnDisconnectedCallback) != SDKReturnCode::SDKReturnCode_Success)
+	{
+		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
+	}
+
 	return ClientReturnCode::ClientReturnCode_Success;
 }
 
 /// @brief main loop
 void SDKMinimalClient::Run()
 {
+	// the host of the last good connection is tried first and kept across restarts, see HostConnection.hpp.
+	const std::string t_DocumentsPath = GetDocumentsDirectoryPath_UTF8();
+	m_HostConnector.Configure(t_DocumentsPath.empty() ? std::string() : t_DocumentsPath + s_SlashForFilesystemPath + "GeoRT" + s_SlashForFilesystemPath + "manus_host.txt", 1);
+
 	// first loop until we get a connection
 	std::cout << "minimal client is connecting to host. (make sure it is running)\n";
 	while (Connect() != ClientReturnCode::ClientReturnCode_Success)
 	{
-		// not yet connected. wait
-		std::cout << "minimal client could not connect.trying again in a second.\n";
-		std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+		// not yet connected. a failed attempt already waited for discovery, so try again soon.
+		std::cout << "minimal client could not connect. trying again.\n";
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
 	}
-	std::cout << "minimal client is connected, setting up skeletons.\n";
+	std::cout << "minimal client is connected to " << m_HostConnector.GetLastHost().hostName << " by " << GetHostConnectStepName(m_HostConnector.GetLastStep())
+		<< ", setting up skeletons.\n";
 	// then upload a simple skeleton with a chain. this will just be a left hand for the first userindex.
 	LoadTestSkeleton();
 
 	// then loop and get its data while waiting for escape key to end it
 	while (m_Running)
 	{
+		// Core went away, e.g. it was restarted. reconnect right away and load the skeleton again.
+		m_ConnectionMutex.lock();
+		const bool t_Disconnected = m_Disconnected;
+		const std::chrono::steady_clock::time_point t_DisconnectTime = m_DisconnectTime;
+		m_Disconnected = false;
+		m_ConnectionMutex.unlock();
+		if (t_Disconnected)
+		{
+			std::cout << "minimal client lost the connection to " << m_HostConnector.GetLastHost().hostName << ", reconnecting.\n";
+			// the skeletons from before the disconnect are stale.
+			m_SkeletonMutex.lock();
+			if (m_NextSkeleton != nullptr) delete m_NextSkeleton;
+			m_NextSkeleton = nullptr;
+			m_SkeletonMutex.unlock();
+			if (m_Skeleton != nullptr) delete m_Skeleton;
+			m_Skeleton = nullptr;
+
+			// the SDK may have found its way back already, only connect if it has not.
+			bool t_Connected = false;
+			while (m_Running && (CoreSdk_GetIsConnectedToCore(&t_Connected) != SDKReturnCode::SDKReturnCode_Success || !t_Connected)
+				&& Connect() != ClientReturnCode::ClientReturnCode_Success)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			}
+			std::cout << "minimal client reconnected to " << m_HostConnector.GetLastHost().hostName << " in "
+				<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_DisconnectTime).count() << " ms.\n";
+			LoadTestSkeleton();
+		}
+
 		// check if there is new data. otherwise we just wait.
 		m_SkeletonMutex.lock();
 		if (m_NextSkeleton != nullptr)
@@ -192,38 +234,10 @@ void SDKMinimalClient::Run()
 }
 
 /// @brief the client will now try to connect to manus core via the SDK.
+/// The last good host is tried first and discovery only if that fails, see HostConnector.
 ClientReturnCode SDKMinimalClient::Connect()
 {
-	SDKReturnCode t_StartResult = CoreSdk_LookForHosts(1, false);
-	if (t_StartResult != SDKReturnCode::SDKReturnCode_Success)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	uint32_t t_NumberOfHostsFound = 0;
-	SDKReturnCode t_NumberResult = CoreSdk_GetNumberOfAvailableHostsFound(&t_NumberOfHostsFound);
-	if (t_NumberResult != SDKReturnCode::SDKReturnCode_Success)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	if (t_NumberOfHostsFound == 0)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	std::unique_ptr<ManusHost[]> t_AvailableHosts; 
-	t_AvailableHosts.reset(new ManusHost[t_NumberOfHostsFound]);
-
-	SDKReturnCode t_HostsResult = CoreSdk_GetAvailableHostsFound(t_AvailableHosts.get(), t_NumberOfHostsFound);
-	if (t_HostsResult != SDKReturnCode::SDKReturnCode_Success)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	SDKReturnCode t_ConnectResult = CoreSdk_ConnectToHost(t_AvailableHosts[0]);
-
-	if (t_ConnectResult == SDKReturnCode::SDKReturnCode_NotConnected)
+	if (!m_HostConnector.Connect())
 	{
 		return ClientReturnCode::ClientReturnCode_FailedToConnect;
 	}
@@ -261,7 +275,7 @@ void SDKMinimalClient::LoadTestSkeleton()
 
 	// setup nodes and chains for the skeleton hand
 	if (!SetupHandNodes(t_SklIndex)) return;
-	if (!SetupHandChains(t_SklIndex)) return;
+	if (!SetupHandChains(t_SklIndex, Side::Side_Left)) return;
 
 	// load skeleton 
 	uint32_t t_ID = 0;
@@ -392,8 +406,9 @@ bool SDKMinimalClient::SetupHandNodes(uint32_t p_SklIndex)
 /// Chains are required for a Skeleton to be able to be animated, it basically tells Manus Core
 /// which nodes belong to which body part and what data needs to be applied to which node.
 /// @param p_SklIndex The index of the temporary skeleton on which the chains will be added.
+/// @param p_Side The hand the chains are for.
 /// @return Returns true if everything went fine, otherwise returns false.
-bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
+bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex, Side p_Side)
 {
 	// Add the Hand chain, this identifies the wrist of the hand
 	{
@@ -413,7 +428,7 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 		t_Chain.id = 0; //Every ID needs to be unique per chain in a skeleton.
 		t_Chain.type = ChainType::ChainType_Hand;
 		t_Chain.dataType = ChainType::ChainType_Hand;
-		t_Chain.side = Side::Side_Left;
+		t_Chain.side = p_Side;
 		t_Chain.dataIndex = 0;
 		t_Chain.nodeIdCount = 1;
 		t_Chain.nodeIds[0] = 0; //this links to the hand node created in the SetupHandNodes
@@ -447,7 +462,7 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 		t_Chain.id = i + 1; //Every ID needs to be unique per chain in a skeleton.
 		t_Chain.type = t_FingerTypes[i];
 		t_Chain.dataType = t_FingerTypes[i];
-		t_Chain.side = Side::Side_Left;
+		t_Chain.side = p_Side;
 		t_Chain.dataIndex = 0;
 		if (i == 0) // Thumb
 		{
@@ -476,6 +491,31 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 	return true;
 }
 
+/// @brief This gets called when the client is connected to manus core.
+/// @param p_Host the host it connected to.
+void SDKMinimalClient::OnConnectedCallback(const ManusHost* const p_Host)
+{
+	if (s_Instance && p_Host != nullptr)
+	{
+		std::cout << "Connected to Manus Core " << p_Host->hostName << " (" << p_Host->ipAddress << ").\n";
+	}
+}
+
+/// @brief This gets called when the connection to manus core is lost. The SDK must not be called
+/// from its callbacks, so this only notes it and Run reconnects.
+/// @param p_Host the host it was connected to.
+void SDKMinimalClient::OnDisconnectedCallback(const ManusHost* const p_Host)
+{
+	(void)p_Host;
+	if (s_Instance)
+	{
+		s_Instance->m_ConnectionMutex.lock();
+		s_Instance->m_Disconnected = true;
+		s_Instance->m_DisconnectTime = std::chrono::steady_clock::now();
+		s_Instance->m_ConnectionMutex.unlock();
+	}
+}
+
 /// @brief This gets called when the client is connected to manus core
 /// @param p_SkeletonStreamInfo contains the meta data on how much data regarding the skeleton we need to get from the SDK.
 void SDKMinimalClient::OnSkeletonStreamCallback(const SkeletonStreamInfo* const p_SkeletonStreamInfo)
@@ -15,7 +15,15 @@
 
 
 #include "ClientPlatformSpecific.hpp"
+#include "FrameHandoff.hpp"
+#include "HostConnection.hpp"
 #include "ManusSDK.h"
+#include "SkeletonProvisioning.hpp"
+#include "SkeletonRecording.hpp"
+#include "SkeletonSetupCache.hpp"
+#include "StartupProfiler.hpp"
+#include "StreamRecording.hpp"
+#include <chrono>
 #include <mutex>
 #include <vector>
 
@@ -64,6 +72,7 @@ public:
 class ClientSkeletonCollection
 {
 public:
+	std::chrono::steady_clock::time_point receiveTime; // when the callback got it.
 	std::vector<ClientSkeleton> skeletons;
 };
 
@@ -79,6 +88,8 @@ public:
 class TrackerDataCollection
 {
 public:
+	ManusTimestamp publishTime = {};
+	std::chrono::steady_clock::time_point receiveTime; // when the callback got it.
 	std::vector<TrackerData> trackerData;
 };
 
@@ -94,18 +105,23 @@ public:
 	void Run();
 
 	static void OnConnectedCallback(const ManusHost* const p_Host);
+	static void OnDisconnectedCallback(const ManusHost* const p_Host);
 	static void OnLandscapeCallback(const Landscape* const p_Landscape);
 	static void OnSkeletonStreamCallback(const SkeletonStreamInfo* const p_SkeletonStreamInfo);
 	static void OnTrackerStreamCallback(const TrackerStreamInfo* const p_TrackerStreamInfo);
 	static void OnRawSkeletonStreamCallback(const SkeletonStreamInfo* const p_RawSkeletonStreamInfo);
+	static void OnErgonomicsCallback(const ErgonomicsStream* const p_Ergonomics);
+	static void OnGestureStreamCallback(const GestureStreamInfo* const p_GestureStreamInfo);
 
 protected:
 
 	ClientReturnCode Connect();
 	ClientReturnCode UpdateBeforeDisplayingData();
 	bool SetupHandNodes(uint32_t p_SklIndex);
-	bool SetupHandChains(uint32_t p_SklIndex);
+	bool SetupHandChains(uint32_t p_SklIndex, Side p_Side);
 	void LoadTestSkeleton();
+	bool LoadHandSkeleton(SkeletonTargetType p_TargetType, uint32_t p_Target, Side p_Side, uint32_t& p_SkeletonId);
+	void ProvisionSkeletons(const LandscapeUsers& p_Users);
 	void PrintRawSkeletonData();
 	void GetRawSkeletonData(std::vector<float>* position, std::vector<float>* quat);
 	NodeSetup CreateNodeSetup(uint32_t p_Id, uint32_t p_ParentId, float p_PosX, float p_PosY, float p_PosZ, std::string p_Name);
@@ -115,7 +131,6 @@ protected:
 	bool m_Running = true;
 
 	std::mutex m_SkeletonMutex;
-	std::mutex m_TrackerMutex;
 	std::mutex m_RawSkeletonMutex;
 
 	
@@ -124,9 +139,16 @@ protected:
 	
 	ClientSkeletonCollection* m_NextSkeleton = nullptr;
 	ClientSkeletonCollection* m_Skeleton = nullptr;
+	// skeleton frames from OnSkeletonStreamCallback to Run with a configurable policy and counters.
+	FrameHandoff<ClientSkeletonCollection> m_SkeletonHandoff;
 
 	uint32_t m_FrameCounter = 0;
 
+	// optional raw copy of the skeleton stream, fed from OnSkeletonStreamCallback.
+	SkeletonRecorder m_Recorder;
+	// optional interleaved log of every stream this client receives, for fusing them offline.
+	StreamRecorder m_StreamRecorder;
+
 	// void PrintTrackerData(const TrackerData& trackerData);
 	// void PrintTrackerDataGlobal();
 	// void PrintTrackerDataPerUser();
@@ -136,8 +158,7 @@ protected:
 	float m_TrackerOffset = 0.0f;
 
 	
-	TrackerDataCollection* m_NextTrackerData = nullptr;
-	TrackerDataCollection* m_TrackerData = nullptr;
+	FrameHandoff<TrackerDataCollection> m_TrackerHandoff;
 
 	
 	std::mutex m_LandscapeMutex;
@@ -145,6 +166,26 @@ protected:
 	Landscape* m_Landscape = nullptr;
 	std::vector<GestureLandscapeData> m_NewGestureLandscapeData;
 	std::vector<GestureLandscapeData> m_GestureLandscapeData;
+	// the users of the latest landscape, for loading a skeleton per user and hand.
+	LandscapeUsers m_NewLandscapeUsers;
+	bool m_HasNewLandscapeUsers = false;
+	SkeletonProvisioner m_Provisioner;
+	// reused by ProvisionSkeletons, so following the landscape does not allocate once it has been at its largest.
+	std::vector<uint32_t> m_ProvisionUnload;
+	std::vector<SkeletonRequest> m_ProvisionLoad;
+	// compressed hand skeleton setups from earlier runs, see LoadHandSkeleton.
+	SkeletonSetupCache m_SkeletonCache;
+	std::vector<unsigned char> m_SkeletonSetupData; // reused by every LoadHandSkeleton.
+	uint32_t m_SkeletonLoads = 0;
+	uint32_t m_SkeletonCacheHits = 0;
+	// how long each phase from Initialize to the first skeleton frame took.
+	StartupProfiler m_Startup;
+
+	// the connection to Core, see HostConnection.hpp. The callbacks only note a disconnect, Run reconnects.
+	HostConnector m_HostConnector;
+	std::mutex m_ConnectionMutex;
+	bool m_Disconnected = false;
+	std::chrono::steady_clock::time_point m_DisconnectTime;
 
 	uint32_t m_FirstLeftGloveID = 0;
 	uint32_t m_FirstRightGloveID = 0;
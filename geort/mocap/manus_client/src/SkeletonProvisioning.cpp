@@ -0,0 +1,122 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "SkeletonProvisioning.hpp"
+
+// std::min
+#include <algorithm>
+
+void LandscapeUsers::Set(const Landscape& p_Landscape)
+{
+	userCount = (std::min)(p_Landscape.users.userCount, static_cast<uint32_t>(MAX_USERS));
+	for (uint32_t i = 0; i < userCount; i++)
+	{
+		const UserLandscapeData& t_User = p_Landscape.users.users[i];
+		users[i].id = t_User.id;
+		users[i].index = t_User.userIndex;
+		users[i].hasLeftGlove = t_User.leftGloveID != 0;
+		users[i].hasRightGlove = t_User.rightGloveID != 0;
+	}
+}
+
+void SkeletonProvisioner::Configure(const bool p_Left, const bool p_Right, const Side p_DefaultSide)
+{
+	m_Sides[0] = p_Left;
+	m_Sides[1] = p_Right;
+	m_DefaultSide = p_DefaultSide;
+	m_Skeletons.clear();
+	m_Skeletons.reserve(MAX_NUMBER_OF_SKELETONS);
+}
+
+void SkeletonProvisioner::Plan(const LandscapeUsers& p_Users, std::vector<uint32_t>& p_Unload, std::vector<SkeletonRequest>& p_Load) const
+{
+	p_Unload.clear();
+	p_Load.clear();
+
+	// a skeleton stays while its user is in the same slot and still has the glove of its side.
+	for (const Skeleton& t_Skeleton : m_Skeletons)
+	{
+		bool t_Keep = false;
+		for (uint32_t i = 0; i < p_Users.userCount && !t_Keep; i++)
+		{
+			const LandscapeUsers::User& t_User = p_Users.users[i];
+			t_Keep = t_User.id == t_Skeleton.request.userId && t_User.index == t_Skeleton.request.userIndex
+				&& (t_Skeleton.request.side == Side::Side_Left ? t_User.hasLeftGlove : t_User.hasRightGlove);
+		}
+		if (!t_Keep) p_Unload.push_back(t_Skeleton.id);
+	}
+
+	size_t t_Count = m_Skeletons.size() - p_Unload.size();
+	for (uint32_t i = 0; i < p_Users.userCount; i++)
+	{
+		const LandscapeUsers::User& t_User = p_Users.users[i];
+		if (t_User.index >= MAX_USERS) continue;
+		for (int t_SideIndex = 0; t_SideIndex < 2; t_SideIndex++)
+		{
+			const Side t_Side = t_SideIndex == 0 ? Side::Side_Left : Side::Side_Right;
+			if (!m_Sides[t_SideIndex] || !(t_SideIndex == 0 ? t_User.hasLeftGlove : t_User.hasRightGlove)) continue;
+
+			const uint32_t t_Route = GetRoute(t_User.index, t_Side);
+			bool t_Loaded = false;
+			for (const Skeleton& t_Skeleton : m_Skeletons)
+			{
+				if (t_Skeleton.request.route != t_Route) continue;
+				// one that is about to be unloaded is replaced.
+				t_Loaded = std::find(p_Unload.begin(), p_Unload.end(), t_Skeleton.id) == p_Unload.end();
+				break;
+			}
+			if (t_Loaded || t_Count >= MAX_NUMBER_OF_SKELETONS) continue;
+
+			SkeletonRequest t_Request;
+			t_Request.userId = t_User.id;
+			t_Request.userIndex = t_User.index;
+			t_Request.side = t_Side;
+			t_Request.route = t_Route;
+			p_Load.push_back(t_Request);
+			t_Count++;
+		}
+	}
+}
+
+void SkeletonProvisioner::Add(const SkeletonRequest& p_Request, const uint32_t p_SkeletonId)
+{
+	Skeleton t_Skeleton;
+	t_Skeleton.id = p_SkeletonId;
+	t_Skeleton.request = p_Request;
+	m_Skeletons.push_back(t_Skeleton);
+}
+
+void SkeletonProvisioner::Remove(const uint32_t p_SkeletonId)
+{
+	for (size_t i = 0; i < m_Skeletons.size(); i++)
+	{
+		if (m_Skeletons[i].id != p_SkeletonId) continue;
+		m_Skeletons[i] = m_Skeletons.back();
+		m_Skeletons.pop_back();
+		return;
+	}
+}
+
+uint32_t SkeletonProvisioner::FindRoute(const uint32_t p_SkeletonId) const
+{
+	// at most MAX_NUMBER_OF_SKELETONS, a scan is as fast as anything else.
+	for (const Skeleton& t_Skeleton : m_Skeletons)
+	{
+		if (t_Skeleton.id == p_SkeletonId) return t_Skeleton.request.route;
+	}
+	return SKELETON_ROUTE_NONE;
+}
+
+uint32_t SkeletonProvisioner::GetRoute(const uint32_t p_UserIndex, const Side p_Side)
+{
+	return p_UserIndex * 2 + (p_Side == Side::Side_Left ? 0 : 1);
+}
+
+std::string SkeletonProvisioner::GetRoutePrefix(const uint32_t p_Route) const
+{
+	if (p_Route == GetRoute(0, m_DefaultSide)) return std::string();
+	return "user" + std::to_string(p_Route / 2) + (p_Route % 2 == 0 ? "/left/" : "/right/");
+}
@@ -0,0 +1,109 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _SKELETON_PROVISIONING_HPP_
+#define _SKELETON_PROVISIONING_HPP_
+
+#include "ManusSDKTypes.h"
+
+// size_t
+#include <cstddef>
+// uint32_t
+#include <cstdint>
+// std::string
+#include <string>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup SDKMinimalClient
+ *  @{
+ */
+
+/// @brief Returned by SkeletonProvisioner::FindRoute for a skeleton that is not provisioned.
+#define SKELETON_ROUTE_NONE 0xFFFFFFFFu
+
+/// @brief The users of a landscape and which gloves they have, all the provisioning needs from it.
+/// Fixed size, so the landscape callback can fill it without allocating.
+class LandscapeUsers
+{
+public:
+	class User
+	{
+	public:
+		uint32_t id = 0;
+		uint32_t index = 0;
+		bool hasLeftGlove = false;
+		bool hasRightGlove = false;
+	};
+
+	User users[MAX_USERS];
+	uint32_t userCount = 0;
+
+	void Set(const Landscape& p_Landscape);
+};
+
+/// @brief A hand skeleton to load for a user.
+class SkeletonRequest
+{
+public:
+	uint32_t userId = 0;
+	uint32_t userIndex = 0;
+	Side side = Side::Side_Right;
+	uint32_t route = SKELETON_ROUTE_NONE;
+};
+
+/// @brief Keeps one hand skeleton loaded per user and hand side in the landscape.
+///
+/// Plan compares the users of the latest landscape with the loaded skeletons and says which to
+/// unload (the user left or lost the glove of that side) and which to load, up to
+/// MAX_NUMBER_OF_SKELETONS. The caller does the SDK calls and reports the loaded ids back.
+///
+/// Every skeleton gets a route, the user index and side, which stays the same while the user is
+/// in the same slot of Core. There are at most MAX_USERS * 2 of them, so the outputs of the routes
+/// can be created on first use and kept, and memory stays bounded as users come and go.
+class SkeletonProvisioner
+{
+public:
+	/// @param p_DefaultSide the side whose route for user index 0 keeps the unprefixed topics.
+	void Configure(const bool p_Left, const bool p_Right, const Side p_DefaultSide);
+
+	/// @brief What to unload and load so the skeletons match p_Users. The outputs are cleared first.
+	void Plan(const LandscapeUsers& p_Users, std::vector<uint32_t>& p_Unload, std::vector<SkeletonRequest>& p_Load) const;
+
+	/// @brief Record that the skeleton of p_Request was loaded as p_SkeletonId.
+	void Add(const SkeletonRequest& p_Request, const uint32_t p_SkeletonId);
+	/// @brief Forget p_SkeletonId, after it was unloaded.
+	void Remove(const uint32_t p_SkeletonId);
+	/// @brief Forget all skeletons, after the connection to Core was lost and took them with it.
+	void Clear() { m_Skeletons.clear(); }
+
+	/// @return the route of p_SkeletonId, SKELETON_ROUTE_NONE if it is not one of ours.
+	uint32_t FindRoute(const uint32_t p_SkeletonId) const;
+	size_t GetSkeletonCount() const { return m_Skeletons.size(); }
+
+	static uint32_t GetRoute(const uint32_t p_UserIndex, const Side p_Side);
+	static uint32_t GetRouteCount() { return MAX_USERS * 2; }
+	/// @brief The topic prefix of p_Route, e.g. "user1/left/". Empty for user index 0 on the default side.
+	std::string GetRoutePrefix(const uint32_t p_Route) const;
+
+protected:
+	class Skeleton
+	{
+	public:
+		uint32_t id = 0;
+		SkeletonRequest request;
+	};
+
+	bool m_Sides[2] = { false, true }; // left, right.
+	Side m_DefaultSide = Side::Side_Right;
+	std::vector<Skeleton> m_Skeletons;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,118 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "SkeletonPublisher.hpp"
+
+// std::to_chars
+#include <charconv>
+// std::atan2, std::asin, std::copysign
+#include <cmath>
+// std::to_string
+#include <string>
+// std::pair
+#include <utility>
+
+/// @brief Roll, pitch, yaw of a Manus rotation, in radians.
+static ManusVec3 QuaternionToEuler(const ManusQuaternion& p_Q)
+{
+	ManusVec3 t_Euler;
+
+	// Roll (x-axis rotation)
+	const float t_SinRCosP = 2 * (p_Q.w * p_Q.x + p_Q.y * p_Q.z);
+	const float t_CosRCosP = 1 - 2 * (p_Q.x * p_Q.x + p_Q.y * p_Q.y);
+	t_Euler.x = std::atan2(t_SinRCosP, t_CosRCosP);
+
+	// Pitch (y-axis rotation)
+	const float t_SinP = 2 * (p_Q.w * p_Q.y - p_Q.z * p_Q.x);
+	if (std::abs(t_SinP) >= 1)
+		t_Euler.y = std::copysign(M_PI / 2, t_SinP); // Use 90 degrees if out of range
+	else
+		t_Euler.y = std::asin(t_SinP);
+
+	// Yaw (z-axis rotation)
+	const float t_SinYCosP = 2 * (p_Q.w * p_Q.z + p_Q.x * p_Q.y);
+	const float t_CosYCosP = 1 - 2 * (p_Q.y * p_Q.y + p_Q.z * p_Q.z);
+	t_Euler.z = std::atan2(t_SinYCosP, t_CosYCosP);
+
+	return t_Euler;
+}
+
+SkeletonPublisher::SkeletonPublisher(const rclcpp::Node::SharedPtr& p_Node, const std::string& p_Prefix)
+{
+	m_XPublisher = p_Node->create_publisher<std_msgs::msg::Float32MultiArray>(p_Prefix + "x_manus_rotations", 10);
+	m_YPublisher = p_Node->create_publisher<std_msgs::msg::Float32MultiArray>(p_Prefix + "y_manus_rotations", 10);
+	m_ZPublisher = p_Node->create_publisher<std_msgs::msg::Float32MultiArray>(p_Prefix + "z_manus_rotations", 10);
+	m_PositionPublisher = p_Node->create_publisher<std_msgs::msg::Float32MultiArray>(p_Prefix + "manus_positions", 10);
+	m_QuaternionPublisher = p_Node->create_publisher<std_msgs::msg::Float32MultiArray>(p_Prefix + "manus_quats", 10);
+	m_StampPublisher = p_Node->create_publisher<std_msgs::msg::Header>(p_Prefix + "manus_stamps", 10);
+}
+
+const std::string& SkeletonPublisher::GetFramePrefix(const uint32_t p_SkeletonId)
+{
+	for (const std::pair<uint32_t, std::string>& t_Prefix : m_FramePrefixes)
+	{
+		if (t_Prefix.first == p_SkeletonId) return t_Prefix.second;
+	}
+	// skeleton ids change when Core reconnects, forget the old ones rather than growing forever.
+	if (m_FramePrefixes.size() >= MAX_NUMBER_OF_SKELETONS) m_FramePrefixes.clear();
+	m_FramePrefixes.emplace_back(p_SkeletonId, "manus_skeleton_" + std::to_string(p_SkeletonId) + "/");
+	return m_FramePrefixes.back().second;
+}
+
+void SkeletonPublisher::Publish(const SkeletonInfo& p_Info, const SkeletonNode* const p_Nodes, const builtin_interfaces::msg::Time& p_Stamp, const uint32_t p_Frame)
+{
+	m_StampMessage.stamp = p_Stamp;
+	// assigned and appended in place, so the frame id keeps its capacity and does not allocate.
+	char t_Frame[16];
+	const std::to_chars_result t_FrameEnd = std::to_chars(t_Frame, t_Frame + sizeof(t_Frame), p_Frame);
+	m_StampMessage.frame_id.assign(GetFramePrefix(p_Info.id));
+	m_StampMessage.frame_id.append(t_Frame, t_FrameEnd.ptr);
+
+	// the messages keep their capacity between calls.
+	m_XMessage.data.clear();
+	m_YMessage.data.clear();
+	m_ZMessage.data.clear();
+	m_PositionMessage.data.clear();
+	m_QuaternionMessage.data.clear();
+
+	for (uint32_t i = 0; i < p_Info.nodesCount; i++)
+	{
+		const ManusTransform& t_Transform = p_Nodes[i].transform;
+
+		m_PositionMessage.data.push_back(t_Transform.position.x);
+		m_PositionMessage.data.push_back(t_Transform.position.y);
+		m_PositionMessage.data.push_back(t_Transform.position.z);
+
+		// manus_mocap_core.py expects scipy order, x y z w.
+		m_QuaternionMessage.data.push_back(t_Transform.rotation.x);
+		m_QuaternionMessage.data.push_back(t_Transform.rotation.y);
+		m_QuaternionMessage.data.push_back(t_Transform.rotation.z);
+		m_QuaternionMessage.data.push_back(t_Transform.rotation.w);
+
+		const ManusVec3 t_Euler = QuaternionToEuler(t_Transform.rotation);
+		m_XMessage.data.push_back(t_Euler.x);
+		m_YMessage.data.push_back(t_Euler.y);
+		m_ZMessage.data.push_back(t_Euler.z);
+	}
+
+	// one dimension, the nodes, labelled like the stamp. the data stays a flat array, as manus_mocap_core.py reads it.
+	const std::pair<std_msgs::msg::Float32MultiArray*, uint32_t> t_Arrays[] = {
+		{ &m_XMessage, 1 }, { &m_YMessage, 1 }, { &m_ZMessage, 1 }, { &m_PositionMessage, 3 }, { &m_QuaternionMessage, 4 } };
+	for (const std::pair<std_msgs::msg::Float32MultiArray*, uint32_t>& t_Array : t_Arrays)
+	{
+		t_Array.first->layout.dim.resize(1);
+		t_Array.first->layout.dim[0].label.assign(m_StampMessage.frame_id);
+		t_Array.first->layout.dim[0].size = p_Info.nodesCount;
+		t_Array.first->layout.dim[0].stride = p_Info.nodesCount * t_Array.second;
+	}
+
+	m_XPublisher->publish(m_XMessage);
+	m_YPublisher->publish(m_YMessage);
+	m_ZPublisher->publish(m_ZMessage);
+	m_PositionPublisher->publish(m_PositionMessage);
+	m_QuaternionPublisher->publish(m_QuaternionMessage);
+	m_StampPublisher->publish(m_StampMessage);
+}
@@ -0,0 +1,66 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _SKELETON_PUBLISHER_HPP_
+#define _SKELETON_PUBLISHER_HPP_
+
+#include "ManusSDKTypes.h"
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/float32_multi_array.hpp"
+#include "std_msgs/msg/header.hpp"
+
+// std::string
+#include <string>
+// std::pair
+#include <utility>
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup SDKMinimalClient
+ *  @{
+ */
+
+/// @brief Publishes one skeleton on the topics manus_mocap_core.py listens to:
+/// x/y/z_manus_rotations (euler angles per node), manus_positions (xyz per node)
+/// and manus_quats (xyzw per node).
+/// The arrays have no header, so each skeleton is followed by a std_msgs/Header on manus_stamps with
+/// its capture time and manus_skeleton_<id>/<frame> as the frame id, <frame> counting the frames of
+/// the publishing node. The layout of every array has one dimension, the nodes, labelled with the
+/// same string, so an array is paired with its stamp by the label rather than by arrival order.
+/// Shared by manus_right and manus_replay so a replayed session looks exactly like a live one.
+class SkeletonPublisher
+{
+public:
+	/// @param p_Prefix put in front of every topic name, e.g. "user1/left/" for a second hand.
+	explicit SkeletonPublisher(const rclcpp::Node::SharedPtr& p_Node, const std::string& p_Prefix = std::string());
+
+	/// @param p_Frame the frame the skeleton is part of, the same for every skeleton of a frame.
+	void Publish(const SkeletonInfo& p_Info, const SkeletonNode* const p_Nodes, const builtin_interfaces::msg::Time& p_Stamp, const uint32_t p_Frame);
+
+protected:
+	/// @brief "manus_skeleton_<id>/" for p_SkeletonId, built the first time the skeleton is seen.
+	const std::string& GetFramePrefix(const uint32_t p_SkeletonId);
+
+	rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr m_XPublisher;
+	rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr m_YPublisher;
+	rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr m_ZPublisher;
+	rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr m_PositionPublisher;
+	rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr m_QuaternionPublisher;
+	rclcpp::Publisher<std_msgs::msg::Header>::SharedPtr m_StampPublisher;
+
+	std_msgs::msg::Float32MultiArray m_XMessage;
+	std_msgs::msg::Float32MultiArray m_YMessage;
+	std_msgs::msg::Float32MultiArray m_ZMessage;
+	std_msgs::msg::Float32MultiArray m_PositionMessage;
+	std_msgs::msg::Float32MultiArray m_QuaternionMessage;
+	std_msgs::msg::Header m_StampMessage;
+	std::vector<std::pair<uint32_t, std::string>> m_FramePrefixes;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
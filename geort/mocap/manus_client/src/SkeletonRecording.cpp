@@ -0,0 +1,268 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "SkeletonRecording.hpp"
+#include "SDKMinimalClient.hpp"
+
+// std::min
+#include <algorithm>
+// std::chrono::steady_clock
+#include <chrono>
+// std::memcpy, std::memset
+#include <cstring>
+#include <iostream>
+
+// mmap
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// the file stores these structs as the SDK lays them out, readers rely on these sizes.
+static_assert(sizeof(SkeletonRecordingHeader) == 64, "SkeletonRecordingHeader layout changed.");
+static_assert(sizeof(SkeletonRecordingFrame) == 32, "SkeletonRecordingFrame layout changed.");
+static_assert(sizeof(SkeletonInfo) == 16, "SkeletonInfo is not 16 bytes, the recording format assumes it is.");
+static_assert(sizeof(SkeletonNode) == 44, "SkeletonNode is not 44 bytes, the recording format assumes it is.");
+
+static uint64_t NanosecondsSinceEpoch(const std::chrono::steady_clock::time_point p_Time)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(p_Time.time_since_epoch()).count());
+}
+
+SkeletonRecorder::SkeletonRecorder()
+{
+	m_Description = "Skeleton recording";
+	m_RecordName = "frames";
+}
+
+SkeletonRecorder::~SkeletonRecorder()
+{
+	Close();
+}
+
+bool SkeletonRecorder::Open(const std::string& p_Path, size_t p_BlockBytes, size_t p_BlockCount)
+{
+	RecordingWriterSettings t_Settings;
+	t_Settings.blockBytes = p_BlockBytes;
+	t_Settings.blockCount = p_BlockCount;
+	return Open(p_Path, t_Settings);
+}
+
+bool SkeletonRecorder::Open(const std::string& p_Path, const RecordingWriterSettings& p_Settings)
+{
+	Close();
+	m_FrameIndex = 0;
+	return RecordingBlockWriter::Open(p_Path, p_Settings);
+}
+
+bool SkeletonRecorder::RecordFrame(const ClientSkeleton* const p_Skeletons, const size_t p_SkeletonCount)
+{
+	size_t t_FrameBytes = sizeof(SkeletonRecordingFrame);
+	for (size_t i = 0; i < p_SkeletonCount; i++)
+	{
+		t_FrameBytes += sizeof(SkeletonInfo) + sizeof(SkeletonNode) * p_Skeletons[i].info.nodesCount;
+	}
+	const size_t t_Padding = (8 - t_FrameBytes % 8) % 8;
+	t_FrameBytes += t_Padding;
+
+	uint64_t t_HostTime = 0;
+	if (!BeginRecord(t_FrameBytes, t_HostTime)) return false;
+
+	SkeletonRecordingFrame t_Frame;
+	t_Frame.magic = SKELETON_RECORDING_FRAME_MAGIC;
+	t_Frame.frameBytes = static_cast<uint32_t>(t_FrameBytes);
+	t_Frame.frameIndex = m_FrameIndex++;
+	t_Frame.hostTimeNs = t_HostTime;
+	t_Frame.skeletonCount = static_cast<uint32_t>(p_SkeletonCount);
+	t_Frame.reserved = 0;
+	Append(&t_Frame, sizeof(t_Frame));
+
+	for (size_t i = 0; i < p_SkeletonCount; i++)
+	{
+		Append(&p_Skeletons[i].info, sizeof(SkeletonInfo));
+		Append(p_Skeletons[i].nodes, sizeof(SkeletonNode) * p_Skeletons[i].info.nodesCount);
+	}
+	static const char s_Zeros[8] = { 0 };
+	Append(s_Zeros, t_Padding);
+
+	EndRecord();
+	return true;
+}
+
+void SkeletonRecorder::AppendFileHeader(const uint64_t p_HostTime)
+{
+	SkeletonRecordingHeader t_Header;
+	std::memset(&t_Header, 0, sizeof(t_Header));
+	std::memcpy(t_Header.magic, SKELETON_RECORDING_MAGIC, sizeof(t_Header.magic));
+	t_Header.version = SKELETON_RECORDING_VERSION;
+	t_Header.headerBytes = sizeof(SkeletonRecordingHeader);
+	t_Header.skeletonInfoBytes = sizeof(SkeletonInfo);
+	t_Header.skeletonNodeBytes = sizeof(SkeletonNode);
+	// both clocks are read now, steadyStartNs is the time of the chunk's first frame or earlier.
+	t_Header.steadyStartNs = (std::min)(p_HostTime, NanosecondsSinceEpoch(std::chrono::steady_clock::now()));
+	t_Header.systemStartNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count());
+	Append(&t_Header, sizeof(t_Header));
+}
+
+SkeletonRecordingReader::SkeletonRecordingReader()
+{
+}
+
+SkeletonRecordingReader::~SkeletonRecordingReader()
+{
+	Close();
+}
+
+bool SkeletonRecordingReader::Open(const std::string& p_Path)
+{
+	Close();
+
+	const int t_Descriptor = open(p_Path.c_str(), O_RDONLY);
+	if (t_Descriptor < 0)
+	{
+		std::cerr << "Could not open skeleton recording " << p_Path << "." << std::endl;
+		return false;
+	}
+
+	struct stat t_Stat;
+	if (fstat(t_Descriptor, &t_Stat) != 0 || static_cast<size_t>(t_Stat.st_size) < sizeof(SkeletonRecordingHeader))
+	{
+		std::cerr << "Skeleton recording " << p_Path << " is too small." << std::endl;
+		close(t_Descriptor);
+		return false;
+	}
+
+	void* const t_Mapping = mmap(nullptr, static_cast<size_t>(t_Stat.st_size), PROT_READ, MAP_SHARED, t_Descriptor, 0);
+	// the mapping keeps the file alive, the descriptor is no longer needed.
+	close(t_Descriptor);
+	if (t_Mapping == MAP_FAILED)
+	{
+		std::cerr << "Could not mmap skeleton recording " << p_Path << "." << std::endl;
+		return false;
+	}
+	madvise(t_Mapping, static_cast<size_t>(t_Stat.st_size), MADV_SEQUENTIAL);
+
+	m_Data = static_cast<const unsigned char*>(t_Mapping);
+	m_Size = static_cast<size_t>(t_Stat.st_size);
+
+	const SkeletonRecordingHeader* const t_Header = GetHeader();
+	if (std::memcmp(t_Header->magic, SKELETON_RECORDING_MAGIC, sizeof(t_Header->magic)) != 0
+		|| t_Header->version != SKELETON_RECORDING_VERSION
+		|| t_Header->headerBytes != sizeof(SkeletonRecordingHeader)
+		|| t_Header->skeletonInfoBytes != sizeof(SkeletonInfo)
+		|| t_Header->skeletonNodeBytes != sizeof(SkeletonNode))
+	{
+		std::cerr << "Skeleton recording " << p_Path << " has an unknown format or version." << std::endl;
+		Close();
+		return false;
+	}
+
+	// walk the frames and check that everything inside each one fits, so GetSkeletons can trust them.
+	uint64_t t_Offset = t_Header->headerBytes;
+	while (t_Offset + sizeof(SkeletonRecordingFrame) <= m_Size)
+	{
+		SkeletonRecordingFrame t_Frame;
+		std::memcpy(&t_Frame, m_Data + t_Offset, sizeof(t_Frame));
+		if (t_Frame.magic != SKELETON_RECORDING_FRAME_MAGIC || t_Frame.frameBytes < sizeof(t_Frame)
+			|| t_Frame.frameBytes % 8 != 0 || t_Offset + t_Frame.frameBytes > m_Size)
+		{
+			break;
+		}
+
+		uint64_t t_Used = sizeof(SkeletonRecordingFrame);
+		bool t_Valid = true;
+		for (uint32_t i = 0; t_Valid && i < t_Frame.skeletonCount; i++)
+		{
+			SkeletonInfo t_Info;
+			t_Valid = t_Used + sizeof(SkeletonInfo) <= t_Frame.frameBytes;
+			if (!t_Valid) break;
+			std::memcpy(&t_Info, m_Data + t_Offset + t_Used, sizeof(t_Info));
+			t_Used += sizeof(SkeletonInfo) + sizeof(SkeletonNode) * static_cast<uint64_t>(t_Info.nodesCount);
+			t_Valid = t_Used <= t_Frame.frameBytes;
+		}
+		if (!t_Valid)
+		{
+			break;
+		}
+
+		m_FrameOffsets.push_back(t_Offset);
+		t_Offset += t_Frame.frameBytes;
+	}
+
+	if (t_Offset != m_Size)
+	{
+		std::cerr << "Skeleton recording " << p_Path << " has " << (m_Size - t_Offset)
+			<< " trailing bytes that are not a complete frame, they are ignored." << std::endl;
+	}
+	return true;
+}
+
+void SkeletonRecordingReader::Close()
+{
+	if (m_Data != nullptr)
+	{
+		munmap(const_cast<unsigned char*>(m_Data), m_Size);
+	}
+	m_Data = nullptr;
+	m_Size = 0;
+	m_FrameOffsets.clear();
+}
+
+const SkeletonRecordingFrame* SkeletonRecordingReader::GetFrame(const size_t p_Index) const
+{
+	return reinterpret_cast<const SkeletonRecordingFrame*>(m_Data + m_FrameOffsets[p_Index]);
+}
+
+void SkeletonRecordingReader::GetSkeletons(const size_t p_Index, std::vector<RecordedSkeleton>& p_Skeletons) const
+{
+	const SkeletonRecordingFrame* const t_Frame = GetFrame(p_Index);
+	const unsigned char* t_Cursor = m_Data + m_FrameOffsets[p_Index] + sizeof(SkeletonRecordingFrame);
+
+	p_Skeletons.resize(t_Frame->skeletonCount);
+	for (RecordedSkeleton& t_Skeleton : p_Skeletons)
+	{
+		// SkeletonInfo holds a 64 bit timestamp but is only 4 byte aligned in the file, copy it out.
+		std::memcpy(&t_Skeleton.info, t_Cursor, sizeof(SkeletonInfo));
+		t_Cursor += sizeof(SkeletonInfo);
+		t_Skeleton.nodes = reinterpret_cast<const SkeletonNode*>(t_Cursor);
+		t_Cursor += sizeof(SkeletonNode) * t_Skeleton.info.nodesCount;
+	}
+}
+
+bool SkeletonRecordingReader::ReadFrame(const size_t p_Index, SkeletonRecordingFrame& p_Header, std::vector<RecordedSkeleton>& p_Skeletons) const
+{
+	if (p_Index >= m_FrameOffsets.size()) return false;
+	std::memcpy(&p_Header, GetFrame(p_Index), sizeof(p_Header));
+	GetSkeletons(p_Index, p_Skeletons);
+	return true;
+}
+
+bool SkeletonRecordingReader::FindFirstFrame(const RecordingFrameKey& p_Key, const int64_t p_Target, size_t& p_Frame) const
+{
+	size_t t_Low = 0;
+	size_t t_High = m_FrameOffsets.size();
+	SkeletonRecordingFrame t_Frame;
+	while (t_Low < t_High)
+	{
+		const size_t t_Middle = t_Low + (t_High - t_Low) / 2;
+		std::memcpy(&t_Frame, GetFrame(t_Middle), sizeof(t_Frame));
+		SkeletonInfo t_Info;
+		uint64_t t_PublishTime = 0;
+		if (t_Frame.skeletonCount > 0)
+		{
+			std::memcpy(&t_Info, m_Data + m_FrameOffsets[t_Middle] + sizeof(SkeletonRecordingFrame), sizeof(t_Info));
+			t_PublishTime = t_Info.publishTime.time;
+		}
+
+		int64_t t_Key = 0;
+		if (!p_Key(t_Frame, t_PublishTime, t_Key)) return false;
+		if (t_Key < p_Target) t_Low = t_Middle + 1;
+		else t_High = t_Middle;
+	}
+	p_Frame = t_Low;
+	return true;
+}
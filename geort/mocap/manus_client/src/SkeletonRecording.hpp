@@ -0,0 +1,158 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _SKELETON_RECORDING_HPP_
+#define _SKELETON_RECORDING_HPP_
+
+#include "ManusSDKTypes.h"
+#include "RecordingBlockWriter.hpp"
+
+// size_t
+#include <cstddef>
+// uint32_t, uint64_t
+#include <cstdint>
+// std::function
+#include <functional>
+// std::string
+#include <string>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTRecording
+ *  @{
+ */
+
+/// @brief A skeleton recording is the exact stream OnSkeletonStreamCallback receives, one frame
+/// per callback, appended to a single file.
+///
+/// File layout, little endian, the file can be mmapped and walked in place:
+///   SkeletonRecordingHeader (64 bytes)
+///   frames, back to back, each one:
+///     SkeletonRecordingFrame (32 bytes)
+///     per skeleton: SkeletonInfo (16 bytes, includes publishTime), SkeletonNode[info.nodesCount] (44 bytes each)
+///     zero padding up to frameBytes, which is a multiple of 8.
+///
+/// SkeletonInfo and SkeletonNode are stored exactly as the Manus SDK defines them, publishTime is
+/// the compressed ManusTimestamp, decode it with CoreSdk_GetTimestampInfo. hostTimeNs is
+/// std::chrono::steady_clock at the time of the callback, the header stores the steady and system
+/// clocks at the moment the file was opened so host time can be turned into wall time.
+///
+/// A file that was not closed cleanly (crash, power loss) ends with a partially written frame.
+/// Readers stop at the first frame whose magic is wrong or whose frameBytes runs past the end of
+/// the file.
+
+/// @brief Magic bytes at the start of a skeleton recording.
+#define SKELETON_RECORDING_MAGIC "GEORTREC"
+/// @brief Bumped whenever the layout below changes.
+#define SKELETON_RECORDING_VERSION 1
+/// @brief "FRME", at the start of every frame.
+#define SKELETON_RECORDING_FRAME_MAGIC 0x454D5246u
+
+typedef struct SkeletonRecordingHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t headerBytes;
+	uint32_t skeletonInfoBytes; // sizeof(SkeletonInfo) of the writer.
+	uint32_t skeletonNodeBytes; // sizeof(SkeletonNode) of the writer.
+	uint64_t steadyStartNs;
+	uint64_t systemStartNs; // nanoseconds since the unix epoch.
+	uint8_t reserved[24];
+} SkeletonRecordingHeader;
+
+typedef struct SkeletonRecordingFrame
+{
+	uint32_t magic;
+	uint32_t frameBytes; // including this header and the padding.
+	uint64_t frameIndex;
+	uint64_t hostTimeNs;
+	uint32_t skeletonCount;
+	uint32_t reserved;
+} SkeletonRecordingFrame;
+
+class ClientSkeleton;
+
+/// @brief Appends skeleton frames to a recording without ever blocking the SDK callback on I/O.
+/// Buffering, rotation and the disk budget are those of RecordingBlockWriter, every chunk is a
+/// complete skeleton recording that starts on a frame boundary.
+class SkeletonRecorder : public RecordingBlockWriter
+{
+public:
+	SkeletonRecorder();
+	~SkeletonRecorder();
+
+	/// @brief Create p_Path (or its first chunk) and start the writer thread.
+	bool Open(const std::string& p_Path, const RecordingWriterSettings& p_Settings);
+
+	/// @brief Open without rotation or disk budget.
+	/// @param p_BlockBytes size of every write, rounded up to a multiple of 4096.
+	/// @param p_BlockCount number of blocks, this bounds the memory use and how far the disk may fall behind.
+	bool Open(const std::string& p_Path, size_t p_BlockBytes = 1 << 20, size_t p_BlockCount = 16);
+
+	/// @brief Queue one callback's worth of skeletons. Safe to call from the SDK callback thread.
+	/// @return false if the recorder is closed or the frame had to be dropped.
+	bool RecordFrame(const ClientSkeleton* const p_Skeletons, const size_t p_SkeletonCount);
+
+	uint64_t GetFramesRecorded() const { return GetRecordsRecorded(); }
+	uint64_t GetFramesDropped() const { return GetRecordsDropped(); }
+
+protected:
+	void AppendFileHeader(const uint64_t p_HostTime) override;
+
+	uint64_t m_FrameIndex = 0; // guarded by the writer lock.
+};
+
+/// @brief One skeleton of a recorded frame. The nodes point into the mapped file.
+class RecordedSkeleton
+{
+public:
+	SkeletonInfo info;
+	const SkeletonNode* nodes = nullptr;
+};
+
+/// @brief Sort key of a recorded frame for seeking, e.g. its host time or its decoded publishTime.
+/// p_PublishTime is the publishTime of the first skeleton, 0 if the frame has none. Return false
+/// if the frame has no key. The key must not decrease over the recording.
+typedef std::function<bool(const SkeletonRecordingFrame& p_Frame, const uint64_t p_PublishTime, int64_t& p_Key)> RecordingFrameKey;
+
+/// @brief Maps a skeleton recording read-only and indexes its frames.
+/// Open walks the frame headers once, after that every frame is reached in constant time and
+/// the node data is read straight from the mapping.
+class SkeletonRecordingReader
+{
+public:
+	SkeletonRecordingReader();
+	~SkeletonRecordingReader();
+
+	/// @brief Map p_Path and index its frames. A torn last frame is ignored with a warning.
+	bool Open(const std::string& p_Path);
+	void Close();
+
+	const SkeletonRecordingHeader* GetHeader() const { return reinterpret_cast<const SkeletonRecordingHeader*>(m_Data); }
+	size_t GetFrameCount() const { return m_FrameOffsets.size(); }
+	const SkeletonRecordingFrame* GetFrame(const size_t p_Index) const;
+
+	/// @brief Fill p_Skeletons with the skeletons of frame p_Index.
+	void GetSkeletons(const size_t p_Index, std::vector<RecordedSkeleton>& p_Skeletons) const;
+
+	/// @brief GetFrame and GetSkeletons in one call, the same interface CompressedRecordingReader has.
+	bool ReadFrame(const size_t p_Index, SkeletonRecordingFrame& p_Header, std::vector<RecordedSkeleton>& p_Skeletons) const;
+
+	/// @brief Binary search for the first frame whose p_Key is at least p_Target, the frame count if
+	/// there is none. @return false if p_Key failed on a frame it had to look at.
+	bool FindFirstFrame(const RecordingFrameKey& p_Key, const int64_t p_Target, size_t& p_Frame) const;
+
+protected:
+	const unsigned char* m_Data = nullptr;
+	size_t m_Size = 0;
+	std::vector<uint64_t> m_FrameOffsets;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,128 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "SkeletonSetupCache.hpp"
+
+// std::max, std::sort
+#include <algorithm>
+// std::memcmp
+#include <cstring>
+// std::filesystem::create_directories, std::filesystem::rename
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+// std::pair
+#include <utility>
+
+/// @brief Start of every cache file.
+static const char s_Magic[8] = { 'G', 'R', 'T', 'S', 'K', 'E', 'L', '\0' };
+
+/// @brief Larger files are not skeleton setups, a corrupt length must not allocate gigabytes.
+static const uint32_t s_MaxDataBytes = 16u << 20;
+
+void SkeletonSetupCache::Configure(const std::string& p_Folder, const uint32_t p_SetupVersion, const size_t p_MaxFiles)
+{
+	m_Folder = p_Folder;
+	m_SetupVersion = p_SetupVersion;
+	m_MaxFiles = (std::max)(p_MaxFiles, static_cast<size_t>(1));
+	if (m_Folder.empty()) return;
+
+	std::error_code t_Error;
+	std::filesystem::create_directories(m_Folder, t_Error);
+	if (t_Error)
+	{
+		std::cerr << "Cannot create the skeleton cache folder " << m_Folder << ", skeletons are set up without it." << std::endl;
+		m_Folder.clear();
+	}
+}
+
+std::string SkeletonSetupCache::GetPath(const SkeletonTargetType p_TargetType, const uint32_t p_Target, const Side p_Side) const
+{
+	const char* const t_Target = p_TargetType == SkeletonTargetType::SkeletonTargetType_UserIndexData ? "userindex" : "user";
+	const char* const t_Side = p_Side == Side::Side_Left ? "left" : "right";
+	return (std::filesystem::path(m_Folder) / (std::string(t_Side) + "_hand_" + t_Target + std::to_string(p_Target) + ".skel")).string();
+}
+
+bool SkeletonSetupCache::Read(const std::string& p_Path, std::vector<unsigned char>& p_Data) const
+{
+	if (!IsEnabled()) return false;
+	std::ifstream t_File(p_Path, std::ifstream::binary);
+	char t_Magic[sizeof(s_Magic)] = {};
+	uint32_t t_Version = 0;
+	uint32_t t_Length = 0;
+	t_File.read(t_Magic, sizeof(t_Magic));
+	t_File.read(reinterpret_cast<char*>(&t_Version), sizeof(t_Version));
+	t_File.read(reinterpret_cast<char*>(&t_Length), sizeof(t_Length));
+	if (!t_File || std::memcmp(t_Magic, s_Magic, sizeof(s_Magic)) != 0 || t_Version != m_SetupVersion || t_Length == 0 || t_Length > s_MaxDataBytes)
+	{
+		return false;
+	}
+
+	p_Data.resize(t_Length);
+	t_File.read(reinterpret_cast<char*>(p_Data.data()), t_Length);
+	if (!t_File) return false;
+
+	// the modification time is the last use, Prune keeps the files in use.
+	std::error_code t_Error;
+	std::filesystem::last_write_time(p_Path, std::filesystem::file_time_type::clock::now(), t_Error);
+	return true;
+}
+
+bool SkeletonSetupCache::Write(const std::string& p_Path, const std::vector<unsigned char>& p_Data) const
+{
+	if (!IsEnabled() || p_Data.empty()) return false;
+	const std::string t_TemporaryPath = p_Path + ".tmp";
+	{
+		std::ofstream t_File(t_TemporaryPath, std::ofstream::binary | std::ofstream::trunc);
+		const uint32_t t_Length = static_cast<uint32_t>(p_Data.size());
+		t_File.write(s_Magic, sizeof(s_Magic));
+		t_File.write(reinterpret_cast<const char*>(&m_SetupVersion), sizeof(m_SetupVersion));
+		t_File.write(reinterpret_cast<const char*>(&t_Length), sizeof(t_Length));
+		t_File.write(reinterpret_cast<const char*>(p_Data.data()), t_Length);
+		// closing flushes the last of the data, only a file that was written completely replaces the old one.
+		t_File.close();
+		if (t_File.fail())
+		{
+			std::cerr << "Cannot write the skeleton cache " << t_TemporaryPath << "." << std::endl;
+			std::error_code t_Error;
+			std::filesystem::remove(t_TemporaryPath, t_Error);
+			return false;
+		}
+	}
+
+	std::error_code t_Error;
+	std::filesystem::rename(t_TemporaryPath, p_Path, t_Error);
+	if (t_Error)
+	{
+		std::cerr << "Cannot replace the skeleton cache " << p_Path << "." << std::endl;
+		std::filesystem::remove(t_TemporaryPath, t_Error);
+		return false;
+	}
+	Prune();
+	return true;
+}
+
+void SkeletonSetupCache::Prune() const
+{
+	std::error_code t_Error;
+	std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> t_Files;
+	for (std::filesystem::directory_iterator t_Entry(m_Folder, t_Error), t_End; !t_Error && t_Entry != t_End; t_Entry.increment(t_Error))
+	{
+		if (t_Entry->path().extension() != ".skel") continue;
+		std::error_code t_TimeError;
+		const std::filesystem::file_time_type t_Time = std::filesystem::last_write_time(t_Entry->path(), t_TimeError);
+		if (!t_TimeError) t_Files.emplace_back(t_Time, t_Entry->path());
+	}
+	if (t_Files.size() <= m_MaxFiles) return;
+
+	// newest first, everything after the first m_MaxFiles goes.
+	std::sort(t_Files.begin(), t_Files.end(), [](const std::pair<std::filesystem::file_time_type, std::filesystem::path>& p_A,
+		const std::pair<std::filesystem::file_time_type, std::filesystem::path>& p_B) { return p_A.first > p_B.first; });
+	for (size_t i = m_MaxFiles; i < t_Files.size(); i++)
+	{
+		std::filesystem::remove(t_Files[i].second, t_Error);
+	}
+}
@@ -0,0 +1,66 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _SKELETON_SETUP_CACHE_HPP_
+#define _SKELETON_SETUP_CACHE_HPP_
+
+#include "ManusSDKTypes.h"
+
+// uint32_t
+#include <cstdint>
+// std::string
+#include <string>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup SDKMinimalClient
+ *  @{
+ */
+
+/// @brief Skeleton setups compressed by Core, kept on disk so a restart can restore a setup in one
+/// call instead of adding every node and chain again.
+///
+/// There is one file per target and hand side, because the target is part of the compressed setup
+/// and cannot be changed after restoring it. A file holds:
+///
+///   char[8]   magic "GRTSKEL\0"
+///   uint32_t  setup version, see Configure
+///   uint32_t  length of the data in bytes
+///   uint8_t[] the data from CoreSdk_GetCompressedTemporarySkeletonData
+///
+/// Files are replaced with a rename, so a crash while writing never leaves a half written one.
+/// Skeletons that follow a user id get a file per id, so every Write removes the least recently
+/// used files beyond the limit given to Configure. Read marks a file as used.
+class SkeletonSetupCache
+{
+public:
+	/// @param p_Folder where the files go, empty turns the cache off.
+	/// @param p_SetupVersion stored in every file, files with another version are ignored. Bump it
+	/// when the setup that is built changes.
+	/// @param p_MaxFiles how many files the folder keeps, at least 1.
+	void Configure(const std::string& p_Folder, const uint32_t p_SetupVersion, const size_t p_MaxFiles);
+
+	bool IsEnabled() const { return !m_Folder.empty(); }
+	std::string GetPath(const SkeletonTargetType p_TargetType, const uint32_t p_Target, const Side p_Side) const;
+
+	/// @brief Read the data of p_Path, false if there is none or it is of another setup version.
+	bool Read(const std::string& p_Path, std::vector<unsigned char>& p_Data) const;
+	bool Write(const std::string& p_Path, const std::vector<unsigned char>& p_Data) const;
+
+protected:
+	/// @brief Remove the least recently used files beyond m_MaxFiles.
+	void Prune() const;
+
+	std::string m_Folder;
+	uint32_t m_SetupVersion = 0;
+	size_t m_MaxFiles = 1;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
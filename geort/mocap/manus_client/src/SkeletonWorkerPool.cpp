@@ -0,0 +1,237 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "SkeletonWorkerPool.hpp"
+
+// std::max, std::rotate
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+// std::string
+#include <string>
+// std::swap
+#include <utility>
+
+SkeletonWorkerPool::SkeletonWorkerPool(const rclcpp::Node::SharedPtr& p_Node, const size_t p_WorkerCount, const uint32_t p_RouteCount, const RealtimeSettings& p_Settings, const bool p_Print)
+	: m_Node(p_Node)
+	, m_Publishers(p_RouteCount)
+	, m_Latencies(p_RouteCount)
+	, m_Settings(p_Settings)
+	, m_Print(p_Print)
+{
+	const size_t t_WorkerCount = (std::max)(p_WorkerCount, static_cast<size_t>(1));
+	for (size_t i = 0; i < t_WorkerCount; i++)
+	{
+		m_Workers.emplace_back(new Worker());
+	}
+	// only start the threads once every worker exists.
+	for (size_t i = 0; i < t_WorkerCount; i++)
+	{
+		Worker& t_Worker = *m_Workers[i];
+		t_Worker.thread = std::thread(&SkeletonWorkerPool::RunWorker, this, std::ref(t_Worker), i);
+	}
+}
+
+SkeletonWorkerPool::~SkeletonWorkerPool()
+{
+	Stop();
+}
+
+void SkeletonWorkerPool::Stop()
+{
+	for (std::unique_ptr<Worker>& t_Worker : m_Workers)
+	{
+		std::lock_guard<std::mutex> t_Lock(t_Worker->mutex);
+		t_Worker->stop = true;
+		t_Worker->wake.notify_one();
+		t_Worker->space.notify_all();
+	}
+	for (std::unique_ptr<Worker>& t_Worker : m_Workers)
+	{
+		if (t_Worker->thread.joinable()) t_Worker->thread.join();
+	}
+}
+
+void SkeletonWorkerPool::Configure(const FrameHandoffPolicy p_Policy, const size_t p_Slots)
+{
+	m_Policy = p_Policy;
+	// latest is a queue of one frame that is replaced.
+	m_Slots = p_Policy == FrameHandoffPolicy::FrameHandoffPolicy_Latest ? 1 : (std::max)(p_Slots, static_cast<size_t>(1));
+}
+
+size_t SkeletonWorkerPool::GetWorkerIndex(const uint32_t p_Route) const
+{
+	// the murmur3 finalizer, every bit of the route affects the worker.
+	uint32_t t_Hash = p_Route;
+	t_Hash ^= t_Hash >> 16;
+	t_Hash *= 0x85EBCA6Bu;
+	t_Hash ^= t_Hash >> 13;
+	t_Hash *= 0xC2B2AE35u;
+	t_Hash ^= t_Hash >> 16;
+	return static_cast<size_t>(t_Hash) % m_Workers.size();
+}
+
+void SkeletonWorkerPool::AddRoute(const uint32_t p_Route, const std::string& p_Prefix)
+{
+	if (p_Route >= m_Publishers.size() || m_Publishers[p_Route] != nullptr) return;
+	// the worker first sees the publisher through its mailbox lock, so it is complete by then.
+	m_Publishers[p_Route].reset(new SkeletonPublisher(m_Node, p_Prefix));
+	m_Latencies[p_Route].reset(new RouteLatency());
+	m_Latencies[p_Route]->prefix = p_Prefix;
+}
+
+void SkeletonWorkerPool::Add(const SkeletonInfo& p_Info, const SkeletonNode* const p_Nodes, const builtin_interfaces::msg::Time& p_Stamp, const uint32_t p_Frame,
+	const uint32_t p_Route, const double p_CaptureMs, const double p_ReceiveMs)
+{
+	if (p_Route >= m_Publishers.size() || m_Publishers[p_Route] == nullptr) return;
+	// staged without the lock, Submit hands the whole frame over at once.
+	Worker& t_Worker = *m_Workers[GetWorkerIndex(p_Route)];
+	if (t_Worker.stagedCount == t_Worker.staged.size()) t_Worker.staged.emplace_back();
+	SkeletonWorkItem& t_Item = t_Worker.staged[t_Worker.stagedCount++];
+	t_Item.info = p_Info;
+	t_Item.nodes.assign(p_Nodes, p_Nodes + p_Info.nodesCount);
+	t_Item.stamp = p_Stamp;
+	t_Item.frame = p_Frame;
+	t_Item.route = p_Route;
+	t_Item.captureMs = p_CaptureMs;
+	t_Item.receiveMs = p_ReceiveMs;
+}
+
+void SkeletonWorkerPool::Submit()
+{
+	for (std::unique_ptr<Worker>& t_Worker : m_Workers)
+	{
+		if (t_Worker->stagedCount == 0) continue;
+		std::unique_lock<std::mutex> t_Lock(t_Worker->mutex);
+		if (m_Policy == FrameHandoffPolicy::FrameHandoffPolicy_Block)
+		{
+			t_Worker->space.wait(t_Lock, [this, &t_Worker]() { return t_Worker->stop || t_Worker->frameEnds.size() < m_Slots; });
+		}
+		else if (t_Worker->frameEnds.size() >= m_Slots)
+		{
+			SkipOldestFrame(*t_Worker);
+		}
+		if (t_Worker->stop)
+		{
+			t_Worker->stagedCount = 0;
+			continue;
+		}
+
+		// swapping the items keeps the capacity of their node buffers on both sides.
+		for (size_t i = 0; i < t_Worker->stagedCount; i++)
+		{
+			if (t_Worker->pendingCount == t_Worker->pending.size()) t_Worker->pending.emplace_back();
+			std::swap(t_Worker->pending[t_Worker->pendingCount++], t_Worker->staged[i]);
+		}
+		t_Worker->stagedCount = 0;
+		t_Worker->frameEnds.push_back(t_Worker->pendingCount);
+		t_Worker->wake.notify_one();
+	}
+}
+
+void SkeletonWorkerPool::SkipOldestFrame(Worker& p_Worker)
+{
+	const size_t t_End = p_Worker.frameEnds.front();
+	// rotating instead of erasing keeps the skipped items, and their buffers, for later frames.
+	std::rotate(p_Worker.pending.begin(), p_Worker.pending.begin() + t_End, p_Worker.pending.begin() + p_Worker.pendingCount);
+	p_Worker.pendingCount -= t_End;
+	p_Worker.frameEnds.erase(p_Worker.frameEnds.begin());
+	for (size_t& t_FrameEnd : p_Worker.frameEnds) t_FrameEnd -= t_End;
+	p_Worker.skipped++;
+}
+
+uint64_t SkeletonWorkerPool::GetSkippedCount() const
+{
+	uint64_t t_Skipped = 0;
+	for (const std::unique_ptr<Worker>& t_Worker : m_Workers)
+	{
+		std::lock_guard<std::mutex> t_Lock(t_Worker->mutex);
+		t_Skipped += t_Worker->skipped;
+	}
+	return t_Skipped;
+}
+
+void SkeletonWorkerPool::PrintLatency() const
+{
+	for (const std::unique_ptr<RouteLatency>& t_Latency : m_Latencies)
+	{
+		if (t_Latency == nullptr || t_Latency->fromCapture.GetCount() == 0) continue;
+		std::cout << "Latency of " << (t_Latency->prefix.empty() ? "the default topics" : t_Latency->prefix) << " over " << t_Latency->fromCapture.GetCount() << " skeletons:\n";
+		const std::pair<const char*, const LatencyStatistics*> t_Rows[] = { { "capture to publish", &t_Latency->fromCapture }, { "callback to publish", &t_Latency->fromReceive } };
+		for (const std::pair<const char*, const LatencyStatistics*>& t_Row : t_Rows)
+		{
+			std::cout << "  " << t_Row.first << ": mean " << t_Row.second->GetMean() << " ms, p50 " << t_Row.second->GetPercentile(0.5)
+				<< " ms, p99 " << t_Row.second->GetPercentile(0.99) << " ms, max " << t_Row.second->GetMax() << " ms.\n";
+		}
+	}
+}
+
+LatencyStatistics SkeletonWorkerPool::GetLatency() const
+{
+	LatencyStatistics t_Latency(100.0);
+	for (const std::unique_ptr<RouteLatency>& t_Route : m_Latencies)
+	{
+		if (t_Route != nullptr) t_Latency.Add(t_Route->fromReceive);
+	}
+	return t_Latency;
+}
+
+void SkeletonWorkerPool::RunWorker(Worker& p_Worker, const size_t p_Index)
+{
+	if (m_Settings.publishPriority > 0 || !m_Settings.cpus.empty() || m_Settings.lockMemory)
+	{
+		RealtimeSettings t_Settings = m_Settings;
+		if (!t_Settings.cpus.empty()) t_Settings.cpus.assign(1, m_Settings.cpus[p_Index % m_Settings.cpus.size()]);
+		const std::string t_Name = "skeleton worker " + std::to_string(p_Index);
+		ApplyRealtimeThreadSettings(t_Settings, t_Settings.publishPriority, t_Name.c_str());
+	}
+
+	while (true)
+	{
+		size_t t_Count = 0;
+		{
+			std::unique_lock<std::mutex> t_Lock(p_Worker.mutex);
+			p_Worker.wake.wait(t_Lock, [&p_Worker]() { return p_Worker.stop || !p_Worker.frameEnds.empty(); });
+			if (p_Worker.stop) return;
+			// swapping keeps the capacity of both buffers, so frames stop allocating once they are warmed up.
+			// all queued frames are taken at once and published in order.
+			p_Worker.pending.swap(p_Worker.working);
+			t_Count = p_Worker.pendingCount;
+			p_Worker.pendingCount = 0;
+			p_Worker.frameEnds.clear();
+			p_Worker.space.notify_one();
+		}
+
+		for (size_t i = 0; i < t_Count; i++)
+		{
+			const SkeletonWorkItem& t_Item = p_Worker.working[i];
+			if (m_Print)
+			{
+				// one write per skeleton, so the output of the workers does not interleave line by line.
+				std::ostringstream& t_Text = p_Worker.text;
+				t_Text.str(std::string());
+				t_Text << "Skeleton ID: " << t_Item.info.id << "\n";
+				t_Text << "Number of joints: " << t_Item.info.nodesCount << "\n";
+				t_Text << "Publish Time: " << t_Item.info.publishTime.time << "\n";
+				for (const SkeletonNode& node : t_Item.nodes)
+				{
+					t_Text << "Joint ID: " << node.id << "\n";
+					t_Text << "Position: (" << node.transform.position.x << ", " << node.transform.position.y << ", " << node.transform.position.z << ")" << "\n";
+					t_Text << node.id << " " << node.transform.rotation.x << " " << node.transform.rotation.y << " " << node.transform.rotation.z << " " << node.transform.rotation.w << "\n";
+					t_Text << "\n";
+				}
+				std::cout << t_Text.str() << std::flush;
+			}
+
+			// Publish joint rotations, positions and quaternions as float arrays
+			m_Publishers[t_Item.route]->Publish(t_Item.info, t_Item.nodes.data(), t_Item.stamp, t_Item.frame);
+			const double t_PublishedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			RouteLatency& t_Latency = *m_Latencies[t_Item.route];
+			t_Latency.fromCapture.Add(t_PublishedMs - t_Item.captureMs);
+			t_Latency.fromReceive.Add(t_PublishedMs - t_Item.receiveMs);
+		}
+	}
+}
@@ -0,0 +1,145 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _SKELETON_WORKER_POOL_HPP_
+#define _SKELETON_WORKER_POOL_HPP_
+
+#include "FrameHandoff.hpp"
+#include "LatencyStatistics.hpp"
+#include "ManusSDKTypes.h"
+#include "RealtimeSettings.hpp"
+#include "SkeletonPublisher.hpp"
+
+#include <condition_variable>
+// std::unique_ptr
+#include <memory>
+#include <mutex>
+// std::ostringstream
+#include <sstream>
+// std::string
+#include <string>
+#include <thread>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup SDKMinimalClient
+ *  @{
+ */
+
+/// @brief One skeleton of a frame, copied so the worker does not share it with the dispatcher.
+class SkeletonWorkItem
+{
+public:
+	SkeletonInfo info;
+	std::vector<SkeletonNode> nodes;
+	builtin_interfaces::msg::Time stamp; // the capture time, see ClockMapping.hpp.
+	uint32_t frame = 0; // the frame counter of the dispatcher, see SkeletonPublisher.
+	uint32_t route = 0;
+	double captureMs = 0.0; // steady_clock milliseconds, for the latency of the route.
+	double receiveMs = 0.0;
+};
+
+/// @brief Publishes the skeletons of each frame on a small fixed pool of threads, so the last of
+/// several gloves does not wait for all the others.
+///
+/// Every skeleton is published on the topics of its route (see SkeletonProvisioner), and a route
+/// always goes to the same worker, picked by a hash of the route, which keeps the messages of one
+/// hand in order and its publisher on one thread. Every worker owns its copies of the frame and its
+/// text buffer, the dispatcher only touches a worker's mailbox under that worker's lock.
+///
+/// Every worker queues the frames it has not started on with the policy of a FrameHandoff: latest
+/// keeps only the newest frame, so a busy worker skips the older one, fifo keeps up to slots frames
+/// and skips the oldest when full, and block makes Submit wait until the worker took its frames.
+class SkeletonWorkerPool
+{
+public:
+	/// @param p_WorkerCount at least 1.
+	/// @param p_Settings the workers run with its publish priority and worker i is pinned to the
+	/// i-th CPU of its list (round robin), they are not pinned if the list is empty.
+	/// @param p_RouteCount the routes are 0 to p_RouteCount - 1.
+	/// @param p_Print also print every skeleton, as manus_right always did.
+	SkeletonWorkerPool(const rclcpp::Node::SharedPtr& p_Node, const size_t p_WorkerCount, const uint32_t p_RouteCount, const RealtimeSettings& p_Settings, const bool p_Print);
+	~SkeletonWorkerPool();
+
+	/// @brief How the workers queue frames, latest by default. Before the first Add.
+	void Configure(const FrameHandoffPolicy p_Policy, const size_t p_Slots);
+	/// @brief Create the publishers of p_Route with p_Prefix in front of the topics, if it has none yet.
+	/// From the dispatching thread, before the first Add for the route.
+	void AddRoute(const uint32_t p_Route, const std::string& p_Prefix);
+	/// @brief Copy one skeleton for the worker of p_Route, which must have been added. It gets it with
+	/// the next Submit.
+	/// @param p_CaptureMs when it was captured and p_ReceiveMs when the SDK callback got it, in
+	/// steady_clock milliseconds. Only used for the latency of the route.
+	void Add(const SkeletonInfo& p_Info, const SkeletonNode* const p_Nodes, const builtin_interfaces::msg::Time& p_Stamp, const uint32_t p_Frame,
+		const uint32_t p_Route, const double p_CaptureMs, const double p_ReceiveMs);
+	/// @brief Queue the skeletons added since the last Submit as one frame per worker and wake the
+	/// workers. Only waits for them with the block policy, while a worker has slots frames queued.
+	void Submit();
+	/// @brief Stop and join the workers, the skeletons they did not get to are dropped.
+	void Stop();
+
+	size_t GetWorkerCount() const { return m_Workers.size(); }
+	size_t GetWorkerIndex(const uint32_t p_Route) const;
+	/// @brief Frames a worker skipped because it already had as many queued as the policy allows.
+	/// Always 0 with block.
+	uint64_t GetSkippedCount() const;
+	/// @brief Per route, the latency from capture and from the SDK callback to the skeleton being
+	/// published. After Stop.
+	void PrintLatency() const;
+	/// @brief The latency from the SDK callback to publishing, of all routes together. After Stop.
+	LatencyStatistics GetLatency() const;
+
+protected:
+	class Worker
+	{
+	public:
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable space; // the worker took its frames, for Submit with the block policy.
+		bool stop = false; // guarded by mutex, and so is the mailbox.
+		size_t pendingCount = 0;
+		std::vector<SkeletonWorkItem> pending;
+		std::vector<size_t> frameEnds; // where each queued frame ends in pending, oldest first.
+		uint64_t skipped = 0;
+
+		// dispatcher thread only, the skeletons added since the last Submit.
+		size_t stagedCount = 0;
+		std::vector<SkeletonWorkItem> staged;
+
+		// worker thread only.
+		std::vector<SkeletonWorkItem> working;
+		std::ostringstream text;
+	};
+
+	void RunWorker(Worker& p_Worker, const size_t p_Index);
+	/// @brief Drop the oldest queued frame of p_Worker, with its lock held.
+	static void SkipOldestFrame(Worker& p_Worker);
+
+	rclcpp::Node::SharedPtr m_Node;
+	std::vector<std::unique_ptr<Worker>> m_Workers;
+	class RouteLatency
+	{
+	public:
+		std::string prefix;
+		LatencyStatistics fromCapture = LatencyStatistics(100.0);
+		LatencyStatistics fromReceive = LatencyStatistics(100.0);
+	};
+
+	// per route, created by AddRoute and then only used by the worker of the route.
+	std::vector<std::unique_ptr<SkeletonPublisher>> m_Publishers;
+	std::vector<std::unique_ptr<RouteLatency>> m_Latencies;
+	RealtimeSettings m_Settings;
+	bool m_Print = false;
+	FrameHandoffPolicy m_Policy = FrameHandoffPolicy::FrameHandoffPolicy_Latest;
+	size_t m_Slots = 1;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,162 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "StartupProfiler.hpp"
+
+// std::max
+#include <algorithm>
+// std::time
+#include <ctime>
+#include <fstream>
+// std::setw, std::setprecision
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static double GetMilliseconds(const std::chrono::steady_clock::duration p_Duration)
+{
+	return std::chrono::duration<double, std::milli>(p_Duration).count();
+}
+
+/// @brief p_Text as a JSON string, the notes are host names and settings so escaping quotes,
+/// backslashes and control characters is all there is to it.
+static std::string ToJsonString(const std::string& p_Text)
+{
+	std::ostringstream t_Json;
+	t_Json << '"';
+	for (const char t_Char : p_Text)
+	{
+		if (t_Char == '"' || t_Char == '\\') t_Json << '\\' << t_Char;
+		else if (static_cast<unsigned char>(t_Char) < 0x20) t_Json << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(t_Char) << std::dec;
+		else t_Json << t_Char;
+	}
+	t_Json << '"';
+	return t_Json.str();
+}
+
+const char* GetStartupPhaseName(const StartupPhase p_Phase)
+{
+	switch (p_Phase)
+	{
+	case StartupPhase::StartupPhase_PlatformInit: return "platform_init";
+	case StartupPhase::StartupPhase_SdkInitialize: return "sdk_initialize";
+	case StartupPhase::StartupPhase_Callbacks: return "callbacks";
+	case StartupPhase::StartupPhase_CoordinateSystem: return "coordinate_system";
+	case StartupPhase::StartupPhase_Discovery: return "discovery";
+	case StartupPhase::StartupPhase_Connect: return "connect";
+	case StartupPhase::StartupPhase_Landscape: return "landscape";
+	case StartupPhase::StartupPhase_SkeletonSetup: return "skeleton_setup";
+	case StartupPhase::StartupPhase_SkeletonLoad: return "skeleton_load";
+	case StartupPhase::StartupPhase_FirstCallback: return "first_callback";
+	default: return "unknown";
+	}
+}
+
+void StartupProfiler::Start()
+{
+	m_Start = std::chrono::steady_clock::now();
+	m_Last = m_Start;
+	m_Started = true;
+}
+
+void StartupProfiler::Lap(const StartupPhase p_Phase)
+{
+	if (!m_Started || m_Finished) return;
+	const std::chrono::steady_clock::time_point t_Now = std::chrono::steady_clock::now();
+	m_PhaseMs[static_cast<int>(p_Phase)] += GetMilliseconds(t_Now - m_Last);
+	m_Last = t_Now;
+}
+
+void StartupProfiler::Add(const StartupPhase p_Phase, const double p_Milliseconds)
+{
+	if (!m_Started || m_Finished) return;
+	m_PhaseMs[static_cast<int>(p_Phase)] += p_Milliseconds;
+}
+
+void StartupProfiler::Mark()
+{
+	if (!m_Started || m_Finished) return;
+	m_Last = std::chrono::steady_clock::now();
+}
+
+void StartupProfiler::SetNote(const std::string& p_Key, const std::string& p_Value)
+{
+	if (m_Finished) return;
+	for (std::pair<std::string, std::string>& t_Note : m_Notes)
+	{
+		if (t_Note.first != p_Key) continue;
+		t_Note.second = p_Value;
+		return;
+	}
+	m_Notes.emplace_back(p_Key, p_Value);
+}
+
+void StartupProfiler::Finish(const std::chrono::steady_clock::time_point p_FirstFrame)
+{
+	if (!m_Started || m_Finished) return;
+	// the frame may have been received before the last Mark, e.g. while the loop was loading skeletons.
+	m_PhaseMs[static_cast<int>(StartupPhase::StartupPhase_FirstCallback)] += (std::max)(GetMilliseconds(p_FirstFrame - m_Last), 0.0);
+	m_TotalMs = GetMilliseconds(p_FirstFrame - m_Start);
+	m_Finished = true;
+}
+
+double StartupProfiler::GetOtherMs() const
+{
+	double t_Other = m_TotalMs;
+	for (const double t_Ms : m_PhaseMs) t_Other -= t_Ms;
+	return (std::max)(t_Other, 0.0);
+}
+
+void StartupProfiler::Print() const
+{
+	if (!m_Finished) return;
+	std::ostringstream t_Text;
+	t_Text << std::fixed << std::setprecision(1);
+	t_Text << "Startup took " << m_TotalMs << " ms to the first frame:\n";
+	for (int i = 0; i < static_cast<int>(StartupPhase::StartupPhase_Count); i++)
+	{
+		t_Text << "  " << std::left << std::setw(18) << GetStartupPhaseName(static_cast<StartupPhase>(i)) << std::right << std::setw(10) << m_PhaseMs[i] << " ms"
+			<< std::setw(7) << (m_TotalMs > 0.0 ? 100.0 * m_PhaseMs[i] / m_TotalMs : 0.0) << " %\n";
+	}
+	t_Text << "  " << std::left << std::setw(18) << "other" << std::right << std::setw(10) << GetOtherMs() << " ms"
+		<< std::setw(7) << (m_TotalMs > 0.0 ? 100.0 * GetOtherMs() / m_TotalMs : 0.0) << " %\n";
+	for (const std::pair<std::string, std::string>& t_Note : m_Notes)
+	{
+		t_Text << "  " << t_Note.first << ": " << t_Note.second << "\n";
+	}
+	std::cout << t_Text.str() << std::flush;
+}
+
+std::string StartupProfiler::ToJson(const std::string& p_Node) const
+{
+	std::ostringstream t_Json;
+	t_Json << std::fixed << std::setprecision(3);
+	t_Json << "{\"node\":" << ToJsonString(p_Node) << ",\"unix_time\":" << static_cast<long long>(std::time(nullptr))
+		<< ",\"time_to_first_frame_ms\":" << m_TotalMs << ",\"phases_ms\":{";
+	for (int i = 0; i < static_cast<int>(StartupPhase::StartupPhase_Count); i++)
+	{
+		t_Json << "\"" << GetStartupPhaseName(static_cast<StartupPhase>(i)) << "\":" << m_PhaseMs[i] << ",";
+	}
+	t_Json << "\"other\":" << GetOtherMs() << "}";
+	for (const std::pair<std::string, std::string>& t_Note : m_Notes)
+	{
+		t_Json << "," << ToJsonString(t_Note.first) << ":" << ToJsonString(t_Note.second);
+	}
+	t_Json << "}";
+	return t_Json.str();
+}
+
+bool StartupProfiler::Append(const std::string& p_Path, const std::string& p_Node) const
+{
+	std::ofstream t_File(p_Path, std::ofstream::app);
+	t_File << ToJson(p_Node) << "\n";
+	if (!t_File)
+	{
+		std::cerr << "Cannot append the startup profile to " << p_Path << "." << std::endl;
+		return false;
+	}
+	return true;
+}
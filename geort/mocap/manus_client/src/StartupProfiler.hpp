@@ -0,0 +1,89 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _STARTUP_PROFILER_HPP_
+#define _STARTUP_PROFILER_HPP_
+
+#include <chrono>
+// std::string
+#include <string>
+// std::pair
+#include <utility>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTools
+ *  @{
+ */
+
+/// @brief The phases from starting a client to its first frame, in the order they happen.
+enum class StartupPhase
+{
+	StartupPhase_PlatformInit,
+	StartupPhase_SdkInitialize, // CoreSdk_Initialize.
+	StartupPhase_Callbacks, // registering the SDK callbacks.
+	StartupPhase_CoordinateSystem,
+	StartupPhase_Discovery, // looking for hosts.
+	StartupPhase_Connect, // connecting to the host found.
+	StartupPhase_Landscape, // waiting for the first users, when provisioning follows the landscape.
+	StartupPhase_SkeletonSetup, // creating or restoring the skeleton setups.
+	StartupPhase_SkeletonLoad, // CoreSdk_LoadSkeleton.
+	StartupPhase_FirstCallback, // from the skeletons being loaded to the first frame with data.
+
+	StartupPhase_Count
+};
+
+const char* GetStartupPhaseName(const StartupPhase p_Phase);
+
+/// @brief Times the startup of a client up to its first frame.
+///
+/// Phases that follow each other are timed with Lap, which adds the time since the previous Lap or
+/// Mark. Phases that are timed elsewhere, or happen several times like loading a skeleton per hand,
+/// are added with Add, and Mark then starts the next Lap from now. The time the phases do not
+/// account for, e.g. the pauses between connection attempts, is reported as "other".
+///
+/// Finish ends the profile at the first frame, later calls change nothing, so the same code can run
+/// again on a reconnect. Print gives a table, ToJson one line that can be appended to a file to
+/// follow the time to first frame across SDK versions and settings.
+class StartupProfiler
+{
+public:
+	void Start();
+
+	void Lap(const StartupPhase p_Phase);
+	void Add(const StartupPhase p_Phase, const double p_Milliseconds);
+	void Mark();
+	/// @brief A value that goes with the profile, e.g. how the host was found.
+	void SetNote(const std::string& p_Key, const std::string& p_Value);
+	/// @param p_FirstFrame when the callback of the first frame ran.
+	void Finish(const std::chrono::steady_clock::time_point p_FirstFrame);
+
+	bool IsFinished() const { return m_Finished; }
+	double GetTimeToFirstFrameMs() const { return m_TotalMs; }
+
+	void Print() const;
+	/// @brief The profile as a JSON object on one line, times in milliseconds.
+	std::string ToJson(const std::string& p_Node) const;
+	/// @brief Append ToJson to the file at p_Path.
+	bool Append(const std::string& p_Path, const std::string& p_Node) const;
+
+protected:
+	double GetOtherMs() const;
+
+	std::chrono::steady_clock::time_point m_Start;
+	std::chrono::steady_clock::time_point m_Last;
+	double m_PhaseMs[static_cast<int>(StartupPhase::StartupPhase_Count)] = {};
+	std::vector<std::pair<std::string, std::string>> m_Notes;
+	double m_TotalMs = 0.0;
+	bool m_Started = false;
+	bool m_Finished = false;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,89 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "StreamDiagnostics.hpp"
+
+#include <iostream>
+
+StreamDiagnostics::StreamDiagnostics(const rclcpp::Node::SharedPtr& p_Node, const std::string& p_NodeName, const double p_PeriodSeconds)
+	: m_Node(p_Node)
+	, m_NodeName(p_NodeName)
+	, m_Period(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(p_PeriodSeconds)))
+	, m_LastPublish(std::chrono::steady_clock::now())
+{
+	m_Publisher = p_Node->create_publisher<diagnostic_msgs::msg::DiagnosticArray>("/diagnostics", 10);
+}
+
+void StreamDiagnostics::Update(const std::string& p_Stream, const FrameHandoffCounters& p_Counters)
+{
+	for (Stream& t_Stream : m_Streams)
+	{
+		if (t_Stream.name != p_Stream) continue;
+		t_Stream.counters = p_Counters;
+		return;
+	}
+	Stream t_Stream;
+	t_Stream.name = p_Stream;
+	t_Stream.counters = p_Counters;
+	m_Streams.push_back(t_Stream);
+}
+
+void StreamDiagnostics::PublishIfDue()
+{
+	const std::chrono::steady_clock::time_point t_Now = std::chrono::steady_clock::now();
+	if (t_Now - m_LastPublish < m_Period) return;
+	m_LastPublish = t_Now;
+
+	m_Message.header.stamp = m_Node->get_clock()->now();
+	m_Message.status.resize(m_Streams.size());
+	for (size_t i = 0; i < m_Streams.size(); i++)
+	{
+		Stream& t_Stream = m_Streams[i];
+		const FrameHandoffCounters& t_Counters = t_Stream.counters;
+		diagnostic_msgs::msg::DiagnosticStatus& t_Status = m_Message.status[i];
+		t_Status.name = m_NodeName + ": " + t_Stream.name + " stream";
+		t_Status.hardware_id = "manus";
+
+		const uint64_t t_Lost = t_Counters.overwritten + t_Counters.skipped - t_Stream.reportedLost;
+		t_Stream.reportedLost = t_Counters.overwritten + t_Counters.skipped;
+		t_Status.level = t_Lost > 0 ? diagnostic_msgs::msg::DiagnosticStatus::WARN : diagnostic_msgs::msg::DiagnosticStatus::OK;
+		t_Status.message = t_Lost > 0 ? std::to_string(t_Lost) + " frames overwritten or skipped since the last report" : "no frames lost";
+
+		const std::pair<const char*, std::string> t_Values[] = {
+			{ "policy", GetFrameHandoffPolicyName(t_Counters.policy) },
+			{ "slots", std::to_string(t_Counters.slots) },
+			{ "produced", std::to_string(t_Counters.produced) },
+			{ "consumed", std::to_string(t_Counters.consumed) },
+			{ "overwritten", std::to_string(t_Counters.overwritten) },
+			{ "republished", std::to_string(t_Counters.republished) },
+			{ "queued", std::to_string(t_Counters.queued) },
+			{ "skipped", std::to_string(t_Counters.skipped) },
+			{ "producer_wait_ms", std::to_string(t_Counters.producerWaitMs) },
+		};
+		t_Status.values.resize(sizeof(t_Values) / sizeof(t_Values[0]));
+		for (size_t j = 0; j < t_Status.values.size(); j++)
+		{
+			t_Status.values[j].key = t_Values[j].first;
+			t_Status.values[j].value = t_Values[j].second;
+		}
+	}
+	m_Publisher->publish(m_Message);
+}
+
+void StreamDiagnostics::Print() const
+{
+	for (const Stream& t_Stream : m_Streams)
+	{
+		const FrameHandoffCounters& t_Counters = t_Stream.counters;
+		std::cout << t_Stream.name << " stream (" << GetFrameHandoffPolicyName(t_Counters.policy) << "): " << t_Counters.produced << " produced, "
+			<< t_Counters.consumed << " consumed, " << t_Counters.overwritten << " overwritten, " << t_Counters.skipped << " skipped, " << t_Counters.republished << " republished";
+		if (t_Counters.policy == FrameHandoffPolicy::FrameHandoffPolicy_Block)
+		{
+			std::cout << ", the SDK waited " << t_Counters.producerWaitMs << " ms";
+		}
+		std::cout << ".\n";
+	}
+}
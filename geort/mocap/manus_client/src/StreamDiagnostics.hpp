@@ -0,0 +1,61 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _STREAM_DIAGNOSTICS_HPP_
+#define _STREAM_DIAGNOSTICS_HPP_
+
+#include "FrameHandoff.hpp"
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include <chrono>
+// std::string
+#include <string>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup SDKMinimalClient
+ *  @{
+ */
+
+/// @brief Publishes the FrameHandoff counters of the SDK streams of a node on /diagnostics, one
+/// DiagnosticStatus per stream. A stream is reported as WARN while it is losing frames, whether they
+/// are overwritten in the handoff or skipped after it.
+class StreamDiagnostics
+{
+public:
+	StreamDiagnostics(const rclcpp::Node::SharedPtr& p_Node, const std::string& p_NodeName, const double p_PeriodSeconds = 1.0);
+
+	/// @brief Set the latest counters of a stream, it is added on first use.
+	void Update(const std::string& p_Stream, const FrameHandoffCounters& p_Counters);
+	/// @brief Publish if the period has passed since the last time.
+	void PublishIfDue();
+	/// @brief One line per stream on the console.
+	void Print() const;
+
+protected:
+	class Stream
+	{
+	public:
+		std::string name;
+		FrameHandoffCounters counters;
+		uint64_t reportedLost = 0; // overwritten and skipped at the last publish.
+	};
+
+	rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr m_Publisher;
+	rclcpp::Node::SharedPtr m_Node;
+	std::string m_NodeName;
+	std::chrono::steady_clock::duration m_Period;
+	std::chrono::steady_clock::time_point m_LastPublish;
+	std::vector<Stream> m_Streams;
+	diagnostic_msgs::msg::DiagnosticArray m_Message;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
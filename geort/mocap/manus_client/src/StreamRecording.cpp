@@ -0,0 +1,563 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "StreamRecording.hpp"
+#include "SDKMinimalClient.hpp"
+
+// std::lower_bound, std::min, std::sort
+#include <algorithm>
+// std::chrono::steady_clock
+#include <chrono>
+// std::memcpy, std::memset
+#include <cstring>
+#include <iostream>
+
+// mmap
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// the file stores these structs as the SDK lays them out, the header records their sizes.
+static_assert(sizeof(StreamRecordingHeader) == 64, "StreamRecordingHeader layout changed.");
+static_assert(sizeof(StreamRecord) == 40, "StreamRecord layout changed.");
+static_assert(sizeof(StreamRecordingIndexEntry) == 24, "StreamRecordingIndexEntry layout changed.");
+static_assert(sizeof(StreamRecordingIndexTable) == 24, "StreamRecordingIndexTable layout changed.");
+static_assert(sizeof(StreamRecordingFooter) == 32, "StreamRecordingFooter layout changed.");
+
+static const char s_Zeros[8] = { 0 };
+
+static uint64_t NanosecondsSinceEpoch(const std::chrono::steady_clock::time_point p_Time)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(p_Time.time_since_epoch()).count());
+}
+
+static size_t PaddingTo8(const size_t p_Bytes)
+{
+	return (8 - p_Bytes % 8) % 8;
+}
+
+StreamRecorder::StreamRecorder()
+{
+	m_Description = "Stream recording";
+	m_RecordName = "records";
+}
+
+StreamRecorder::~StreamRecorder()
+{
+	Close();
+}
+
+bool StreamRecorder::Open(const std::string& p_Path, const RecordingWriterSettings& p_Settings)
+{
+	Close();
+	for (uint64_t& t_Sequence : m_Sequences) t_Sequence = 0;
+	return RecordingBlockWriter::Open(p_Path, p_Settings);
+}
+
+bool StreamRecorder::BeginStreamRecord(const StreamRecordType p_Type, const size_t p_PayloadBytes, const size_t p_ItemCount, const uint64_t p_PublishTime)
+{
+	const size_t t_RecordBytes = sizeof(StreamRecord) + p_PayloadBytes + PaddingTo8(p_PayloadBytes);
+
+	uint64_t t_HostTime = 0;
+	if (!BeginRecord(t_RecordBytes, t_HostTime)) return false;
+
+	StreamRecord t_Record;
+	t_Record.magic = STREAM_RECORDING_RECORD_MAGIC;
+	t_Record.type = p_Type;
+	t_Record.reserved = 0;
+	t_Record.recordBytes = static_cast<uint32_t>(t_RecordBytes);
+	t_Record.itemCount = static_cast<uint32_t>(p_ItemCount);
+	t_Record.sequence = m_Sequences[p_Type]++;
+	t_Record.hostTimeNs = t_HostTime;
+	t_Record.publishTime = p_PublishTime;
+	Append(&t_Record, sizeof(t_Record));
+	return true;
+}
+
+void StreamRecorder::EndStreamRecord(const size_t p_PayloadBytes)
+{
+	Append(s_Zeros, PaddingTo8(p_PayloadBytes));
+	EndRecord();
+}
+
+bool StreamRecorder::RecordSkeletons(const ManusTimestamp p_PublishTime, const ClientSkeleton* const p_Skeletons, const size_t p_Count)
+{
+	size_t t_PayloadBytes = 0;
+	for (size_t i = 0; i < p_Count; i++)
+	{
+		t_PayloadBytes += sizeof(SkeletonInfo) + sizeof(SkeletonNode) * p_Skeletons[i].info.nodesCount;
+	}
+	if (!BeginStreamRecord(StreamRecordType_Skeleton, t_PayloadBytes, p_Count, p_PublishTime.time)) return false;
+	for (size_t i = 0; i < p_Count; i++)
+	{
+		Append(&p_Skeletons[i].info, sizeof(SkeletonInfo));
+		Append(p_Skeletons[i].nodes, sizeof(SkeletonNode) * p_Skeletons[i].info.nodesCount);
+	}
+	EndStreamRecord(t_PayloadBytes);
+	return true;
+}
+
+bool StreamRecorder::RecordRawSkeletons(const ManusTimestamp p_PublishTime, const ClientRawSkeleton* const p_Skeletons, const size_t p_Count)
+{
+	size_t t_PayloadBytes = 0;
+	for (size_t i = 0; i < p_Count; i++)
+	{
+		// the node vector is what was filled, it wins over a nodesCount that disagrees.
+		t_PayloadBytes += sizeof(RawSkeletonInfo) + sizeof(SkeletonNode) * p_Skeletons[i].nodes.size();
+	}
+	if (!BeginStreamRecord(StreamRecordType_RawSkeleton, t_PayloadBytes, p_Count, p_PublishTime.time)) return false;
+	for (size_t i = 0; i < p_Count; i++)
+	{
+		RawSkeletonInfo t_Info = p_Skeletons[i].info;
+		t_Info.nodesCount = static_cast<uint32_t>(p_Skeletons[i].nodes.size());
+		Append(&t_Info, sizeof(RawSkeletonInfo));
+		Append(p_Skeletons[i].nodes.data(), sizeof(SkeletonNode) * p_Skeletons[i].nodes.size());
+	}
+	EndStreamRecord(t_PayloadBytes);
+	return true;
+}
+
+bool StreamRecorder::RecordTrackers(const ManusTimestamp p_PublishTime, const TrackerData* const p_Trackers, const size_t p_Count)
+{
+	const size_t t_PayloadBytes = sizeof(TrackerData) * p_Count;
+	if (!BeginStreamRecord(StreamRecordType_Tracker, t_PayloadBytes, p_Count, p_PublishTime.time)) return false;
+	Append(p_Trackers, t_PayloadBytes);
+	EndStreamRecord(t_PayloadBytes);
+	return true;
+}
+
+bool StreamRecorder::RecordErgonomics(const ErgonomicsStream& p_Ergonomics)
+{
+	const size_t t_Count = (std::min)(static_cast<size_t>(p_Ergonomics.dataCount), static_cast<size_t>(MAX_NUMBER_OF_ERGONOMICS_DATA));
+	const size_t t_PayloadBytes = sizeof(ErgonomicsData) * t_Count;
+	if (!BeginStreamRecord(StreamRecordType_Ergonomics, t_PayloadBytes, t_Count, p_Ergonomics.publishTime.time)) return false;
+	Append(p_Ergonomics.data, t_PayloadBytes);
+	EndStreamRecord(t_PayloadBytes);
+	return true;
+}
+
+bool StreamRecorder::RecordGestures(const ManusTimestamp p_PublishTime, const GestureProbabilities* const p_Gestures, const size_t p_Count)
+{
+	const size_t t_PayloadBytes = sizeof(GestureProbabilities) * p_Count;
+	if (!BeginStreamRecord(StreamRecordType_Gesture, t_PayloadBytes, p_Count, p_PublishTime.time)) return false;
+	Append(p_Gestures, t_PayloadBytes);
+	EndStreamRecord(t_PayloadBytes);
+	return true;
+}
+
+bool StreamRecorder::RecordLandscape(const Landscape& p_Landscape)
+{
+	if (!BeginStreamRecord(StreamRecordType_Landscape, sizeof(Landscape), 1, 0)) return false;
+	Append(&p_Landscape, sizeof(Landscape));
+	EndStreamRecord(sizeof(Landscape));
+	return true;
+}
+
+void StreamRecorder::AppendFileHeader(const uint64_t p_HostTime)
+{
+	StreamRecordingHeader t_Header;
+	std::memset(&t_Header, 0, sizeof(t_Header));
+	std::memcpy(t_Header.magic, STREAM_RECORDING_MAGIC, sizeof(t_Header.magic));
+	t_Header.version = STREAM_RECORDING_VERSION;
+	t_Header.headerBytes = sizeof(StreamRecordingHeader);
+	t_Header.skeletonInfoBytes = sizeof(SkeletonInfo);
+	t_Header.skeletonNodeBytes = sizeof(SkeletonNode);
+	t_Header.rawSkeletonInfoBytes = sizeof(RawSkeletonInfo);
+	t_Header.trackerDataBytes = sizeof(TrackerData);
+	t_Header.ergonomicsDataBytes = sizeof(ErgonomicsData);
+	t_Header.gestureProbabilitiesBytes = sizeof(GestureProbabilities);
+	t_Header.landscapeBytes = sizeof(Landscape);
+	// both clocks are read now, steadyStartNs is the time of the chunk's first record or earlier.
+	t_Header.steadyStartNs = (std::min)(p_HostTime, NanosecondsSinceEpoch(std::chrono::steady_clock::now()));
+	t_Header.systemStartNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count());
+	Append(&t_Header, sizeof(t_Header));
+}
+
+void StreamRecorder::BeginChunkData()
+{
+	for (std::vector<StreamRecordingIndexEntry>& t_Index : m_Index) t_Index.clear();
+	m_ObservedBytes = 0;
+	m_SkipBytes = sizeof(StreamRecordingHeader);
+	m_PendingBytes = 0;
+	m_IndexBroken = false;
+}
+
+void StreamRecorder::ObserveChunkData(const char* const p_Data, const size_t p_Bytes)
+{
+	// the blocks cut records anywhere, so collect each record header across calls and skip its payload.
+	size_t t_Position = 0;
+	while (!m_IndexBroken && t_Position < p_Bytes)
+	{
+		if (m_SkipBytes > 0)
+		{
+			const size_t t_Skip = static_cast<size_t>((std::min)(m_SkipBytes, static_cast<uint64_t>(p_Bytes - t_Position)));
+			m_SkipBytes -= t_Skip;
+			t_Position += t_Skip;
+			continue;
+		}
+
+		const size_t t_Copy = (std::min)(sizeof(StreamRecord) - m_PendingBytes, p_Bytes - t_Position);
+		std::memcpy(reinterpret_cast<char*>(&m_PendingRecord) + m_PendingBytes, p_Data + t_Position, t_Copy);
+		m_PendingBytes += t_Copy;
+		t_Position += t_Copy;
+		if (m_PendingBytes < sizeof(StreamRecord)) break;
+
+		const uint64_t t_Offset = m_ObservedBytes + t_Position - sizeof(StreamRecord);
+		m_PendingBytes = 0;
+		if (m_PendingRecord.magic != STREAM_RECORDING_RECORD_MAGIC || m_PendingRecord.type >= StreamRecordType_Count
+			|| m_PendingRecord.recordBytes < sizeof(StreamRecord))
+		{
+			// cannot happen with records from this class, but never write an index that lies.
+			std::cerr << "Stream recording index lost track at offset " << t_Offset << ", the file will be scanned instead." << std::endl;
+			m_IndexBroken = true;
+			break;
+		}
+
+		StreamRecordingIndexEntry t_Entry;
+		t_Entry.offset = t_Offset;
+		t_Entry.hostTimeNs = m_PendingRecord.hostTimeNs;
+		t_Entry.publishTime = m_PendingRecord.publishTime;
+		m_Index[m_PendingRecord.type].push_back(t_Entry);
+		m_SkipBytes = m_PendingRecord.recordBytes - sizeof(StreamRecord);
+	}
+	m_ObservedBytes += p_Bytes;
+}
+
+void StreamRecorder::GetChunkTrailer(std::vector<char>& p_Trailer)
+{
+	p_Trailer.clear();
+	// without a consistent index the file ends after its last record and readers scan it.
+	if (m_IndexBroken || m_PendingBytes != 0 || m_SkipBytes != 0) return;
+
+	uint64_t t_RecordCount = 0;
+	uint32_t t_TableCount = 0;
+	for (const std::vector<StreamRecordingIndexEntry>& t_Index : m_Index)
+	{
+		t_RecordCount += t_Index.size();
+		if (!t_Index.empty()) t_TableCount++;
+	}
+	const size_t t_EntryBytes = sizeof(StreamRecordingIndexEntry) * static_cast<size_t>(t_RecordCount);
+	p_Trailer.resize(t_EntryBytes + sizeof(StreamRecordingIndexTable) * t_TableCount + sizeof(StreamRecordingFooter));
+
+	std::vector<StreamRecordingIndexTable> t_Tables;
+	t_Tables.reserve(t_TableCount);
+	size_t t_Position = 0;
+	for (uint32_t t_Type = 0; t_Type < StreamRecordType_Count; t_Type++)
+	{
+		const std::vector<StreamRecordingIndexEntry>& t_Index = m_Index[t_Type];
+		if (t_Index.empty()) continue;
+
+		StreamRecordingIndexTable t_Table;
+		t_Table.type = t_Type;
+		t_Table.reserved = 0;
+		t_Table.count = t_Index.size();
+		t_Table.offset = m_ObservedBytes + t_Position;
+		t_Tables.push_back(t_Table);
+
+		std::memcpy(p_Trailer.data() + t_Position, t_Index.data(), sizeof(StreamRecordingIndexEntry) * t_Index.size());
+		t_Position += sizeof(StreamRecordingIndexEntry) * t_Index.size();
+	}
+
+	StreamRecordingFooter t_Footer;
+	t_Footer.tableOffset = m_ObservedBytes + t_Position;
+	t_Footer.tableCount = t_TableCount;
+	t_Footer.reserved = 0;
+	t_Footer.recordCount = t_RecordCount;
+	std::memcpy(t_Footer.magic, STREAM_RECORDING_INDEX_MAGIC, sizeof(t_Footer.magic));
+
+	std::memcpy(p_Trailer.data() + t_Position, t_Tables.data(), sizeof(StreamRecordingIndexTable) * t_Tables.size());
+	t_Position += sizeof(StreamRecordingIndexTable) * t_Tables.size();
+	std::memcpy(p_Trailer.data() + t_Position, &t_Footer, sizeof(t_Footer));
+}
+
+StreamRecordingReader::StreamRecordingReader()
+{
+}
+
+StreamRecordingReader::~StreamRecordingReader()
+{
+	Close();
+}
+
+bool StreamRecordingReader::Open(const std::string& p_Path)
+{
+	Close();
+
+	const int t_Descriptor = open(p_Path.c_str(), O_RDONLY);
+	if (t_Descriptor < 0)
+	{
+		std::cerr << "Could not open stream recording " << p_Path << "." << std::endl;
+		return false;
+	}
+
+	struct stat t_Stat;
+	if (fstat(t_Descriptor, &t_Stat) != 0 || static_cast<size_t>(t_Stat.st_size) < sizeof(StreamRecordingHeader))
+	{
+		std::cerr << "Stream recording " << p_Path << " is too small." << std::endl;
+		close(t_Descriptor);
+		return false;
+	}
+
+	void* const t_Mapping = mmap(nullptr, static_cast<size_t>(t_Stat.st_size), PROT_READ, MAP_SHARED, t_Descriptor, 0);
+	// the mapping keeps the file alive, the descriptor is no longer needed.
+	close(t_Descriptor);
+	if (t_Mapping == MAP_FAILED)
+	{
+		std::cerr << "Could not mmap stream recording " << p_Path << "." << std::endl;
+		return false;
+	}
+
+	m_Data = static_cast<const unsigned char*>(t_Mapping);
+	m_Size = static_cast<size_t>(t_Stat.st_size);
+	m_DataEnd = m_Size;
+
+	// payloads are read as the SDK structs of this build, they have to match the writer's.
+	const StreamRecordingHeader* const t_Header = GetHeader();
+	if (std::memcmp(t_Header->magic, STREAM_RECORDING_MAGIC, sizeof(t_Header->magic)) != 0
+		|| t_Header->version != STREAM_RECORDING_VERSION
+		|| t_Header->headerBytes != sizeof(StreamRecordingHeader)
+		|| t_Header->skeletonInfoBytes != sizeof(SkeletonInfo)
+		|| t_Header->skeletonNodeBytes != sizeof(SkeletonNode)
+		|| t_Header->rawSkeletonInfoBytes != sizeof(RawSkeletonInfo)
+		|| t_Header->trackerDataBytes != sizeof(TrackerData)
+		|| t_Header->ergonomicsDataBytes != sizeof(ErgonomicsData)
+		|| t_Header->gestureProbabilitiesBytes != sizeof(GestureProbabilities)
+		|| t_Header->landscapeBytes != sizeof(Landscape))
+	{
+		std::cerr << "Stream recording " << p_Path << " has an unknown format or version, or was written with another Manus SDK." << std::endl;
+		Close();
+		return false;
+	}
+
+	m_HasIndex = LoadIndex();
+	if (!m_HasIndex)
+	{
+		madvise(t_Mapping, m_Size, MADV_SEQUENTIAL);
+		ScanRecords();
+		if (m_DataEnd != m_Size)
+		{
+			std::cerr << "Stream recording " << p_Path << " has no index and " << (m_Size - m_DataEnd)
+				<< " trailing bytes that are not a complete record, they are ignored." << std::endl;
+		}
+	}
+	return true;
+}
+
+void StreamRecordingReader::Close()
+{
+	if (m_Data != nullptr)
+	{
+		munmap(const_cast<unsigned char*>(m_Data), m_Size);
+	}
+	m_Data = nullptr;
+	m_Size = 0;
+	m_DataEnd = 0;
+	m_HasIndex = false;
+	m_Records.clear();
+	for (std::vector<StreamRecordingIndexEntry>& t_Records : m_TypeRecords) t_Records.clear();
+}
+
+bool StreamRecordingReader::LoadIndex()
+{
+	if (m_Size < sizeof(StreamRecordingHeader) + sizeof(StreamRecordingFooter)) return false;
+
+	StreamRecordingFooter t_Footer;
+	std::memcpy(&t_Footer, m_Data + m_Size - sizeof(t_Footer), sizeof(t_Footer));
+	if (std::memcmp(t_Footer.magic, STREAM_RECORDING_INDEX_MAGIC, sizeof(t_Footer.magic)) != 0
+		|| t_Footer.tableCount > StreamRecordType_Count
+		|| t_Footer.tableOffset < sizeof(StreamRecordingHeader)
+		|| t_Footer.tableOffset + sizeof(StreamRecordingIndexTable) * static_cast<uint64_t>(t_Footer.tableCount) + sizeof(t_Footer) != m_Size)
+	{
+		return false;
+	}
+
+	// only the index is read here, each entry is checked against the data area so GetRecord can trust it.
+	uint64_t t_DataEnd = t_Footer.tableOffset;
+	uint64_t t_RecordCount = 0;
+	for (uint32_t t = 0; t < t_Footer.tableCount; t++)
+	{
+		StreamRecordingIndexTable t_Table;
+		std::memcpy(&t_Table, m_Data + t_Footer.tableOffset + sizeof(t_Table) * t, sizeof(t_Table));
+		if (t_Table.type >= StreamRecordType_Count || !m_TypeRecords[t_Table.type].empty()
+			|| t_Table.count > t_Footer.recordCount || t_Table.offset < sizeof(StreamRecordingHeader)
+			|| t_Table.offset + sizeof(StreamRecordingIndexEntry) * t_Table.count > t_Footer.tableOffset)
+		{
+			for (std::vector<StreamRecordingIndexEntry>& t_Records : m_TypeRecords) t_Records.clear();
+			return false;
+		}
+		t_DataEnd = (std::min)(t_DataEnd, t_Table.offset);
+
+		std::vector<StreamRecordingIndexEntry>& t_Records = m_TypeRecords[t_Table.type];
+		t_Records.resize(static_cast<size_t>(t_Table.count));
+		std::memcpy(t_Records.data(), m_Data + t_Table.offset, sizeof(StreamRecordingIndexEntry) * t_Records.size());
+		t_RecordCount += t_Table.count;
+	}
+
+	bool t_Valid = t_RecordCount == t_Footer.recordCount;
+	for (const std::vector<StreamRecordingIndexEntry>& t_Records : m_TypeRecords)
+	{
+		for (size_t i = 0; t_Valid && i < t_Records.size(); i++)
+		{
+			t_Valid = t_Records[i].offset >= sizeof(StreamRecordingHeader) && t_Records[i].offset + sizeof(StreamRecord) <= t_DataEnd
+				&& (i == 0 || t_Records[i].offset > t_Records[i - 1].offset);
+		}
+	}
+	if (!t_Valid)
+	{
+		for (std::vector<StreamRecordingIndexEntry>& t_Records : m_TypeRecords) t_Records.clear();
+		return false;
+	}
+
+	m_DataEnd = static_cast<size_t>(t_DataEnd);
+	m_Records.reserve(static_cast<size_t>(t_RecordCount));
+	for (const std::vector<StreamRecordingIndexEntry>& t_Records : m_TypeRecords)
+	{
+		m_Records.insert(m_Records.end(), t_Records.begin(), t_Records.end());
+	}
+	std::sort(m_Records.begin(), m_Records.end(), [](const StreamRecordingIndexEntry& p_A, const StreamRecordingIndexEntry& p_B) { return p_A.offset < p_B.offset; });
+	return true;
+}
+
+void StreamRecordingReader::ScanRecords()
+{
+	uint64_t t_Offset = sizeof(StreamRecordingHeader);
+	while (t_Offset + sizeof(StreamRecord) <= m_Size)
+	{
+		StreamRecord t_Record;
+		std::memcpy(&t_Record, m_Data + t_Offset, sizeof(t_Record));
+		if (t_Record.magic != STREAM_RECORDING_RECORD_MAGIC || t_Record.type >= StreamRecordType_Count
+			|| t_Record.recordBytes < sizeof(t_Record) || t_Record.recordBytes % 8 != 0 || t_Offset + t_Record.recordBytes > m_Size)
+		{
+			break;
+		}
+
+		StreamRecordingIndexEntry t_Entry;
+		t_Entry.offset = t_Offset;
+		t_Entry.hostTimeNs = t_Record.hostTimeNs;
+		t_Entry.publishTime = t_Record.publishTime;
+		m_Records.push_back(t_Entry);
+		m_TypeRecords[t_Record.type].push_back(t_Entry);
+		t_Offset += t_Record.recordBytes;
+	}
+	m_DataEnd = static_cast<size_t>(t_Offset);
+}
+
+const StreamRecord* StreamRecordingReader::GetRecord(const size_t p_Index) const
+{
+	return reinterpret_cast<const StreamRecord*>(m_Data + m_Records[p_Index].offset);
+}
+
+size_t StreamRecordingReader::GetTypeCount(const StreamRecordType p_Type) const
+{
+	return p_Type < StreamRecordType_Count ? m_TypeRecords[p_Type].size() : 0;
+}
+
+const StreamRecord* StreamRecordingReader::GetTypeRecord(const StreamRecordType p_Type, const size_t p_Index) const
+{
+	return reinterpret_cast<const StreamRecord*>(m_Data + m_TypeRecords[p_Type][p_Index].offset);
+}
+
+static size_t FindFirstEntry(const std::vector<StreamRecordingIndexEntry>& p_Entries, const uint64_t p_HostTimeNs)
+{
+	return static_cast<size_t>(std::lower_bound(p_Entries.begin(), p_Entries.end(), p_HostTimeNs,
+		[](const StreamRecordingIndexEntry& p_Entry, const uint64_t p_Time) { return p_Entry.hostTimeNs < p_Time; }) - p_Entries.begin());
+}
+
+size_t StreamRecordingReader::FindFirstRecord(const uint64_t p_HostTimeNs) const
+{
+	return FindFirstEntry(m_Records, p_HostTimeNs);
+}
+
+size_t StreamRecordingReader::FindFirstTypeRecord(const StreamRecordType p_Type, const uint64_t p_HostTimeNs) const
+{
+	if (p_Type >= StreamRecordType_Count) return 0;
+	return FindFirstEntry(m_TypeRecords[p_Type], p_HostTimeNs);
+}
+
+/// @brief The payload of p_Record after checking the record itself, the index only vouches for its header.
+static const unsigned char* GetPayload(const unsigned char* const p_Data, const size_t p_DataEnd, const StreamRecord& p_Record, const StreamRecordType p_Type)
+{
+	const unsigned char* const t_Record = reinterpret_cast<const unsigned char*>(&p_Record);
+	if (t_Record < p_Data || p_Record.magic != STREAM_RECORDING_RECORD_MAGIC || p_Record.type != p_Type
+		|| p_Record.recordBytes < sizeof(StreamRecord) || static_cast<size_t>(t_Record - p_Data) + p_Record.recordBytes > p_DataEnd)
+	{
+		return nullptr;
+	}
+	return t_Record + sizeof(StreamRecord);
+}
+
+const unsigned char* StreamRecordingReader::GetArrayPayload(const StreamRecord& p_Record, const StreamRecordType p_Type, const size_t p_ItemBytes) const
+{
+	const unsigned char* const t_Payload = GetPayload(m_Data, m_DataEnd, p_Record, p_Type);
+	if (t_Payload == nullptr || sizeof(StreamRecord) + p_ItemBytes * static_cast<uint64_t>(p_Record.itemCount) > p_Record.recordBytes) return nullptr;
+	return t_Payload;
+}
+
+bool StreamRecordingReader::GetSkeletons(const StreamRecord& p_Record, std::vector<RecordedSkeleton>& p_Skeletons) const
+{
+	const unsigned char* t_Cursor = GetPayload(m_Data, m_DataEnd, p_Record, StreamRecordType_Skeleton);
+	if (t_Cursor == nullptr) return false;
+
+	uint64_t t_Used = sizeof(StreamRecord);
+	p_Skeletons.resize(p_Record.itemCount);
+	for (RecordedSkeleton& t_Skeleton : p_Skeletons)
+	{
+		t_Used += sizeof(SkeletonInfo);
+		if (t_Used > p_Record.recordBytes) return false;
+		// SkeletonInfo holds a 64 bit timestamp but is only 4 byte aligned in the file, copy it out.
+		std::memcpy(&t_Skeleton.info, t_Cursor, sizeof(SkeletonInfo));
+		t_Cursor += sizeof(SkeletonInfo);
+		t_Used += sizeof(SkeletonNode) * static_cast<uint64_t>(t_Skeleton.info.nodesCount);
+		if (t_Used > p_Record.recordBytes) return false;
+		t_Skeleton.nodes = reinterpret_cast<const SkeletonNode*>(t_Cursor);
+		t_Cursor += sizeof(SkeletonNode) * t_Skeleton.info.nodesCount;
+	}
+	return true;
+}
+
+bool StreamRecordingReader::GetRawSkeletons(const StreamRecord& p_Record, std::vector<RecordedRawSkeleton>& p_Skeletons) const
+{
+	const unsigned char* t_Cursor = GetPayload(m_Data, m_DataEnd, p_Record, StreamRecordType_RawSkeleton);
+	if (t_Cursor == nullptr) return false;
+
+	uint64_t t_Used = sizeof(StreamRecord);
+	p_Skeletons.resize(p_Record.itemCount);
+	for (RecordedRawSkeleton& t_Skeleton : p_Skeletons)
+	{
+		t_Used += sizeof(RawSkeletonInfo);
+		if (t_Used > p_Record.recordBytes) return false;
+		std::memcpy(&t_Skeleton.info, t_Cursor, sizeof(RawSkeletonInfo));
+		t_Cursor += sizeof(RawSkeletonInfo);
+		t_Used += sizeof(SkeletonNode) * static_cast<uint64_t>(t_Skeleton.info.nodesCount);
+		if (t_Used > p_Record.recordBytes) return false;
+		t_Skeleton.nodes = reinterpret_cast<const SkeletonNode*>(t_Cursor);
+		t_Cursor += sizeof(SkeletonNode) * t_Skeleton.info.nodesCount;
+	}
+	return true;
+}
+
+const TrackerData* StreamRecordingReader::GetTrackers(const StreamRecord& p_Record) const
+{
+	return reinterpret_cast<const TrackerData*>(GetArrayPayload(p_Record, StreamRecordType_Tracker, sizeof(TrackerData)));
+}
+
+const ErgonomicsData* StreamRecordingReader::GetErgonomics(const StreamRecord& p_Record) const
+{
+	return reinterpret_cast<const ErgonomicsData*>(GetArrayPayload(p_Record, StreamRecordType_Ergonomics, sizeof(ErgonomicsData)));
+}
+
+const GestureProbabilities* StreamRecordingReader::GetGestures(const StreamRecord& p_Record) const
+{
+	return reinterpret_cast<const GestureProbabilities*>(GetArrayPayload(p_Record, StreamRecordType_Gesture, sizeof(GestureProbabilities)));
+}
+
+const Landscape* StreamRecordingReader::GetLandscape(const StreamRecord& p_Record) const
+{
+	if (p_Record.itemCount != 1) return nullptr;
+	return reinterpret_cast<const Landscape*>(GetArrayPayload(p_Record, StreamRecordType_Landscape, sizeof(Landscape)));
+}
@@ -0,0 +1,239 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _STREAM_RECORDING_HPP_
+#define _STREAM_RECORDING_HPP_
+
+#include "ManusSDKTypes.h"
+#include "RecordingBlockWriter.hpp"
+#include "SkeletonRecording.hpp"
+
+// size_t
+#include <cstddef>
+// uint16_t, uint32_t, uint64_t
+#include <cstdint>
+// std::string
+#include <string>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTRecording
+ *  @{
+ */
+
+/// @brief A stream recording interleaves everything the SDK streams (skeletons, raw skeletons,
+/// trackers, ergonomics, gestures and landscape snapshots) in one log, so the streams can be fused
+/// or replayed later with their original timing relative to each other.
+///
+/// File layout, little endian, the file can be mmapped and walked in place:
+///   StreamRecordingHeader (64 bytes)
+///   records, back to back, in the order the callbacks delivered them, each one:
+///     StreamRecord (40 bytes)
+///     payload, see StreamRecordType, zero padded up to recordBytes, which is a multiple of 8.
+///   index (only in files that were closed cleanly):
+///     per record type: StreamRecordingIndexEntry[count], in file order
+///     StreamRecordingIndexTable[tableCount]
+///     StreamRecordingFooter (32 bytes, last in the file)
+///
+/// hostTimeNs is std::chrono::steady_clock at the time of the callback and never decreases over
+/// the file, it is the clock to replay all streams on. publishTime is the ManusTimestamp of the
+/// stream, 0 for landscape snapshots, which have none. sequence counts the records of each type,
+/// also across chunks, so a gap means records of that type were dropped.
+///
+/// A file that was not closed cleanly has no index and may end with a partially written record.
+/// Readers then walk the records and stop at the first one whose magic is wrong or whose
+/// recordBytes runs past the end of the file.
+
+/// @brief Magic bytes at the start of a stream recording.
+#define STREAM_RECORDING_MAGIC "GEORTMSR"
+/// @brief Bumped whenever the layout below changes.
+#define STREAM_RECORDING_VERSION 1
+/// @brief "RCRD", at the start of every record.
+#define STREAM_RECORDING_RECORD_MAGIC 0x44524352u
+/// @brief Magic bytes at the end of a stream recording with an index.
+#define STREAM_RECORDING_INDEX_MAGIC "GRMINDEX"
+
+/// @brief What a record holds, its payload and what itemCount counts.
+enum StreamRecordType : uint16_t
+{
+	StreamRecordType_Skeleton = 0, // per skeleton: SkeletonInfo, SkeletonNode[info.nodesCount].
+	StreamRecordType_RawSkeleton = 1, // per skeleton: RawSkeletonInfo, SkeletonNode[info.nodesCount].
+	StreamRecordType_Tracker = 2, // TrackerData[itemCount].
+	StreamRecordType_Ergonomics = 3, // ErgonomicsData[itemCount].
+	StreamRecordType_Gesture = 4, // GestureProbabilities[itemCount].
+	StreamRecordType_Landscape = 5, // one Landscape.
+	StreamRecordType_Count = 6,
+};
+
+typedef struct StreamRecordingHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t headerBytes;
+	uint32_t skeletonInfoBytes; // sizeof(SkeletonInfo) of the writer, and so on.
+	uint32_t skeletonNodeBytes;
+	uint64_t steadyStartNs;
+	uint64_t systemStartNs; // nanoseconds since the unix epoch.
+	uint32_t rawSkeletonInfoBytes;
+	uint32_t trackerDataBytes;
+	uint32_t ergonomicsDataBytes;
+	uint32_t gestureProbabilitiesBytes;
+	uint32_t landscapeBytes;
+	uint32_t reserved;
+} StreamRecordingHeader;
+
+typedef struct StreamRecord
+{
+	uint32_t magic;
+	uint16_t type; // StreamRecordType.
+	uint16_t reserved;
+	uint32_t recordBytes; // including this header and the padding.
+	uint32_t itemCount;
+	uint64_t sequence; // per type.
+	uint64_t hostTimeNs;
+	uint64_t publishTime; // ManusTimestamp::time of the stream.
+} StreamRecord;
+
+typedef struct StreamRecordingIndexEntry
+{
+	uint64_t offset; // of the StreamRecord from the start of the file.
+	uint64_t hostTimeNs;
+	uint64_t publishTime;
+} StreamRecordingIndexEntry;
+
+typedef struct StreamRecordingIndexTable
+{
+	uint32_t type; // StreamRecordType.
+	uint32_t reserved;
+	uint64_t count;
+	uint64_t offset; // of the first StreamRecordingIndexEntry of this type.
+} StreamRecordingIndexTable;
+
+typedef struct StreamRecordingFooter
+{
+	uint64_t tableOffset;
+	uint32_t tableCount;
+	uint32_t reserved;
+	uint64_t recordCount;
+	char magic[8];
+} StreamRecordingFooter;
+
+class ClientSkeleton;
+class ClientRawSkeleton;
+
+/// @brief Appends the SDK streams to one stream recording without blocking the callbacks on I/O.
+/// Every Record call is safe from any SDK callback thread, the records of all streams share the
+/// blocks, rotation and disk budget of RecordingBlockWriter. The writer thread indexes the records
+/// while it writes them and appends the index when a file (chunk) is finished.
+class StreamRecorder : public RecordingBlockWriter
+{
+public:
+	StreamRecorder();
+	~StreamRecorder();
+
+	/// @brief Create p_Path (or its first chunk) and start the writer thread.
+	bool Open(const std::string& p_Path, const RecordingWriterSettings& p_Settings);
+
+	/// @brief One OnSkeletonStreamCallback, p_PublishTime is SkeletonStreamInfo::publishTime.
+	bool RecordSkeletons(const ManusTimestamp p_PublishTime, const ClientSkeleton* const p_Skeletons, const size_t p_Count);
+	/// @brief One OnRawSkeletonStreamCallback.
+	bool RecordRawSkeletons(const ManusTimestamp p_PublishTime, const ClientRawSkeleton* const p_Skeletons, const size_t p_Count);
+	/// @brief One OnTrackerStreamCallback, p_PublishTime is TrackerStreamInfo::publishTime.
+	bool RecordTrackers(const ManusTimestamp p_PublishTime, const TrackerData* const p_Trackers, const size_t p_Count);
+	bool RecordErgonomics(const ErgonomicsStream& p_Ergonomics);
+	bool RecordGestures(const ManusTimestamp p_PublishTime, const GestureProbabilities* const p_Gestures, const size_t p_Count);
+	/// @brief A snapshot of the landscape, e.g. from OnLandscapeCallback.
+	bool RecordLandscape(const Landscape& p_Landscape);
+
+protected:
+	/// @brief Reserve a record, BeginRecord plus the StreamRecord header. Ends with EndRecord.
+	bool BeginStreamRecord(const StreamRecordType p_Type, const size_t p_PayloadBytes, const size_t p_ItemCount, const uint64_t p_PublishTime);
+	void EndStreamRecord(const size_t p_PayloadBytes);
+
+	void AppendFileHeader(const uint64_t p_HostTime) override;
+	void BeginChunkData() override;
+	void ObserveChunkData(const char* const p_Data, const size_t p_Bytes) override;
+	void GetChunkTrailer(std::vector<char>& p_Trailer) override;
+
+	uint64_t m_Sequences[StreamRecordType_Count] = {}; // guarded by the writer lock.
+
+	// writer thread only, the index of the file being written.
+	std::vector<StreamRecordingIndexEntry> m_Index[StreamRecordType_Count];
+	uint64_t m_ObservedBytes = 0; // file offset of the next observed byte.
+	uint64_t m_SkipBytes = 0; // of the file header or the payload of the last record.
+	StreamRecord m_PendingRecord;
+	size_t m_PendingBytes = 0; // of m_PendingRecord collected so far.
+	bool m_IndexBroken = false;
+};
+
+/// @brief One raw skeleton of a recorded record. The nodes point into the mapped file.
+class RecordedRawSkeleton
+{
+public:
+	RawSkeletonInfo info;
+	const SkeletonNode* nodes = nullptr;
+};
+
+/// @brief Maps a stream recording read-only and indexes its records per type and in file order.
+/// Files that were closed cleanly are indexed from their footer without touching the records,
+/// others are walked once.
+class StreamRecordingReader
+{
+public:
+	StreamRecordingReader();
+	~StreamRecordingReader();
+
+	/// @brief Map p_Path and index its records. A torn last record is ignored with a warning.
+	bool Open(const std::string& p_Path);
+	void Close();
+
+	const StreamRecordingHeader* GetHeader() const { return reinterpret_cast<const StreamRecordingHeader*>(m_Data); }
+	/// @brief Whether the records were indexed from the footer.
+	bool HasIndex() const { return m_HasIndex; }
+
+	/// @brief All records in file order, which is host time order.
+	size_t GetRecordCount() const { return m_Records.size(); }
+	const StreamRecord* GetRecord(const size_t p_Index) const;
+	const StreamRecordingIndexEntry& GetRecordEntry(const size_t p_Index) const { return m_Records[p_Index]; }
+
+	/// @brief The records of one type in file order.
+	size_t GetTypeCount(const StreamRecordType p_Type) const;
+	const StreamRecord* GetTypeRecord(const StreamRecordType p_Type, const size_t p_Index) const;
+
+	/// @brief Binary search for the first record at or after p_HostTimeNs, GetRecordCount if there is none.
+	size_t FindFirstRecord(const uint64_t p_HostTimeNs) const;
+	/// @brief The same within the records of p_Type, GetTypeCount if there is none.
+	size_t FindFirstTypeRecord(const StreamRecordType p_Type, const uint64_t p_HostTimeNs) const;
+
+	/// @brief Decode the payload of a record of the matching type.
+	/// @return false if p_Record has another type or its payload does not fit its recordBytes.
+	bool GetSkeletons(const StreamRecord& p_Record, std::vector<RecordedSkeleton>& p_Skeletons) const;
+	bool GetRawSkeletons(const StreamRecord& p_Record, std::vector<RecordedRawSkeleton>& p_Skeletons) const;
+	/// @brief Trackers, ergonomics, gestures and landscapes are arrays of itemCount SDK structs.
+	const TrackerData* GetTrackers(const StreamRecord& p_Record) const;
+	const ErgonomicsData* GetErgonomics(const StreamRecord& p_Record) const;
+	const GestureProbabilities* GetGestures(const StreamRecord& p_Record) const;
+	const Landscape* GetLandscape(const StreamRecord& p_Record) const;
+
+protected:
+	bool LoadIndex();
+	void ScanRecords();
+	/// @brief The payload of p_Record if it has p_Type and holds itemCount items of p_ItemBytes.
+	const unsigned char* GetArrayPayload(const StreamRecord& p_Record, const StreamRecordType p_Type, const size_t p_ItemBytes) const;
+
+	const unsigned char* m_Data = nullptr;
+	size_t m_Size = 0;
+	size_t m_DataEnd = 0; // end of the records, the index follows.
+	bool m_HasIndex = false;
+	std::vector<StreamRecordingIndexEntry> m_Records;
+	std::vector<StreamRecordingIndexEntry> m_TypeRecords[StreamRecordType_Count];
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
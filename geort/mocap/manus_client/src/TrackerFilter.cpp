@@ -0,0 +1,85 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "TrackerFilter.hpp"
+
+#include <iostream>
+
+void TrackerFilter::Configure(const TrackingQuality p_MinQuality, const double p_HoldMs, const double p_BlendMs)
+{
+	m_MinQuality = p_MinQuality;
+	m_HoldMs = p_HoldMs;
+	m_BlendMs = p_BlendMs;
+}
+
+void TrackerFilter::Resize(const size_t p_TrackerCount)
+{
+	if (p_TrackerCount <= m_States.size()) return;
+	m_States.resize(p_TrackerCount, TrackerFilterState_None);
+	m_LastGoodMs.resize(p_TrackerCount, 0.0);
+	m_BlendStartMs.resize(p_TrackerCount, -1.0);
+	m_LastGood.resize(p_TrackerCount);
+	m_LastOutput.resize(p_TrackerCount);
+	m_BlendFrom.resize(p_TrackerCount);
+}
+
+bool TrackerFilter::Update(const uint32_t p_Slot, const double p_TimeMs, const TrackingQuality p_Quality, const TrackerPose& p_Sample,
+	const TrackerPose* const p_Extrapolated, TrackerPose& p_Output)
+{
+	if (p_Slot >= m_States.size()) return false;
+
+	TrackerPose t_Target;
+	if (IsGood(p_Quality))
+	{
+		if (m_States[p_Slot] == TrackerFilterState_Holding || m_States[p_Slot] == TrackerFilterState_Lost)
+		{
+			// blend from what was passed on last, the held pose or the one before the tracker was lost.
+			m_BlendFrom[p_Slot] = m_LastOutput[p_Slot];
+			m_BlendStartMs[p_Slot] = p_TimeMs;
+			m_ReacquiredCount++;
+		}
+		m_States[p_Slot] = TrackerFilterState_Tracking;
+		m_LastGoodMs[p_Slot] = p_TimeMs;
+		m_LastGood[p_Slot] = p_Sample;
+		t_Target = p_Sample;
+	}
+	else if (m_States[p_Slot] == TrackerFilterState_None)
+	{
+		return false;
+	}
+	else if (p_TimeMs - m_LastGoodMs[p_Slot] <= m_HoldMs)
+	{
+		m_States[p_Slot] = TrackerFilterState_Holding;
+		m_HeldCount++;
+		t_Target = p_Extrapolated != nullptr ? *p_Extrapolated : m_LastGood[p_Slot];
+	}
+	else
+	{
+		m_States[p_Slot] = TrackerFilterState_Lost;
+		m_BlendStartMs[p_Slot] = -1.0;
+		m_LostCount++;
+		return false;
+	}
+
+	const double t_Blend = m_BlendStartMs[p_Slot] < 0.0 || m_BlendMs <= 0.0 ? 1.0 : (p_TimeMs - m_BlendStartMs[p_Slot]) / m_BlendMs;
+	if (t_Blend >= 1.0)
+	{
+		m_BlendStartMs[p_Slot] = -1.0;
+		p_Output = t_Target;
+	}
+	else
+	{
+		InterpolateTrackerPose(m_BlendFrom[p_Slot], t_Target, t_Blend, p_Output);
+	}
+	m_LastOutput[p_Slot] = p_Output;
+	return true;
+}
+
+void TrackerFilter::PrintCounts() const
+{
+	std::cout << "Tracker filter held " << m_HeldCount << " samples, dropped " << m_LostCount
+		<< " of lost trackers and blended back " << m_ReacquiredCount << " reacquired trackers.\n";
+}
@@ -0,0 +1,88 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _TRACKER_FILTER_HPP_
+#define _TRACKER_FILTER_HPP_
+
+#include "ManusSDKTypes.h"
+#include "TrackerPrediction.hpp"
+
+// size_t
+#include <cstddef>
+// uint8_t, uint32_t, uint64_t
+#include <cstdint>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTracking
+ *  @{
+ */
+
+/// @brief Keeps trackers that lose tracking from jumping.
+///
+/// A sample whose TrackingQuality is below the minimum is not passed on. Instead the last good
+/// pose is held (or an extrapolation of it, if the caller has one) for a bounded time, after which
+/// the tracker counts as lost and nothing is passed on until it is tracked again. When tracking
+/// comes back the output is blended from where it was to the new samples by SLERP over a short
+/// time, so a tracker that drifted while held does not snap back.
+///
+/// Trackers are addressed by slot. The state is kept in one flat array per field, so a frame costs
+/// the same per tracker however many slots there are. Times are milliseconds on any one clock.
+class TrackerFilter
+{
+public:
+	/// @param p_MinQuality the lowest quality that is passed on.
+	/// @param p_HoldMs how long a tracker is held after its last good sample.
+	/// @param p_BlendMs how long the output takes to blend back onto a reacquired tracker.
+	void Configure(const TrackingQuality p_MinQuality, const double p_HoldMs, const double p_BlendMs);
+
+	/// @brief Make room for p_TrackerCount slots, existing slots keep their state.
+	void Resize(const size_t p_TrackerCount);
+
+	/// @brief Whether a sample of p_Quality is passed on.
+	bool IsGood(const TrackingQuality p_Quality) const { return p_Quality >= m_MinQuality; }
+
+	/// @brief Filter one sample of a tracker.
+	/// @param p_Extrapolated where the tracker probably is while it is held, the last good pose is held if nullptr.
+	/// @return false if there is nothing to pass on, the tracker has not been good yet or is lost.
+	bool Update(const uint32_t p_Slot, const double p_TimeMs, const TrackingQuality p_Quality, const TrackerPose& p_Sample,
+		const TrackerPose* const p_Extrapolated, TrackerPose& p_Output);
+
+	uint64_t GetHeldCount() const { return m_HeldCount; }
+	uint64_t GetLostCount() const { return m_LostCount; }
+	uint64_t GetReacquiredCount() const { return m_ReacquiredCount; }
+	void PrintCounts() const;
+
+protected:
+	enum TrackerFilterState : uint8_t
+	{
+		TrackerFilterState_None = 0, // no good sample yet.
+		TrackerFilterState_Tracking,
+		TrackerFilterState_Holding,
+		TrackerFilterState_Lost,
+	};
+
+	TrackingQuality m_MinQuality = TrackingQuality::TrackingQuality_BadTracking;
+	double m_HoldMs = 250.0;
+	double m_BlendMs = 150.0;
+
+	std::vector<uint8_t> m_States; // TrackerFilterState.
+	std::vector<double> m_LastGoodMs;
+	std::vector<double> m_BlendStartMs; // negative when not blending.
+	std::vector<TrackerPose> m_LastGood;
+	std::vector<TrackerPose> m_LastOutput;
+	std::vector<TrackerPose> m_BlendFrom;
+
+	uint64_t m_HeldCount = 0; // samples replaced by a held pose.
+	uint64_t m_LostCount = 0; // samples dropped after the hold time.
+	uint64_t m_ReacquiredCount = 0;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,230 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "TrackerPrediction.hpp"
+
+// std::min, std::max
+#include <algorithm>
+// std::sqrt, std::acos, std::atan2, std::sin, std::cos
+#include <cmath>
+#include <iostream>
+
+/// @brief Samples further apart than this do not give a usable velocity, e.g. after a tracking loss.
+static const double s_MaxSampleGapSeconds = 0.25;
+/// @brief Weight of a new finite difference in the smoothed velocity.
+static const double s_VelocitySmoothing = 0.5;
+
+static void Multiply(const double p_A[4], const double p_B[4], double p_Result[4])
+{
+	const double t_W = p_A[0] * p_B[0] - p_A[1] * p_B[1] - p_A[2] * p_B[2] - p_A[3] * p_B[3];
+	const double t_X = p_A[0] * p_B[1] + p_A[1] * p_B[0] + p_A[2] * p_B[3] - p_A[3] * p_B[2];
+	const double t_Y = p_A[0] * p_B[2] - p_A[1] * p_B[3] + p_A[2] * p_B[0] + p_A[3] * p_B[1];
+	const double t_Z = p_A[0] * p_B[3] + p_A[1] * p_B[2] - p_A[2] * p_B[1] + p_A[3] * p_B[0];
+	p_Result[0] = t_W;
+	p_Result[1] = t_X;
+	p_Result[2] = t_Y;
+	p_Result[3] = t_Z;
+}
+
+static void Normalize(double p_Rotation[4])
+{
+	const double t_Length = std::sqrt(p_Rotation[0] * p_Rotation[0] + p_Rotation[1] * p_Rotation[1] + p_Rotation[2] * p_Rotation[2] + p_Rotation[3] * p_Rotation[3]);
+	if (t_Length <= 0.0 || !std::isfinite(t_Length))
+	{
+		p_Rotation[0] = 1.0;
+		p_Rotation[1] = p_Rotation[2] = p_Rotation[3] = 0.0;
+		return;
+	}
+	for (int i = 0; i < 4; i++) p_Rotation[i] /= t_Length;
+}
+
+static double Dot(const double p_A[4], const double p_B[4])
+{
+	return p_A[0] * p_B[0] + p_A[1] * p_B[1] + p_A[2] * p_B[2] + p_A[3] * p_B[3];
+}
+
+/// @brief The rotation vector (axis times angle) of a unit quaternion, along the short way round.
+static void ToRotationVector(const double p_Rotation[4], double p_Vector[3])
+{
+	const double t_Sign = p_Rotation[0] < 0.0 ? -1.0 : 1.0;
+	const double t_Sin = std::sqrt(p_Rotation[1] * p_Rotation[1] + p_Rotation[2] * p_Rotation[2] + p_Rotation[3] * p_Rotation[3]);
+	// close to identity angle / sin(angle / 2) tends to 2.
+	const double t_Scale = t_Sin < 1e-9 ? 2.0 : 2.0 * std::atan2(t_Sin, t_Sign * p_Rotation[0]) / t_Sin;
+	for (int i = 0; i < 3; i++) p_Vector[i] = t_Sign * t_Scale * p_Rotation[i + 1];
+}
+
+static void FromRotationVector(const double p_Vector[3], double p_Rotation[4])
+{
+	const double t_Angle = std::sqrt(p_Vector[0] * p_Vector[0] + p_Vector[1] * p_Vector[1] + p_Vector[2] * p_Vector[2]);
+	const double t_Scale = t_Angle < 1e-9 ? 0.5 : std::sin(t_Angle * 0.5) / t_Angle;
+	p_Rotation[0] = std::cos(t_Angle * 0.5);
+	for (int i = 0; i < 3; i++) p_Rotation[i + 1] = t_Scale * p_Vector[i];
+	Normalize(p_Rotation);
+}
+
+TrackerPose TrackerPose::FromTrackerData(const TrackerData& p_Data)
+{
+	TrackerPose t_Pose;
+	t_Pose.position[0] = p_Data.position.x;
+	t_Pose.position[1] = p_Data.position.y;
+	t_Pose.position[2] = p_Data.position.z;
+	t_Pose.rotation[0] = p_Data.rotation.w;
+	t_Pose.rotation[1] = p_Data.rotation.x;
+	t_Pose.rotation[2] = p_Data.rotation.y;
+	t_Pose.rotation[3] = p_Data.rotation.z;
+	Normalize(t_Pose.rotation);
+	return t_Pose;
+}
+
+void TrackerPoseError::Add(const TrackerPose& p_Pose, const TrackerPose& p_Truth)
+{
+	double t_Squared = 0.0;
+	for (int i = 0; i < 3; i++) t_Squared += (p_Pose.position[i] - p_Truth.position[i]) * (p_Pose.position[i] - p_Truth.position[i]);
+	const double t_Position = std::sqrt(t_Squared);
+	const double t_Rotation = 2.0 * std::acos((std::min)(1.0, std::fabs(Dot(p_Pose.rotation, p_Truth.rotation))));
+
+	count++;
+	positionSum += t_Position;
+	positionMax = (std::max)(positionMax, t_Position);
+	rotationSum += t_Rotation;
+	rotationMax = (std::max)(rotationMax, t_Rotation);
+}
+
+void InterpolateTrackerPose(const TrackerPose& p_From, const TrackerPose& p_To, const double p_Fraction, TrackerPose& p_Pose)
+{
+	for (int i = 0; i < 3; i++) p_Pose.position[i] = p_From.position[i] + (p_To.position[i] - p_From.position[i]) * p_Fraction;
+
+	// q and -q are the same rotation, blend towards whichever is closer.
+	double t_To[4] = { p_To.rotation[0], p_To.rotation[1], p_To.rotation[2], p_To.rotation[3] };
+	double t_Cos = Dot(p_From.rotation, t_To);
+	if (t_Cos < 0.0)
+	{
+		t_Cos = -t_Cos;
+		for (int i = 0; i < 4; i++) t_To[i] = -t_To[i];
+	}
+
+	double t_FromWeight = 1.0 - p_Fraction;
+	double t_ToWeight = p_Fraction;
+	if (t_Cos < 0.9995)
+	{
+		const double t_Angle = std::acos(t_Cos);
+		const double t_Sin = std::sin(t_Angle);
+		t_FromWeight = std::sin((1.0 - p_Fraction) * t_Angle) / t_Sin;
+		t_ToWeight = std::sin(p_Fraction * t_Angle) / t_Sin;
+	}
+	for (int i = 0; i < 4; i++) p_Pose.rotation[i] = t_FromWeight * p_From.rotation[i] + t_ToWeight * t_To[i];
+	Normalize(p_Pose.rotation);
+}
+
+void TrackerPredictor::Resize(const size_t p_TrackerCount)
+{
+	if (p_TrackerCount > m_Motion.size()) m_Motion.resize(p_TrackerCount);
+}
+
+void TrackerPredictor::AddSample(const uint32_t p_Slot, const int64_t p_SampleMs, const TrackerPose& p_Pose)
+{
+	if (p_Slot >= m_Motion.size()) return;
+	TrackerMotion& t_Motion = m_Motion[p_Slot];
+
+	if (!t_Motion.hasSample)
+	{
+		t_Motion.hasSample = true;
+		t_Motion.sampleMs = p_SampleMs;
+		t_Motion.pose = p_Pose;
+		return;
+	}
+	// the loop picks up the same sample again when the tracker has not moved on.
+	if (p_SampleMs <= t_Motion.sampleMs) return;
+
+	const double t_Seconds = (p_SampleMs - t_Motion.sampleMs) / 1000.0;
+	if (t_Motion.hasPending && p_SampleMs >= t_Motion.pendingMs)
+	{
+		if (t_Seconds <= s_MaxSampleGapSeconds)
+		{
+			TrackerPose t_Truth;
+			InterpolateTrackerPose(t_Motion.pose, p_Pose, (t_Motion.pendingMs - t_Motion.sampleMs) / (p_SampleMs - t_Motion.sampleMs), t_Truth);
+			m_PredictionError.Add(t_Motion.pendingPose, t_Truth);
+			m_HoldError.Add(t_Motion.heldPose, t_Truth);
+		}
+		t_Motion.hasPending = false;
+	}
+
+	if (t_Seconds > s_MaxSampleGapSeconds)
+	{
+		t_Motion.hasVelocity = false;
+		t_Motion.hasPending = false;
+	}
+	else
+	{
+		double t_Linear[3];
+		for (int i = 0; i < 3; i++) t_Linear[i] = (p_Pose.position[i] - t_Motion.pose.position[i]) / t_Seconds;
+
+		const double t_Inverse[4] = { t_Motion.pose.rotation[0], -t_Motion.pose.rotation[1], -t_Motion.pose.rotation[2], -t_Motion.pose.rotation[3] };
+		double t_Delta[4];
+		Multiply(p_Pose.rotation, t_Inverse, t_Delta);
+		double t_Angular[3];
+		ToRotationVector(t_Delta, t_Angular);
+
+		const double t_Weight = t_Motion.hasVelocity ? s_VelocitySmoothing : 1.0;
+		for (int i = 0; i < 3; i++)
+		{
+			t_Motion.linear[i] += (t_Linear[i] - t_Motion.linear[i]) * t_Weight;
+			t_Motion.angular[i] += (t_Angular[i] / t_Seconds - t_Motion.angular[i]) * t_Weight;
+		}
+		t_Motion.hasVelocity = true;
+	}
+
+	t_Motion.sampleMs = p_SampleMs;
+	t_Motion.pose = p_Pose;
+}
+
+bool TrackerPredictor::Predict(const uint32_t p_Slot, const double p_TargetMs, const double p_MaxHorizonMs, TrackerPose& p_Pose)
+{
+	if (p_Slot >= m_Motion.size() || !m_Motion[p_Slot].hasSample) return false;
+	TrackerMotion& t_Motion = m_Motion[p_Slot];
+
+	p_Pose = t_Motion.pose;
+	if (!t_Motion.hasVelocity) return true;
+
+	const double t_Seconds = (std::min)((std::max)(p_TargetMs - t_Motion.sampleMs, 0.0), p_MaxHorizonMs) / 1000.0;
+	for (int i = 0; i < 3; i++) p_Pose.position[i] += t_Motion.linear[i] * t_Seconds;
+	const double t_Vector[3] = { t_Motion.angular[0] * t_Seconds, t_Motion.angular[1] * t_Seconds, t_Motion.angular[2] * t_Seconds };
+	double t_Step[4];
+	FromRotationVector(t_Vector, t_Step);
+	Multiply(t_Step, t_Motion.pose.rotation, p_Pose.rotation);
+	Normalize(p_Pose.rotation);
+
+	// one prediction per tracker is scored at a time, enough for the statistics.
+	if (!t_Motion.hasPending && t_Seconds > 0.0)
+	{
+		t_Motion.hasPending = true;
+		t_Motion.pendingMs = t_Motion.sampleMs + t_Seconds * 1000.0;
+		t_Motion.pendingPose = p_Pose;
+		t_Motion.heldPose = t_Motion.pose;
+	}
+	return true;
+}
+
+void TrackerPredictor::PrintErrors() const
+{
+	if (m_PredictionError.count == 0)
+	{
+		std::cout << "No tracker prediction could be checked against a later sample.\n";
+		return;
+	}
+
+	const double t_Degrees = 180.0 / 3.14159265358979323846;
+	std::cout << "Tracker prediction residual over " << m_PredictionError.count << " predictions: "
+		<< (m_PredictionError.positionSum / m_PredictionError.count * 1000.0) << " mm mean, "
+		<< (m_PredictionError.positionMax * 1000.0) << " mm max, "
+		<< (m_PredictionError.rotationSum / m_PredictionError.count * t_Degrees) << " deg mean, "
+		<< (m_PredictionError.rotationMax * t_Degrees) << " deg max.\n";
+	std::cout << "Holding the last sample instead: "
+		<< (m_HoldError.positionSum / m_HoldError.count * 1000.0) << " mm mean, "
+		<< (m_HoldError.positionMax * 1000.0) << " mm max, "
+		<< (m_HoldError.rotationSum / m_HoldError.count * t_Degrees) << " deg mean, "
+		<< (m_HoldError.rotationMax * t_Degrees) << " deg max.\n";
+}
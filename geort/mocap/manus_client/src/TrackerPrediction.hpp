@@ -0,0 +1,108 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _TRACKER_PREDICTION_HPP_
+#define _TRACKER_PREDICTION_HPP_
+
+#include "ManusSDKTypes.h"
+
+// size_t
+#include <cstddef>
+// int64_t, uint32_t, uint64_t
+#include <cstdint>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTracking
+ *  @{
+ */
+
+/// @brief A tracker pose in double precision, the rotation as w, x, y, z.
+class TrackerPose
+{
+public:
+	double position[3] = { 0.0, 0.0, 0.0 };
+	double rotation[4] = { 1.0, 0.0, 0.0, 0.0 };
+
+	static TrackerPose FromTrackerData(const TrackerData& p_Data);
+};
+
+/// @brief Position (meters) and rotation (radians) error of a series of poses.
+class TrackerPoseError
+{
+public:
+	uint64_t count = 0;
+	double positionSum = 0.0;
+	double positionMax = 0.0;
+	double rotationSum = 0.0;
+	double rotationMax = 0.0;
+
+	void Add(const TrackerPose& p_Pose, const TrackerPose& p_Truth);
+};
+
+/// @brief Interpolate between two poses, linearly for the position and by SLERP for the rotation.
+void InterpolateTrackerPose(const TrackerPose& p_From, const TrackerPose& p_To, const double p_Fraction, TrackerPose& p_Pose);
+
+/// @brief Extrapolates tracker poses to hide the latency between a lighthouse sample and the
+/// moment it is used.
+///
+/// Per tracker the linear and angular velocity are estimated by finite differences on SE(3)
+/// between consecutive samples (position difference and the rotation vector of q1 * q0^-1, both
+/// over the lastUpdateTime difference), smoothed over a few samples. A prediction moves the last
+/// sample along these velocities, at constant velocity, up to a bounded horizon.
+///
+/// Predictions are scored against the samples that arrive later: the truth at the predicted time
+/// is interpolated between the samples around it. The error of simply holding the last sample is
+/// scored alongside, so the two can be compared.
+///
+/// Times are milliseconds on the clock of the SDK (lastUpdateTime, publishTime). Trackers are
+/// addressed by slot, the state of all slots is kept in one flat array.
+class TrackerPredictor
+{
+public:
+	/// @brief Make room for p_TrackerCount slots, existing slots keep their state.
+	void Resize(const size_t p_TrackerCount);
+
+	/// @brief Add a sample of a tracker taken at p_SampleMs. A sample that is not newer than the
+	/// last one of the slot is ignored. Settles the pending prediction of the slot if the sample
+	/// is past its time.
+	void AddSample(const uint32_t p_Slot, const int64_t p_SampleMs, const TrackerPose& p_Pose);
+
+	/// @brief The pose of a tracker at p_TargetMs, at most p_MaxHorizonMs past its last sample.
+	/// @return false if the slot has no sample yet.
+	bool Predict(const uint32_t p_Slot, const double p_TargetMs, const double p_MaxHorizonMs, TrackerPose& p_Pose);
+
+	const TrackerPoseError& GetPredictionError() const { return m_PredictionError; }
+	/// @brief The error of publishing the last sample at the predicted times instead.
+	const TrackerPoseError& GetHoldError() const { return m_HoldError; }
+	void PrintErrors() const;
+
+protected:
+	class TrackerMotion
+	{
+	public:
+		bool hasSample = false;
+		bool hasVelocity = false;
+		bool hasPending = false;
+		int64_t sampleMs = 0;
+		TrackerPose pose;
+		double linear[3] = { 0.0, 0.0, 0.0 }; // meters per second.
+		double angular[3] = { 0.0, 0.0, 0.0 }; // rotation vector per second, world frame.
+		double pendingMs = 0.0;
+		TrackerPose pendingPose; // predicted for pendingMs, waiting for a later sample.
+		TrackerPose heldPose; // the sample the pending prediction started from.
+	};
+
+	std::vector<TrackerMotion> m_Motion;
+	TrackerPoseError m_PredictionError;
+	TrackerPoseError m_HoldError;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
@@ -0,0 +1,153 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "TrackerRegistry.hpp"
+
+// std::memcmp, std::memcpy, std::memset
+#include <cstring>
+// std::ifstream
+#include <fstream>
+#include <iostream>
+// std::istringstream
+#include <sstream>
+
+/// @brief Seeds tried per table size before the table is doubled.
+static const uint32_t s_SeedAttempts = 256;
+
+bool TrackerRegistry::MakeTrackerId(const std::string& p_Text, TrackerId& p_Id)
+{
+	// the SDK terminates the ID, so one byte is taken by the terminator.
+	if (p_Text.empty() || p_Text.size() >= sizeof(p_Id.id)) return false;
+	std::memset(p_Id.id, 0, sizeof(p_Id.id));
+	std::memcpy(p_Id.id, p_Text.data(), p_Text.size());
+	return true;
+}
+
+uint32_t TrackerRegistry::Hash(const TrackerId& p_Id, const uint32_t p_Seed)
+{
+	// FNV-1a up to the terminator, the seed replaces the offset basis.
+	uint32_t t_Hash = 2166136261u ^ p_Seed;
+	for (size_t i = 0; i < sizeof(p_Id.id) && p_Id.id[i] != '\0'; i++)
+	{
+		t_Hash ^= static_cast<unsigned char>(p_Id.id[i]);
+		t_Hash *= 16777619u;
+	}
+	// FNV spreads poorly into the low bits for short keys, mix before masking.
+	t_Hash ^= t_Hash >> 15;
+	t_Hash *= 0x2C1B3C6Du;
+	t_Hash ^= t_Hash >> 12;
+	return t_Hash;
+}
+
+bool TrackerRegistry::Load(const std::string& p_Path)
+{
+	std::ifstream t_File(p_Path);
+	if (!t_File)
+	{
+		std::cerr << "Could not open tracker config " << p_Path << "." << std::endl;
+		return false;
+	}
+
+	std::vector<TrackerRoute> t_Routes;
+	std::string t_Line;
+	for (size_t t_LineNumber = 1; std::getline(t_File, t_Line); t_LineNumber++)
+	{
+		if (!t_Line.empty() && t_Line.back() == '\r') t_Line.pop_back();
+		const size_t t_First = t_Line.find_first_not_of(" \t");
+		if (t_First == std::string::npos || t_Line[t_First] == '#') continue;
+
+		std::istringstream t_Stream(t_Line);
+		std::string t_Topic;
+		std::string t_Frame;
+		std::string t_Id;
+		t_Stream >> t_Topic >> t_Frame >> std::ws;
+		std::getline(t_Stream, t_Id);
+		const size_t t_Last = t_Id.find_last_not_of(" \t");
+		t_Id.erase(t_Last == std::string::npos ? 0 : t_Last + 1);
+
+		TrackerRoute t_Route;
+		if (t_Frame.empty() || !MakeTrackerId(t_Id, t_Route.trackerId))
+		{
+			std::cerr << "Tracker config " << p_Path << " line " << t_LineNumber << " is not <topic> <frame> <tracker id> with an ID of at most "
+				<< (sizeof(t_Route.trackerId.id) - 1) << " characters." << std::endl;
+			return false;
+		}
+		t_Route.topic = t_Topic == "-" ? std::string() : t_Topic;
+		t_Route.frame = t_Frame == "-" ? t_Id : t_Frame;
+		t_Routes.push_back(t_Route);
+	}
+
+	if (!SetRoutes(t_Routes)) return false;
+	std::cout << "Loaded " << m_Routes.size() << " tracker routes from " << p_Path << ".\n";
+	return true;
+}
+
+bool TrackerRegistry::SetRoutes(const std::vector<TrackerRoute>& p_Routes)
+{
+	for (const TrackerRoute& t_Route : p_Routes)
+	{
+		if (t_Route.trackerId.id[0] == '\0' || std::memchr(t_Route.trackerId.id, '\0', sizeof(t_Route.trackerId.id)) == nullptr)
+		{
+			std::cerr << "A tracker route has an empty or unterminated tracker ID." << std::endl;
+			return false;
+		}
+	}
+
+	// a power of two at least twice the route count keeps a collision free seed easy to find.
+	uint32_t t_Size = 1;
+	while (t_Size < p_Routes.size() * 2) t_Size *= 2;
+
+	std::vector<uint32_t> t_Slots;
+	while (true)
+	{
+		for (uint32_t t_Seed = 0; t_Seed < s_SeedAttempts; t_Seed++)
+		{
+			t_Slots.assign(t_Size, TRACKER_ROUTE_NONE);
+			bool t_Collision = false;
+			for (uint32_t i = 0; i < p_Routes.size() && !t_Collision; i++)
+			{
+				uint32_t& t_Slot = t_Slots[Hash(p_Routes[i].trackerId, t_Seed) & (t_Size - 1)];
+				if (t_Slot != TRACKER_ROUTE_NONE)
+				{
+					// a repeated ID collides with every seed, report it instead of growing forever.
+					if (std::memcmp(p_Routes[t_Slot].trackerId.id, p_Routes[i].trackerId.id, sizeof(p_Routes[i].trackerId.id)) == 0)
+					{
+						std::cerr << "Tracker " << p_Routes[i].trackerId.id << " has more than one route." << std::endl;
+						return false;
+					}
+					t_Collision = true;
+				}
+				t_Slot = i;
+			}
+			if (!t_Collision)
+			{
+				m_Routes = p_Routes;
+				m_Slots.swap(t_Slots);
+				m_Seed = t_Seed;
+				m_Mask = t_Size - 1;
+				return true;
+			}
+		}
+		t_Size *= 2;
+	}
+}
+
+uint32_t TrackerRegistry::Find(const TrackerId& p_Id) const
+{
+	if (m_Slots.empty()) return TRACKER_ROUTE_NONE;
+
+	const uint32_t t_Route = m_Slots[Hash(p_Id, m_Seed) & m_Mask];
+	if (t_Route == TRACKER_ROUTE_NONE) return TRACKER_ROUTE_NONE;
+
+	// the hash is only perfect for the configured IDs, anything else has to be compared away.
+	const TrackerId& t_Candidate = m_Routes[t_Route].trackerId;
+	const size_t t_Length = strnlen(p_Id.id, sizeof(p_Id.id));
+	if (std::memcmp(t_Candidate.id, p_Id.id, t_Length) != 0 || (t_Length < sizeof(t_Candidate.id) && t_Candidate.id[t_Length] != '\0'))
+	{
+		return TRACKER_ROUTE_NONE;
+	}
+	return t_Route;
+}
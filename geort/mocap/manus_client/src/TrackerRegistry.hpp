@@ -0,0 +1,75 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _TRACKER_REGISTRY_HPP_
+#define _TRACKER_REGISTRY_HPP_
+
+#include "ManusSDKTypes.h"
+
+// uint32_t
+#include <cstdint>
+// std::string
+#include <string>
+// std::vector
+#include <vector>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTracking
+ *  @{
+ */
+
+/// @brief Returned by TrackerRegistry::Find for a tracker that has no route.
+#define TRACKER_ROUTE_NONE 0xFFFFFFFFu
+
+/// @brief Where the data of one tracker goes.
+class TrackerRoute
+{
+public:
+	TrackerId trackerId; // zero padded, so IDs compare as whole arrays.
+	std::string topic; // PoseStamped topic, empty for TF only.
+	std::string frame; // TF child frame.
+};
+
+/// @brief Maps tracker IDs to their routes in constant time.
+///
+/// The routes come from a text file, one tracker per line:
+///   <topic> <frame> <tracker id>
+/// The tracker ID is the rest of the line, so it may contain spaces ("headset serial"). A topic of
+/// "-" publishes TF only, a frame of "-" uses the tracker ID as the frame. Empty lines and lines
+/// starting with # are skipped.
+///
+/// The IDs are interned into fixed size arrays and placed in a table by a seeded hash that is
+/// chosen at load time to be collision free for exactly these IDs, so Find costs one hash and one
+/// comparison however many trackers are configured.
+class TrackerRegistry
+{
+public:
+	/// @brief Read the routes from p_Path. The registry is left unchanged on failure.
+	bool Load(const std::string& p_Path);
+	/// @brief Replace the routes. Fails, changing nothing, if an ID is empty, too long or repeated.
+	bool SetRoutes(const std::vector<TrackerRoute>& p_Routes);
+
+	const std::vector<TrackerRoute>& GetRoutes() const { return m_Routes; }
+
+	/// @return the index of the route of p_Id in GetRoutes, TRACKER_ROUTE_NONE if there is none.
+	uint32_t Find(const TrackerId& p_Id) const;
+
+	/// @brief Fill a TrackerId from a string, false if it does not fit.
+	static bool MakeTrackerId(const std::string& p_Text, TrackerId& p_Id);
+
+protected:
+	static uint32_t Hash(const TrackerId& p_Id, const uint32_t p_Seed);
+
+	std::vector<TrackerRoute> m_Routes;
+	std::vector<uint32_t> m_Slots; // route index per slot, TRACKER_ROUTE_NONE if empty.
+	uint32_t m_Seed = 0;
+	uint32_t m_Mask = 0;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
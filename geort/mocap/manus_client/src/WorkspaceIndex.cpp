@@ -0,0 +1,347 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#include "WorkspaceIndex.hpp"
+
+// std::nth_element, std::min, std::max
+#include <algorithm>
+// std::isfinite, std::sqrt
+#include <cmath>
+// std::memcmp, std::memcpy
+#include <cstring>
+// std::ofstream
+#include <fstream>
+#include <iostream>
+// std::numeric_limits
+#include <limits>
+// std::vector
+#include <vector>
+
+// mmap
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// @brief Round p_Value up to the next multiple of 64.
+static inline uint64_t AlignTo64(const uint64_t p_Value)
+{
+	return (p_Value + 63) & ~static_cast<uint64_t>(63);
+}
+
+/// @brief Recursively split the points [p_Begin, p_End) of p_Order and append the nodes in pre-order.
+static void BuildKdTree(
+	const float* const p_Points,
+	std::vector<uint32_t>& p_Order,
+	const uint32_t p_Begin,
+	const uint32_t p_End,
+	const uint32_t p_LeafSize,
+	std::vector<WorkspaceIndexNode>& p_Nodes)
+{
+	const size_t t_NodeIndex = p_Nodes.size();
+	p_Nodes.push_back(WorkspaceIndexNode{ 0.0f, WORKSPACE_INDEX_LEAF, p_Begin, p_End, 0 });
+	if (p_End - p_Begin <= p_LeafSize)
+	{
+		return;
+	}
+
+	// split along the axis with the largest extent.
+	float t_Min[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+	float t_Max[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+	for (uint32_t i = p_Begin; i < p_End; i++)
+	{
+		for (int a = 0; a < 3; a++)
+		{
+			t_Min[a] = std::min(t_Min[a], p_Points[p_Order[i] * 3 + a]);
+			t_Max[a] = std::max(t_Max[a], p_Points[p_Order[i] * 3 + a]);
+		}
+	}
+	uint32_t t_Axis = 0;
+	for (uint32_t a = 1; a < 3; a++)
+	{
+		if (t_Max[a] - t_Min[a] > t_Max[t_Axis] - t_Min[t_Axis]) t_Axis = a;
+	}
+
+	const uint32_t t_Mid = p_Begin + (p_End - p_Begin) / 2;
+	std::nth_element(p_Order.begin() + p_Begin, p_Order.begin() + t_Mid, p_Order.begin() + p_End,
+		[p_Points, t_Axis](const uint32_t p_A, const uint32_t p_B)
+		{
+			return p_Points[p_A * 3 + t_Axis] < p_Points[p_B * 3 + t_Axis];
+		});
+
+	p_Nodes[t_NodeIndex].axis = t_Axis;
+	p_Nodes[t_NodeIndex].split = p_Points[p_Order[t_Mid] * 3 + t_Axis];
+	BuildKdTree(p_Points, p_Order, p_Begin, t_Mid, p_LeafSize, p_Nodes);
+	p_Nodes[t_NodeIndex].right = static_cast<uint32_t>(p_Nodes.size());
+	BuildKdTree(p_Points, p_Order, t_Mid, p_End, p_LeafSize, p_Nodes);
+}
+
+WorkspaceIndex::WorkspaceIndex()
+{
+}
+
+WorkspaceIndex::~WorkspaceIndex()
+{
+	Unload();
+}
+
+/*static*/ bool WorkspaceIndex::Build(
+	const float* const p_Points,
+	const uint32_t p_NumFingers,
+	const uint32_t p_NumPoints,
+	const uint32_t p_LeafSize,
+	const std::string& p_Path)
+{
+	if (p_NumFingers == 0 || p_LeafSize == 0)
+	{
+		std::cerr << "A workspace index needs at least one finger and a leaf size of at least one." << std::endl;
+		return false;
+	}
+
+	std::vector<WorkspaceIndexFinger> t_Fingers(p_NumFingers);
+	std::vector<std::vector<WorkspaceIndexNode>> t_Nodes(p_NumFingers);
+	std::vector<std::vector<float>> t_Points(p_NumFingers);
+
+	uint64_t t_Offset = AlignTo64(sizeof(WorkspaceIndexHeader));
+	t_Offset = AlignTo64(t_Offset + sizeof(WorkspaceIndexFinger) * p_NumFingers);
+
+	for (uint32_t f = 0; f < p_NumFingers; f++)
+	{
+		const float* const t_Source = p_Points + static_cast<size_t>(f) * p_NumPoints * 3;
+
+		// drop non-finite samples, they would poison every split they touch.
+		std::vector<uint32_t> t_Order;
+		t_Order.reserve(p_NumPoints);
+		for (uint32_t i = 0; i < p_NumPoints; i++)
+		{
+			if (std::isfinite(t_Source[i * 3]) && std::isfinite(t_Source[i * 3 + 1]) && std::isfinite(t_Source[i * 3 + 2]))
+			{
+				t_Order.push_back(i);
+			}
+		}
+		if (t_Order.empty())
+		{
+			std::cerr << "Finger " << f << " has no finite points." << std::endl;
+			return false;
+		}
+
+		BuildKdTree(t_Source, t_Order, 0, static_cast<uint32_t>(t_Order.size()), p_LeafSize, t_Nodes[f]);
+
+		WorkspaceIndexFinger& t_Finger = t_Fingers[f];
+		t_Finger.numNodes = static_cast<uint32_t>(t_Nodes[f].size());
+		t_Finger.numPoints = static_cast<uint32_t>(t_Order.size());
+		for (int a = 0; a < 3; a++)
+		{
+			t_Finger.boundsMin[a] = std::numeric_limits<float>::max();
+			t_Finger.boundsMax[a] = std::numeric_limits<float>::lowest();
+		}
+
+		// store the points in tree order so a leaf is one contiguous run.
+		t_Points[f].resize(t_Order.size() * 3);
+		for (size_t i = 0; i < t_Order.size(); i++)
+		{
+			for (int a = 0; a < 3; a++)
+			{
+				const float t_Value = t_Source[t_Order[i] * 3 + a];
+				t_Points[f][i * 3 + a] = t_Value;
+				t_Finger.boundsMin[a] = std::min(t_Finger.boundsMin[a], t_Value);
+				t_Finger.boundsMax[a] = std::max(t_Finger.boundsMax[a], t_Value);
+			}
+		}
+
+		t_Finger.nodeOffset = t_Offset;
+		t_Offset = AlignTo64(t_Offset + sizeof(WorkspaceIndexNode) * t_Finger.numNodes);
+		t_Finger.pointOffset = t_Offset;
+		t_Offset = AlignTo64(t_Offset + sizeof(float) * 3 * t_Finger.numPoints);
+	}
+
+	WorkspaceIndexHeader t_Header;
+	std::memset(&t_Header, 0, sizeof(t_Header));
+	std::memcpy(t_Header.magic, WORKSPACE_INDEX_MAGIC, sizeof(t_Header.magic));
+	t_Header.version = WORKSPACE_INDEX_VERSION;
+	t_Header.numFingers = p_NumFingers;
+	t_Header.leafSize = p_LeafSize;
+	t_Header.fileSize = t_Offset;
+
+	std::ofstream t_File(p_Path, std::ofstream::binary | std::ofstream::trunc);
+	if (!t_File)
+	{
+		std::cerr << "Could not open " << p_Path << " for writing." << std::endl;
+		return false;
+	}
+
+	static const char s_Zeros[64] = { 0 };
+	auto t_PadTo = [&t_File](const uint64_t p_Target)
+	{
+		const uint64_t t_Position = static_cast<uint64_t>(t_File.tellp());
+		t_File.write(s_Zeros, static_cast<std::streamsize>(p_Target - t_Position));
+	};
+
+	t_File.write(reinterpret_cast<const char*>(&t_Header), sizeof(t_Header));
+	t_PadTo(AlignTo64(sizeof(WorkspaceIndexHeader)));
+	t_File.write(reinterpret_cast<const char*>(t_Fingers.data()), sizeof(WorkspaceIndexFinger) * p_NumFingers);
+	for (uint32_t f = 0; f < p_NumFingers; f++)
+	{
+		t_PadTo(t_Fingers[f].nodeOffset);
+		t_File.write(reinterpret_cast<const char*>(t_Nodes[f].data()), sizeof(WorkspaceIndexNode) * t_Nodes[f].size());
+		t_PadTo(t_Fingers[f].pointOffset);
+		t_File.write(reinterpret_cast<const char*>(t_Points[f].data()), sizeof(float) * t_Points[f].size());
+	}
+	t_PadTo(t_Offset);
+
+	if (!t_File)
+	{
+		std::cerr << "Failed to write " << p_Path << "." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool WorkspaceIndex::Load(const std::string& p_Path)
+{
+	Unload();
+
+	const int t_Descriptor = open(p_Path.c_str(), O_RDONLY);
+	if (t_Descriptor < 0)
+	{
+		std::cerr << "Could not open workspace index " << p_Path << "." << std::endl;
+		return false;
+	}
+
+	struct stat t_Stat;
+	if (fstat(t_Descriptor, &t_Stat) != 0 || static_cast<size_t>(t_Stat.st_size) < sizeof(WorkspaceIndexHeader))
+	{
+		std::cerr << "Workspace index " << p_Path << " is too small." << std::endl;
+		close(t_Descriptor);
+		return false;
+	}
+
+	void* const t_Mapping = mmap(nullptr, static_cast<size_t>(t_Stat.st_size), PROT_READ, MAP_SHARED, t_Descriptor, 0);
+	// the mapping keeps the file alive, the descriptor is no longer needed.
+	close(t_Descriptor);
+	if (t_Mapping == MAP_FAILED)
+	{
+		std::cerr << "Could not mmap workspace index " << p_Path << "." << std::endl;
+		return false;
+	}
+
+	m_Data = static_cast<const unsigned char*>(t_Mapping);
+	m_Size = static_cast<size_t>(t_Stat.st_size);
+	m_Header = reinterpret_cast<const WorkspaceIndexHeader*>(m_Data);
+
+	bool t_Valid = std::memcmp(m_Header->magic, WORKSPACE_INDEX_MAGIC, sizeof(m_Header->magic)) == 0
+		&& m_Header->version == WORKSPACE_INDEX_VERSION
+		&& m_Header->fileSize == m_Size
+		&& AlignTo64(sizeof(WorkspaceIndexHeader)) + sizeof(WorkspaceIndexFinger) * static_cast<uint64_t>(m_Header->numFingers) <= m_Size;
+	for (uint32_t f = 0; t_Valid && f < m_Header->numFingers; f++)
+	{
+		const WorkspaceIndexFinger* const t_Finger = GetFinger(f);
+		t_Valid = t_Finger->nodeOffset + sizeof(WorkspaceIndexNode) * static_cast<uint64_t>(t_Finger->numNodes) <= m_Size
+			&& t_Finger->pointOffset + sizeof(float) * 3 * static_cast<uint64_t>(t_Finger->numPoints) <= m_Size
+			&& t_Finger->numNodes > 0;
+	}
+	if (!t_Valid)
+	{
+		std::cerr << "Workspace index " << p_Path << " is corrupt or was written by a different version." << std::endl;
+		Unload();
+		return false;
+	}
+
+	return true;
+}
+
+void WorkspaceIndex::Unload()
+{
+	if (m_Data != nullptr)
+	{
+		munmap(const_cast<unsigned char*>(m_Data), m_Size);
+	}
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Header = nullptr;
+}
+
+const WorkspaceIndexFinger* WorkspaceIndex::GetFinger(const uint32_t p_Finger) const
+{
+	if (m_Header == nullptr || p_Finger >= m_Header->numFingers) return nullptr;
+	return reinterpret_cast<const WorkspaceIndexFinger*>(m_Data + AlignTo64(sizeof(WorkspaceIndexHeader))) + p_Finger;
+}
+
+bool WorkspaceIndex::FindNearest(
+	const uint32_t p_Finger,
+	const float* const p_Query,
+	float* const p_Nearest,
+	float* const p_DistanceSquared) const
+{
+	const WorkspaceIndexFinger* const t_Finger = GetFinger(p_Finger);
+	if (t_Finger == nullptr || t_Finger->numPoints == 0) return false;
+
+	const WorkspaceIndexNode* const t_Nodes = reinterpret_cast<const WorkspaceIndexNode*>(m_Data + t_Finger->nodeOffset);
+	const float* const t_Points = reinterpret_cast<const float*>(m_Data + t_Finger->pointOffset);
+
+	float t_Best = std::numeric_limits<float>::max();
+	uint32_t t_BestIndex = 0;
+
+	// the tree depth is log2(points / leafSize), 64 entries covers any 32 bit point count.
+	struct StackEntry
+	{
+		uint32_t node;
+		float boundSquared;
+	};
+	StackEntry t_Stack[64];
+	uint32_t t_StackSize = 0;
+	t_Stack[t_StackSize++] = { 0, 0.0f };
+
+	while (t_StackSize > 0)
+	{
+		const StackEntry t_Entry = t_Stack[--t_StackSize];
+		if (t_Entry.boundSquared >= t_Best) continue;
+
+		const WorkspaceIndexNode& t_Node = t_Nodes[t_Entry.node];
+		if (t_Node.axis == WORKSPACE_INDEX_LEAF)
+		{
+			for (uint32_t i = t_Node.begin; i < t_Node.end; i++)
+			{
+				const float t_X = t_Points[i * 3] - p_Query[0];
+				const float t_Y = t_Points[i * 3 + 1] - p_Query[1];
+				const float t_Z = t_Points[i * 3 + 2] - p_Query[2];
+				const float t_DistanceSquared = t_X * t_X + t_Y * t_Y + t_Z * t_Z;
+				if (t_DistanceSquared < t_Best)
+				{
+					t_Best = t_DistanceSquared;
+					t_BestIndex = i;
+				}
+			}
+			continue;
+		}
+
+		// visit the side containing the query first, so push it last.
+		const float t_Delta = p_Query[t_Node.axis] - t_Node.split;
+		const uint32_t t_Near = t_Delta < 0.0f ? t_Entry.node + 1 : t_Node.right;
+		const uint32_t t_Far = t_Delta < 0.0f ? t_Node.right : t_Entry.node + 1;
+		t_Stack[t_StackSize++] = { t_Far, std::max(t_Entry.boundSquared, t_Delta * t_Delta) };
+		t_Stack[t_StackSize++] = { t_Near, t_Entry.boundSquared };
+	}
+
+	p_Nearest[0] = t_Points[t_BestIndex * 3];
+	p_Nearest[1] = t_Points[t_BestIndex * 3 + 1];
+	p_Nearest[2] = t_Points[t_BestIndex * 3 + 2];
+	if (p_DistanceSquared != nullptr) *p_DistanceSquared = t_Best;
+	return true;
+}
+
+bool WorkspaceIndex::ProjectToWorkspace(const uint32_t p_Finger, float* const p_Point, const float p_Tolerance) const
+{
+	float t_Nearest[3];
+	float t_DistanceSquared = 0.0f;
+	if (!FindNearest(p_Finger, p_Point, t_Nearest, &t_DistanceSquared)) return false;
+	if (t_DistanceSquared <= p_Tolerance * p_Tolerance) return false;
+
+	p_Point[0] = t_Nearest[0];
+	p_Point[1] = t_Nearest[1];
+	p_Point[2] = t_Nearest[2];
+	return true;
+}
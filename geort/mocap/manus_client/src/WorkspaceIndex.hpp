@@ -0,0 +1,121 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+#ifndef _WORKSPACE_INDEX_HPP_
+#define _WORKSPACE_INDEX_HPP_
+
+// size_t
+#include <cstddef>
+// uint32_t, uint64_t
+#include <cstdint>
+// std::string
+#include <string>
+
+// Set up a Doxygen group.
+/** @addtogroup GeoRTTools
+ *  @{
+ */
+
+/// @brief Per-finger spatial index over the reachable robot fingertip positions.
+///
+/// The index is built once by the build_workspace_index tool from the robot point cloud the
+/// trainer exports (data/<hand>_pointcloud.npy, [Num_Fingers, N, 3]) and stored in a single
+/// file that is used in place through mmap. Every finger gets a kd-tree whose nodes and
+/// points are plain arrays, so loading is one mmap call and a header check.
+///
+/// File layout, all little endian, every section starts at a 64 byte boundary:
+///   WorkspaceIndexHeader
+///   WorkspaceIndexFinger[numFingers]
+///   per finger: WorkspaceIndexNode[numNodes], then float[numPoints * 3] points in tree order.
+/// Offsets in the finger table are relative to the start of the file.
+
+/// @brief Magic bytes at the start of a workspace index file.
+#define WORKSPACE_INDEX_MAGIC "GEORTWSI"
+/// @brief Bumped whenever the layout below changes.
+#define WORKSPACE_INDEX_VERSION 1
+
+typedef struct WorkspaceIndexHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t numFingers;
+	uint32_t leafSize;
+	uint32_t reserved;
+	uint64_t fileSize;
+} WorkspaceIndexHeader;
+
+typedef struct WorkspaceIndexFinger
+{
+	uint64_t nodeOffset;
+	uint64_t pointOffset;
+	uint32_t numNodes;
+	uint32_t numPoints;
+	float boundsMin[3];
+	float boundsMax[3];
+} WorkspaceIndexFinger;
+
+/// @brief A kd-tree node. Nodes are stored in pre-order, so the left child is the next node.
+/// Leaves have axis set to WORKSPACE_INDEX_LEAF and cover points [begin, end).
+typedef struct WorkspaceIndexNode
+{
+	float split;
+	uint32_t axis;
+	uint32_t begin;
+	uint32_t end;
+	uint32_t right;
+} WorkspaceIndexNode;
+
+#define WORKSPACE_INDEX_LEAF 3u
+
+class WorkspaceIndex
+{
+public:
+	WorkspaceIndex();
+	~WorkspaceIndex();
+
+	/// @brief Build the index from a [p_NumFingers, p_NumPoints, 3] cloud and write it to p_Path.
+	static bool Build(
+		const float* const p_Points,
+		const uint32_t p_NumFingers,
+		const uint32_t p_NumPoints,
+		const uint32_t p_LeafSize,
+		const std::string& p_Path);
+
+	/// @brief Map an index file. Any previously loaded file is released first.
+	bool Load(const std::string& p_Path);
+
+	/// @brief Release the mapping.
+	void Unload();
+
+	bool IsLoaded() const { return m_Data != nullptr; }
+	uint32_t GetNumFingers() const { return m_Header != nullptr ? m_Header->numFingers : 0; }
+
+	/// @brief Find the reachable point of a finger closest to p_Query.
+	/// @param p_Nearest receives the xyz of the nearest reachable point.
+	/// @param p_DistanceSquared optionally receives the squared distance to it.
+	/// @return false if the finger does not exist or has no points.
+	bool FindNearest(
+		const uint32_t p_Finger,
+		const float* const p_Query,
+		float* const p_Nearest,
+		float* const p_DistanceSquared = nullptr) const;
+
+	/// @brief Project p_Query onto the reachable set when it is further than p_Tolerance away from it.
+	/// @return true if the point was moved.
+	bool ProjectToWorkspace(const uint32_t p_Finger, float* const p_Point, const float p_Tolerance) const;
+
+protected:
+	const WorkspaceIndexFinger* GetFinger(const uint32_t p_Finger) const;
+
+	const unsigned char* m_Data = nullptr;
+	size_t m_Size = 0;
+	const WorkspaceIndexHeader* m_Header = nullptr;
+};
+
+// Close the Doxygen group.
+/** @} */
+
+#endif
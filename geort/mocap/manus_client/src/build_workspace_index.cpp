@@ -0,0 +1,89 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+// build_workspace_index : builds the per-finger workspace index from the robot point cloud.
+//
+// Usage: build_workspace_index <hand>_pointcloud.npy <out>.wsi [leaf_size]
+//
+// The point cloud is the [Num_Fingers, N, 3] array GeoRTTrainer.generate_robot_kinematics_dataset writes
+// next to the kinematics dataset. After writing, the index is mapped again and every finger is
+// queried with jittered samples of its own cloud to report the lookup cost.
+
+#include "CommandLine.hpp"
+#include "NpyFile.hpp"
+#include "WorkspaceIndex.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+	uint32_t t_LeafSize = 16;
+	if (argc < 3 || (argc > 3 && (!ParseUnsignedArgument(argv[3], t_LeafSize) || t_LeafSize == 0)))
+	{
+		std::cerr << "Usage: " << argv[0] << " <pointcloud.npy> <out.wsi> [leaf_size]\n";
+		return 1;
+	}
+	const std::string t_InputPath = argv[1];
+	const std::string t_OutputPath = argv[2];
+
+	NpyArray t_Cloud;
+	if (!LoadNpyAsFloat32(t_InputPath, t_Cloud)) return 1;
+	if (t_Cloud.shape.size() != 3 || t_Cloud.shape[2] != 3)
+	{
+		std::cerr << t_InputPath << " should have the shape [Num_Fingers, N, 3].\n";
+		return 1;
+	}
+
+	const auto t_BuildStart = std::chrono::steady_clock::now();
+	if (!WorkspaceIndex::Build(
+		t_Cloud.data.data(),
+		static_cast<uint32_t>(t_Cloud.shape[0]),
+		static_cast<uint32_t>(t_Cloud.shape[1]),
+		t_LeafSize,
+		t_OutputPath))
+	{
+		return 1;
+	}
+	const auto t_BuildEnd = std::chrono::steady_clock::now();
+	std::cout << "Built workspace index for " << t_Cloud.shape[0] << " fingers x " << t_Cloud.shape[1]
+		<< " points in " << std::chrono::duration<double, std::milli>(t_BuildEnd - t_BuildStart).count() << " ms.\n";
+
+	WorkspaceIndex t_Index;
+	if (!t_Index.Load(t_OutputPath)) return 1;
+
+	// query random points around each finger cloud to report the lookup cost.
+	const uint32_t t_NumQueries = 10000;
+	std::mt19937 t_Generator(0);
+	std::uniform_real_distribution<float> t_Offset(-0.02f, 0.02f);
+	for (uint32_t f = 0; f < t_Index.GetNumFingers(); f++)
+	{
+		const float* const t_Sample = t_Cloud.data.data() + f * t_Cloud.shape[1] * 3;
+		float t_Nearest[3];
+		float t_DistanceSquared = 0.0f;
+		double t_MaxDistance = 0.0;
+
+		const auto t_QueryStart = std::chrono::steady_clock::now();
+		for (uint32_t q = 0; q < t_NumQueries; q++)
+		{
+			const float* const t_Base = t_Sample + (q % t_Cloud.shape[1]) * 3;
+			const float t_Query[3] = { t_Base[0] + t_Offset(t_Generator), t_Base[1] + t_Offset(t_Generator), t_Base[2] + t_Offset(t_Generator) };
+			t_Index.FindNearest(f, t_Query, t_Nearest, &t_DistanceSquared);
+			t_MaxDistance = std::max(t_MaxDistance, static_cast<double>(t_DistanceSquared));
+		}
+		const auto t_QueryEnd = std::chrono::steady_clock::now();
+
+		std::cout << "Finger " << f << ": "
+			<< std::chrono::duration<double, std::micro>(t_QueryEnd - t_QueryStart).count() / t_NumQueries
+			<< " us per query, max projection " << std::sqrt(t_MaxDistance) * 1000.0 << " mm.\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,165 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+// compress_recording : converts a raw skeleton recording (manus_right record_path) into the
+// compressed format of CompressedRecording.hpp.
+//
+// Usage: compress_recording <session.rec> <session.grz> [--quantum METERS] [--rotation-bits BITS] [--block FRAMES]
+//
+// The result is decoded again and compared against the input, the worst position and rotation
+// errors and the single core decode speed are reported.
+
+#include "CommandLine.hpp"
+#include "CompressedRecording.hpp"
+#include "SkeletonRecording.hpp"
+
+// std::max, std::min
+#include <algorithm>
+#include <chrono>
+// std::asin, std::fabs, std::sqrt
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+	std::string t_InputPath;
+	std::string t_OutputPath;
+	float t_Quantum = 1e-5f;
+	uint32_t t_RotationBits = 16;
+	uint32_t t_FramesPerBlock = 256;
+	bool t_ValidArguments = true;
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string t_Argument = argv[i];
+		double t_Value = 0.0;
+		if (t_Argument == "--quantum" && i + 1 < argc)
+		{
+			t_ValidArguments &= ParseDoubleArgument(argv[++i], t_Value) && t_Value > 0.0;
+			t_Quantum = static_cast<float>(t_Value);
+		}
+		else if (t_Argument == "--rotation-bits" && i + 1 < argc) t_ValidArguments &= ParseUnsignedArgument(argv[++i], t_RotationBits);
+		else if (t_Argument == "--block" && i + 1 < argc) t_ValidArguments &= ParseUnsignedArgument(argv[++i], t_FramesPerBlock);
+		else if (t_InputPath.empty()) t_InputPath = t_Argument;
+		else t_OutputPath = t_Argument;
+	}
+	if (!t_ValidArguments || t_InputPath.empty() || t_OutputPath.empty())
+	{
+		std::cerr << "Usage: " << argv[0] << " <session.rec> <session.grz> [--quantum METERS] [--rotation-bits BITS] [--block FRAMES]\n";
+		return 1;
+	}
+
+	SkeletonRecordingReader t_Input;
+	if (!t_Input.Open(t_InputPath)) return 1;
+	const size_t t_FrameCount = t_Input.GetFrameCount();
+
+	CompressedRecordingWriter t_Writer;
+	if (!t_Writer.Open(t_OutputPath, *t_Input.GetHeader(), CompressedRecordingCodec_Zstd, t_Quantum, t_RotationBits, t_FramesPerBlock))
+	{
+		return 1;
+	}
+
+	SkeletonRecordingFrame t_Frame;
+	std::vector<RecordedSkeleton> t_Skeletons;
+	uint64_t t_RawBytes = sizeof(SkeletonRecordingHeader);
+	for (size_t i = 0; i < t_FrameCount; i++)
+	{
+		t_Input.ReadFrame(i, t_Frame, t_Skeletons);
+		t_RawBytes += t_Frame.frameBytes;
+		if (!t_Writer.WriteFrame(t_Frame, t_Skeletons.data(), t_Skeletons.size())) return 1;
+	}
+	if (!t_Writer.Close()) return 1;
+
+	std::cout << "Compressed " << t_FrameCount << " frames, " << t_RawBytes << " -> " << t_Writer.GetBytesWritten() << " bytes ("
+		<< static_cast<double>(t_RawBytes) / static_cast<double>((std::max)(t_Writer.GetBytesWritten(), static_cast<uint64_t>(1))) << "x"
+		<< (IsZstdAvailable() ? ", zstd" : ", no zstd in this build") << ").\n";
+
+	// decode everything once for speed, then compare frame by frame.
+	CompressedRecordingReader t_Output;
+	if (!t_Output.Open(t_OutputPath)) return 1;
+	if (t_Output.GetFrameCount() != t_FrameCount)
+	{
+		std::cerr << "The compressed recording has " << t_Output.GetFrameCount() << " frames instead of " << t_FrameCount << ".\n";
+		return 1;
+	}
+
+	DecodedRecordingBlock t_Decoded;
+	const auto t_DecodeStart = std::chrono::steady_clock::now();
+	for (size_t b = 0; b < t_Output.GetBlockCount(); b++)
+	{
+		if (!t_Output.DecodeBlock(b, t_Decoded)) return 1;
+	}
+	const double t_DecodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_DecodeStart).count();
+
+	double t_MaxPositionError = 0.0;
+	double t_MaxAngleError = 0.0;
+	SkeletonRecordingFrame t_DecodedFrame;
+	std::vector<RecordedSkeleton> t_DecodedSkeletons;
+	for (size_t i = 0; i < t_FrameCount; i++)
+	{
+		t_Input.ReadFrame(i, t_Frame, t_Skeletons);
+		if (!t_Output.ReadFrame(i, t_DecodedFrame, t_DecodedSkeletons)) return 1;
+
+		bool t_Match = t_Frame.frameIndex == t_DecodedFrame.frameIndex && t_Frame.hostTimeNs == t_DecodedFrame.hostTimeNs
+			&& t_Skeletons.size() == t_DecodedSkeletons.size();
+		for (size_t s = 0; t_Match && s < t_Skeletons.size(); s++)
+		{
+			const RecordedSkeleton& t_A = t_Skeletons[s];
+			const RecordedSkeleton& t_B = t_DecodedSkeletons[s];
+			t_Match = t_A.info.id == t_B.info.id && t_A.info.nodesCount == t_B.info.nodesCount && t_A.info.publishTime.time == t_B.info.publishTime.time;
+			for (uint32_t n = 0; t_Match && n < t_A.info.nodesCount; n++)
+			{
+				const ManusTransform& t_TA = t_A.nodes[n].transform;
+				const ManusTransform& t_TB = t_B.nodes[n].transform;
+				t_Match = t_A.nodes[n].id == t_B.nodes[n].id
+					&& t_TA.scale.x == t_TB.scale.x && t_TA.scale.y == t_TB.scale.y && t_TA.scale.z == t_TB.scale.z;
+
+				t_MaxPositionError = (std::max)(t_MaxPositionError, static_cast<double>((std::max)({
+					std::fabs(t_TA.position.x - t_TB.position.x), std::fabs(t_TA.position.y - t_TB.position.y), std::fabs(t_TA.position.z - t_TB.position.z) })));
+
+				// angle between the rotations from the chord between the sign aligned unit quaternions,
+				// acos of the dot product is too coarse near zero for float inputs.
+				const double t_QA[4] = { t_TA.rotation.w, t_TA.rotation.x, t_TA.rotation.y, t_TA.rotation.z };
+				const double t_QB[4] = { t_TB.rotation.w, t_TB.rotation.x, t_TB.rotation.y, t_TB.rotation.z };
+				const double t_NormA = std::sqrt(t_QA[0] * t_QA[0] + t_QA[1] * t_QA[1] + t_QA[2] * t_QA[2] + t_QA[3] * t_QA[3]);
+				if (t_NormA > 1e-6)
+				{
+					const double t_Dot = t_QA[0] * t_QB[0] + t_QA[1] * t_QB[1] + t_QA[2] * t_QB[2] + t_QA[3] * t_QB[3];
+					const double t_Sign = t_Dot < 0.0 ? -1.0 : 1.0;
+					double t_Chord = 0.0;
+					for (int a = 0; a < 4; a++)
+					{
+						const double t_Difference = t_QA[a] / t_NormA - t_Sign * t_QB[a];
+						t_Chord += t_Difference * t_Difference;
+					}
+					t_MaxAngleError = (std::max)(t_MaxAngleError, 4.0 * std::asin((std::min)(1.0, std::sqrt(t_Chord) / 2.0)));
+				}
+			}
+		}
+		if (!t_Match)
+		{
+			std::cerr << "Frame " << i << " does not survive the round trip.\n";
+			return 1;
+		}
+	}
+
+	double t_RecordedSeconds = 0.0;
+	if (t_FrameCount > 1)
+	{
+		t_RecordedSeconds = static_cast<double>(t_Input.GetFrame(t_FrameCount - 1)->hostTimeNs - t_Input.GetFrame(0)->hostTimeNs) * 1e-9;
+	}
+	std::cout << "Round trip ok, max position error " << t_MaxPositionError * 1000.0 << " mm, max rotation error "
+		<< t_MaxAngleError * 180.0 / 3.14159265358979 << " deg.\n";
+	std::cout << "Decoded in " << t_DecodeSeconds * 1000.0 << " ms on one core, "
+		<< static_cast<double>(t_FrameCount) / (std::max)(t_DecodeSeconds, 1e-9) << " frames/s";
+	if (t_RecordedSeconds > 0.0)
+	{
+		std::cout << ", " << t_RecordedSeconds / (std::max)(t_DecodeSeconds, 1e-9) << "x real time";
+	}
+	std::cout << ".\n";
+	return 0;
+}
@@ -0,0 +1,301 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+// export_recording : turns skeleton recordings (raw or compressed) into the [T, 21, 3] canonical
+// keypoint array GeoRTTrainer.train loads as human_data_path, the same keypoints
+// manus_mocap_core.py broadcasts live, without ROS or Python in the loop.
+//
+// Usage: export_recording <out.npy> <session.rec|session.grz>... [--skeleton INDEX] [--filter] [--threads N]
+//
+//   --skeleton  which skeleton of every frame to export, 0 by default.
+//   --filter    leave out frames that cannot be used: the skeleton is missing, a rotation is
+//               zero, the glove is not tracking yet (every rotation is the identity) or the hand
+//               frame is degenerate. Without it such frames are written as NaN so frame numbers
+//               stay aligned with the recordings.
+//
+// The recordings are cut into blocks that are decoded and solved on all cores, every block
+// writes straight into the mmapped output file.
+
+#include "CommandLine.hpp"
+#include "CompressedRecording.hpp"
+#include "ManusHandKinematics.hpp"
+#include "NpyFile.hpp"
+#include "SkeletonRecording.hpp"
+
+// std::min, std::max
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+// std::isfinite
+#include <cmath>
+// std::memcmp, std::memcpy, std::memmove
+#include <cstring>
+// std::ifstream
+#include <fstream>
+#include <iostream>
+// std::numeric_limits
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// mmap
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// @brief Frames per work item of a raw recording, compressed ones are split at their blocks.
+static const size_t s_RawFramesPerUnit = 1024;
+
+/// @brief Floats per exported frame.
+static const size_t s_FrameFloats = MANUS_HAND_KEYPOINTS * 3;
+
+enum class FrameStatus
+{
+	FrameStatus_Valid,
+	FrameStatus_Missing, // no skeleton at the requested index, or too few nodes.
+	FrameStatus_Untracked, // every rotation is the identity.
+	FrameStatus_Unusable, // a zero rotation, a degenerate hand frame or a non finite result.
+	FrameStatus_Count,
+};
+
+/// @brief A range of frames of one recording, decoded and solved by one worker.
+class ExportUnit
+{
+public:
+	const SkeletonRecordingReader* raw = nullptr;
+	const CompressedRecordingReader* compressed = nullptr;
+	size_t block = 0; // compressed only.
+	size_t firstFrame = 0; // raw only.
+	size_t frameCount = 0;
+	size_t outputFrame = 0; // first row of the output this unit writes.
+};
+
+/// @brief Solve one skeleton into a row of the output.
+static FrameStatus ExportFrame(const RecordedSkeleton* const p_Skeleton, float* const p_Row)
+{
+	if (p_Skeleton == nullptr || p_Skeleton->info.nodesCount < MANUS_HAND_KEYPOINTS)
+	{
+		return FrameStatus::FrameStatus_Missing;
+	}
+
+	bool t_Untracked = true;
+	for (uint32_t i = 0; i < MANUS_HAND_KEYPOINTS && t_Untracked; i++)
+	{
+		const ManusQuaternion& t_Rotation = p_Skeleton->nodes[i].transform.rotation;
+		t_Untracked = t_Rotation.w == 1.0f && t_Rotation.x == 0.0f && t_Rotation.y == 0.0f && t_Rotation.z == 0.0f;
+	}
+	if (t_Untracked) return FrameStatus::FrameStatus_Untracked;
+
+	double t_Keypoints[MANUS_HAND_KEYPOINTS][3];
+	if (!SolveManusKeypoints(p_Skeleton->nodes, p_Skeleton->info.nodesCount, t_Keypoints) || !HandToCanonical(t_Keypoints))
+	{
+		return FrameStatus::FrameStatus_Unusable;
+	}
+	for (uint32_t i = 0; i < MANUS_HAND_KEYPOINTS; i++)
+	{
+		for (int a = 0; a < 3; a++)
+		{
+			if (!std::isfinite(t_Keypoints[i][a])) return FrameStatus::FrameStatus_Unusable;
+			p_Row[i * 3 + a] = static_cast<float>(t_Keypoints[i][a]);
+		}
+	}
+	return FrameStatus::FrameStatus_Valid;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string t_OutputPath;
+	std::vector<std::string> t_InputPaths;
+	size_t t_SkeletonIndex = 0;
+	bool t_Filter = false;
+	unsigned int t_ThreadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+	bool t_ValidArguments = true;
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string t_Argument = argv[i];
+		if (t_Argument == "--skeleton" && i + 1 < argc) t_ValidArguments &= ParseUnsignedArgument(argv[++i], t_SkeletonIndex);
+		else if (t_Argument == "--threads" && i + 1 < argc) t_ValidArguments &= ParseUnsignedArgument(argv[++i], t_ThreadCount) && t_ThreadCount > 0;
+		else if (t_Argument == "--filter") t_Filter = true;
+		else if (t_OutputPath.empty()) t_OutputPath = t_Argument;
+		else t_InputPaths.push_back(t_Argument);
+	}
+	if (!t_ValidArguments || t_OutputPath.empty() || t_InputPaths.empty())
+	{
+		std::cerr << "Usage: " << argv[0] << " <out.npy> <session.rec|session.grz>... [--skeleton INDEX] [--filter] [--threads N]\n";
+		return 1;
+	}
+
+	// open every recording and cut it into work units.
+	std::vector<std::unique_ptr<SkeletonRecordingReader>> t_RawReaders;
+	std::vector<std::unique_ptr<CompressedRecordingReader>> t_CompressedReaders;
+	std::vector<ExportUnit> t_Units;
+	size_t t_TotalFrames = 0;
+	double t_RecordedSeconds = 0.0;
+	for (const std::string& t_Path : t_InputPaths)
+	{
+		char t_Magic[8] = { 0 };
+		std::ifstream(t_Path, std::ifstream::binary).read(t_Magic, sizeof(t_Magic));
+		if (std::memcmp(t_Magic, COMPRESSED_RECORDING_MAGIC, sizeof(t_Magic)) == 0)
+		{
+			t_CompressedReaders.emplace_back(new CompressedRecordingReader());
+			const CompressedRecordingReader* const t_Reader = t_CompressedReaders.back().get();
+			if (!t_CompressedReaders.back()->Open(t_Path)) return 1;
+			for (size_t b = 0; b < t_Reader->GetBlockCount(); b++)
+			{
+				ExportUnit t_Unit;
+				t_Unit.compressed = t_Reader;
+				t_Unit.block = b;
+				t_Unit.frameCount = t_Reader->GetBlockFirstFrame(b + 1) - t_Reader->GetBlockFirstFrame(b);
+				t_Unit.outputFrame = t_TotalFrames;
+				t_Units.push_back(t_Unit);
+				t_TotalFrames += t_Unit.frameCount;
+			}
+			if (t_Reader->GetBlockCount() > 0)
+			{
+				const uint64_t t_First = t_Reader->GetIndexEntry(0).firstHostTimeNs;
+				const uint64_t t_Last = t_Reader->GetBlock(t_Reader->GetBlockCount() - 1).lastHostTimeNs;
+				t_RecordedSeconds += static_cast<double>(t_Last - t_First) * 1e-9;
+			}
+		}
+		else
+		{
+			t_RawReaders.emplace_back(new SkeletonRecordingReader());
+			const SkeletonRecordingReader* const t_Reader = t_RawReaders.back().get();
+			if (!t_RawReaders.back()->Open(t_Path)) return 1;
+			for (size_t f = 0; f < t_Reader->GetFrameCount(); f += s_RawFramesPerUnit)
+			{
+				ExportUnit t_Unit;
+				t_Unit.raw = t_Reader;
+				t_Unit.firstFrame = f;
+				t_Unit.frameCount = (std::min)(s_RawFramesPerUnit, t_Reader->GetFrameCount() - f);
+				t_Unit.outputFrame = t_TotalFrames;
+				t_Units.push_back(t_Unit);
+				t_TotalFrames += t_Unit.frameCount;
+			}
+			if (t_Reader->GetFrameCount() > 1)
+			{
+				t_RecordedSeconds += static_cast<double>(t_Reader->GetFrame(t_Reader->GetFrameCount() - 1)->hostTimeNs - t_Reader->GetFrame(0)->hostTimeNs) * 1e-9;
+			}
+		}
+	}
+
+	// size the output for every frame, filtered frames are squeezed out at the end.
+	const std::string t_FullHeader = MakeNpyFloat32Header({ t_TotalFrames, MANUS_HAND_KEYPOINTS, 3 });
+	const size_t t_FullBytes = t_FullHeader.size() + t_TotalFrames * s_FrameFloats * sizeof(float);
+	const int t_Descriptor = open(t_OutputPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (t_Descriptor < 0 || ftruncate(t_Descriptor, static_cast<off_t>(t_FullBytes)) != 0)
+	{
+		std::cerr << "Could not create " << t_OutputPath << ".\n";
+		if (t_Descriptor >= 0) close(t_Descriptor);
+		return 1;
+	}
+	void* const t_Mapping = mmap(nullptr, t_FullBytes, PROT_READ | PROT_WRITE, MAP_SHARED, t_Descriptor, 0);
+	if (t_Mapping == MAP_FAILED)
+	{
+		std::cerr << "Could not mmap " << t_OutputPath << ".\n";
+		close(t_Descriptor);
+		return 1;
+	}
+	char* const t_Output = static_cast<char*>(t_Mapping);
+	std::memcpy(t_Output, t_FullHeader.data(), t_FullHeader.size());
+	float* const t_Rows = reinterpret_cast<float*>(t_Output + t_FullHeader.size());
+	std::vector<uint8_t> t_Valid(t_TotalFrames, 0);
+
+	std::atomic<size_t> t_NextUnit{ 0 };
+	std::atomic<bool> t_Failed{ false };
+	std::atomic<size_t> t_StatusCounts[static_cast<int>(FrameStatus::FrameStatus_Count)];
+	for (std::atomic<size_t>& t_Count : t_StatusCounts) t_Count.store(0);
+
+	const auto t_Worker = [&]()
+	{
+		DecodedRecordingBlock t_Decoded;
+		std::vector<RecordedSkeleton> t_Skeletons;
+		size_t t_Counts[static_cast<int>(FrameStatus::FrameStatus_Count)] = { 0 };
+		for (size_t u = t_NextUnit.fetch_add(1); u < t_Units.size() && !t_Failed.load(); u = t_NextUnit.fetch_add(1))
+		{
+			const ExportUnit& t_Unit = t_Units[u];
+			if (t_Unit.compressed != nullptr && !t_Unit.compressed->DecodeBlock(t_Unit.block, t_Decoded))
+			{
+				t_Failed.store(true);
+				break;
+			}
+			for (size_t f = 0; f < t_Unit.frameCount; f++)
+			{
+				if (t_Unit.compressed != nullptr) t_Decoded.GetSkeletons(f, t_Skeletons);
+				else t_Unit.raw->GetSkeletons(t_Unit.firstFrame + f, t_Skeletons);
+
+				const size_t t_OutputFrame = t_Unit.outputFrame + f;
+				float* const t_Row = t_Rows + t_OutputFrame * s_FrameFloats;
+				const FrameStatus t_Status = ExportFrame(t_SkeletonIndex < t_Skeletons.size() ? &t_Skeletons[t_SkeletonIndex] : nullptr, t_Row);
+				if (t_Status != FrameStatus::FrameStatus_Valid)
+				{
+					std::fill(t_Row, t_Row + s_FrameFloats, std::numeric_limits<float>::quiet_NaN());
+				}
+				t_Valid[t_OutputFrame] = t_Status == FrameStatus::FrameStatus_Valid;
+				t_Counts[static_cast<int>(t_Status)]++;
+			}
+		}
+		for (int s = 0; s < static_cast<int>(FrameStatus::FrameStatus_Count); s++) t_StatusCounts[s] += t_Counts[s];
+	};
+
+	const auto t_Start = std::chrono::steady_clock::now();
+	std::vector<std::thread> t_Threads;
+	for (unsigned int i = 0; i < t_ThreadCount; i++) t_Threads.emplace_back(t_Worker);
+	for (std::thread& t_Thread : t_Threads) t_Thread.join();
+	const double t_SolveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+
+	size_t t_WrittenFrames = t_TotalFrames;
+	size_t t_FinalBytes = t_FullBytes;
+	if (!t_Failed.load() && t_Filter)
+	{
+		// squeeze the valid rows together, then put the final header in front of them. The frame
+		// count only shrinks, so the new header is never longer than the old one.
+		t_WrittenFrames = 0;
+		for (size_t f = 0; f < t_TotalFrames; f++)
+		{
+			if (!t_Valid[f]) continue;
+			if (t_WrittenFrames != f)
+			{
+				std::memcpy(t_Rows + t_WrittenFrames * s_FrameFloats, t_Rows + f * s_FrameFloats, s_FrameFloats * sizeof(float));
+			}
+			t_WrittenFrames++;
+		}
+		const std::string t_Header = MakeNpyFloat32Header({ t_WrittenFrames, MANUS_HAND_KEYPOINTS, 3 });
+		const size_t t_DataBytes = t_WrittenFrames * s_FrameFloats * sizeof(float);
+		if (t_Header.size() != t_FullHeader.size())
+		{
+			std::memmove(t_Output + t_Header.size(), t_Rows, t_DataBytes);
+		}
+		std::memcpy(t_Output, t_Header.data(), t_Header.size());
+		t_FinalBytes = t_Header.size() + t_DataBytes;
+	}
+
+	munmap(t_Mapping, t_FullBytes);
+	const bool t_Truncated = ftruncate(t_Descriptor, static_cast<off_t>(t_FinalBytes)) == 0;
+	close(t_Descriptor);
+	if (t_Failed.load() || !t_Truncated)
+	{
+		std::cerr << "Exporting to " << t_OutputPath << " failed.\n";
+		return 1;
+	}
+
+	std::cout << "Exported " << t_WrittenFrames << " of " << t_TotalFrames << " frames from " << t_InputPaths.size()
+		<< " recordings to " << t_OutputPath << (t_Filter ? "" : ", invalid frames are NaN") << ".\n";
+	std::cout << "Invalid frames: " << t_StatusCounts[static_cast<int>(FrameStatus::FrameStatus_Missing)] << " missing, "
+		<< t_StatusCounts[static_cast<int>(FrameStatus::FrameStatus_Untracked)] << " not tracking, "
+		<< t_StatusCounts[static_cast<int>(FrameStatus::FrameStatus_Unusable)] << " unusable.\n";
+	std::cout << "Solved in " << t_SolveSeconds * 1000.0 << " ms on " << t_ThreadCount << " threads, "
+		<< static_cast<double>(t_TotalFrames) / (std::max)(t_SolveSeconds, 1e-9) << " frames/s";
+	if (t_RecordedSeconds > 0.0)
+	{
+		std::cout << ", " << t_RecordedSeconds / (std::max)(t_SolveSeconds, 1e-9) << "x real time";
+	}
+	std::cout << ".\n";
+	return 0;
+}
@@ -0,0 +1,171 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+// realtime_jitter : measures how regular a publish loop like the one of manus_right is, once with
+// the normal scheduler and once with the real-time settings of RealtimeSettings.hpp, while other
+// threads load the machine like a perception stack would.
+//
+// Usage: realtime_jitter [--rate HZ] [--seconds S] [--load THREADS] [--rt-priority N] [--rt-cpus LIST] [--rt-mlock] [--rt-prefault-mb N]
+//
+// Prints a histogram of how far each frame interval is off the period for both runs. The real-time
+// run usually needs root, CAP_SYS_NICE or an rtprio limit, what did not take effect is reported.
+
+#include "CommandLine.hpp"
+#include "RealtimeSettings.hpp"
+
+// std::sort
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+// std::fabs
+#include <cmath>
+// std::memcpy
+#include <cstring>
+// std::setw
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// @brief Upper edges of the histogram buckets in microseconds, the last bucket is everything above.
+static const double s_BucketEdges[] = { 50.0, 100.0, 250.0, 500.0, 1000.0, 2000.0, 5000.0 };
+static const size_t s_BucketCount = sizeof(s_BucketEdges) / sizeof(s_BucketEdges[0]) + 1;
+
+/// @brief Size of the frame each iteration copies, about one glove skeleton.
+static const size_t s_FrameBytes = 2048;
+
+class JitterResult
+{
+public:
+	std::vector<double> errors; // |interval - period| per frame in microseconds.
+	size_t buckets[s_BucketCount] = {};
+};
+
+/// @brief Keep a core busy and churn the caches and the allocator until p_Stop is set.
+static void RunLoad(const std::atomic<bool>& p_Stop)
+{
+	std::vector<char> t_Buffer;
+	uint64_t t_Sum = 0;
+	while (!p_Stop.load(std::memory_order_relaxed))
+	{
+		t_Buffer.assign(4u << 20, static_cast<char>(t_Sum));
+		for (size_t i = 0; i < t_Buffer.size(); i += 64) t_Sum += static_cast<unsigned char>(t_Buffer[i]);
+	}
+	// keep the loop from being optimized away.
+	if (t_Sum == 1) std::cout << "";
+}
+
+/// @brief The publish loop: wake up every period, copy a frame, sleep until the next one.
+static void RunLoop(const double p_Rate, const double p_Seconds, JitterResult& p_Result)
+{
+	const std::chrono::nanoseconds t_Period(static_cast<int64_t>(1e9 / p_Rate));
+	const size_t t_FrameCount = static_cast<size_t>(p_Seconds * p_Rate);
+	std::vector<char> t_Source(s_FrameBytes, 1);
+	std::vector<char> t_Frame(s_FrameBytes, 0);
+	p_Result.errors.reserve(t_FrameCount);
+
+	std::chrono::steady_clock::time_point t_Next = std::chrono::steady_clock::now() + t_Period;
+	std::chrono::steady_clock::time_point t_Last;
+	for (size_t i = 0; i <= t_FrameCount; i++)
+	{
+		std::this_thread::sleep_until(t_Next);
+		const std::chrono::steady_clock::time_point t_Now = std::chrono::steady_clock::now();
+		if (i > 0)
+		{
+			const double t_Interval = std::chrono::duration<double, std::micro>(t_Now - t_Last).count();
+			p_Result.errors.push_back(std::fabs(t_Interval - std::chrono::duration<double, std::micro>(t_Period).count()));
+		}
+		t_Last = t_Now;
+		std::memcpy(t_Frame.data(), t_Source.data(), s_FrameBytes);
+		t_Source[i % s_FrameBytes] = t_Frame[(i + 1) % s_FrameBytes];
+		t_Next += t_Period;
+	}
+
+	for (const double t_Error : p_Result.errors)
+	{
+		size_t t_Bucket = 0;
+		while (t_Bucket < s_BucketCount - 1 && t_Error >= s_BucketEdges[t_Bucket]) t_Bucket++;
+		p_Result.buckets[t_Bucket]++;
+	}
+	std::sort(p_Result.errors.begin(), p_Result.errors.end());
+}
+
+static double Percentile(const std::vector<double>& p_Sorted, const double p_Fraction)
+{
+	if (p_Sorted.empty()) return 0.0;
+	return p_Sorted[static_cast<size_t>(p_Fraction * (p_Sorted.size() - 1))];
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> t_Arguments(argv + 1, argv + argc);
+	RealtimeSettings t_Settings;
+	bool t_ValidArguments = t_Settings.Parse(t_Arguments);
+	double t_Rate = 120.0;
+	double t_Seconds = 10.0;
+	size_t t_LoadThreads = (std::max)(1u, std::thread::hardware_concurrency());
+	for (size_t i = 0; i < t_Arguments.size(); i++)
+	{
+		const std::string& t_Argument = t_Arguments[i];
+		const bool t_HasValue = i + 1 < t_Arguments.size();
+		if (t_Argument == "--rate" && t_HasValue) t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Rate);
+		else if (t_Argument == "--seconds" && t_HasValue) t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Seconds);
+		else if (t_Argument == "--load" && t_HasValue) t_ValidArguments &= ParseUnsignedArgument(t_Arguments[++i], t_LoadThreads);
+		else t_ValidArguments = false;
+	}
+	if (!t_ValidArguments || t_Rate <= 0.0 || t_Seconds <= 0.0)
+	{
+		std::cerr << "Usage: " << argv[0] << " [--rate HZ] [--seconds S] [--load THREADS] " << RealtimeSettings::GetUsage() << "\n";
+		return 1;
+	}
+	if (!t_Settings.IsEnabled())
+	{
+		std::cout << "No --rt-* option given, both runs use the normal scheduler.\n";
+	}
+
+	std::atomic<bool> t_Stop(false);
+	std::vector<std::thread> t_Load;
+	for (size_t i = 0; i < t_LoadThreads; i++) t_Load.emplace_back(RunLoad, std::cref(t_Stop));
+	std::cout << "Running a " << t_Rate << " Hz loop for " << t_Seconds << " s twice, against " << t_LoadThreads << " load threads.\n";
+
+	// the normal run goes first, memory locking cannot be undone.
+	JitterResult t_Results[2];
+	std::thread(RunLoop, t_Rate, t_Seconds, std::ref(t_Results[0])).join();
+	ApplyRealtimeProcessSettings(t_Settings);
+	std::thread([&]()
+	{
+		ApplyRealtimeThreadSettings(t_Settings, t_Settings.publishPriority, "loop");
+		RunLoop(t_Rate, t_Seconds, t_Results[1]);
+	}).join();
+
+	t_Stop = true;
+	for (std::thread& t_Thread : t_Load) t_Thread.join();
+
+	std::cout << "\nFrame interval error   " << std::setw(10) << "normal" << std::setw(12) << "real-time" << "\n";
+	for (size_t t_Bucket = 0; t_Bucket < s_BucketCount; t_Bucket++)
+	{
+		std::string t_Label = t_Bucket < s_BucketCount - 1 ? "< " + std::to_string(static_cast<int>(s_BucketEdges[t_Bucket])) + " us"
+			: ">= " + std::to_string(static_cast<int>(s_BucketEdges[t_Bucket - 1])) + " us";
+		std::cout << "  " << std::left << std::setw(20) << t_Label << std::right;
+		for (const JitterResult& t_Result : t_Results)
+		{
+			const double t_Share = t_Result.errors.empty() ? 0.0 : 100.0 * t_Result.buckets[t_Bucket] / t_Result.errors.size();
+			std::cout << std::setw(10) << std::fixed << std::setprecision(2) << t_Share << " %";
+		}
+		std::cout << "\n";
+	}
+	std::cout << std::setprecision(1);
+	const char* const t_Percentiles[] = { "p50", "p99", "p99.9", "max" };
+	const double t_Fractions[] = { 0.5, 0.99, 0.999, 1.0 };
+	for (size_t i = 0; i < 4; i++)
+	{
+		std::cout << "  " << std::left << std::setw(20) << t_Percentiles[i] << std::right;
+		for (const JitterResult& t_Result : t_Results) std::cout << std::setw(9) << Percentile(t_Result.errors, t_Fractions[i]) << " us";
+		std::cout << "\n";
+	}
+	return 0;
+}
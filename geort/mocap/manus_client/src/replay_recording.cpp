@@ -0,0 +1,450 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+// replay_recording : republishes a skeleton recording (see SkeletonRecording.hpp, or a compressed
+// one, see CompressedRecording.hpp) on the same topics as manus_right, so manus_mocap_core.py and
+// everything behind it cannot tell it apart from a live glove.
+//
+// Usage: manus_replay <session.rec|session.grz|session.msr> [--mode original|fixed|fast] [--rate HZ]
+//                     [--start SECONDS | --frame N] [--duration SECONDS]
+//
+//   original  keep the spacing of the recorded publishTime stamps (host receive time if those
+//             cannot be decoded).
+//   fixed     one frame every 1/HZ seconds, HZ defaults to 120.
+//   fast      publish as fast as possible, for load tests.
+//
+// --start and --frame seek to a time since the first frame or to a frame number before playing,
+// --duration stops after that much recorded time. Seeking is a binary search over the recording
+// (over the block index of a compressed one), so only the frames played back are decoded.
+//
+// A stream recording (session.msr, see StreamRecording.hpp) is played in one pass over all of its
+// records in the order they arrived, paced on their host receive times so the streams keep their
+// timing relative to each other: skeletons as above, trackers as TF like manus_tracker sends them.
+// There --frame is a record number and fixed mode is not available.
+//
+// At the end the achieved rate and the timing jitter are printed.
+
+#include "CommandLine.hpp"
+#include "CompressedRecording.hpp"
+#include "ManusSDK.h"
+#include "ManusTimestamp.hpp"
+#include "SkeletonPublisher.hpp"
+#include "SkeletonRecording.hpp"
+#include "StreamRecording.hpp"
+#include "geometry_msgs/msg/transform_stamped.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "tf2_ros/transform_broadcaster.h"
+
+// std::sort, std::min
+#include <algorithm>
+#include <chrono>
+// std::sqrt
+#include <cmath>
+// std::memcmp, strnlen
+#include <cstring>
+// std::ifstream
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ReplayMode
+{
+	ReplayMode_Original,
+	ReplayMode_Fixed,
+	ReplayMode_Fast,
+};
+
+class ReplayOptions
+{
+public:
+	ReplayMode mode = ReplayMode::ReplayMode_Original;
+	double rate = 120.0;
+	double start = -1.0; // seconds since the first frame, negative if not set.
+	size_t frame = 0;
+	double duration = -1.0; // seconds, negative to play to the end.
+};
+
+/// @brief Seek key of a frame in nanoseconds, from its decoded publishTime. Needs the SDK.
+static bool PublishTimeKey(const SkeletonRecordingFrame&, const uint64_t p_PublishTime, int64_t& p_Key)
+{
+	ManusTimestamp t_Timestamp;
+	t_Timestamp.time = p_PublishTime;
+	int64_t t_Milliseconds = 0;
+	if (p_PublishTime == 0 || !ManusTimestampToUnixMilliseconds(t_Timestamp, t_Milliseconds)) return false;
+	p_Key = t_Milliseconds * 1000000;
+	return true;
+}
+
+/// @brief Seek key of a frame in nanoseconds, from the host receive time.
+static bool HostTimeKey(const SkeletonRecordingFrame& p_Frame, const uint64_t, int64_t& p_Key)
+{
+	p_Key = static_cast<int64_t>(p_Frame.hostTimeNs);
+	return true;
+}
+
+/// @brief Find the frames [p_Begin, p_End) that p_Options asks for. Times are taken from the
+/// recorded publishTime, or from the host receive time if those cannot be decoded.
+template <class Reader>
+static bool FindReplayRange(Reader& p_Reader, const ReplayOptions& p_Options, const bool p_SdkReady, size_t& p_Begin, size_t& p_End)
+{
+	SkeletonRecordingFrame t_Frame;
+	std::vector<RecordedSkeleton> t_Skeletons;
+	const auto t_KeyOf = [&](const RecordingFrameKey& p_Key, const size_t p_Index, int64_t& p_Value)
+	{
+		return p_Reader.ReadFrame(p_Index, t_Frame, t_Skeletons)
+			&& p_Key(t_Frame, t_Skeletons.empty() ? 0 : t_Skeletons[0].info.publishTime.time, p_Value);
+	};
+
+	RecordingFrameKey t_Key = PublishTimeKey;
+	bool t_ByHostTime = false;
+	int64_t t_FirstKey = 0;
+	if (!p_SdkReady || !t_KeyOf(t_Key, 0, t_FirstKey))
+	{
+		t_Key = HostTimeKey;
+		t_ByHostTime = true;
+		t_KeyOf(t_Key, 0, t_FirstKey);
+	}
+	// p_Offset is relative to the first frame so it survives the switch to host time.
+	const auto t_Seek = [&](const size_t p_From, const int64_t p_Offset, size_t& p_Frame)
+	{
+		int64_t t_FromKey = t_FirstKey;
+		if ((p_From == 0 || t_KeyOf(t_Key, p_From, t_FromKey)) && p_Reader.FindFirstFrame(t_Key, t_FromKey + p_Offset, p_Frame))
+		{
+			return true;
+		}
+		if (t_ByHostTime) return false;
+
+		std::cout << "publishTime could not be decoded, seeking by host receive time.\n";
+		t_Key = HostTimeKey;
+		t_ByHostTime = true;
+		t_KeyOf(t_Key, 0, t_FirstKey);
+		t_FromKey = t_FirstKey;
+		return (p_From == 0 || t_KeyOf(t_Key, p_From, t_FromKey)) && p_Reader.FindFirstFrame(t_Key, t_FromKey + p_Offset, p_Frame);
+	};
+
+	p_Begin = (std::min)(p_Options.frame, p_Reader.GetFrameCount());
+	p_End = p_Reader.GetFrameCount();
+	if (p_Options.start >= 0.0 && !t_Seek(0, static_cast<int64_t>(p_Options.start * 1e9), p_Begin))
+	{
+		return false;
+	}
+	if (p_Options.duration >= 0.0 && p_Begin < p_End && !t_Seek(p_Begin, static_cast<int64_t>(p_Options.duration * 1e9), p_End))
+	{
+		return false;
+	}
+	return true;
+}
+
+/// @brief Times of the frames [p_Begin, p_End) relative to the first of them, in nanoseconds,
+/// from the recorded publishTime. Falls back to the host receive time when a stamp cannot be
+/// decoded or runs backwards.
+template <class Reader>
+static std::vector<int64_t> GetOriginalFrameTimes(Reader& p_Reader, const size_t p_Begin, const size_t p_End, const bool p_SdkReady)
+{
+	const size_t t_FrameCount = p_End - p_Begin;
+	std::vector<int64_t> t_PublishTimes(t_FrameCount, 0);
+	std::vector<int64_t> t_HostTimes(t_FrameCount, 0);
+	SkeletonRecordingFrame t_Frame;
+	std::vector<RecordedSkeleton> t_Skeletons;
+
+	bool t_UsePublishTime = p_SdkReady;
+	int64_t t_FirstMilliseconds = 0;
+	uint64_t t_FirstHostTime = 0;
+	for (size_t i = 0; i < t_FrameCount; i++)
+	{
+		if (!p_Reader.ReadFrame(p_Begin + i, t_Frame, t_Skeletons)) break;
+		if (i == 0) t_FirstHostTime = t_Frame.hostTimeNs;
+		t_HostTimes[i] = static_cast<int64_t>(t_Frame.hostTimeNs - t_FirstHostTime);
+
+		int64_t t_Milliseconds = 0;
+		if (!t_UsePublishTime || t_Skeletons.empty() || !ManusTimestampToUnixMilliseconds(t_Skeletons[0].info.publishTime, t_Milliseconds))
+		{
+			t_UsePublishTime = false;
+			continue;
+		}
+		if (i == 0) t_FirstMilliseconds = t_Milliseconds;
+		t_PublishTimes[i] = (t_Milliseconds - t_FirstMilliseconds) * 1000000;
+		if (i > 0 && t_PublishTimes[i] < t_PublishTimes[i - 1])
+		{
+			t_UsePublishTime = false;
+		}
+	}
+
+	if (t_UsePublishTime)
+	{
+		std::cout << "Replaying with the recorded publishTime spacing.\n";
+		return t_PublishTimes;
+	}
+	std::cout << "publishTime could not be used, replaying with the host receive time spacing.\n";
+	return t_HostTimes;
+}
+
+/// @brief Value at fraction p_Fraction of the sorted p_Values.
+static double Percentile(std::vector<double> p_Values, const double p_Fraction)
+{
+	if (p_Values.empty()) return 0.0;
+	std::sort(p_Values.begin(), p_Values.end());
+	const size_t t_Index = static_cast<size_t>(p_Fraction * static_cast<double>(p_Values.size() - 1) + 0.5);
+	return p_Values[t_Index];
+}
+
+/// @brief Print the mean, spread and tail of how late each item was against its schedule.
+static void PrintJitter(const std::vector<double>& p_Lateness)
+{
+	if (p_Lateness.empty()) return;
+
+	double t_Mean = 0.0;
+	for (const double t_Value : p_Lateness) t_Mean += t_Value;
+	t_Mean /= static_cast<double>(p_Lateness.size());
+	double t_Variance = 0.0;
+	for (const double t_Value : p_Lateness) t_Variance += (t_Value - t_Mean) * (t_Value - t_Mean);
+	t_Variance /= static_cast<double>(p_Lateness.size());
+
+	std::cout << "Jitter against the schedule (us): mean " << t_Mean << ", std " << std::sqrt(t_Variance)
+		<< ", p50 " << Percentile(p_Lateness, 0.5) << ", p99 " << Percentile(p_Lateness, 0.99)
+		<< ", max " << Percentile(p_Lateness, 1.0) << ".\n";
+}
+
+/// @brief Publish the frames of p_Reader that p_Options selects on the manus_right topics with the requested pacing.
+template <class Reader>
+static int Replay(Reader& p_Reader, const std::string& p_Path, const ReplayOptions& p_Options)
+{
+	if (p_Reader.GetFrameCount() == 0)
+	{
+		std::cerr << "Nothing to replay in " << p_Path << ".\n";
+		return 1;
+	}
+
+	// the SDK only needs to be initialized to decode timestamps, it does not connect to anything.
+	const bool t_SdkReady = CoreSdk_Initialize(SessionType::SessionType_CoreSDK) == SDKReturnCode::SDKReturnCode_Success;
+	size_t t_Begin = 0;
+	size_t t_End = 0;
+	const bool t_Found = FindReplayRange(p_Reader, p_Options, t_SdkReady, t_Begin, t_End);
+	const size_t t_FrameCount = t_End - t_Begin;
+	std::vector<int64_t> t_FrameTimes(t_FrameCount, 0);
+	if (t_Found && p_Options.mode == ReplayMode::ReplayMode_Original)
+	{
+		t_FrameTimes = GetOriginalFrameTimes(p_Reader, t_Begin, t_End, t_SdkReady);
+	}
+	else if (p_Options.mode == ReplayMode::ReplayMode_Fixed)
+	{
+		for (size_t i = 0; i < t_FrameCount; i++)
+		{
+			t_FrameTimes[i] = static_cast<int64_t>(static_cast<double>(i) * 1e9 / p_Options.rate);
+		}
+	}
+	CoreSdk_ShutDown();
+
+	if (!t_Found)
+	{
+		std::cerr << "Could not seek in " << p_Path << ".\n";
+		return 1;
+	}
+	if (t_FrameCount == 0)
+	{
+		std::cerr << "No frames of " << p_Path << " are in the requested range.\n";
+		return 1;
+	}
+
+	auto t_Node = std::make_shared<rclcpp::Node>("manus_replay");
+	SkeletonPublisher t_Publisher(t_Node);
+	SkeletonRecordingFrame t_Frame;
+	std::vector<RecordedSkeleton> t_Skeletons;
+
+	// lateness of every frame against its schedule, in microseconds.
+	std::vector<double> t_Lateness;
+	t_Lateness.reserve(t_FrameCount);
+
+	std::cout << "Replaying frames " << t_Begin << " to " << t_End << " of " << p_Reader.GetFrameCount() << " from " << p_Path << ".\n";
+	const auto t_Start = std::chrono::steady_clock::now();
+	size_t t_Published = 0;
+	for (size_t i = 0; i < t_FrameCount && rclcpp::ok(); i++)
+	{
+		if (p_Options.mode != ReplayMode::ReplayMode_Fast)
+		{
+			const auto t_Deadline = t_Start + std::chrono::nanoseconds(t_FrameTimes[i]);
+			std::this_thread::sleep_until(t_Deadline);
+			t_Lateness.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t_Deadline).count());
+		}
+
+		if (!p_Reader.ReadFrame(t_Begin + i, t_Frame, t_Skeletons))
+		{
+			break;
+		}
+		const builtin_interfaces::msg::Time t_Stamp = t_Node->get_clock()->now();
+		for (const RecordedSkeleton& t_Skeleton : t_Skeletons)
+		{
+			t_Publisher.Publish(t_Skeleton.info, t_Skeleton.nodes, t_Stamp, static_cast<uint32_t>(t_Published));
+		}
+		t_Published++;
+	}
+	const double t_Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+
+	std::cout << "Published " << t_Published << " frames in " << t_Elapsed << " s, "
+		<< (t_Elapsed > 0.0 ? static_cast<double>(t_Published) / t_Elapsed : 0.0) << " Hz";
+	if (p_Options.mode != ReplayMode::ReplayMode_Fast && t_Published > 1)
+	{
+		const double t_Scheduled = static_cast<double>(t_FrameTimes[t_Published - 1]) * 1e-9;
+		std::cout << " (recorded " << (t_Scheduled > 0.0 ? static_cast<double>(t_Published - 1) / t_Scheduled : 0.0) << " Hz)";
+	}
+	std::cout << ".\n";
+
+	PrintJitter(t_Lateness);
+	return 0;
+}
+
+/// @brief Publish the records of a stream recording that p_Options selects, skeletons on the
+/// manus_right topics and trackers as TF, spaced by their host receive times.
+static int ReplayStreams(const StreamRecordingReader& p_Reader, const std::string& p_Path, const ReplayOptions& p_Options)
+{
+	if (p_Options.mode == ReplayMode::ReplayMode_Fixed)
+	{
+		std::cerr << "A stream recording interleaves several rates, it can only be replayed in original or fast mode.\n";
+		return 1;
+	}
+	if (p_Reader.GetRecordCount() == 0)
+	{
+		std::cerr << "Nothing to replay in " << p_Path << ".\n";
+		return 1;
+	}
+
+	// host times never decrease over the file, so the range is two binary searches.
+	const uint64_t t_FirstTime = p_Reader.GetRecordEntry(0).hostTimeNs;
+	size_t t_Begin = (std::min)(p_Options.frame, p_Reader.GetRecordCount());
+	if (p_Options.start >= 0.0)
+	{
+		t_Begin = p_Reader.FindFirstRecord(t_FirstTime + static_cast<uint64_t>(p_Options.start * 1e9));
+	}
+	size_t t_End = p_Reader.GetRecordCount();
+	if (p_Options.duration >= 0.0 && t_Begin < t_End)
+	{
+		t_End = p_Reader.FindFirstRecord(p_Reader.GetRecordEntry(t_Begin).hostTimeNs + static_cast<uint64_t>(p_Options.duration * 1e9) + 1);
+	}
+	if (t_Begin >= t_End)
+	{
+		std::cerr << "No records of " << p_Path << " are in the requested range.\n";
+		return 1;
+	}
+
+	auto t_Node = std::make_shared<rclcpp::Node>("manus_replay");
+	SkeletonPublisher t_Publisher(t_Node);
+	tf2_ros::TransformBroadcaster t_Broadcaster(t_Node);
+	std::vector<RecordedSkeleton> t_Skeletons;
+	std::vector<double> t_Lateness;
+	t_Lateness.reserve(t_End - t_Begin);
+	size_t t_Published[StreamRecordType_Count] = {};
+
+	std::cout << "Replaying records " << t_Begin << " to " << t_End << " of " << p_Reader.GetRecordCount() << " from " << p_Path << ".\n";
+	const uint64_t t_BeginTime = p_Reader.GetRecordEntry(t_Begin).hostTimeNs;
+	const auto t_Start = std::chrono::steady_clock::now();
+	for (size_t i = t_Begin; i < t_End && rclcpp::ok(); i++)
+	{
+		const StreamRecord* const t_Record = p_Reader.GetRecord(i);
+		if (p_Options.mode == ReplayMode::ReplayMode_Original)
+		{
+			const auto t_Deadline = t_Start + std::chrono::nanoseconds(t_Record->hostTimeNs - t_BeginTime);
+			std::this_thread::sleep_until(t_Deadline);
+			t_Lateness.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t_Deadline).count());
+		}
+
+		if (t_Record->type == StreamRecordType_Skeleton && p_Reader.GetSkeletons(*t_Record, t_Skeletons))
+		{
+			const builtin_interfaces::msg::Time t_Stamp = t_Node->get_clock()->now();
+			for (const RecordedSkeleton& t_Skeleton : t_Skeletons)
+			{
+				t_Publisher.Publish(t_Skeleton.info, t_Skeleton.nodes, t_Stamp, static_cast<uint32_t>(t_Published[StreamRecordType_Skeleton]));
+			}
+		}
+		else if (t_Record->type == StreamRecordType_Tracker)
+		{
+			const TrackerData* const t_Trackers = p_Reader.GetTrackers(*t_Record);
+			for (uint32_t t = 0; t_Trackers != nullptr && t < t_Record->itemCount; t++)
+			{
+				geometry_msgs::msg::TransformStamped t_Transform;
+				t_Transform.header.stamp = t_Node->get_clock()->now();
+				t_Transform.header.frame_id = "lighthouse_frame";
+				t_Transform.child_frame_id = std::string(t_Trackers[t].trackerId.id, strnlen(t_Trackers[t].trackerId.id, sizeof(t_Trackers[t].trackerId.id)));
+				t_Transform.transform.translation.x = t_Trackers[t].position.x;
+				t_Transform.transform.translation.y = t_Trackers[t].position.y;
+				t_Transform.transform.translation.z = t_Trackers[t].position.z;
+				t_Transform.transform.rotation.x = t_Trackers[t].rotation.x;
+				t_Transform.transform.rotation.y = t_Trackers[t].rotation.y;
+				t_Transform.transform.rotation.z = t_Trackers[t].rotation.z;
+				t_Transform.transform.rotation.w = t_Trackers[t].rotation.w;
+				t_Broadcaster.sendTransform(t_Transform);
+			}
+		}
+		t_Published[t_Record->type]++;
+	}
+	const double t_Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_Start).count();
+
+	std::cout << "Published " << t_Published[StreamRecordType_Skeleton] << " skeleton and " << t_Published[StreamRecordType_Tracker]
+		<< " tracker records in " << t_Elapsed << " s, recorded over " << static_cast<double>(p_Reader.GetRecordEntry(t_End - 1).hostTimeNs - t_BeginTime) * 1e-9
+		<< " s. Other streams are skipped.\n";
+	PrintJitter(t_Lateness);
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	rclcpp::init(argc, argv);
+	const std::vector<std::string> t_Arguments = rclcpp::remove_ros_arguments(argc, argv);
+
+	std::string t_Path;
+	ReplayOptions t_Options;
+	bool t_ValidArguments = true;
+	for (size_t i = 1; i < t_Arguments.size(); i++)
+	{
+		const std::string& t_Argument = t_Arguments[i];
+		const bool t_HasValue = i + 1 < t_Arguments.size();
+		if (t_Argument == "--mode" && t_HasValue)
+		{
+			const std::string& t_Value = t_Arguments[++i];
+			if (t_Value == "original") t_Options.mode = ReplayMode::ReplayMode_Original;
+			else if (t_Value == "fixed") t_Options.mode = ReplayMode::ReplayMode_Fixed;
+			else if (t_Value == "fast") t_Options.mode = ReplayMode::ReplayMode_Fast;
+			else t_ValidArguments = false;
+		}
+		else if (t_Argument == "--rate" && t_HasValue) t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Options.rate);
+		else if (t_Argument == "--start" && t_HasValue) t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Options.start);
+		else if (t_Argument == "--frame" && t_HasValue) t_ValidArguments &= ParseUnsignedArgument(t_Arguments[++i], t_Options.frame);
+		else if (t_Argument == "--duration" && t_HasValue) t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Options.duration);
+		else if (t_Path.empty()) t_Path = t_Argument;
+		else t_ValidArguments = false;
+	}
+	if (!t_ValidArguments || t_Path.empty() || t_Options.rate <= 0.0 || (t_Options.start >= 0.0 && t_Options.frame > 0))
+	{
+		std::cerr << "Usage: " << argv[0] << " <session.rec|session.grz|session.msr> [--mode original|fixed|fast] [--rate HZ]"
+			<< " [--start SECONDS | --frame N] [--duration SECONDS]\n";
+		rclcpp::shutdown();
+		return 1;
+	}
+
+	// compressed and stream recordings start with their own magic.
+	char t_Magic[8] = { 0 };
+	std::ifstream(t_Path, std::ifstream::binary).read(t_Magic, sizeof(t_Magic));
+	int t_Result = 1;
+	if (std::memcmp(t_Magic, COMPRESSED_RECORDING_MAGIC, sizeof(t_Magic)) == 0)
+	{
+		CompressedRecordingReader t_Reader;
+		if (t_Reader.Open(t_Path)) t_Result = Replay(t_Reader, t_Path, t_Options);
+	}
+	else if (std::memcmp(t_Magic, STREAM_RECORDING_MAGIC, sizeof(t_Magic)) == 0)
+	{
+		StreamRecordingReader t_Reader;
+		if (t_Reader.Open(t_Path)) t_Result = ReplayStreams(t_Reader, t_Path, t_Options);
+	}
+	else
+	{
+		SkeletonRecordingReader t_Reader;
+		if (t_Reader.Open(t_Path)) t_Result = Replay(t_Reader, t_Path, t_Options);
+	}
+
+	rclcpp::shutdown();
+	return t_Result;
+}
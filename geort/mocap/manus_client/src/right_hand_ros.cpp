@@ -9,53 +9,53 @@
 
 #include "SDKMinimalClient.hpp"
 #include "ManusSDKTypes.h"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <thread>
 #include "rclcpp/rclcpp.hpp"
 #include "std_msgs/msg/string.hpp"
 #include "std_msgs/msg/float32_multi_array.hpp"
+#include "ClockMapping.hpp"
+#include "ManusTimestamp.hpp"
+#include "SkeletonSetupCache.hpp"
+#include "SkeletonWorkerPool.hpp"
+#include "StreamDiagnostics.hpp"
+
+// manus_hands is built from this file with GEORT_BOTH_HANDS, one SDK session and node for both hands.
+#ifdef GEORT_BOTH_HANDS
+#define GEORT_NODE_NAME "manus_hands"
+#define GEORT_DEFAULT_HANDS "both"
+#else
+#define GEORT_NODE_NAME "manus_node"
+#define GEORT_DEFAULT_HANDS "right"
+#endif
 
 
-struct Quaternion{
-    float w, x, y, z;
-};
-
-struct Vector3 {
-    float x, y, z;
-};
-
-Vector3 QuaternionToEuler(const Quaternion& q) {
-
-	Vector3 euler;
-
-    // Roll (x-axis rotation)
-    float sinr_cosp = 2 * (q.w * q.x + q.y * q.z);
-    float cosr_cosp = 1 - 2 * (q.x * q.x + q.y * q.y);
-    euler.x = std::atan2(sinr_cosp, cosr_cosp);
-
-    // Pitch (y-axis rotation)
-    float sinp = 2 * (q.w * q.y - q.z * q.x);
-    if (std::abs(sinp) >= 1)
-        euler.y = std::copysign(M_PI / 2, sinp); // Use 90 degrees if out of range
-    else
-        euler.y = std::asin(sinp);
-
-    // Yaw (z-axis rotation)
-    float siny_cosp = 2 * (q.w * q.z + q.x * q.y);
-    float cosy_cosp = 1 - 2 * (q.y * q.y + q.z * q.z);
-    euler.z = std::atan2(siny_cosp, cosy_cosp);
-
-	return euler;
-}
-
 SDKMinimalClient* SDKMinimalClient::s_Instance = nullptr;
 
+/// @brief Version of the hand skeleton built by SetupHandNodes and SetupHandChains, bump it when they
+/// change so the cached setups of the old one are built again.
+static const uint32_t s_HandSkeletonSetupVersion = 1;
+
 int main(int argc, char * argv[])
 {
     rclcpp::init(argc, argv);
+
+    // scheduling, CPU pinning and memory locking, e.g. ros2 run manus_client manus_right --rt-priority 80 --rt-cpus 3 --rt-mlock
+    std::vector<std::string> t_Arguments = rclcpp::remove_ros_arguments(argc, argv);
+    t_Arguments.erase(t_Arguments.begin());
+    RealtimeSettings t_RealtimeSettings;
+    if (!t_RealtimeSettings.Parse(t_Arguments) || !t_Arguments.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " " << RealtimeSettings::GetUsage() << " [--ros-args ...]\n";
+        rclcpp::shutdown();
+        return 1;
+    }
+
     std::cout << "Starting minimal client!\n";
     SDKMinimalClient t_Client;
+    t_Client.SetRealtimeSettings(t_RealtimeSettings);
     t_Client.Initialize();
     std::cout << "minimal client is initialized.\n";
 
@@ -81,10 +81,12 @@ SDKMinimalClient::~SDKMinimalClient()
 /// This function attempts to resize the console window and then proceeds to initialize the SDK's interface.
 ClientReturnCode SDKMinimalClient::Initialize()
 {
+	m_Startup.Start();
 	if (!PlatformSpecificInitialization())
 	{
 		return ClientReturnCode::ClientReturnCode_FailedPlatformSpecificInitialization;
 	}
+	m_Startup.Lap(StartupPhase::StartupPhase_PlatformInit);
 
 	const ClientReturnCode t_IntializeResult = InitializeSDK();
 	if (t_IntializeResult != ClientReturnCode::ClientReturnCode_Success)
@@ -106,12 +108,14 @@ ClientReturnCode SDKMinimalClient::InitializeSDK()
 	{
 		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
 	}
+	m_Startup.Lap(StartupPhase::StartupPhase_SdkInitialize);
 
 	const ClientReturnCode t_CallBackResults = RegisterAllCallbacks();
 	if (t_CallBackResults != ::ClientReturnCode::ClientReturnCode_Success)
 	{
 		return t_CallBackResults;
 	}
+	m_Startup.Lap(StartupPhase::StartupPhase_Callbacks);
 
 	// after everything is registered and initialized as seen above
 	// we must also set the coordinate system being used for the data in this client.
@@ -130,6 +134,7 @@ ClientReturnCode SDKMinimalClient::InitializeSDK()
 	{
 		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
 	}
+	m_Startup.Lap(StartupPhase::StartupPhase_CoordinateSystem);
 
 	return ClientReturnCode::ClientReturnCode_Success;
 }
@@ -167,168 +172,299 @@ ClientReturnCode SDKMinimalClient::RegisterAllCallbacks()
 		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
 	}
 
+	// Register the callback for when manus core is sending landscape data, the users and their gloves.
+	// see OnLandscapeCallback and ProvisionSkeletons for more details.
+	const SDKReturnCode t_RegisterLandscapeCallbackResult = CoreSdk_RegisterCallbackForLandscapeStream(*OnLandscapeCallback);
+	if (t_RegisterLandscapeCallbackResult != SDKReturnCode::SDKReturnCode_Success)
+	{
+		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
+	}
+
+	// Register the callbacks for when the connection to manus core is made or lost, so Run can reconnect
+	// and reload the skeletons as soon as Core goes away, e.g. when it is restarted.
+	const SDKReturnCode t_RegisterConnectCallbackResult = CoreSdk_RegisterCallbackForOnConnect(*OnConnectedCallback);
+	if (t_RegisterConnectCallbackResult != SDKReturnCode::SDKReturnCode_Success)
+	{
+		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
+	}
+	const SDKReturnCode t_RegisterDisconnectCallbackResult = CoreSdk_RegisterCallbackForOnDisconnect(*OnDisconnectedCallback);
+	if (t_RegisterDisconnectCallbackResult != SDKReturnCode::SDKReturnCode_Success)
+	{
+		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
+	}
+
 	return ClientReturnCode::ClientReturnCode_Success;
 }
 
+/// @brief Hand the skeletons of one frame to the workers, each stamped with the time it was captured
+/// and routed to the topics of its user and hand.
+static void PublishSkeletons(const ClientSkeletonCollection& p_Frame, const uint32_t p_FrameNumber, const SkeletonProvisioner& p_Provisioner, const ClockMapping& p_ClockMapping, rclcpp::Clock& p_Clock, SkeletonWorkerPool& p_Workers)
+{
+	// print update
+	std::cout << "skeleton data obtained for frame: " << std::to_string(p_FrameNumber) << ".\n";
+
+	// the workers copy the skeletons, so the frame can be replaced while they publish.
+	const double t_ReceiveMs = ClockMapping::ToMilliseconds(p_Frame.receiveTime);
+	for (const auto& skeleton : p_Frame.skeletons)
+	{
+		// skeletons that were just unloaded can still be in a frame.
+		const uint32_t t_Route = p_Provisioner.FindRoute(skeleton.info.id);
+		if (t_Route == SKELETON_ROUTE_NONE) continue;
+		p_Workers.AddRoute(t_Route, p_Provisioner.GetRoutePrefix(t_Route));
+
+		// until the mapping has settled, or without a publishTime, the arrival time is the best guess.
+		double t_CaptureMs = t_ReceiveMs;
+		int64_t t_PublishMs = 0;
+		if (p_ClockMapping.IsValid() && ManusTimestampToUnixMilliseconds(skeleton.info.publishTime, t_PublishMs) && t_PublishMs > 0)
+		{
+			t_CaptureMs = p_ClockMapping.ToHost(static_cast<double>(t_PublishMs));
+		}
+		p_Workers.Add(skeleton.info, skeleton.nodes, HostToRosTime(t_CaptureMs, p_Clock), p_FrameNumber, t_Route, t_CaptureMs, t_ReceiveMs);
+	}
+	p_Workers.Submit();
+}
+
 /// @brief main loop
 void SDKMinimalClient::Run()
 {
 	// ROS node setup
-    auto node = std::make_shared<rclcpp::Node>("manus_node");
+    auto node = std::make_shared<rclcpp::Node>(GEORT_NODE_NAME);
 	
-	auto x_publisher = node->create_publisher<std_msgs::msg::Float32MultiArray>("x_manus_rotations", 10);
-    auto y_publisher = node->create_publisher<std_msgs::msg::Float32MultiArray>("y_manus_rotations", 10);
-    auto z_publisher = node->create_publisher<std_msgs::msg::Float32MultiArray>("z_manus_rotations", 10);
-	
-	auto pos_publisher = node->create_publisher<std_msgs::msg::Float32MultiArray>("manus_positions", 10);
-	auto quat_publisher = node->create_publisher<std_msgs::msg::Float32MultiArray>("manus_quats", 10);
-
-
+	// the skeletons of a frame are published in parallel, each skeleton id always by the same worker.
+	// skeleton_worker_cpus pins worker i to the i-th CPU of the list, e.g. -p skeleton_worker_cpus:=2,3
+	const int64_t t_WorkerCount = node->declare_parameter<int64_t>("skeleton_workers", 1);
+	const std::string t_WorkerCpus = node->declare_parameter<std::string>("skeleton_worker_cpus", "");
+	const bool t_PrintSkeletons = node->declare_parameter<bool>("print_skeletons", true);
+	RealtimeSettings t_WorkerSettings = m_RealtimeSettings;
+	if (!t_WorkerCpus.empty() && !ParseCpuList(t_WorkerCpus, t_WorkerSettings.cpus))
+	{
+		std::cerr << "skeleton_worker_cpus " << t_WorkerCpus << " is not a CPU list like 2,3 or 2-3, the workers are not pinned." << std::endl;
+		t_WorkerSettings.cpus.clear();
+	}
+	SkeletonWorkerPool t_Workers(node, static_cast<size_t>((std::max)(t_WorkerCount, static_cast<int64_t>(1))), SkeletonProvisioner::GetRouteCount(), t_WorkerSettings, t_PrintSkeletons);
+
+	// by default a hand skeleton is loaded for every user in the landscape that has a glove of that side, see
+	// SkeletonProvisioning.hpp. user index 0 keeps the plain topics, the others get a user<index>/<side>/ prefix.
+	// auto_provision:=false loads the one skeleton of user index 0 as before.
+	const bool t_AutoProvision = node->declare_parameter<bool>("auto_provision", true);
+	const std::string t_ProvisionHands = node->declare_parameter<std::string>("provision_hands", GEORT_DEFAULT_HANDS);
+	if (t_ProvisionHands != "right" && t_ProvisionHands != "left" && t_ProvisionHands != "both")
+	{
+		std::cerr << "provision_hands must be left, right or both, using right." << std::endl;
+	}
+	m_Provisioner.Configure(t_ProvisionHands == "left" || t_ProvisionHands == "both", t_ProvisionHands != "left", Side::Side_Right);
+
+	// optionally record the raw skeleton stream, e.g. ros2 run manus_client manus_right --ros-args -p record_path:=session.rec
+	// for always-on capture add record_chunk_mb / record_chunk_seconds and record_budget_mb.
+	const std::string t_RecordPath = node->declare_parameter<std::string>("record_path", "");
+	RecordingWriterSettings t_RecordSettings;
+	t_RecordSettings.chunkBytes = static_cast<uint64_t>(node->declare_parameter<int64_t>("record_chunk_mb", 0)) << 20;
+	t_RecordSettings.chunkSeconds = node->declare_parameter<double>("record_chunk_seconds", 0.0);
+	t_RecordSettings.diskBudgetBytes = static_cast<uint64_t>(node->declare_parameter<int64_t>("record_budget_mb", 0)) << 20;
+	t_RecordSettings.directIo = node->declare_parameter<bool>("record_direct_io", true);
+	if (!t_RecordPath.empty())
+	{
+		m_Recorder.Open(t_RecordPath, t_RecordSettings);
+	}
 
-	// Initialize vectors to store x, y, z rotations
-    std::vector<float> x_rotations;
-    std::vector<float> y_rotations;
-    std::vector<float> z_rotations;
-	std::vector<float> positions;
-	std::vector<float> quats;
-	
-	std_msgs::msg::Float32MultiArray x_msg, y_msg, z_msg, pos_msg, quat_msg;
+	// what happens to skeleton frames when this loop falls behind the SDK: latest keeps only the newest,
+	// fifo queues skeleton_handoff_slots of them and drops the oldest, block makes the SDK wait. the skeleton
+	// workers queue the frames they have not started on the same way, so with block this loop waits for them.
+	FrameHandoffPolicy t_HandoffPolicy = FrameHandoffPolicy::FrameHandoffPolicy_Latest;
+	const std::string t_HandoffPolicyName = node->declare_parameter<std::string>("skeleton_handoff", "latest");
+	if (!ParseFrameHandoffPolicy(t_HandoffPolicyName, t_HandoffPolicy))
+	{
+		std::cerr << "skeleton_handoff must be latest, fifo or block, using latest." << std::endl;
+	}
+	const size_t t_HandoffSlots = static_cast<size_t>((std::max)(node->declare_parameter<int64_t>("skeleton_handoff_slots", 8), static_cast<int64_t>(1)));
+	m_SkeletonHandoff.Configure(t_HandoffPolicy, t_HandoffSlots);
+	t_Workers.Configure(t_HandoffPolicy, t_HandoffSlots);
+	StreamDiagnostics t_Diagnostics(node, GEORT_NODE_NAME);
+
+	// the skeletons are stamped with their publishTime mapped onto this host's clock, see ClockMapping.hpp.
+	// clock_latency_ms moves the stamps back by the part of the transport delay that is always there.
+	const double t_ClockWindowSeconds = node->declare_parameter<double>("clock_window_s", 30.0);
+	ClockMapping t_ClockMapping;
+	t_ClockMapping.Configure(100.0, static_cast<size_t>((std::max)(t_ClockWindowSeconds, 1.0) * 10.0), 10000.0, 1000.0, node->declare_parameter<double>("clock_latency_ms", 0.0));
+	const std::shared_ptr<rclcpp::Clock> t_Clock = node->get_clock();
+	LandscapeUsers t_LandscapeUsers;
+
+	// the host of the last good connection is tried first and kept in host_cache across restarts, see
+	// HostConnection.hpp. an empty host_cache keeps it for this run only.
+	const std::string t_DocumentsPath = GetDocumentsDirectoryPath_UTF8();
+	const std::string t_HostCache = node->declare_parameter<std::string>("host_cache",
+		t_DocumentsPath.empty() ? std::string() : t_DocumentsPath + s_SlashForFilesystemPath + "GeoRT" + s_SlashForFilesystemPath + "manus_host.txt");
+	m_HostConnector.Configure(t_HostCache, static_cast<uint32_t>((std::max)(node->declare_parameter<int64_t>("discovery_wait_s", 1), static_cast<int64_t>(1))));
+
+	// the hand skeleton setups Core compressed are kept in skeleton_cache and restored from there, see
+	// SkeletonSetupCache.hpp. an empty skeleton_cache builds them every time, it keeps the skeleton_cache_files
+	// setups that were used last.
+	const std::string t_SkeletonCache = node->declare_parameter<std::string>("skeleton_cache",
+		t_DocumentsPath.empty() ? std::string() : t_DocumentsPath + s_SlashForFilesystemPath + "GeoRT" + s_SlashForFilesystemPath + "skeletons");
+	m_SkeletonCache.Configure(t_SkeletonCache, s_HandSkeletonSetupVersion,
+		static_cast<size_t>((std::max)(node->declare_parameter<int64_t>("skeleton_cache_files", 64), static_cast<int64_t>(1))));
+
+	// the startup breakdown is printed at the first frame, and with startup_profile_path appended to
+	// that file as one JSON line, to follow the time to first frame across SDK versions and settings.
+	const std::string t_StartupProfilePath = node->declare_parameter<std::string>("startup_profile_path", "");
+
+	// the skeletons live in the SDK session, so they are loaded again after every (re)connection.
+	auto t_LoadSkeletons = [&]()
+	{
+		if (t_AutoProvision)
+		{
+			// the users Core had before, corrected by the next landscape if it changed while disconnected.
+			ProvisionSkeletons(t_LandscapeUsers);
+			return;
+		}
+		// then upload a simple skeleton with a chain. this will just be a right hand for the first userindex.
+		SkeletonRequest t_Request;
+		t_Request.route = SkeletonProvisioner::GetRoute(0, Side::Side_Right);
+		uint32_t t_SkeletonId = 0;
+		if (LoadHandSkeleton(SkeletonTargetType::SkeletonTargetType_UserIndexData, 0, Side::Side_Right, t_SkeletonId))
+		{
+			m_Provisioner.Add(t_Request, t_SkeletonId);
+		}
+		m_Startup.Mark();
+	};
 
 	// first loop until we get a connection
 	std::cout << "minimal client is connecting to host. (make sure it is running)\n";
+	const std::chrono::steady_clock::time_point t_ConnectStart = std::chrono::steady_clock::now();
 	while (Connect() != ClientReturnCode::ClientReturnCode_Success)
 	{
-		// not yet connected. wait
-		std::cout << "minimal client could not connect.trying again in a second.\n";
-		std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+		// not yet connected. a failed attempt already waited for discovery, so try again soon.
+		std::cout << "minimal client could not connect. trying again.\n";
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
 	}
-	std::cout << "minimal client is connected, setting up skeletons.\n";
-	// then upload a simple skeleton with a chain. this will just be a left hand for the first userindex.
-	LoadTestSkeleton();
-
-	Quaternion qut;
+	std::cout << "minimal client is connected to " << m_HostConnector.GetLastHost().hostName << " by " << GetHostConnectStepName(m_HostConnector.GetLastStep())
+		<< " in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_ConnectStart).count() << " ms, setting up skeletons.\n";
+	m_Startup.Add(StartupPhase::StartupPhase_Discovery, m_HostConnector.GetDiscoveryMs());
+	m_Startup.Add(StartupPhase::StartupPhase_Connect, m_HostConnector.GetConnectMs());
+	m_Startup.Mark();
+	m_Startup.SetNote("connected_by", GetHostConnectStepName(m_HostConnector.GetLastStep()));
+	m_Startup.SetNote("auto_provision", t_AutoProvision ? "true" : "false");
+	t_LoadSkeletons();
+
+	// only now that the SDK is connected and the node and workers exist, so their threads keep the default
+	// scheduling. the SDK threads started by a reconnect do inherit the settings of this thread.
+	PlatformSpecificPublishThreadInitialization();
+
+	// reconnection timing, from the disconnect callback to connected and to the first frame after it.
+	uint32_t t_ReconnectCount = 0;
+	bool t_WaitingForFirstFrame = false;
+	std::chrono::steady_clock::time_point t_DisconnectTime;
 
 	// then loop and get its data while waiting for escape key to end it
 	while (m_Running)
 	{
-		// check if there is new data. otherwise we just wait.
-		m_SkeletonMutex.lock();
-		if (m_NextSkeleton != nullptr)
+		// Core went away, e.g. it was restarted. reconnect right away and load the skeletons again.
+		m_ConnectionMutex.lock();
+		const bool t_Disconnected = m_Disconnected;
+		if (t_Disconnected) t_DisconnectTime = m_DisconnectTime;
+		m_Disconnected = false;
+		m_ConnectionMutex.unlock();
+		if (t_Disconnected)
 		{
-			if (m_Skeleton != nullptr)delete m_Skeleton;
-			m_Skeleton = m_NextSkeleton;
-			m_NextSkeleton = nullptr;
+			std::cout << "minimal client lost the connection to " << m_HostConnector.GetLastHost().hostName << ", reconnecting.\n";
+			// the frames from before are stale and their skeleton ids may be reused by the new session.
+			while (ClientSkeletonCollection* const t_Frame = m_SkeletonHandoff.Pop()) delete t_Frame;
+			if (m_Skeleton != nullptr) delete m_Skeleton;
+			m_Skeleton = nullptr;
+			m_Provisioner.Clear();
+
+			// the SDK may have found its way back already, only connect if it has not.
+			bool t_Connected = false;
+			while (m_Running && (CoreSdk_GetIsConnectedToCore(&t_Connected) != SDKReturnCode::SDKReturnCode_Success || !t_Connected)
+				&& Connect() != ClientReturnCode::ClientReturnCode_Success)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			}
+			t_ReconnectCount++;
+			t_WaitingForFirstFrame = true;
+			std::cout << "minimal client reconnected to " << m_HostConnector.GetLastHost().hostName << " in "
+				<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_DisconnectTime).count() << " ms.\n";
+			t_LoadSkeletons();
 		}
-		m_SkeletonMutex.unlock();
 
-		if (m_Skeleton != nullptr && m_Skeleton->skeletons.size() != 0)
+		// follow the users of the landscape, the SDK must not be called from its own callbacks so it is done here.
+		if (t_AutoProvision)
 		{
-			// print update
-			std::cout << "skeleton data obtained for frame: " << std::to_string(m_FrameCounter) << ".\n";
-			if (m_Skeleton != nullptr && m_Skeleton->skeletons.size() != 0)
+			m_LandscapeMutex.lock();
+			const bool t_HasUsers = m_HasNewLandscapeUsers;
+			if (t_HasUsers) t_LandscapeUsers = m_NewLandscapeUsers;
+			m_HasNewLandscapeUsers = false;
+			m_LandscapeMutex.unlock();
+			if (t_HasUsers)
 			{
-				// Print skeleton data
-				for (const auto& skeleton : m_Skeleton->skeletons)
-				{
-					std::cout << "Skeleton ID: " << skeleton.info.id << std::endl;
-					std::cout << "Number of joints: " << skeleton.info.nodesCount << std::endl;
-					std::cout << "Publish Time: " << skeleton.info.publishTime.time << std::endl;
-					// Print joint rotations
-					// Clear previous rotations
-					x_rotations.clear();
-					y_rotations.clear();
-					z_rotations.clear();
-					positions.clear();
-					quats.clear();
-					for (int i=0; i < skeleton.info.nodesCount; i++)
-					{
-						SkeletonNode node = skeleton.nodes[i];
-						std::cout << "Joint ID: " << node.id << std::endl;
-						std::cout << "Position: (" << node.transform.position.x << ", " << node.transform.position.y << ", " << node.transform.position.z << ")" << std::endl;
-
-						positions.push_back(node.transform.position.x);
-						positions.push_back(node.transform.position.y);
-						positions.push_back(node.transform.position.z);
-
-						qut.w = node.transform.rotation.w;
-						qut.x = node.transform.rotation.x;
-						qut.y = node.transform.rotation.y;
-						qut.z = node.transform.rotation.z;
-
-						std::cout << node.id << " " << qut.x << " " << qut.y << " " << qut.z << " " << qut.w << std::endl;
-						quats.push_back(qut.x);
-						quats.push_back(qut.y);
-						quats.push_back(qut.z);
-						quats.push_back(qut.w);
-
-
-						Vector3 euler = QuaternionToEuler(qut);
-
-						// std::cout << "Rotation: (" << euler.x << ", " << euler.y << ", " << euler.z <<")" << std::endl;
-						std::cout << std::endl;
-
-						x_rotations.push_back(euler.x);
-						y_rotations.push_back(euler.y);
-						z_rotations.push_back(euler.z);			
-					}
-
-					// Publish joint rotations as float arrays
-					x_msg.data = x_rotations;
-					y_msg.data = y_rotations;
-					z_msg.data = z_rotations;
-					pos_msg.data = positions;
-					quat_msg.data = quats;
-
-					x_publisher->publish(x_msg);
-					y_publisher->publish(y_msg);
-					z_publisher->publish(z_msg);
-					pos_publisher->publish(pos_msg);
-					quat_publisher->publish(quat_msg);
-				
-				}
+				m_Startup.Lap(StartupPhase::StartupPhase_Landscape);
+				ProvisionSkeletons(t_LandscapeUsers);
+				m_Startup.Mark();
 			}
-			m_FrameCounter++;
 		}
 
+		// publish every frame the handoff passes on, or the previous one again if there is no new one.
+		bool t_NewFrame = false;
+		while (ClientSkeletonCollection* const t_Frame = m_SkeletonHandoff.Pop())
+		{
+			if (m_Skeleton != nullptr) delete m_Skeleton;
+			m_Skeleton = t_Frame;
+			t_NewFrame = true;
+			if (!m_Startup.IsFinished() && m_Skeleton->skeletons.size() != 0)
+			{
+				m_Startup.Finish(m_Skeleton->receiveTime);
+				m_Startup.Print();
+				std::cout << "startup_profile " << m_Startup.ToJson(GEORT_NODE_NAME) << "\n";
+				if (!t_StartupProfilePath.empty()) m_Startup.Append(t_StartupProfilePath, GEORT_NODE_NAME);
+			}
+			if (t_WaitingForFirstFrame && m_Skeleton->skeletons.size() != 0)
+			{
+				t_WaitingForFirstFrame = false;
+				std::cout << "minimal client has skeleton data again " << std::chrono::duration<double, std::milli>(m_Skeleton->receiveTime - t_DisconnectTime).count()
+					<< " ms after the connection was lost.\n";
+			}
+			int64_t t_PublishMs = 0;
+			if (m_Skeleton->skeletons.size() != 0 && ManusTimestampToUnixMilliseconds(m_Skeleton->skeletons[0].info.publishTime, t_PublishMs) && t_PublishMs > 0)
+			{
+				t_ClockMapping.AddSample(static_cast<double>(t_PublishMs), ClockMapping::ToMilliseconds(m_Skeleton->receiveTime));
+			}
+			if (m_Skeleton->skeletons.size() != 0) PublishSkeletons(*m_Skeleton, m_FrameCounter++, m_Provisioner, t_ClockMapping, *t_Clock, t_Workers);
+		}
+		if (!t_NewFrame && m_Skeleton != nullptr && m_Skeleton->skeletons.size() != 0)
+		{
+			m_SkeletonHandoff.CountRepublished();
+			PublishSkeletons(*m_Skeleton, m_FrameCounter++, m_Provisioner, t_ClockMapping, *t_Clock, t_Workers);
+		}
+		FrameHandoffCounters t_Counters = m_SkeletonHandoff.GetCounters();
+		t_Counters.skipped = t_Workers.GetSkippedCount();
+		t_Diagnostics.Update("skeleton", t_Counters);
+		t_Diagnostics.PublishIfDue();
+
 		std::this_thread::sleep_for(std::chrono::milliseconds(33)); // or roughly 30fps, but good enough to show the results.
 		
 	}
+	// a producer blocked on a full handoff has to be released before the SDK shuts down.
+	m_SkeletonHandoff.Close();
+	t_Workers.Stop();
+	FrameHandoffCounters t_Counters = m_SkeletonHandoff.GetCounters();
+	t_Counters.skipped = t_Workers.GetSkippedCount();
+	t_Diagnostics.Update("skeleton", t_Counters);
+	t_Diagnostics.Print();
+	t_ClockMapping.Print();
+	m_Recorder.Close();
+	t_Workers.PrintLatency();
+	if (t_ReconnectCount > 0)
+	{
+		std::cout << "Reconnected to Manus Core " << t_ReconnectCount << " times.\n";
+	}
 	// then exit.
 }
 
 /// @brief the client will now try to connect to manus core via the SDK.
+/// The last good host is tried first and discovery only if that fails, see HostConnector.
 ClientReturnCode SDKMinimalClient::Connect()
 {
-	SDKReturnCode t_StartResult = CoreSdk_LookForHosts(1, false);
-	if (t_StartResult != SDKReturnCode::SDKReturnCode_Success)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	uint32_t t_NumberOfHostsFound = 0;
-	SDKReturnCode t_NumberResult = CoreSdk_GetNumberOfAvailableHostsFound(&t_NumberOfHostsFound);
-	if (t_NumberResult != SDKReturnCode::SDKReturnCode_Success)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	if (t_NumberOfHostsFound == 0)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	std::unique_ptr<ManusHost[]> t_AvailableHosts; 
-	t_AvailableHosts.reset(new ManusHost[t_NumberOfHostsFound]);
-
-	SDKReturnCode t_HostsResult = CoreSdk_GetAvailableHostsFound(t_AvailableHosts.get(), t_NumberOfHostsFound);
-	if (t_HostsResult != SDKReturnCode::SDKReturnCode_Success)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	SDKReturnCode t_ConnectResult = CoreSdk_ConnectToHost(t_AvailableHosts[0]);
-
-	if (t_ConnectResult == SDKReturnCode::SDKReturnCode_NotConnected)
+	if (!m_HostConnector.Connect())
 	{
 		return ClientReturnCode::ClientReturnCode_FailedToConnect;
 	}
@@ -343,37 +479,111 @@ ClientReturnCode SDKMinimalClient::Connect()
 /// In the case of this sample we create a Hand skeleton in order to get skeleton information
 /// in the OnSkeletonStreamCallback function. This sample does not contain any 3D rendering, so
 /// we will not be applying the returned data on anything.
-void SDKMinimalClient::LoadTestSkeleton()
+/// @param p_TargetType SkeletonTargetType_UserIndexData or SkeletonTargetType_UserData.
+/// @param p_Target the user index or the user id.
+/// @param p_SkeletonId the id of the loaded skeleton, as in SkeletonInfo::id.
+bool SDKMinimalClient::LoadHandSkeleton(SkeletonTargetType p_TargetType, uint32_t p_Target, Side p_Side, uint32_t& p_SkeletonId)
 {
+	const std::chrono::steady_clock::time_point t_Start = std::chrono::steady_clock::now();
 	uint32_t t_SklIndex = 0;
 
 	SkeletonSetupInfo t_SKL;
 	SkeletonSetupInfo_Init(&t_SKL);
 	t_SKL.type = SkeletonType::SkeletonType_Hand;
 	t_SKL.settings.scaleToTarget = true;
-	t_SKL.settings.targetType = SkeletonTargetType::SkeletonTargetType_UserIndexData;
+	t_SKL.settings.targetType = p_TargetType;
 	//If the glove does not exist then the added skeleton will not be animated.
 	//Same goes for any other skeleton made for invalid users/gloves.
-	t_SKL.settings.skeletonTargetUserIndexData.userIndex = 0; // just take the first index. make sure this matches in the landscape. 
+	if (p_TargetType == SkeletonTargetType::SkeletonTargetType_UserData) t_SKL.settings.skeletonTargetUserData.userID = p_Target;
+	else t_SKL.settings.skeletonTargetUserIndexData.userIndex = p_Target;
 
-	CopyString(t_SKL.name, sizeof(t_SKL.name), std::string("RightHand"));
+	CopyString(t_SKL.name, sizeof(t_SKL.name), std::string(p_Side == Side::Side_Left ? "LeftHand" : "RightHand") + std::to_string(p_Target));
 
 	SDKReturnCode t_Res = CoreSdk_CreateSkeletonSetup(t_SKL, &t_SklIndex);
 	if (t_Res != SDKReturnCode::SDKReturnCode_Success)
 	{
-		return;
+		return false;
 	}
 
-	// setup nodes and chains for the skeleton hand
-	if (!SetupHandNodes(t_SklIndex)) return;
-	if (!SetupHandChains(t_SklIndex)) return;
+	// a setup Core compressed for us before is restored in one call, see SkeletonSetupCache.hpp.
+	// if it cannot be, e.g. after a Core update, it is built node by node and cached again.
+	uint32_t t_SessionId = 0;
+	const bool t_HasSession = m_SkeletonCache.IsEnabled() && CoreSdk_GetSessionId(&t_SessionId) == SDKReturnCode::SDKReturnCode_Success;
+	const std::string t_CachePath = m_SkeletonCache.GetPath(p_TargetType, p_Target, p_Side);
+	const bool t_Cached = t_HasSession && m_SkeletonCache.Read(t_CachePath, m_SkeletonSetupData);
+	const bool t_FromCache = t_Cached
+		&& CoreSdk_GetTemporarySkeletonFromCompressedData(t_SklIndex, t_SessionId, m_SkeletonSetupData.data(), static_cast<uint32_t>(m_SkeletonSetupData.size())) == SDKReturnCode::SDKReturnCode_Success;
+	if (!t_FromCache)
+	{
+		// a failed restore may have left part of a setup behind, start over from the plain one.
+		if (t_Cached && CoreSdk_OverwriteSkeletonSetup(t_SklIndex, t_SKL) != SDKReturnCode::SDKReturnCode_Success) return false;
+
+		// setup nodes and chains for the skeleton hand
+		if (!SetupHandNodes(t_SklIndex)) return false;
+		if (!SetupHandChains(t_SklIndex, p_Side)) return false;
+
+		// Core compresses what it has saved, before loading, which takes the setup away.
+		uint32_t t_Length = 0;
+		if (t_HasSession && CoreSdk_SaveTemporarySkeleton(t_SklIndex, t_SessionId, false) == SDKReturnCode::SDKReturnCode_Success
+			&& CoreSdk_CompressTemporarySkeletonAndGetSize(t_SklIndex, t_SessionId, &t_Length) == SDKReturnCode::SDKReturnCode_Success && t_Length > 0)
+		{
+			m_SkeletonSetupData.resize(t_Length);
+			if (CoreSdk_GetCompressedTemporarySkeletonData(m_SkeletonSetupData.data(), t_Length) == SDKReturnCode::SDKReturnCode_Success)
+			{
+				m_SkeletonCache.Write(t_CachePath, m_SkeletonSetupData);
+			}
+		}
+	}
+	const std::chrono::steady_clock::time_point t_SetUp = std::chrono::steady_clock::now();
 
 	// load skeleton 
-	uint32_t t_ID = 0;
-	t_Res = CoreSdk_LoadSkeleton(t_SklIndex, &t_ID);
+	t_Res = CoreSdk_LoadSkeleton(t_SklIndex, &p_SkeletonId);
 	if (t_Res != SDKReturnCode::SDKReturnCode_Success)
 	{
-		return;
+		return false;
+	}
+	const std::chrono::steady_clock::time_point t_Loaded = std::chrono::steady_clock::now();
+	m_Startup.Add(StartupPhase::StartupPhase_SkeletonSetup, std::chrono::duration<double, std::milli>(t_SetUp - t_Start).count());
+	m_Startup.Add(StartupPhase::StartupPhase_SkeletonLoad, std::chrono::duration<double, std::milli>(t_Loaded - t_SetUp).count());
+	m_SkeletonLoads++;
+	if (t_FromCache) m_SkeletonCacheHits++;
+	m_Startup.SetNote("skeleton_cache_hits", std::to_string(m_SkeletonCacheHits) + "/" + std::to_string(m_SkeletonLoads));
+	std::cout << "Set up " << t_SKL.name << (t_FromCache ? " from the cache" : "") << " in " << std::chrono::duration<double, std::milli>(t_SetUp - t_Start).count()
+		<< " ms, loaded it in " << std::chrono::duration<double, std::milli>(t_Loaded - t_SetUp).count() << " ms.\n";
+	return true;
+}
+
+/// @brief Unload the skeletons of users that left or lost a glove, and load one for every user and
+/// hand that has none yet, see SkeletonProvisioner. Skeletons are loaded for the user id, so they keep
+/// following the same person whatever index Core gives them.
+void SDKMinimalClient::ProvisionSkeletons(const LandscapeUsers& p_Users)
+{
+	m_Provisioner.Plan(p_Users, m_ProvisionUnload, m_ProvisionLoad);
+
+	for (const uint32_t t_SkeletonId : m_ProvisionUnload)
+	{
+		const SDKReturnCode t_Res = CoreSdk_UnloadSkeleton(t_SkeletonId);
+		if (t_Res != SDKReturnCode::SDKReturnCode_Success)
+		{
+			std::cerr << "Failed to unload skeleton " << t_SkeletonId << ", the error given " << t_Res << "." << std::endl;
+		}
+		// forgotten either way, its frames are not published any more.
+		m_Provisioner.Remove(t_SkeletonId);
+		std::cout << "Unloaded skeleton " << t_SkeletonId << ".\n";
+	}
+	for (const SkeletonRequest& t_Request : m_ProvisionLoad)
+	{
+		uint32_t t_SkeletonId = 0;
+		const char* const t_SideName = t_Request.side == Side::Side_Left ? "left" : "right";
+		if (!LoadHandSkeleton(SkeletonTargetType::SkeletonTargetType_UserData, t_Request.userId, t_Request.side, t_SkeletonId))
+		{
+			std::cerr << "Failed to load a " << t_SideName << " hand skeleton for user " << t_Request.userId << "." << std::endl;
+			continue;
+		}
+		m_Provisioner.Add(t_Request, t_SkeletonId);
+		const std::string t_Prefix = m_Provisioner.GetRoutePrefix(t_Request.route);
+		std::cout << "Loaded " << t_SideName << " hand skeleton " << t_SkeletonId << " for user " << t_Request.userId << " (index " << t_Request.userIndex
+			<< "), published on " << (t_Prefix.empty() ? "the default topics" : t_Prefix) << ".\n";
 	}
 }
 
@@ -519,8 +729,9 @@ bool SDKMinimalClient::SetupHandNodes(uint32_t p_SklIndex)
 /// Chains are required for a Skeleton to be able to be animated, it basically tells Manus Core
 /// which nodes belong to which body part and what data needs to be applied to which node.
 /// @param p_SklIndex The index of the temporary skeleton on which the chains will be added.
+/// @param p_Side The hand the chains are for.
 /// @return Returns true if everything went fine, otherwise returns false.
-bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
+bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex, Side p_Side)
 {
 	// Add the Hand chain, this identifies the wrist of the hand
 	{
@@ -540,7 +751,7 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 		t_Chain.id = 0; //Every ID needs to be unique per chain in a skeleton.
 		t_Chain.type = ChainType::ChainType_Hand;
 		t_Chain.dataType = ChainType::ChainType_Hand;
-		t_Chain.side = Side::Side_Right;
+		t_Chain.side = p_Side;
 		t_Chain.dataIndex = 0;
 		t_Chain.nodeIdCount = 1;
 		t_Chain.nodeIds[0] = 0; //this links to the hand node created in the SetupHandNodes
@@ -574,7 +785,7 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 		t_Chain.id = i + 1; //Every ID needs to be unique per chain in a skeleton.
 		t_Chain.type = t_FingerTypes[i];
 		t_Chain.dataType = t_FingerTypes[i];
-		t_Chain.side = Side::Side_Right;
+		t_Chain.side = p_Side;
 		t_Chain.dataIndex = 0;
 		if (i == 0) // Thumb
 		{
@@ -603,13 +814,61 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 	return true;
 }
 
+/// @brief This gets called when the landscape changes, e.g. a user or glove is added or removed.
+/// Only the users are kept, Run provisions their skeletons since the SDK must not be called from here.
+/// @param p_Landscape the whole landscape, only valid during the call.
+void SDKMinimalClient::OnLandscapeCallback(const Landscape* const p_Landscape)
+{
+	if (s_Instance)
+	{
+		s_Instance->m_LandscapeMutex.lock();
+		s_Instance->m_NewLandscapeUsers.Set(*p_Landscape);
+		s_Instance->m_HasNewLandscapeUsers = true;
+		s_Instance->m_LandscapeMutex.unlock();
+	}
+}
+
+/// @brief This gets called when the client is connected to manus core.
+/// @param p_Host the host it connected to.
+void SDKMinimalClient::OnConnectedCallback(const ManusHost* const p_Host)
+{
+	if (s_Instance && p_Host != nullptr)
+	{
+		std::cout << "Connected to Manus Core " << p_Host->hostName << " (" << p_Host->ipAddress << ").\n";
+	}
+}
+
+/// @brief This gets called when the connection to manus core is lost. The SDK must not be called
+/// from its callbacks, so this only notes it and Run reconnects.
+/// @param p_Host the host it was connected to.
+void SDKMinimalClient::OnDisconnectedCallback(const ManusHost* const p_Host)
+{
+	(void)p_Host;
+	if (s_Instance)
+	{
+		s_Instance->m_ConnectionMutex.lock();
+		s_Instance->m_Disconnected = true;
+		s_Instance->m_DisconnectTime = std::chrono::steady_clock::now();
+		s_Instance->m_ConnectionMutex.unlock();
+	}
+}
+
 /// @brief This gets called when the client is connected to manus core
 /// @param p_SkeletonStreamInfo contains the meta data on how much data regarding the skeleton we need to get from the SDK.
 void SDKMinimalClient::OnSkeletonStreamCallback(const SkeletonStreamInfo* const p_SkeletonStreamInfo)
 {
 	if (s_Instance)
 	{
+		// the SDK owns this thread, so it gets the real-time settings on its first callback.
+		static thread_local bool t_ThreadInitialized = false;
+		if (!t_ThreadInitialized)
+		{
+			t_ThreadInitialized = true;
+			s_Instance->PlatformSpecificCallbackThreadInitialization();
+		}
+
 		ClientSkeletonCollection* t_NxtClientSkeleton = new ClientSkeletonCollection();
+		t_NxtClientSkeleton->receiveTime = std::chrono::steady_clock::now();
 		t_NxtClientSkeleton->skeletons.resize(p_SkeletonStreamInfo->skeletonsCount);
 
 		for (uint32_t i = 0; i < p_SkeletonStreamInfo->skeletonsCount; i++)
@@ -618,9 +877,7 @@ void SDKMinimalClient::OnSkeletonStreamCallback(const SkeletonStreamInfo* const
 			t_NxtClientSkeleton->skeletons[i].nodes = new SkeletonNode[t_NxtClientSkeleton->skeletons[i].info.nodesCount];
 			CoreSdk_GetSkeletonData(i, t_NxtClientSkeleton->skeletons[i].nodes, t_NxtClientSkeleton->skeletons[i].info.nodesCount);
 		}
-		s_Instance->m_SkeletonMutex.lock();
-		if (s_Instance->m_NextSkeleton != nullptr) delete s_Instance->m_NextSkeleton;
-		s_Instance->m_NextSkeleton = t_NxtClientSkeleton;
-		s_Instance->m_SkeletonMutex.unlock();
+		s_Instance->m_Recorder.RecordFrame(t_NxtClientSkeleton->skeletons.data(), t_NxtClientSkeleton->skeletons.size());
+		s_Instance->m_SkeletonHandoff.Push(t_NxtClientSkeleton);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,483 @@
+// Copyright (c) Meta Platforms, Inc. and affiliates.
+// All rights reserved.
+
+// This source code is licensed under the license found in the
+// LICENSE file in the root directory of this source tree.
+
+// scale_benchmark : drives the skeleton pipeline of manus_right and the tracker pipeline of
+// manus_tracker with synthetic frames at the limits of the SDK (MAX_NUMBER_OF_SKELETONS skeletons
+// and MAX_NUMBER_OF_TRACKERS trackers by default, at 120 Hz), so their cost can be measured without
+// gloves, trackers or Manus Core.
+//
+// Usage: scale_benchmark [--rate HZ] [--seconds S] [--warmup S] [--skeletons N] [--trackers N]
+//            [--workers N] [--handoff latest|fifo|block] [--slots N] [--poll-ms MS]
+//            [--baseline FILE] [--write-baseline FILE] [--tolerance FRACTION]
+//            [--max-cpu-ms MS] [--max-allocations N] [--max-p99-ms MS] [--max-dropped-percent P]
+//            [--rt-* ...] [--ros-args ...]
+//
+// Two threads stand in for the SDK callbacks: every period they allocate and fill a frame the way
+// OnSkeletonStreamCallback and OnTrackerStreamCallback do and push it into a FrameHandoff. Two
+// loops like the Run loops take them out, the skeletons go through the SkeletonWorkerPool onto
+// ROS topics (under scale_benchmark/) and the trackers through the TrackerRegistry, the
+// TrackerPredictor and the TrackerFilter into one TF message per frame.
+//
+// After the warmup it measures the process CPU time and the C++ operator new allocations per
+// frame (a frame being one skeleton and one tracker frame, malloc calls in the ROS layers are not
+// counted), the latency from the callback to publishing (for the skeletons over the whole run, the
+// pool keeps its own statistics) and the frames that were dropped. It exits with 1 if a metric is
+// worse than its --max-* limit, or worse than the --baseline file by more than the tolerance.
+// --write-baseline saves the metrics of a good run in the same format, one "name value" pair per
+// line.
+
+#include "CommandLine.hpp"
+#include "LatencyStatistics.hpp"
+#include "SDKMinimalClient.hpp"
+#include "SkeletonWorkerPool.hpp"
+#include "TrackerFilter.hpp"
+#include "TrackerPrediction.hpp"
+#include "TrackerRegistry.hpp"
+#include "geometry_msgs/msg/transform_stamped.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "tf2_ros/transform_broadcaster.h"
+
+// std::max
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+// std::sin, std::cos
+#include <cmath>
+// std::malloc, std::free
+#include <cstdlib>
+// clock_gettime
+#include <ctime>
+// std::function
+#include <functional>
+#include <fstream>
+#include <iostream>
+// std::bad_alloc
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// every C++ operator new of the process is counted, whichever thread makes it. rcl, rmw and DDS
+// allocate mostly with malloc, which is not counted, so this is the cost of our own code.
+static std::atomic<uint64_t> s_Allocations(0);
+
+void* operator new(size_t p_Size)
+{
+	s_Allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* const t_Memory = std::malloc(p_Size == 0 ? 1 : p_Size)) return t_Memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p_Memory) noexcept
+{
+	std::free(p_Memory);
+}
+
+void operator delete(void* p_Memory, size_t) noexcept
+{
+	std::free(p_Memory);
+}
+
+/// @brief Number of nodes of the hand skeleton manus_right sets up.
+static const uint32_t s_NodesPerSkeleton = 21;
+
+/// @brief The measured metrics, a larger value is always worse.
+class ScaleMetrics
+{
+public:
+	double cpuMsPerFrame = 0.0;
+	double allocationsPerFrame = 0.0;
+	double skeletonP50Ms = 0.0;
+	double skeletonP99Ms = 0.0;
+	double trackerP50Ms = 0.0;
+	double trackerP99Ms = 0.0;
+	double droppedPercent = 0.0;
+
+	/// @brief Limits that fail nothing, every metric is -1, so a --max-* option only sets its own.
+	static ScaleMetrics GetUnlimited();
+};
+
+/// @brief Name, value and the absolute slack allowed on top of the relative tolerance, so metrics
+/// that are close to 0 do not fail on noise.
+class MetricEntry
+{
+public:
+	const char* name;
+	double* value;
+	double slack;
+};
+
+static std::vector<MetricEntry> GetMetricEntries(ScaleMetrics& p_Metrics)
+{
+	return {
+		{ "cpu_ms_per_frame", &p_Metrics.cpuMsPerFrame, 0.05 },
+		{ "allocations_per_frame", &p_Metrics.allocationsPerFrame, 1.0 },
+		{ "skeleton_p50_ms", &p_Metrics.skeletonP50Ms, 0.2 },
+		{ "skeleton_p99_ms", &p_Metrics.skeletonP99Ms, 0.5 },
+		{ "tracker_p50_ms", &p_Metrics.trackerP50Ms, 0.2 },
+		{ "tracker_p99_ms", &p_Metrics.trackerP99Ms, 0.5 },
+		{ "dropped_percent", &p_Metrics.droppedPercent, 0.1 },
+	};
+}
+
+ScaleMetrics ScaleMetrics::GetUnlimited()
+{
+	ScaleMetrics t_Limits;
+	for (const MetricEntry& t_Entry : GetMetricEntries(t_Limits)) *t_Entry.value = -1.0;
+	return t_Limits;
+}
+
+static bool ReadMetrics(const std::string& p_Path, ScaleMetrics& p_Metrics)
+{
+	std::ifstream t_File(p_Path);
+	if (!t_File)
+	{
+		std::cerr << "Cannot read the baseline " << p_Path << "." << std::endl;
+		return false;
+	}
+	std::vector<MetricEntry> t_Entries = GetMetricEntries(p_Metrics);
+	std::string t_Name;
+	double t_Value = 0.0;
+	while (t_File >> t_Name >> t_Value)
+	{
+		for (MetricEntry& t_Entry : t_Entries)
+		{
+			if (t_Name == t_Entry.name) *t_Entry.value = t_Value;
+		}
+	}
+	return true;
+}
+
+static bool WriteMetrics(const std::string& p_Path, ScaleMetrics p_Metrics)
+{
+	std::ofstream t_File(p_Path);
+	for (const MetricEntry& t_Entry : GetMetricEntries(p_Metrics))
+	{
+		t_File << t_Entry.name << " " << *t_Entry.value << "\n";
+	}
+	if (!t_File)
+	{
+		std::cerr << "Cannot write the baseline " << p_Path << "." << std::endl;
+		return false;
+	}
+	return true;
+}
+
+static double GetProcessCpuMs()
+{
+	timespec t_Time;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t_Time);
+	return t_Time.tv_sec * 1e3 + t_Time.tv_nsec / 1e6;
+}
+
+static double GetSteadyMs()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// @brief The work of OnSkeletonStreamCallback: a new collection with a copy of every skeleton.
+static ClientSkeletonCollection* MakeSkeletonFrame(const uint32_t p_SkeletonCount, const uint64_t p_Frame)
+{
+	ClientSkeletonCollection* const t_Frame = new ClientSkeletonCollection();
+	t_Frame->receiveTime = std::chrono::steady_clock::now();
+	t_Frame->skeletons.resize(p_SkeletonCount);
+	for (uint32_t i = 0; i < p_SkeletonCount; i++)
+	{
+		ClientSkeleton& t_Skeleton = t_Frame->skeletons[i];
+		t_Skeleton.info.id = i + 1;
+		t_Skeleton.info.nodesCount = s_NodesPerSkeleton;
+		t_Skeleton.info.publishTime.time = p_Frame;
+		t_Skeleton.nodes = new SkeletonNode[s_NodesPerSkeleton];
+		for (uint32_t j = 0; j < s_NodesPerSkeleton; j++)
+		{
+			const float t_Angle = 0.01f * static_cast<float>(p_Frame + i + j);
+			t_Skeleton.nodes[j].id = j;
+			t_Skeleton.nodes[j].transform.position = { 0.01f * j, 0.0f, 0.02f * std::sin(t_Angle) };
+			t_Skeleton.nodes[j].transform.rotation = { std::cos(t_Angle), std::sin(t_Angle), 0.0f, 0.0f };
+			t_Skeleton.nodes[j].transform.scale = { 1.0f, 1.0f, 1.0f };
+		}
+	}
+	return t_Frame;
+}
+
+/// @brief The work of OnTrackerStreamCallback. Every 50th tracker loses tracking for a while now
+/// and then, so the filter does more than pass samples on.
+static TrackerDataCollection* MakeTrackerFrame(const std::vector<TrackerId>& p_Ids, const uint64_t p_Frame)
+{
+	TrackerDataCollection* const t_Frame = new TrackerDataCollection();
+	t_Frame->receiveTime = std::chrono::steady_clock::now();
+	t_Frame->publishTime.time = p_Frame;
+	t_Frame->trackerData.resize(p_Ids.size());
+	for (size_t i = 0; i < p_Ids.size(); i++)
+	{
+		TrackerData& t_Data = t_Frame->trackerData[i];
+		const float t_Angle = 0.02f * static_cast<float>(p_Frame + i);
+		t_Data.trackerId = p_Ids[i];
+		t_Data.lastUpdateTime.time = p_Frame;
+		t_Data.position = { std::sin(t_Angle), std::cos(t_Angle), 0.001f * i };
+		t_Data.rotation = { std::cos(t_Angle), 0.0f, std::sin(t_Angle), 0.0f };
+		t_Data.quality = (i % 50 == 0 && (p_Frame / 60) % 4 == 3) ? TrackingQuality::TrackingQuality_Untrackable : TrackingQuality::TrackingQuality_Trackable;
+	}
+	return t_Frame;
+}
+
+/// @brief Calls p_Produce at p_Rate until p_Stop is set, like the SDK callback thread would.
+template <class Produce>
+static void RunProducer(const double p_Rate, const std::atomic<bool>& p_Stop, Produce p_Produce)
+{
+	const std::chrono::nanoseconds t_Period(static_cast<int64_t>(1e9 / p_Rate));
+	std::chrono::steady_clock::time_point t_Next = std::chrono::steady_clock::now();
+	for (uint64_t t_Frame = 0; !p_Stop.load(std::memory_order_relaxed); t_Frame++)
+	{
+		std::this_thread::sleep_until(t_Next);
+		p_Produce(t_Frame);
+		t_Next += t_Period;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	rclcpp::init(argc, argv);
+	std::vector<std::string> t_Arguments = rclcpp::remove_ros_arguments(argc, argv);
+	t_Arguments.erase(t_Arguments.begin());
+	RealtimeSettings t_Settings;
+	bool t_ValidArguments = t_Settings.Parse(t_Arguments);
+
+	double t_Rate = 120.0;
+	double t_Seconds = 10.0;
+	double t_WarmupSeconds = 1.0;
+	uint32_t t_SkeletonCount = MAX_NUMBER_OF_SKELETONS;
+	uint32_t t_TrackerCount = MAX_NUMBER_OF_TRACKERS;
+	size_t t_WorkerCount = 2;
+	std::string t_HandoffName = "fifo";
+	size_t t_Slots = 8;
+	double t_PollMs = 1.0;
+	std::string t_BaselinePath;
+	std::string t_WriteBaselinePath;
+	double t_Tolerance = 0.25;
+	ScaleMetrics t_Limits = ScaleMetrics::GetUnlimited();
+	for (size_t i = 0; i < t_Arguments.size() && t_ValidArguments; i++)
+	{
+		const std::string& t_Argument = t_Arguments[i];
+		if (i + 1 >= t_Arguments.size()) t_ValidArguments = false;
+		else if (t_Argument == "--rate") t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Rate);
+		else if (t_Argument == "--seconds") t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Seconds);
+		else if (t_Argument == "--warmup") t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_WarmupSeconds);
+		else if (t_Argument == "--skeletons") t_ValidArguments &= ParseUnsignedArgument(t_Arguments[++i], t_SkeletonCount);
+		else if (t_Argument == "--trackers") t_ValidArguments &= ParseUnsignedArgument(t_Arguments[++i], t_TrackerCount);
+		else if (t_Argument == "--workers") t_ValidArguments &= ParseUnsignedArgument(t_Arguments[++i], t_WorkerCount);
+		else if (t_Argument == "--handoff") t_HandoffName = t_Arguments[++i];
+		else if (t_Argument == "--slots") t_ValidArguments &= ParseUnsignedArgument(t_Arguments[++i], t_Slots);
+		else if (t_Argument == "--poll-ms") t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_PollMs);
+		else if (t_Argument == "--baseline") t_BaselinePath = t_Arguments[++i];
+		else if (t_Argument == "--write-baseline") t_WriteBaselinePath = t_Arguments[++i];
+		else if (t_Argument == "--tolerance") t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Tolerance);
+		else if (t_Argument == "--max-cpu-ms") t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Limits.cpuMsPerFrame);
+		else if (t_Argument == "--max-allocations") t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Limits.allocationsPerFrame);
+		else if (t_Argument == "--max-p99-ms") t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Limits.skeletonP99Ms);
+		else if (t_Argument == "--max-dropped-percent") t_ValidArguments &= ParseDoubleArgument(t_Arguments[++i], t_Limits.droppedPercent);
+		else t_ValidArguments = false;
+	}
+	FrameHandoffPolicy t_Policy = FrameHandoffPolicy::FrameHandoffPolicy_Fifo;
+	if (!t_ValidArguments || !ParseFrameHandoffPolicy(t_HandoffName, t_Policy) || t_Rate <= 0.0 || t_Seconds <= t_WarmupSeconds || t_TrackerCount == 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " [--rate HZ] [--seconds S] [--warmup S] [--skeletons N] [--trackers N] [--workers N]"
+			<< " [--handoff latest|fifo|block] [--slots N] [--poll-ms MS] [--baseline FILE] [--write-baseline FILE] [--tolerance FRACTION]"
+			<< " [--max-cpu-ms MS] [--max-allocations N] [--max-p99-ms MS] [--max-dropped-percent P] " << RealtimeSettings::GetUsage() << "\n";
+		rclcpp::shutdown();
+		return 1;
+	}
+	t_Limits.trackerP99Ms = t_Limits.skeletonP99Ms;
+	ScaleMetrics t_Baseline;
+	if (!t_BaselinePath.empty() && !ReadMetrics(t_BaselinePath, t_Baseline))
+	{
+		rclcpp::shutdown();
+		return 1;
+	}
+	ApplyRealtimeProcessSettings(t_Settings);
+
+	auto t_Node = std::make_shared<rclcpp::Node>("scale_benchmark");
+	FrameHandoff<ClientSkeletonCollection> t_SkeletonHandoff;
+	FrameHandoff<TrackerDataCollection> t_TrackerHandoff;
+	t_SkeletonHandoff.Configure(t_Policy, t_Slots);
+	t_TrackerHandoff.Configure(t_Policy, t_Slots);
+
+	// the skeleton side, one route per skeleton as if every one were a different hand.
+	SkeletonWorkerPool t_Workers(t_Node, t_WorkerCount, t_SkeletonCount, t_Settings, false);
+	t_Workers.Configure(t_Policy, t_Slots);
+	for (uint32_t i = 0; i < t_SkeletonCount; i++)
+	{
+		t_Workers.AddRoute(i, "scale_benchmark/skeleton" + std::to_string(i) + "/");
+	}
+
+	// the tracker side, every tracker with a TF only route.
+	std::vector<TrackerId> t_TrackerIds(t_TrackerCount);
+	std::vector<TrackerRoute> t_Routes(t_TrackerCount);
+	for (uint32_t i = 0; i < t_TrackerCount; i++)
+	{
+		t_Routes[i].frame = "scale_benchmark_tracker" + std::to_string(i);
+		TrackerRegistry::MakeTrackerId("LHR-" + std::to_string(10000000 + i * 7919), t_TrackerIds[i]);
+		t_Routes[i].trackerId = t_TrackerIds[i];
+	}
+	TrackerRegistry t_Registry;
+	t_Registry.SetRoutes(t_Routes);
+	TrackerPredictor t_Predictor;
+	t_Predictor.Resize(t_TrackerCount);
+	TrackerFilter t_Filter;
+	t_Filter.Configure(TrackingQuality::TrackingQuality_BadTracking, 250.0, 150.0);
+	t_Filter.Resize(t_TrackerCount);
+	tf2_ros::TransformBroadcaster t_Broadcaster(t_Node);
+
+	std::cout << "Driving " << t_SkeletonCount << " skeletons and " << t_TrackerCount << " trackers at " << t_Rate << " Hz for " << t_Seconds
+		<< " s (" << t_WarmupSeconds << " s warmup), " << t_WorkerCount << " skeleton workers, " << t_HandoffName << " handoff.\n";
+
+	std::atomic<bool> t_Stop(false);
+	std::atomic<bool> t_Measuring(false);
+	LatencyStatistics t_TrackerLatency(100.0);
+
+	std::thread t_SkeletonLoop([&]()
+	{
+		builtin_interfaces::msg::Time t_Stamp;
+		uint32_t t_FrameNumber = 0;
+		while (!t_Stop.load(std::memory_order_relaxed))
+		{
+			while (ClientSkeletonCollection* const t_Frame = t_SkeletonHandoff.Pop())
+			{
+				const double t_ReceiveMs = std::chrono::duration<double, std::milli>(t_Frame->receiveTime.time_since_epoch()).count();
+				for (uint32_t i = 0; i < t_Frame->skeletons.size(); i++)
+				{
+					const ClientSkeleton& t_Skeleton = t_Frame->skeletons[i];
+					t_Workers.Add(t_Skeleton.info, t_Skeleton.nodes, t_Stamp, t_FrameNumber, i, t_ReceiveMs, t_ReceiveMs);
+				}
+				t_Workers.Submit();
+				t_FrameNumber++;
+				delete t_Frame;
+			}
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(t_PollMs));
+		}
+	});
+
+	std::thread t_TrackerLoop([&]()
+	{
+		std::vector<geometry_msgs::msg::TransformStamped> t_Transforms;
+		while (!t_Stop.load(std::memory_order_relaxed))
+		{
+			while (TrackerDataCollection* const t_Frame = t_TrackerHandoff.Pop())
+			{
+				const double t_ReceiveMs = std::chrono::duration<double, std::milli>(t_Frame->receiveTime.time_since_epoch()).count();
+				const double t_TargetMs = t_Frame->publishTime.time * 1000.0 / t_Rate;
+				t_Transforms.resize(t_Frame->trackerData.size());
+				size_t t_TransformCount = 0;
+				for (const TrackerData& t_Data : t_Frame->trackerData)
+				{
+					const uint32_t t_Route = t_Registry.Find(t_Data.trackerId);
+					if (t_Route == TRACKER_ROUTE_NONE) continue;
+					TrackerPose t_Sample = TrackerPose::FromTrackerData(t_Data);
+					TrackerPose t_Extrapolated;
+					if (t_Filter.IsGood(t_Data.quality)) t_Predictor.AddSample(t_Route, static_cast<int64_t>(t_TargetMs), t_Sample);
+					const bool t_HasExtrapolation = t_Predictor.Predict(t_Route, t_TargetMs + 10.0, 100.0, t_Extrapolated);
+					if (t_Filter.IsGood(t_Data.quality) && t_HasExtrapolation) t_Sample = t_Extrapolated;
+					TrackerPose t_Pose;
+					if (!t_Filter.Update(t_Route, t_ReceiveMs, t_Data.quality, t_Sample, t_HasExtrapolation ? &t_Extrapolated : nullptr, t_Pose)) continue;
+
+					geometry_msgs::msg::TransformStamped& t_Transform = t_Transforms[t_TransformCount++];
+					t_Transform.header.frame_id = "lighthouse_frame";
+					t_Transform.child_frame_id = t_Registry.GetRoutes()[t_Route].frame;
+					t_Transform.transform.translation.x = t_Pose.position[0];
+					t_Transform.transform.translation.y = t_Pose.position[1];
+					t_Transform.transform.translation.z = t_Pose.position[2];
+					t_Transform.transform.rotation.x = t_Pose.rotation[1];
+					t_Transform.transform.rotation.y = t_Pose.rotation[2];
+					t_Transform.transform.rotation.z = t_Pose.rotation[3];
+					t_Transform.transform.rotation.w = t_Pose.rotation[0];
+				}
+				t_Transforms.resize(t_TransformCount);
+				if (!t_Transforms.empty()) t_Broadcaster.sendTransform(t_Transforms);
+				if (t_Measuring.load(std::memory_order_relaxed)) t_TrackerLatency.Add(GetSteadyMs() - t_ReceiveMs);
+				delete t_Frame;
+			}
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(t_PollMs));
+		}
+	});
+
+	std::thread t_SkeletonProducer(RunProducer<std::function<void(uint64_t)>>, t_Rate, std::cref(t_Stop),
+		std::function<void(uint64_t)>([&](const uint64_t p_Frame) { t_SkeletonHandoff.Push(MakeSkeletonFrame(t_SkeletonCount, p_Frame)); }));
+	std::thread t_TrackerProducer(RunProducer<std::function<void(uint64_t)>>, t_Rate, std::cref(t_Stop),
+		std::function<void(uint64_t)>([&](const uint64_t p_Frame) { t_TrackerHandoff.Push(MakeTrackerFrame(t_TrackerIds, p_Frame)); }));
+
+	// everything before the warmup ends, publisher discovery, first allocations, is left out.
+	std::this_thread::sleep_for(std::chrono::duration<double>(t_WarmupSeconds));
+	const double t_StartCpuMs = GetProcessCpuMs();
+	const uint64_t t_StartAllocations = s_Allocations.load();
+	const FrameHandoffCounters t_StartSkeletons = t_SkeletonHandoff.GetCounters();
+	const FrameHandoffCounters t_StartTrackers = t_TrackerHandoff.GetCounters();
+	const uint64_t t_StartSkipped = t_Workers.GetSkippedCount();
+	t_Measuring = true;
+
+	std::this_thread::sleep_for(std::chrono::duration<double>(t_Seconds - t_WarmupSeconds));
+	t_Measuring = false;
+	const double t_EndCpuMs = GetProcessCpuMs();
+	const uint64_t t_EndAllocations = s_Allocations.load();
+	const FrameHandoffCounters t_EndSkeletons = t_SkeletonHandoff.GetCounters();
+	const FrameHandoffCounters t_EndTrackers = t_TrackerHandoff.GetCounters();
+	const uint64_t t_EndSkipped = t_Workers.GetSkippedCount();
+
+	t_Stop = true;
+	t_SkeletonHandoff.Close();
+	t_TrackerHandoff.Close();
+	t_SkeletonProducer.join();
+	t_TrackerProducer.join();
+	t_SkeletonLoop.join();
+	t_TrackerLoop.join();
+	t_Workers.Stop();
+
+	const uint64_t t_Frames = (std::max)(t_EndSkeletons.produced - t_StartSkeletons.produced, static_cast<uint64_t>(1));
+	const uint64_t t_TrackerFrames = (std::max)(t_EndTrackers.produced - t_StartTrackers.produced, static_cast<uint64_t>(1));
+	const uint64_t t_Dropped = (t_EndSkeletons.overwritten - t_StartSkeletons.overwritten) + (t_EndSkipped - t_StartSkipped)
+		+ (t_EndTrackers.overwritten - t_StartTrackers.overwritten);
+	const LatencyStatistics t_SkeletonLatency = t_Workers.GetLatency();
+
+	ScaleMetrics t_Metrics;
+	t_Metrics.cpuMsPerFrame = (t_EndCpuMs - t_StartCpuMs) / t_Frames;
+	t_Metrics.allocationsPerFrame = static_cast<double>(t_EndAllocations - t_StartAllocations) / t_Frames;
+	t_Metrics.skeletonP50Ms = t_SkeletonLatency.GetPercentile(0.5);
+	t_Metrics.skeletonP99Ms = t_SkeletonLatency.GetPercentile(0.99);
+	t_Metrics.trackerP50Ms = t_TrackerLatency.GetPercentile(0.5);
+	t_Metrics.trackerP99Ms = t_TrackerLatency.GetPercentile(0.99);
+	t_Metrics.droppedPercent = 100.0 * t_Dropped / (t_Frames + t_TrackerFrames);
+
+	std::cout << "Over " << t_Frames << " frames:\n";
+	bool t_Passed = true;
+	std::vector<MetricEntry> t_Baselines = GetMetricEntries(t_Baseline);
+	std::vector<MetricEntry> t_Maxima = GetMetricEntries(t_Limits);
+	std::vector<MetricEntry> t_Entries = GetMetricEntries(t_Metrics);
+	for (size_t i = 0; i < t_Entries.size(); i++)
+	{
+		const double t_Value = *t_Entries[i].value;
+		std::cout << "  " << t_Entries[i].name << " " << t_Value;
+		if (*t_Maxima[i].value >= 0.0 && t_Value > *t_Maxima[i].value)
+		{
+			std::cout << "  FAILED, the limit is " << *t_Maxima[i].value;
+			t_Passed = false;
+		}
+		const double t_Allowed = *t_Baselines[i].value * (1.0 + t_Tolerance) + t_Entries[i].slack;
+		if (!t_BaselinePath.empty() && t_Value > t_Allowed)
+		{
+			std::cout << "  FAILED, the baseline is " << *t_Baselines[i].value << " (at most " << t_Allowed << ")";
+			t_Passed = false;
+		}
+		std::cout << "\n";
+	}
+	std::cout << "  (skeleton latency max " << t_SkeletonLatency.GetMax() << " ms, tracker latency max " << t_TrackerLatency.GetMax() << " ms)\n";
+
+	if (!t_WriteBaselinePath.empty() && t_Passed && WriteMetrics(t_WriteBaselinePath, t_Metrics))
+	{
+		std::cout << "Wrote the baseline " << t_WriteBaselinePath << ".\n";
+	}
+	std::cout << (t_Passed ? "PASSED" : "FAILED") << "\n";
+	rclcpp::shutdown();
+	return t_Passed ? 0 : 1;
+}
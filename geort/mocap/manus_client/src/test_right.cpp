@@ -261,7 +261,7 @@ void SDKMinimalClient::LoadTestSkeleton()
 
 	// setup nodes and chains for the skeleton hand
 	if (!SetupHandNodes(t_SklIndex)) return;
-	if (!SetupHandChains(t_SklIndex)) return;
+	if (!SetupHandChains(t_SklIndex, Side::Side_Right)) return;
 
 	// load skeleton 
 	uint32_t t_ID = 0;
@@ -392,8 +392,9 @@ bool SDKMinimalClient::SetupHandNodes(uint32_t p_SklIndex)
 /// Chains are required for a Skeleton to be able to be animated, it basically tells Manus Core
 /// which nodes belong to which body part and what data needs to be applied to which node.
 /// @param p_SklIndex The index of the temporary skeleton on which the chains will be added.
+/// @param p_Side The hand the chains are for.
 /// @return Returns true if everything went fine, otherwise returns false.
-bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
+bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex, Side p_Side)
 {
 	// Add the Hand chain, this identifies the wrist of the hand
 	{
@@ -413,7 +414,7 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 		t_Chain.id = 0; //Every ID needs to be unique per chain in a skeleton.
 		t_Chain.type = ChainType::ChainType_Hand;
 		t_Chain.dataType = ChainType::ChainType_Hand;
-		t_Chain.side = Side::Side_Right;
+		t_Chain.side = p_Side;
 		t_Chain.dataIndex = 0;
 		t_Chain.nodeIdCount = 1;
 		t_Chain.nodeIds[0] = 0; //this links to the hand node created in the SetupHandNodes
@@ -447,7 +448,7 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 		t_Chain.id = i + 1; //Every ID needs to be unique per chain in a skeleton.
 		t_Chain.type = t_FingerTypes[i];
 		t_Chain.dataType = t_FingerTypes[i];
-		t_Chain.side = Side::Side_Right;
+		t_Chain.side = p_Side;
 		t_Chain.dataIndex = 0;
 		if (i == 0) // Thumb
 		{
@@ -6,6 +6,14 @@
 
 #include "SDKMinimalClient.hpp"
 #include "ManusSDKTypes.h"
+#include "ClockMapping.hpp"
+#include "ManusTimestamp.hpp"
+#include "StreamDiagnostics.hpp"
+#include "TrackerFilter.hpp"
+#include "TrackerPrediction.hpp"
+#include "TrackerRegistry.hpp"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <thread>
@@ -132,6 +140,23 @@ ClientReturnCode SDKMinimalClient::RegisterAllCallbacks()
 	{
 		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
 	}
+
+	// Register the callbacks for when the connection to manus core is made or lost, so Run can reconnect
+	// and reload the skeleton as soon as Core goes away, e.g. when it is restarted.
+	if (CoreSdk_RegisterCallbackForOnConnect(*OnConnectedCallback) != SDKReturnCode::SDKReturnCode_Success
+		|| CoreSdk_RegisterCallbackForOnDisconnect(*OnDisconnectedCallback) != SDKReturnCode::SDKReturnCode_Success)
+	{
+		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
+	}
+
+	// the other streams are only for the stream recording, their callbacks do nothing while it is closed.
+	if (CoreSdk_RegisterCallbackForRawSkeletonStream(*OnRawSkeletonStreamCallback) != SDKReturnCode::SDKReturnCode_Success
+		|| CoreSdk_RegisterCallbackForErgonomicsStream(*OnErgonomicsCallback) != SDKReturnCode::SDKReturnCode_Success
+		|| CoreSdk_RegisterCallbackForGestureStream(*OnGestureStreamCallback) != SDKReturnCode::SDKReturnCode_Success
+		|| CoreSdk_RegisterCallbackForLandscapeStream(*OnLandscapeCallback) != SDKReturnCode::SDKReturnCode_Success)
+	{
+		return ClientReturnCode::ClientReturnCode_FailedToInitialize;
+	}
 	
 	return ClientReturnCode::ClientReturnCode_Success;
 }
@@ -143,9 +168,89 @@ void SDKMinimalClient::Run()
     auto node = std::make_shared<rclcpp::Node>("manus_tracker");
 	tf2_ros::TransformBroadcaster broadcaster(node);
 
-    auto headset_publisher = node->create_publisher<geometry_msgs::msg::PoseStamped>("headset_tracker_data", 10);
-    auto tracker1_publisher = node->create_publisher<geometry_msgs::msg::PoseStamped>("tracker1_tracker_data", 10);
-    auto tracker2_publisher = node->create_publisher<geometry_msgs::msg::PoseStamped>("tracker2_tracker_data", 10);
+	// which tracker goes to which topic and TF frame, see TrackerRegistry.hpp and config/trackers.cfg.
+	// without a config the trackers of the original lab setup are routed.
+	const std::string t_TrackerConfig = node->declare_parameter<std::string>("tracker_config", "");
+	TrackerRegistry t_TrackerRegistry;
+	if (t_TrackerConfig.empty() || !t_TrackerRegistry.Load(t_TrackerConfig))
+	{
+		const char* const t_DefaultRoutes[][2] = {
+			{ "headset serial", "headset_tracker_data" },
+			{ "LHR-DAE7C1A7", "tracker1_tracker_data" },
+			{ "LHR-3C6C2141", "tracker2_tracker_data" },
+		};
+		std::vector<TrackerRoute> t_Routes;
+		for (const auto& t_Default : t_DefaultRoutes)
+		{
+			TrackerRoute t_Route;
+			TrackerRegistry::MakeTrackerId(t_Default[0], t_Route.trackerId);
+			t_Route.topic = t_Default[1];
+			t_Route.frame = t_Default[0];
+			t_Routes.push_back(t_Route);
+		}
+		t_TrackerRegistry.SetRoutes(t_Routes);
+	}
+
+	// one publisher per route, created up front so routing a tracker is a table lookup.
+	std::vector<rclcpp::Publisher<geometry_msgs::msg::PoseStamped>::SharedPtr> t_TrackerPublishers;
+	for (const TrackerRoute& t_Route : t_TrackerRegistry.GetRoutes())
+	{
+		t_TrackerPublishers.push_back(t_Route.topic.empty() ? nullptr : node->create_publisher<geometry_msgs::msg::PoseStamped>(t_Route.topic, 10));
+	}
+
+	// optionally extrapolate the trackers to hide the latency between the lighthouse sample and its
+	// use, see TrackerPrediction.hpp. The residual error is printed on exit.
+	const bool t_Predict = node->declare_parameter<bool>("tracker_predict", false);
+	const double t_PredictLeadMs = node->declare_parameter<double>("tracker_predict_lead_ms", 0.0);
+	const double t_PredictMaxMs = node->declare_parameter<double>("tracker_predict_max_ms", 100.0);
+	TrackerPredictor t_Predictor;
+
+	// samples below the minimum quality are replaced by the last good pose (extrapolated when predicting)
+	// for a while and then dropped, reacquired trackers are blended back in, see TrackerFilter.hpp.
+	const bool t_Filter = node->declare_parameter<bool>("tracker_filter", true);
+	const std::string t_MinQuality = node->declare_parameter<std::string>("tracker_min_quality", "bad_tracking");
+	TrackerFilter t_TrackerFilter;
+	t_TrackerFilter.Configure(t_MinQuality == "trackable" ? TrackingQuality::TrackingQuality_Trackable : TrackingQuality::TrackingQuality_BadTracking,
+		node->declare_parameter<double>("tracker_hold_ms", 250.0), node->declare_parameter<double>("tracker_blend_ms", 150.0));
+	if (t_MinQuality != "trackable" && t_MinQuality != "bad_tracking")
+	{
+		std::cerr << "tracker_min_quality must be trackable or bad_tracking, using bad_tracking." << std::endl;
+	}
+
+	// message buffers reused by every frame.
+	std::vector<geometry_msgs::msg::TransformStamped> t_Transforms;
+	geometry_msgs::msg::PoseStamped t_PoseMessage;
+	t_PoseMessage.header.frame_id = "lighthouse_frame";
+
+	// optionally log the skeleton and tracker streams together with their timing, e.g.
+	// ros2 run manus_client manus_tracker --ros-args -p stream_record_path:=session.msr
+	const std::string t_StreamRecordPath = node->declare_parameter<std::string>("stream_record_path", "");
+	RecordingWriterSettings t_StreamRecordSettings;
+	t_StreamRecordSettings.chunkBytes = static_cast<uint64_t>(node->declare_parameter<int64_t>("stream_record_chunk_mb", 0)) << 20;
+	t_StreamRecordSettings.chunkSeconds = node->declare_parameter<double>("stream_record_chunk_seconds", 0.0);
+	t_StreamRecordSettings.diskBudgetBytes = static_cast<uint64_t>(node->declare_parameter<int64_t>("stream_record_budget_mb", 0)) << 20;
+	t_StreamRecordSettings.directIo = node->declare_parameter<bool>("stream_record_direct_io", true);
+	if (!t_StreamRecordPath.empty())
+	{
+		m_StreamRecorder.Open(t_StreamRecordPath, t_StreamRecordSettings);
+	}
+
+	// what happens to tracker frames when the loop falls behind the SDK, see FrameHandoff.hpp.
+	FrameHandoffPolicy t_HandoffPolicy = FrameHandoffPolicy::FrameHandoffPolicy_Latest;
+	const std::string t_HandoffPolicyName = node->declare_parameter<std::string>("tracker_handoff", "latest");
+	if (!ParseFrameHandoffPolicy(t_HandoffPolicyName, t_HandoffPolicy))
+	{
+		std::cerr << "tracker_handoff must be latest, fifo or block, using latest." << std::endl;
+	}
+	m_TrackerHandoff.Configure(t_HandoffPolicy, static_cast<size_t>(node->declare_parameter<int64_t>("tracker_handoff_slots", 8)));
+	StreamDiagnostics t_Diagnostics(node, "manus_tracker");
+
+	// the trackers are stamped with their publishTime mapped onto this host's clock, see ClockMapping.hpp.
+	// clock_latency_ms moves the stamps back by the part of the transport delay that is always there.
+	const double t_ClockWindowSeconds = node->declare_parameter<double>("clock_window_s", 30.0);
+	ClockMapping t_ClockMapping;
+	t_ClockMapping.Configure(100.0, static_cast<size_t>((std::max)(t_ClockWindowSeconds, 1.0) * 10.0), 10000.0, 1000.0, node->declare_parameter<double>("clock_latency_ms", 0.0));
+	const std::shared_ptr<rclcpp::Clock> t_Clock = node->get_clock();
 
 	// Create a static transform broadcaster
     tf2_ros::StaticTransformBroadcaster static_broadcaster(node);
@@ -168,132 +273,195 @@ void SDKMinimalClient::Run()
     // Publish the static transform
     static_broadcaster.sendTransform(static_transform);
 
+    // the host of the last good connection is tried first and kept in host_cache across restarts, see
+    // HostConnection.hpp. an empty host_cache keeps it for this run only.
+    const std::string t_DocumentsPath = GetDocumentsDirectoryPath_UTF8();
+    const std::string t_HostCache = node->declare_parameter<std::string>("host_cache",
+        t_DocumentsPath.empty() ? std::string() : t_DocumentsPath + s_SlashForFilesystemPath + "GeoRT" + s_SlashForFilesystemPath + "manus_host.txt");
+    m_HostConnector.Configure(t_HostCache, static_cast<uint32_t>((std::max)(node->declare_parameter<int64_t>("discovery_wait_s", 1), static_cast<int64_t>(1))));
+
     // first loop until we get a connection
     std::cout << "minimal client is connecting to host. (make sure it is running)\n";
     while (Connect() != ClientReturnCode::ClientReturnCode_Success)
     {
-        // not yet connected. wait
-        std::cout << "minimal client could not connect. Trying again in a second.\n";
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        // not yet connected. a failed attempt already waited for discovery, so try again soon.
+        std::cout << "minimal client could not connect. trying again.\n";
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
-    std::cout << "minimal client is connected, setting up skeletons.\n";
+    std::cout << "minimal client is connected to " << m_HostConnector.GetLastHost().hostName << " by " << GetHostConnectStepName(m_HostConnector.GetLastStep())
+        << ", setting up skeletons.\n";
     // then upload a simple skeleton with a chain. this will just be a left hand for the first userindex.
     LoadTestSkeleton();
 
     // then loop and get its data while waiting for escape key to end it
     while (m_Running)
     {
+        // Core went away, e.g. it was restarted. reconnect right away and load the skeleton again.
+        m_ConnectionMutex.lock();
+        const bool t_Disconnected = m_Disconnected;
+        const std::chrono::steady_clock::time_point t_DisconnectTime = m_DisconnectTime;
+        m_Disconnected = false;
+        m_ConnectionMutex.unlock();
+        if (t_Disconnected)
+        {
+            std::cout << "minimal client lost the connection to " << m_HostConnector.GetLastHost().hostName << ", reconnecting.\n";
+            // the poses from before the disconnect are stale.
+            while (TrackerDataCollection* const t_Frame = m_TrackerHandoff.Pop()) delete t_Frame;
+
+            // the SDK may have found its way back already, only connect if it has not.
+            bool t_Connected = false;
+            while (m_Running && (CoreSdk_GetIsConnectedToCore(&t_Connected) != SDKReturnCode::SDKReturnCode_Success || !t_Connected)
+                && Connect() != ClientReturnCode::ClientReturnCode_Success)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            std::cout << "minimal client reconnected to " << m_HostConnector.GetLastHost().hostName << " in "
+                << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_DisconnectTime).count() << " ms.\n";
+            LoadTestSkeleton();
+        }
+
         // Check if there is new tracker data
-        m_TrackerMutex.lock();
-        if (m_NextTrackerData != nullptr)
+        while (TrackerDataCollection* const t_TrackerFrame = m_TrackerHandoff.Pop())
         {
-            // Iterate through each tracker data and publish on corresponding topic
-            for (const auto& trackerData : m_NextTrackerData->trackerData)
+            // one stamp for the whole SDK frame, the time Core published the trackers mapped onto this host's clock rather than when they were picked up.
+            // when predicting, the poses are moved on to the Core time of now plus the lead, and stamped with that.
+            builtin_interfaces::msg::Time t_Stamp;
+            int64_t t_PublishMs = 0;
+            const bool t_HasPublishTime = ManusTimestampToUnixMilliseconds(t_TrackerFrame->publishTime, t_PublishMs) && t_PublishMs > 0;
+            const double t_ReceiveMs = ClockMapping::ToMilliseconds(t_TrackerFrame->receiveTime);
+            double t_TargetMs = static_cast<double>(t_PublishMs);
+            if (t_HasPublishTime)
+            {
+                t_ClockMapping.AddSample(t_TargetMs, t_ReceiveMs);
+            }
+            if (t_HasPublishTime && t_ClockMapping.IsValid())
+            {
+                if (t_Predict)
+                {
+                    t_TargetMs = t_ClockMapping.ToDevice(ClockMapping::ToMilliseconds(std::chrono::steady_clock::now())) + t_PredictLeadMs;
+                }
+                t_Stamp = HostToRosTime(t_ClockMapping.ToHost(t_TargetMs), *t_Clock);
+            }
+            else if (t_HasPublishTime)
+            {
+                // until the mapping has settled the frame is taken as captured when it arrived.
+                if (t_Predict)
+                {
+                    t_TargetMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_TrackerFrame->receiveTime).count() + t_PredictLeadMs;
+                }
+                t_Stamp = HostToRosTime(t_ReceiveMs + t_TargetMs - static_cast<double>(t_PublishMs), *t_Clock);
+            }
+            else
             {
-                auto message = geometry_msgs::msg::PoseStamped();
-                message.header.stamp = node->get_clock()->now();
-                message.header.frame_id = "lighthouse_frame";
-
-                // Set tracker position and orientation
-                message.pose.position.x = trackerData.position.x;
-                message.pose.position.y = trackerData.position.y;
-                message.pose.position.z = trackerData.position.z;
-
-                message.pose.orientation.x = trackerData.rotation.x;
-                message.pose.orientation.y = trackerData.rotation.y;
-                message.pose.orientation.z = trackerData.rotation.z;
-                message.pose.orientation.w = trackerData.rotation.w;
-
-                // Publish on individual topics based on tracker ID
-                if (strcmp(trackerData.trackerId.id, "headset serial") == 0)
+                t_Stamp = t_Clock->now();
+            }
+
+            // the transforms of all trackers go out as one /tf message, the vector and its strings are kept across frames.
+            t_Transforms.resize(t_TrackerFrame->trackerData.size());
+            size_t t_TransformCount = 0;
+            for (size_t i = 0; i < t_TrackerFrame->trackerData.size(); i++)
+            {
+                const TrackerData& trackerData = t_TrackerFrame->trackerData[i];
+                uint32_t t_Route = t_TrackerRegistry.Find(trackerData.trackerId);
+                if (t_Route == TRACKER_ROUTE_NONE)
                 {
-                    headset_publisher->publish(message);
+                    // unknown trackers get a TF only route named after them, and are reported once so they can be added to the config.
+                    std::vector<TrackerRoute> t_Routes = t_TrackerRegistry.GetRoutes();
+                    TrackerRoute t_Unknown;
+                    t_Unknown.trackerId = trackerData.trackerId;
+                    t_Unknown.frame.assign(trackerData.trackerId.id, strnlen(trackerData.trackerId.id, sizeof(trackerData.trackerId.id)));
+                    t_Routes.push_back(t_Unknown);
+                    if (t_Unknown.frame.empty() || t_Unknown.frame.size() == sizeof(t_Unknown.trackerId.id) || !t_TrackerRegistry.SetRoutes(t_Routes)) continue;
+                    t_TrackerPublishers.push_back(nullptr);
+                    t_Route = t_TrackerRegistry.Find(trackerData.trackerId);
+                    std::cout << "Tracker " << t_Unknown.frame << " has no route in the tracker config, it is only sent as TF.\n";
                 }
-                else if (strcmp(trackerData.trackerId.id, "LHR-DAE7C1A7") == 0)
+
+                // only good samples feed the velocity estimate, while a tracker is bad the prediction extrapolates its last good one.
+                TrackerPose t_Sample = TrackerPose::FromTrackerData(trackerData);
+                const bool t_Good = !t_Filter || t_TrackerFilter.IsGood(trackerData.quality);
+                TrackerPose t_Extrapolated;
+                bool t_HasExtrapolation = false;
+                if (t_Predict && t_HasPublishTime)
                 {
-                    tracker1_publisher->publish(message);
+                    t_Predictor.Resize(t_TrackerRegistry.GetRoutes().size());
+                    int64_t t_SampleMs = 0;
+                    if (t_Good && ManusTimestampToUnixMilliseconds(trackerData.lastUpdateTime, t_SampleMs))
+                    {
+                        t_Predictor.AddSample(t_Route, t_SampleMs, t_Sample);
+                    }
+                    t_HasExtrapolation = t_Predictor.Predict(t_Route, t_TargetMs, t_PredictMaxMs, t_Extrapolated);
+                    if (t_Good && t_HasExtrapolation) t_Sample = t_Extrapolated;
                 }
-                else if (strcmp(trackerData.trackerId.id, "LHR-3C6C2141") == 0)
+
+                TrackerPose t_Pose = t_Sample;
+                if (t_Filter)
                 {
-                    tracker2_publisher->publish(message);
+                    t_TrackerFilter.Resize(t_TrackerRegistry.GetRoutes().size());
+                    if (!t_TrackerFilter.Update(t_Route, t_ReceiveMs, trackerData.quality, t_Sample, t_HasExtrapolation ? &t_Extrapolated : nullptr, t_Pose)) continue;
                 }
 
-				// Broadcast transforms
-				geometry_msgs::msg::TransformStamped transformStamped;
-				transformStamped.header.stamp = node->get_clock()->now();
+                // Publish on the topic of the tracker's route, if it has one
+                if (t_TrackerPublishers[t_Route] != nullptr)
+                {
+                    t_PoseMessage.header.stamp = t_Stamp;
+                    t_PoseMessage.pose.position.x = t_Pose.position[0];
+                    t_PoseMessage.pose.position.y = t_Pose.position[1];
+                    t_PoseMessage.pose.position.z = t_Pose.position[2];
+
+                    t_PoseMessage.pose.orientation.x = t_Pose.rotation[1];
+                    t_PoseMessage.pose.orientation.y = t_Pose.rotation[2];
+                    t_PoseMessage.pose.orientation.z = t_Pose.rotation[3];
+                    t_PoseMessage.pose.orientation.w = t_Pose.rotation[0];
+
+                    t_TrackerPublishers[t_Route]->publish(t_PoseMessage);
+                }
+
+				geometry_msgs::msg::TransformStamped& transformStamped = t_Transforms[t_TransformCount++];
+				transformStamped.header.stamp = t_Stamp;
 				transformStamped.header.frame_id = "lighthouse_frame";
-				
-				// if (trackerData.trackerId.id == "LHR-DAE7C1A7"){
-					
-				// 	transformStamped.child_frame_id = "Right_tracker";
-				// }
-				// else if(trackerData.trackerId.id == "LHR-3C6C2141")
-				// {
-				// 	transformStamped.child_frame_id = "Left_tracker";
-				// }
-				// else if (trackerData.trackerId.id == "headset serial")
-				// {
-				// 	transformStamped.child_frame_id = "headset_tracker";
-				// }
-
-				transformStamped.child_frame_id = trackerData.trackerId.id;
-
-				transformStamped.transform.translation.x = trackerData.position.x;
-				transformStamped.transform.translation.y = trackerData.position.y;
-				transformStamped.transform.translation.z = trackerData.position.z;
-
-				transformStamped.transform.rotation.x = trackerData.rotation.x;
-				transformStamped.transform.rotation.y = trackerData.rotation.y;
-				transformStamped.transform.rotation.z = trackerData.rotation.z;
-				transformStamped.transform.rotation.w = trackerData.rotation.w;
-
-				broadcaster.sendTransform(transformStamped);
+				transformStamped.child_frame_id = t_TrackerRegistry.GetRoutes()[t_Route].frame;
+
+				transformStamped.transform.translation.x = t_Pose.position[0];
+				transformStamped.transform.translation.y = t_Pose.position[1];
+				transformStamped.transform.translation.z = t_Pose.position[2];
+
+				transformStamped.transform.rotation.x = t_Pose.rotation[1];
+				transformStamped.transform.rotation.y = t_Pose.rotation[2];
+				transformStamped.transform.rotation.z = t_Pose.rotation[3];
+				transformStamped.transform.rotation.w = t_Pose.rotation[0];
+            }
+            // trackers without a usable ID and lost trackers are left out.
+            t_Transforms.resize(t_TransformCount);
+            if (!t_Transforms.empty())
+            {
+                broadcaster.sendTransform(t_Transforms);
             }
 
             // Clean up memory
-            delete m_NextTrackerData;
-            m_NextTrackerData = nullptr;
+            delete t_TrackerFrame;
         }
-        m_TrackerMutex.unlock();
+        t_Diagnostics.Update("tracker", m_TrackerHandoff.GetCounters());
+        t_Diagnostics.PublishIfDue();
 
         std::this_thread::sleep_for(std::chrono::milliseconds(33)); // or roughly 30fps, but good enough to show the results.
     }
+    // a producer blocked on a full handoff has to be released before the SDK shuts down.
+    m_TrackerHandoff.Close();
+    t_Diagnostics.Update("tracker", m_TrackerHandoff.GetCounters());
+    t_Diagnostics.Print();
+    t_ClockMapping.Print();
+    m_StreamRecorder.Close();
+    if (t_Predict) t_Predictor.PrintErrors();
+    if (t_Filter) t_TrackerFilter.PrintCounts();
     // then exit.
 }
 
 /// @brief the client will now try to connect to manus core via the SDK.
+/// The last good host is tried first and discovery only if that fails, see HostConnector.
 ClientReturnCode SDKMinimalClient::Connect()
 {
-	SDKReturnCode t_StartResult = CoreSdk_LookForHosts(1, false);
-	if (t_StartResult != SDKReturnCode::SDKReturnCode_Success)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	uint32_t t_NumberOfHostsFound = 0;
-	SDKReturnCode t_NumberResult = CoreSdk_GetNumberOfAvailableHostsFound(&t_NumberOfHostsFound);
-	if (t_NumberResult != SDKReturnCode::SDKReturnCode_Success)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	if (t_NumberOfHostsFound == 0)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	std::unique_ptr<ManusHost[]> t_AvailableHosts; 
-	t_AvailableHosts.reset(new ManusHost[t_NumberOfHostsFound]);
-
-	SDKReturnCode t_HostsResult = CoreSdk_GetAvailableHostsFound(t_AvailableHosts.get(), t_NumberOfHostsFound);
-	if (t_HostsResult != SDKReturnCode::SDKReturnCode_Success)
-	{
-		return ClientReturnCode::ClientReturnCode_FailedToFindHosts;
-	}
-
-	SDKReturnCode t_ConnectResult = CoreSdk_ConnectToHost(t_AvailableHosts[0]);
-
-	if (t_ConnectResult == SDKReturnCode::SDKReturnCode_NotConnected)
+	if (!m_HostConnector.Connect())
 	{
 		return ClientReturnCode::ClientReturnCode_FailedToConnect;
 	}
@@ -331,7 +499,7 @@ void SDKMinimalClient::LoadTestSkeleton()
 
 	// setup nodes and chains for the skeleton hand
 	if (!SetupHandNodes(t_SklIndex)) return;
-	if (!SetupHandChains(t_SklIndex)) return;
+	if (!SetupHandChains(t_SklIndex, Side::Side_Left)) return;
 
 	// load skeleton 
 	uint32_t t_ID = 0;
@@ -462,8 +630,9 @@ bool SDKMinimalClient::SetupHandNodes(uint32_t p_SklIndex)
 /// Chains are required for a Skeleton to be able to be animated, it basically tells Manus Core
 /// which nodes belong to which body part and what data needs to be applied to which node.
 /// @param p_SklIndex The index of the temporary skeleton on which the chains will be added.
+/// @param p_Side The hand the chains are for.
 /// @return Returns true if everything went fine, otherwise returns false.
-bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
+bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex, Side p_Side)
 {
 	// Add the Hand chain, this identifies the wrist of the hand
 	{
@@ -483,7 +652,7 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 		t_Chain.id = 0; //Every ID needs to be unique per chain in a skeleton.
 		t_Chain.type = ChainType::ChainType_Hand;
 		t_Chain.dataType = ChainType::ChainType_Hand;
-		t_Chain.side = Side::Side_Left;
+		t_Chain.side = p_Side;
 		t_Chain.dataIndex = 0;
 		t_Chain.nodeIdCount = 1;
 		t_Chain.nodeIds[0] = 0; //this links to the hand node created in the SetupHandNodes
@@ -517,7 +686,7 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 		t_Chain.id = i + 1; //Every ID needs to be unique per chain in a skeleton.
 		t_Chain.type = t_FingerTypes[i];
 		t_Chain.dataType = t_FingerTypes[i];
-		t_Chain.side = Side::Side_Left;
+		t_Chain.side = p_Side;
 		t_Chain.dataIndex = 0;
 		if (i == 0) // Thumb
 		{
@@ -546,6 +715,31 @@ bool SDKMinimalClient::SetupHandChains(uint32_t p_SklIndex)
 	return true;
 }
 
+/// @brief This gets called when the client is connected to manus core.
+/// @param p_Host the host it connected to.
+void SDKMinimalClient::OnConnectedCallback(const ManusHost* const p_Host)
+{
+	if (s_Instance && p_Host != nullptr)
+	{
+		std::cout << "Connected to Manus Core " << p_Host->hostName << " (" << p_Host->ipAddress << ").\n";
+	}
+}
+
+/// @brief This gets called when the connection to manus core is lost. The SDK must not be called
+/// from its callbacks, so this only notes it and Run reconnects.
+/// @param p_Host the host it was connected to.
+void SDKMinimalClient::OnDisconnectedCallback(const ManusHost* const p_Host)
+{
+	(void)p_Host;
+	if (s_Instance)
+	{
+		s_Instance->m_ConnectionMutex.lock();
+		s_Instance->m_Disconnected = true;
+		s_Instance->m_DisconnectTime = std::chrono::steady_clock::now();
+		s_Instance->m_ConnectionMutex.unlock();
+	}
+}
+
 /// @brief This gets called when the client is connected to manus core
 /// @param p_SkeletonStreamInfo contains the meta data on how much data regarding the skeleton we need to get from the SDK.
 void SDKMinimalClient::OnSkeletonStreamCallback(const SkeletonStreamInfo* const p_SkeletonStreamInfo)
@@ -561,6 +755,8 @@ void SDKMinimalClient::OnSkeletonStreamCallback(const SkeletonStreamInfo* const
 			t_NxtClientSkeleton->skeletons[i].nodes = new SkeletonNode[t_NxtClientSkeleton->skeletons[i].info.nodesCount];
 			CoreSdk_GetSkeletonData(i, t_NxtClientSkeleton->skeletons[i].nodes, t_NxtClientSkeleton->skeletons[i].info.nodesCount);
 		}
+		// straight from the callback, so the log keeps the order in which the streams arrived.
+		s_Instance->m_StreamRecorder.RecordSkeletons(p_SkeletonStreamInfo->publishTime, t_NxtClientSkeleton->skeletons.data(), t_NxtClientSkeleton->skeletons.size());
 		s_Instance->m_SkeletonMutex.lock();
 		if (s_Instance->m_NextSkeleton != nullptr) delete s_Instance->m_NextSkeleton;
 		s_Instance->m_NextSkeleton = t_NxtClientSkeleton;
@@ -584,6 +780,8 @@ void SDKMinimalClient::OnTrackerStreamCallback(const TrackerStreamInfo* const p_
     if (s_Instance)
     {
         TrackerDataCollection* t_TrackerData = new TrackerDataCollection();
+        t_TrackerData->publishTime = p_TrackerStreamInfo->publishTime;
+        t_TrackerData->receiveTime = std::chrono::steady_clock::now();
         t_TrackerData->trackerData.resize(p_TrackerStreamInfo->trackerCount);
 
         for (uint32_t i = 0; i < p_TrackerStreamInfo->trackerCount; i++)
@@ -592,10 +790,63 @@ void SDKMinimalClient::OnTrackerStreamCallback(const TrackerStreamInfo* const p_
             // Print each tracker data
             PrintTrackerData(t_TrackerData->trackerData[i]);
         }
+        s_Instance->m_StreamRecorder.RecordTrackers(p_TrackerStreamInfo->publishTime, t_TrackerData->trackerData.data(), t_TrackerData->trackerData.size());
 
-        s_Instance->m_TrackerMutex.lock();
-        if (s_Instance->m_NextTrackerData != nullptr) delete s_Instance->m_NextTrackerData;
-        s_Instance->m_NextTrackerData = t_TrackerData;
-        s_Instance->m_TrackerMutex.unlock();
+        s_Instance->m_TrackerHandoff.Push(t_TrackerData);
     }
-}
\ No newline at end of file
+}
+
+/// @brief Records the raw skeletons, the glove data before it is retargeted, while the stream recording is open.
+void SDKMinimalClient::OnRawSkeletonStreamCallback(const SkeletonStreamInfo* const p_RawSkeletonStreamInfo)
+{
+	if (s_Instance == nullptr || !s_Instance->m_StreamRecorder.IsOpen()) return;
+
+	ClientRawSkeletonCollection t_RawSkeletons;
+	t_RawSkeletons.skeletons.resize(p_RawSkeletonStreamInfo->skeletonsCount);
+	for (uint32_t i = 0; i < p_RawSkeletonStreamInfo->skeletonsCount; i++)
+	{
+		ClientRawSkeleton& t_Skeleton = t_RawSkeletons.skeletons[i];
+		if (CoreSdk_GetRawSkeletonInfo(i, &t_Skeleton.info) != SDKReturnCode::SDKReturnCode_Success) continue;
+		t_Skeleton.nodes.resize(t_Skeleton.info.nodesCount);
+		if (CoreSdk_GetRawSkeletonData(i, t_Skeleton.nodes.data(), t_Skeleton.info.nodesCount) != SDKReturnCode::SDKReturnCode_Success) t_Skeleton.nodes.clear();
+	}
+	s_Instance->m_StreamRecorder.RecordRawSkeletons(p_RawSkeletonStreamInfo->publishTime, t_RawSkeletons.skeletons.data(), t_RawSkeletons.skeletons.size());
+}
+
+/// @brief Records the ergonomics (finger and wrist angles) while the stream recording is open.
+void SDKMinimalClient::OnErgonomicsCallback(const ErgonomicsStream* const p_Ergonomics)
+{
+	if (s_Instance == nullptr || !s_Instance->m_StreamRecorder.IsOpen()) return;
+
+	s_Instance->m_StreamRecorder.RecordErgonomics(*p_Ergonomics);
+}
+
+/// @brief Records the gesture probabilities while the stream recording is open.
+void SDKMinimalClient::OnGestureStreamCallback(const GestureStreamInfo* const p_GestureStreamInfo)
+{
+	if (s_Instance == nullptr || !s_Instance->m_StreamRecorder.IsOpen()) return;
+
+	// a hand with more than MAX_GESTURE_DATA_CHUNK_SIZE gestures comes in several chunks, each is recorded as it is.
+	std::vector<GestureProbabilities> t_Gestures;
+	for (uint32_t i = 0; i < p_GestureStreamInfo->gestureProbabilitiesCount; i++)
+	{
+		uint32_t t_Start = 0;
+		while (true)
+		{
+			GestureProbabilities t_Chunk = {};
+			if (CoreSdk_GetGestureStreamData(i, t_Start, &t_Chunk) != SDKReturnCode::SDKReturnCode_Success || t_Chunk.gestureCount == 0) break;
+			t_Gestures.push_back(t_Chunk);
+			t_Start += t_Chunk.gestureCount;
+			if (t_Start >= t_Chunk.totalGestureCount) break;
+		}
+	}
+	s_Instance->m_StreamRecorder.RecordGestures(p_GestureStreamInfo->publishTime, t_Gestures.data(), t_Gestures.size());
+}
+
+/// @brief Records every landscape Core sends while the stream recording is open.
+void SDKMinimalClient::OnLandscapeCallback(const Landscape* const p_Landscape)
+{
+	if (s_Instance == nullptr || !s_Instance->m_StreamRecorder.IsOpen()) return;
+
+	s_Instance->m_StreamRecorder.RecordLandscape(*p_Landscape);
+}
@@ -15,8 +15,8 @@ from geort.utils.hand_utils import get_entity_by_name, get_active_joints, get_ac
 from geort.utils.path import get_human_data 
 from geort.utils.config_utils import get_config, save_json
 from geort.model import FKModel, IKModel 
-from geort.env.hand import HandKinematicModel
-from geort.loss import chamfer_distance
+from geort.env.compiled_hand import CompiledHandModel
+from geort.loss import chamfer_distance, pinch_loss as compute_pinch_loss
 from geort.formatter import HandFormatter
 from geort.dataset import RobotKinematicsDataset, MultiPointDataset
 from datetime import datetime
@@ -53,7 +53,7 @@ def generate_current_timestring():
 class GeoRTTrainer:
     def __init__(self, config):
         self.config = config
-        self.hand = HandKinematicModel.build_from_config(self.config)
+        self.hand = CompiledHandModel.build_from_config(self.config)
         self.device = torch.device("cuda" if torch.cuda.is_available() else "cpu")
 
 
@@ -63,6 +63,21 @@ class GeoRTTrainer:
         '''
         kinematics_dataset = self.get_robot_kinematics_dataset()
         return kinematics_dataset.export_robot_pointcloud(keypoint_names)
+
+    def save_robot_pointcloud(self, keypoint, keypoint_names):
+        '''
+            Save a plain [N_finger, N, 3] float32 copy of the fingertip point cloud for the C++ workspace
+            index builder (manus_client build_workspace_index), which cannot read the pickled keypoint dict.
+        '''
+        robot_points = np.array([keypoint[name][..., :3] for name in keypoint_names])
+        np.save(self.get_robot_pointcloud_path(), np.ascontiguousarray(robot_points, dtype=np.float32))
+
+    def get_robot_pointcloud_path(self):
+        '''
+            Utility getter function. Return the path to the exported robot fingertip point cloud.
+        '''
+        data_name = self.config["name"]
+        return f"data/{data_name}_pointcloud.npy"
         
     def get_robot_kinematics_dataset(self):
         '''
@@ -76,6 +91,10 @@ class GeoRTTrainer:
         keypoint_names = self.get_keypoint_info()["link"]
 
         kinematics_dataset = RobotKinematicsDataset(dataset_path, keypoint_names=keypoint_names)
+
+        # datasets generated before the point cloud was saved with them.
+        if not os.path.exists(self.get_robot_pointcloud_path()):
+            self.save_robot_pointcloud(kinematics_dataset.keypoints, keypoint_names)
         return kinematics_dataset
 
     def get_robot_kinematics_dataset_path(self, postfix=False):
@@ -132,23 +151,18 @@ class GeoRTTrainer:
         joint_range_low = np.array(joint_range_low)
         joint_range_high = np.array(joint_range_high)
 
-        all_data_qpos = []
-        all_data_keypoint = []
-        
-        for _ in tqdm(range(n_total)):
-            qpos = np.random.uniform(0, 1, len(joint_range_low)) * (joint_range_high - joint_range_low) + joint_range_low
-            keypoint = self.hand.keypoint_from_qpos(qpos)
-            all_data_qpos.append(qpos)
-            all_data_keypoint.append(keypoint)
-            
-        all_data_keypoint = merge_dict_list(all_data_keypoint)    
-        
+        all_data_qpos = np.random.uniform(0, 1, (n_total, len(joint_range_low))) * (joint_range_high - joint_range_low) + joint_range_low
+        all_data_keypoint = self.hand.keypoints_from_qpos_batch(all_data_qpos) # [n_total, N_keypoint, 3]
+        all_data_keypoint = {name: all_data_keypoint[:, i] for i, name in enumerate(info["link"])}
+
         dataset = {"qpos": all_data_qpos, "keypoint": all_data_keypoint}
 
         if save:
             # save data to disk for future use.
             os.makedirs("data", exist_ok=True)
             np.savez(self.get_robot_kinematics_dataset_path(), **dataset)
+            # always next to the dataset, so the point cloud never outlives the dataset it came from.
+            self.save_robot_pointcloud(all_data_keypoint, info["link"])
 
         return dataset
 
@@ -286,15 +300,8 @@ class GeoRTTrainer:
 
                 # [Pinch Loss] 
                 # We find it sufficient to only consider thumb-X pinch. Note that idx 0 is thumb.
-                n_finger = point.size(1)
-                pinch_loss = 0
-
-                for i in range(n_finger):
-                    for j in range(i + 1, n_finger):
-                        distance = point[:, i, ...] - point[:, j, ...]
-                        mask = (torch.norm(distance, dim=-1) < 0.015).float()
-                        e_distance = ((embedded_point[:, i, ...] - embedded_point[:, j, ...]) ** 2).sum(dim=-1)
-                        pinch_loss += (mask * e_distance).mean() / (mask.sum() + 1e-7) * point.size(0)
+                # All finger pairs i < j are handled in one fused pass.
+                pinch_loss = compute_pinch_loss(point, embedded_point, threshold=0.015)
 
                 # [Curvature loss] -- Ensuring flatness.
                 direction = F.normalize(torch.randn_like(point), dim=-1, p=2)
@@ -4,8 +4,27 @@
 # This source code is licensed under the license found in the
 # LICENSE file in the root directory of this source tree.
 
+from glob import glob
 from setuptools import setup, find_packages
 
+# The geort._C extension is optional. Without PyTorch at build time (e.g. pip build isolation)
+# it is skipped and geort falls back to the pure Python code paths.
+ext_modules = []
+cmdclass = {}
+try:
+    from torch.utils.cpp_extension import BuildExtension, CppExtension
+
+    ext_modules.append(
+        CppExtension(
+            name='geort._C',
+            sources=sorted(glob('geort/csrc/*.cpp')),
+            extra_compile_args=['-O3'],
+        )
+    )
+    cmdclass['build_ext'] = BuildExtension
+except ImportError:
+    pass
+
 setup(
     name='geort',
     version='0.1',
@@ -13,4 +32,6 @@ setup(
     install_requires=[
         # your dependencies here
     ],
+    ext_modules=ext_modules,
+    cmdclass=cmdclass,
 )